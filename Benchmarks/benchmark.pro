@@ -0,0 +1,10 @@
+# The scene benchmarks; see ../Headless/headless.pri for the sources they need.
+# POSIX only: every scene runs in a child process of its own.
+
+TEMPLATE 	= app
+TARGET 		= benchmark
+DEFINES 	+= RENDER_STATS			# the counts it reports; see Utilities/RenderStats.h
+
+include(../Headless/headless.pri)
+
+SOURCES += $$PWD/main.cpp
@@ -0,0 +1,530 @@
+// Scene benchmarks.
+// Times construction and rendering of the scenes we ship and reports, per scene, the
+// ray throughput, primary, secondary and shadow ray counts, intersection tests per ray, the
+// operator new calls made while tracing tiles and the peak resident memory, as one JSON
+// document on stdout (or in the -o file). operator new is replaced in this program to count
+// them (RenderStats::allocation_counter); the renderer's per-frame set-up (tiles, queues and
+// threads) is left out. Tracing should allocate nothing: a scene whose rays do is flagged
+// with "allocation_free": false and reported on stderr.
+// Every scene runs in its own child process so that its peak memory is its own and a
+// crash in one scene does not lose the others.
+// Benchmarks/benchmark.pro builds it, from the sources listed in Headless/headless.pri.
+//
+//	usage: benchmark [-t threads] [-r resolution scale] [-f name filter] [-o file.json] [-s] [-c] [-A]
+//
+// -s traces every primary ray on its own, for comparison with the packet path.
+// -A builds every scene into a SceneArena; build and teardown times are reported either way.
+// -c also checks PacketTorus against Torus::hit on rays through the voyager's squashed
+// placements and on rays grazing the tube, and times both; and checks that every hit on the
+// library's curved objects lies inside the box AnalyticBounds gives it.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "GeometricObjects/AnalyticBounds.h"
+#include "GeometricObjects/CompoundObjects/SolidCone.h"
+#include "GeometricObjects/CompoundObjects/SolidCylinder.h"
+#include "GeometricObjects/CompoundObjects/ThickRing.h"
+#include "GeometricObjects/Primitives/PacketTorus.h"
+#include "Headless/SceneCatalogue.h"
+#include "Materials/MaterialRegistry.h"
+#include "Tracers/CountingTracer.h"
+#include "Utilities/Constants.h"
+#include "Utilities/RenderStats.h"
+#include "Utilities/SceneArena.h"
+#include "Utilities/ShadeRec.h"
+#include "World/TileRenderer.h"
+#include "World/World.h"
+
+#ifndef RENDER_STATS
+    #error "the benchmark reports the render counts: build it with RENDER_STATS (benchmark.pro does)"
+#endif
+
+struct BenchmarkCase {
+    const char* scene;
+    const char* argument;
+};
+
+static const BenchmarkCase cases[] = {
+    { "build_sphere_world", 		"" },
+    { "build_sphere_field_world", 	"100000" },
+    { "build_city_world", 			"" },
+    { "build_practical_world", 		"" },
+    { "build_olympic_rings_world", 	"" },
+    { "build_fisheye", 				"A" },
+    { "build_fisheye", 				"B" },
+    { "build_fisheye", 				"C" },
+    { "build_fisheye", 				"D" },
+    { "build_fisheye", 				"E" },
+    { "build_stereo", 				"A" },
+    { "build_thinlens", 			"" },
+    { "build_sundial_world", 		"" },
+    { "build_voyager_world", 		"0" },
+    { "build_voyager_world", 		"1" },
+    { "build_voyager_world", 		"2" },
+    { "build_voyager_world", 		"3" },
+    { "build_transparent_world", 	"" },
+    { "build_working_desk_world", 	"OVERHEAD" },
+    { "build_lit_desk_world", 		"8" },
+    { "build_lit_desk_world", 		"64" }
+};
+
+// the voyager's tori: swept and tube radius, and the scale of their placements
+struct TorusShape {
+    double a, b;
+    double sx, sy, sz;
+};
+
+static const TorusShape torus_shapes[] = {
+    { 30, 5, 	3, 1, 0.1 },
+    { 30, 8, 	2.3, 0.75, 0.1 },
+    { 30, 12, 	1.7, 0.5, 0.1 },
+    { 30, 15, 	1.4, 0.35, 0.1 },
+    { 30, 18, 	1.25, 0.3, 0.2 },
+    { 30, 30, 	1, 0.2, 0.1 }
+};
+
+
+// ---------------------------------------------------------------- operator new and delete
+// replaced in this program only, so that RenderStats::allocation_counter() counts every
+// allocation of the calling thread; the memory still comes from malloc
+
+void*
+operator new(std::size_t size) {
+    RenderStats::allocation_counter()++;
+
+    void* p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+
+    return (p);
+}
+
+void
+operator delete(void* p) noexcept {
+    free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept {
+    free(p);
+}
+
+
+// ---------------------------------------------------------------- seconds_since
+
+static double
+seconds_since(const std::chrono::steady_clock::time_point& start) {
+    return (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
+
+// ---------------------------------------------------------------- run_case
+// builds and renders one scene in the calling process and returns its JSON record
+
+static std::string
+run_case(const BenchmarkCase& c, const int num_threads, const double scale, const bool packets, const bool arena) {
+    SceneArena scene_arena(arena ? SceneArena::kDefaultChunkSize : 0);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    World* w = new World;
+    {
+        SceneArena::Scope scope(scene_arena);
+        SceneCatalogue::build(w, c.scene, c.argument);
+    }
+
+    double build_seconds = seconds_since(start);
+
+    if (scale != 1.0) {
+        w->vp.set_hres((int) (w->vp.hres * scale));
+        w->vp.set_vres((int) (w->vp.vres * scale));
+        w->vp.set_pixel_size(w->vp.s / scale);
+    }
+
+    w->tracer_ptr = new CountingTracer(w, w->tracer_ptr);
+
+    TileRenderer renderer;
+    renderer.set_num_threads(num_threads);
+    renderer.set_packets(packets);
+
+    Framebuffer fb;
+
+    RenderStats::reset();		// from here on the counts are the render's own
+
+    start = std::chrono::steady_clock::now();
+    bool rendered = renderer.render(*w, fb);
+    double render_seconds = seconds_since(start);
+
+    RenderCounts counts = RenderStats::total();
+
+    if (counts.allocations > 0)
+        fprintf(stderr, "%s %s: %llu allocations while tracing\n", c.scene, c.argument,
+                (unsigned long long) counts.allocations);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    size_t arena_used = scene_arena.get_used();
+
+    start = std::chrono::steady_clock::now();
+    delete w;
+    MaterialRegistry::shared().clear();
+    double teardown_seconds = seconds_since(start);
+
+    char record[1024];
+    double rays = counts.rays();
+
+    snprintf(record, sizeof(record),
+             "{\"scene\": \"%s\", \"argument\": \"%s\", \"rendered\": %s, "
+             "\"arena\": %s, \"arena_kb\": %lu, "
+             "\"build_seconds\": %.6f, \"render_seconds\": %.6f, \"teardown_seconds\": %.6f, \"rays_per_second\": %.1f, "
+             "\"primary_rays\": %llu, \"secondary_rays\": %llu, "
+             "\"shadow_rays\": %llu, \"occluder_cache_hits\": %llu, \"torus_fallbacks\": %llu, "
+             "\"intersection_tests_per_ray\": %.3f, \"allocations\": %llu, \"allocations_per_ray\": %.6f, "
+             "\"allocation_free\": %s, "
+             "\"peak_memory_kb\": %ld}",
+             c.scene, c.argument, rendered ? "true" : "false",
+             arena ? "true" : "false", (unsigned long) (arena_used / 1024),
+             build_seconds, render_seconds, teardown_seconds, render_seconds > 0.0 ? rays / render_seconds : 0.0,
+             (unsigned long long) counts.primary_rays, (unsigned long long) counts.secondary_rays,
+             (unsigned long long) counts.shadow_rays, (unsigned long long) counts.occluder_cache_hits,
+             (unsigned long long) counts.torus_fallbacks,
+             rays > 0.0 ? counts.intersection_tests() / rays : 0.0,
+             (unsigned long long) counts.allocations, rays > 0.0 ? counts.allocations / rays : 0.0,
+             counts.allocations == 0 ? "true" : "false",
+             (long) usage.ru_maxrss);
+
+    return (record);
+}
+
+
+// ---------------------------------------------------------------- run_isolated
+// runs one case in a child process and reads its record back through a pipe
+
+static std::string
+run_isolated(const BenchmarkCase& c, const int num_threads, const double scale, const bool packets, const bool arena) {
+    int fds[2];
+    if (pipe(fds) != 0)
+        return (run_case(c, num_threads, scale, packets, arena));
+
+    pid_t pid = fork();
+
+    if (pid == 0) {
+        close(fds[0]);
+
+        std::string record;
+        try {
+            record = run_case(c, num_threads, scale, packets, arena);
+        }
+        catch (std::invalid_argument* e) {
+            record = std::string("{\"scene\": \"") + c.scene + "\", \"error\": \"invalid argument\"}";
+            delete e;
+        }
+
+        ssize_t written = write(fds[1], record.data(), record.size());
+        _exit(written == (ssize_t) record.size() ? 0 : 1);
+    }
+
+    close(fds[1]);
+
+    std::string record;
+    char 		buffer[512];
+    ssize_t 	n;
+
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+        record.append(buffer, n);
+
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    if (record.empty() || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        record = std::string("{\"scene\": \"") + c.scene + "\", \"argument\": \"" + c.argument + "\", \"error\": \"crashed\"}";
+
+    return (record);
+}
+
+
+// ---------------------------------------------------------------- grazing_ray
+// a ray in the torus's own space along a tangent of the tube, moved off the surface along
+// its normal by between 1e-9 and 1e-2 of the tube radius, inwards or outwards at random, so
+// that it either misses by a hair or cuts a chord as short as the march could ever skip
+
+static Ray
+grazing_ray(const double a, const double b, std::mt19937& rng) {
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+
+    double 		phi 	= PI * u(rng);
+    double 		theta 	= PI * u(rng);
+    Vector3D 	n(cos(theta) * cos(phi), sin(theta), cos(theta) * sin(phi));
+    Vector3D 	r(u(rng), u(rng), u(rng));
+    Vector3D 	tangent = r - (r * n) * n;
+    tangent.normalize();
+
+    double 		offset 	= (u(rng) < 0.0 ? -b : b) * pow(10.0, -5.5 + 3.5 * u(rng));
+    Point3D 	p(a * cos(phi) + (b + offset) * n.x, (b + offset) * n.y, a * sin(phi) + (b + offset) * n.z);
+
+    return (Ray(p - (0.1 + u(rng) * 0.05) * (a + b) * tangent, tangent));
+}
+
+
+// ---------------------------------------------------------------- check_torus
+// rays from all around each squashed torus, aimed into its box, are taken into the torus's
+// own space as its placement would take them, and intersected by Torus::hit and by
+// PacketTorus::hit; so are as many grazing rays, which are counted apart. Returns a JSON
+// record of where the two disagree and how long each took
+
+static std::string
+check_torus(const int rays_per_shape) {
+    std::mt19937 							rng(1);
+    std::uniform_real_distribution<double> 	u(-1.0, 1.0);
+
+    World 		w;
+    ShadeRec 	sr(w);
+    int 		num_rays = 0, num_hits = 0, disagreements = 0;
+    int 		num_grazing = 0, grazing_hits = 0, grazing_disagreements = 0;
+    double 		max_difference = 0.0, quartic_seconds = 0.0, fast_seconds = 0.0;
+
+    RenderStats::reset();
+
+    for (const TorusShape& shape : torus_shapes) {
+        PacketTorus 		torus(shape.a, shape.b);
+        std::vector<Ray> 	rays(rays_per_shape);
+        std::vector<Ray> 	grazing(rays_per_shape);
+        double 				reach = 3.0 * (shape.a + shape.b) * std::max(shape.sx, std::max(shape.sy, shape.sz));
+
+        for (Ray& ray : rays) {
+            Point3D o(u(rng) * reach, u(rng) * reach, u(rng) * reach);
+            Point3D target(	u(rng) * (shape.a + shape.b) * shape.sx,
+                            u(rng) * shape.b * shape.sy,
+                            u(rng) * (shape.a + shape.b) * shape.sz);
+            Vector3D d = target - o;
+            d.normalize();
+
+            ray.o = Point3D(o.x / shape.sx, o.y / shape.sy, o.z / shape.sz);
+            ray.d = Vector3D(d.x / shape.sx, d.y / shape.sy, d.z / shape.sz);
+        }
+
+        for (Ray& ray : grazing)
+            ray = grazing_ray(shape.a, shape.b, rng);
+
+        rays.insert(rays.end(), grazing.begin(), grazing.end());
+
+        std::vector<double> quartic_t(rays.size(), 0.0);
+        std::vector<double> fast_t(rays.size(), 0.0);
+        double 				t;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t j = 0; j < rays.size(); j++)
+            quartic_t[j] = torus.Torus::hit(rays[j], t, sr) ? t : -1.0;
+        quartic_seconds += seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t j = 0; j < rays.size(); j++)
+            fast_t[j] = torus.hit(rays[j], t, sr) ? t : -1.0;
+        fast_seconds += seconds_since(start);
+
+        for (size_t j = 0; j < rays.size(); j++) {
+            double 	difference 	= fabs(fast_t[j] - quartic_t[j]);
+            bool 	disagree 	= (fast_t[j] > 0.0) != (quartic_t[j] > 0.0) || difference > 1.0e-6 * (1.0 + quartic_t[j]);
+
+            if (j >= (size_t) rays_per_shape) {
+                num_grazing++;
+                grazing_hits 			+= quartic_t[j] > 0.0;
+                grazing_disagreements 	+= disagree;
+                continue;
+            }
+
+            num_rays++;
+            num_hits += quartic_t[j] > 0.0;
+
+            if (disagree)
+                disagreements++;
+            else
+                max_difference = std::max(max_difference, difference);
+        }
+    }
+
+    RenderStats::flush();
+
+    int num_timed = num_rays + num_grazing;
+
+    char record[640];
+    snprintf(record, sizeof(record),
+             "{\"rays\": %d, \"hits\": %d, \"disagreements\": %d, \"max_difference\": %.3g, "
+             "\"grazing_rays\": %d, \"grazing_hits\": %d, \"grazing_disagreements\": %d, "
+             "\"fallbacks\": %llu, \"quartic_ns_per_ray\": %.1f, \"fast_ns_per_ray\": %.1f}",
+             num_rays, num_hits, disagreements, max_difference,
+             num_grazing, grazing_hits, grazing_disagreements,
+             (unsigned long long) RenderStats::total().torus_fallbacks,
+             num_timed ? 1.0e9 * quartic_seconds / num_timed : 0.0,
+             num_timed ? 1.0e9 * fast_seconds / num_timed : 0.0);
+
+    return (record);
+}
+
+
+// ---------------------------------------------------------------- check_bounds
+// rays aimed at a region twice the size of each object's analytic box, from outside it, are
+// intersected with the library object itself; every hit point has to lie inside the box.
+// The shapes are those the scenes bound. Returns a JSON array with a record per shape
+
+struct BoundedShape {
+    const char* 						name;
+    std::shared_ptr<GeometricObject> 	object_ptr;
+    BBox 								box;
+};
+
+static std::string
+check_bounds(const int rays_per_shape) {
+    std::mt19937 							rng(1);
+    std::uniform_real_distribution<double> 	u(-1.0, 1.0);
+
+    const BoundedShape shapes[] = {
+        { "torus(2, 0.5)", 					std::make_shared<Torus>(2, 0.5), 				AnalyticBounds::torus(2, 0.5) },
+        { "torus(30, 18)", 					std::make_shared<Torus>(30, 18), 				AnalyticBounds::torus(30, 18) },
+        { "thick_ring(2, 4, 5, 6)", 		std::make_shared<ThickRing>(2, 4, 5, 6), 		AnalyticBounds::thick_ring(2, 4, 5, 6) },
+        { "thick_ring(1.8, 2, 1, 1.1)", 	std::make_shared<ThickRing>(1.8, 2, 1, 1.1), 	AnalyticBounds::thick_ring(1.8, 2, 1, 1.1) },
+        { "solid_cone(5, 2)", 				std::make_shared<SolidCone>(5, 2), 				AnalyticBounds::solid_cone(5, 2) },
+        { "solid_cone(4, 1)", 				std::make_shared<SolidCone>(4, 1), 				AnalyticBounds::solid_cone(4, 1) },
+        { "solid_cylinder(0, 15, 4)", 		std::make_shared<SolidCylinder>(0, 15, 4), 		AnalyticBounds::solid_cylinder(0, 15, 4) }
+    };
+
+    World 		w;
+    ShadeRec 	sr(w);
+    std::string json = "[";
+
+    for (const BoundedShape& shape : shapes) {
+        const BBox& box = shape.box;
+        Point3D 	centre(0.5 * (box.x0 + box.x1), 0.5 * (box.y0 + box.y1), 0.5 * (box.z0 + box.z1));
+        Vector3D 	half(0.5 * (box.x1 - box.x0), 0.5 * (box.y1 - box.y0), 0.5 * (box.z1 - box.z0));
+        double 		reach = 4.0 * half.length();
+        int 		num_hits = 0, outside = 0;
+
+        for (int j = 0; j < rays_per_shape; j++) {
+            Vector3D from(u(rng), u(rng), u(rng));
+            from.normalize();
+
+            Point3D 	o 		= centre + reach * from;
+            Point3D 	target(	centre.x + 2.0 * half.x * u(rng),
+                                centre.y + 2.0 * half.y * u(rng),
+                                centre.z + 2.0 * half.z * u(rng));
+            Vector3D 	d 		= target - o;
+            d.normalize();
+
+            double t;
+
+            if (!shape.object_ptr->hit(Ray(o, d), t, sr))
+                continue;
+
+            num_hits++;
+            outside += !box.inside(o + t * d);
+        }
+
+        if (outside)
+            fprintf(stderr, "%s: %d of %d hits lie outside the analytic box\n", shape.name, outside, num_hits);
+
+        char record[256];
+        snprintf(record, sizeof(record), "%s\n    {\"shape\": \"%s\", \"rays\": %d, \"hits\": %d, \"outside\": %d}",
+                 json.size() > 1 ? "," : "", shape.name, rays_per_shape, num_hits, outside);
+        json += record;
+    }
+
+    return (json + "\n  ]");
+}
+
+
+// ---------------------------------------------------------------- main
+
+int
+main(int argc, char* argv[]) {
+    int 		num_threads = 0;
+    double 		scale = 1.0;
+    std::string filter;
+    std::string output;
+    bool 		packets = true;
+    bool 		check = false;
+    bool 		arena = false;
+
+    for (int j = 1; j < argc; j++) {
+        std::string arg = argv[j];
+
+        if (arg == "-t" && j + 1 < argc)
+            num_threads = atoi(argv[++j]);
+        else if (arg == "-r" && j + 1 < argc)
+            scale = atof(argv[++j]);
+        else if (arg == "-f" && j + 1 < argc)
+            filter = argv[++j];
+        else if (arg == "-o" && j + 1 < argc)
+            output = argv[++j];
+        else if (arg == "-s")
+            packets = false;
+        else if (arg == "-c")
+            check = true;
+        else if (arg == "-A")
+            arena = true;
+        else {
+            fprintf(stderr, "usage: benchmark [-t threads] [-r resolution scale] [-f name filter] [-o file.json] [-s] [-c] [-A]\n");
+            return (1);
+        }
+    }
+
+    TileRenderer renderer;
+    renderer.set_num_threads(num_threads);
+
+    std::string json = "{\n  \"threads\": " + std::to_string(renderer.get_num_threads())
+                     + ",\n  \"resolution_scale\": " + std::to_string(scale)
+                     + ",\n  \"packets\": " + (packets ? "true" : "false");
+
+    if (check) {
+        json += ",\n  \"torus_check\": " + check_torus(100000);
+        json += ",\n  \"bounds_check\": " + check_bounds(100000);
+    }
+
+    json += ",\n  \"scenes\": [\n";
+
+    bool first = true;
+
+    for (const BenchmarkCase& c : cases) {
+        if (!filter.empty() && std::string(c.scene).find(filter) == std::string::npos)
+            continue;
+
+        fprintf(stderr, "%s %s\n", c.scene, c.argument);
+
+        json += (first ? "    " : ",\n    ") + run_isolated(c, num_threads, scale, packets, arena);
+        first = false;
+    }
+
+    json += "\n  ]\n}\n";
+
+    if (output.empty()) {
+        fputs(json.c_str(), stdout);
+        return (0);
+    }
+
+    FILE* file = fopen(output.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "could not write %s\n", output.c_str());
+        return (1);
+    }
+
+    fputs(json.c_str(), file);
+    fclose(file);
+
+    return (0);
+}
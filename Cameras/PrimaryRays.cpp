@@ -0,0 +1,118 @@
+#include "PrimaryRays.h"
+
+#include "Cameras/Fisheye.h"
+#include "Cameras/Pinhole.h"
+#include "Cameras/ThinLens.h"
+#include "Utilities/Constants.h"
+
+// ---------------------------------------------------------------- constructor
+
+PrimaryRays::PrimaryRays(const Camera* camera_ptr, const ViewPlane& vp)
+    : 	model(UNSUPPORTED),
+        pinhole_ptr(dynamic_cast<const Pinhole*>(camera_ptr)),
+        thin_lens_ptr(dynamic_cast<const ThinLens*>(camera_ptr)),
+        fisheye_ptr(dynamic_cast<const Fisheye*>(camera_ptr)),
+        eye(),
+        u(), v(),
+        lens_radius(0.0),
+        s(vp.s),
+        hres(vp.hres),
+        vres(vp.vres)
+{
+    if (!camera_ptr)
+        return;
+
+    eye = camera_ptr->get_eye();
+    u 	= camera_ptr->get_u();
+    v 	= camera_ptr->get_v();
+
+    if (pinhole_ptr) {
+        model = PINHOLE;
+        s /= pinhole_ptr->get_zoom();
+    }
+    else if (thin_lens_ptr) {
+        model = THIN_LENS;
+        s /= thin_lens_ptr->get_zoom();
+        lens_radius = thin_lens_ptr->get_lens_radius();
+    }
+    else if (fisheye_ptr)
+        model = FISHEYE;
+}
+
+
+// ---------------------------------------------------------------- generate
+// the same arithmetic as the cameras' render_scene loops
+// returns false for samples that fall outside the fisheye image circle, which are black
+
+bool
+PrimaryRays::generate(	const int row, const int column,
+                        const Point2D& pixel_sample, const Point2D& lens_sample, Ray& ray) const {
+    Point2D pp(	s * (column - 0.5 * hres + pixel_sample.x),
+                s * (row - 0.5 * vres + pixel_sample.y));
+
+    switch (model) {
+        case PINHOLE:
+            ray.o = eye;
+            ray.d = pinhole_ptr->get_direction(pp);
+            return (true);
+
+        case THIN_LENS: {
+            Point2D dp = map_to_unit_disk(lens_sample);
+            Point2D lp(dp.x * lens_radius, dp.y * lens_radius);
+
+            ray.o = eye + lp.x * u + lp.y * v;
+            ray.d = thin_lens_ptr->ray_direction(pp, lp);
+            return (true);
+        }
+
+        case FISHEYE: {
+            float r_squared;
+
+            ray.o = eye;
+            ray.d = fisheye_ptr->ray_direction(pp, hres, vres, s, r_squared);
+            return (r_squared <= 1.0);
+        }
+
+        default:
+            return (false);
+    }
+}
+
+
+// ---------------------------------------------------------------- map_to_unit_disk
+// Shirley's concentric map, as in Sampler::map_samples_to_unit_disk
+
+Point2D
+PrimaryRays::map_to_unit_disk(const Point2D& sp) {
+    float r, phi;
+    float x = 2.0 * sp.x - 1.0;
+    float y = 2.0 * sp.y - 1.0;
+
+    if (x > -y) {
+        if (x > y) {
+            r = x;
+            phi = y / x;
+        }
+        else {
+            r = y;
+            phi = 2 - x / y;
+        }
+    }
+    else {
+        if (x < y) {
+            r = -x;
+            phi = 4 + y / x;
+        }
+        else {
+            r = -y;
+            if (y != 0.0)
+                phi = 6 - x / y;
+            else
+                phi  = 0.0;
+        }
+    }
+
+    phi *= PI / 4.0;
+
+    return (Point2D(r * cos(phi), r * sin(phi)));
+}
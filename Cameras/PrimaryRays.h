@@ -0,0 +1,82 @@
+#ifndef __PRIMARY_RAYS__
+#define __PRIMARY_RAYS__
+
+// Generates the primary ray of a single sample for the cameras whose render_scene is a
+// plain loop over pixels (Pinhole, ThinLens, Fisheye), so that a renderer can visit the
+// pixels in any order and on any thread.
+// Sample positions are passed in explicitly instead of being drawn from the camera's
+// or the view plane's sampler, which keeps the rays independent of the visiting order.
+// Other cameras (StereoCamera, MultiCamera) are reported as unsupported and keep their
+// own render_scene.
+
+#include "Cameras/Camera.h"
+#include "Utilities/Point2D.h"
+#include "Utilities/Ray.h"
+#include "World/ViewPlane.h"
+
+class Pinhole;
+class ThinLens;
+class Fisheye;
+
+class PrimaryRays {
+    public:
+
+        PrimaryRays(const Camera* camera_ptr, const ViewPlane& vp);
+
+        bool
+        is_supported(void) const;
+
+        bool
+        uses_lens(void) const;
+
+        bool
+        is_coherent(void) const;		// rays of neighbouring pixels share an origin
+
+        bool
+        generate(	const int row, const int column,
+                    const Point2D& pixel_sample, const Point2D& lens_sample, Ray& ray) const;
+
+    private:
+
+        enum Model { UNSUPPORTED, PINHOLE, THIN_LENS, FISHEYE };
+
+        Model 			model;
+        const Pinhole*	pinhole_ptr;
+        const ThinLens*	thin_lens_ptr;
+        const Fisheye*	fisheye_ptr;
+        Point3D			eye;
+        Vector3D		u, v;
+        double			lens_radius;
+        double			s;				// pixel size, divided by the zoom factor
+        int				hres;
+        int				vres;
+
+        static Point2D
+        map_to_unit_disk(const Point2D& sp);
+};
+
+
+// ---------------------------------------------------------------- is_supported
+
+inline bool
+PrimaryRays::is_supported(void) const {
+    return (model != UNSUPPORTED);
+}
+
+
+// ---------------------------------------------------------------- uses_lens
+
+inline bool
+PrimaryRays::uses_lens(void) const {
+    return (model == THIN_LENS);
+}
+
+
+// ---------------------------------------------------------------- is_coherent
+
+inline bool
+PrimaryRays::is_coherent(void) const {
+    return (model == PINHOLE);
+}
+
+#endif
@@ -0,0 +1,49 @@
+#include "AnalyticBounds.h"
+
+#include <algorithm>
+
+#include "Utilities/Constants.h"
+
+
+// ---------------------------------------------------------------- torus
+// the tube sweeps a circle of radius a in the xz plane
+
+BBox
+AnalyticBounds::torus(const double a, const double b) {
+    double r = a + b + kEpsilon;
+    double h = b + kEpsilon;
+
+    return (BBox(-r, r, -h, h, -r, r));
+}
+
+
+// ---------------------------------------------------------------- thick_ring
+// the inner radius only carves out the hole, which the box cannot follow
+
+BBox
+AnalyticBounds::thick_ring(const double bottom, const double top, const double inner, const double outer) {
+    double r = outer + kEpsilon;
+
+    return (BBox(-r, r, std::min(bottom, top) - kEpsilon, std::max(bottom, top) + kEpsilon, -r, r));
+}
+
+
+// ---------------------------------------------------------------- solid_cone
+// base of the given radius in the plane y = 0, apex at y = height
+
+BBox
+AnalyticBounds::solid_cone(const double height, const double radius) {
+    double r = radius + kEpsilon;
+
+    return (BBox(-r, r, std::min(0.0, height) - kEpsilon, std::max(0.0, height) + kEpsilon, -r, r));
+}
+
+
+// ---------------------------------------------------------------- solid_cylinder
+
+BBox
+AnalyticBounds::solid_cylinder(const double bottom, const double top, const double radius) {
+    double r = radius + kEpsilon;
+
+    return (BBox(-r, r, std::min(bottom, top) - kEpsilon, std::max(bottom, top) + kEpsilon, -r, r));
+}
@@ -0,0 +1,37 @@
+#ifndef __ANALYTIC_BOUNDS__
+#define __ANALYTIC_BOUNDS__
+
+// Bounding boxes of the library's curved primitives, worked out from their parameters in
+// their own object space, for Placement::set_bounds.
+// The library objects either bound themselves loosely or not at all (the compound parts of
+// ThickRing and SolidCone), so a placement of one of them could not be culled by its box.
+// Each shape is taken about the y axis, as the library builds them; the boxes are padded
+// by kEpsilon so that a ray grazing the surface is never culled.
+// Each function takes the arguments of the library constructor it bounds, in its order:
+//	Torus(a, b)										swept radius, tube radius
+//	ThickRing(bottom, top, inner, outer)			as the scenes call it, e.g. ThickRing(0.0, 0.5, radius - 0.1, radius)
+//	SolidCone(height, radius)						base of the radius at y = 0, apex at y = height
+//	SolidCylinder(bottom, top, radius)
+// The library's sources are not in this tree, so these readings are checked rather than
+// trusted: benchmark -c fires rays at each shape the scenes bound and reports every hit that
+// lies outside its box.
+
+#include "Utilities/BBox.h"
+
+class AnalyticBounds {
+    public:
+
+        static BBox
+        torus(const double a, const double b);									// swept radius a, tube radius b
+
+        static BBox
+        thick_ring(const double bottom, const double top, const double inner, const double outer);	// as ThickRing(bottom, top, inner, outer)
+
+        static BBox
+        solid_cone(const double height, const double radius);					// as SolidCone(height, radius)
+
+        static BBox
+        solid_cylinder(const double bottom, const double top, const double radius);	// as SolidCylinder(bottom, top, radius)
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "PacketBeveledBox.h"
+
+
+// ---------------------------------------------------------------- default constructor
+
+PacketBeveledBox::PacketBeveledBox(void)
+    : 	BeveledBox(Point3D(-1.0), Point3D(1.0), 0.25),
+        p0(-1.0),
+        p1(1.0),
+        rb(0.25)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+PacketBeveledBox::PacketBeveledBox(const Point3D& bottom, const Point3D& top, const double bevel_radius)
+    : 	BeveledBox(bottom, top, bevel_radius),
+        p0(bottom),
+        p1(top),
+        rb(bevel_radius)
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+PacketBeveledBox::PacketBeveledBox(const PacketBeveledBox& box)
+    : 	BeveledBox(box),
+        p0(box.p0),
+        p1(box.p1),
+        rb(box.rb)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+PacketBeveledBox*
+PacketBeveledBox::clone(void) const {
+    return (new PacketBeveledBox(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+PacketBeveledBox&
+PacketBeveledBox::operator= (const PacketBeveledBox& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    BeveledBox::operator=(rhs);
+
+    p0 = rhs.p0;
+    p1 = rhs.p1;
+    rb = rhs.rb;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+PacketBeveledBox::~PacketBeveledBox(void) {}
+
+
+// ---------------------------------------------------------------- hit_packet
+
+void
+PacketBeveledBox::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    int lanes 		= enter_box(packet, hits, p0.x, p1.x, p0.y, p1.y, p0.z, p1.z);
+    int fallback 	= 0;
+
+    for (int j = 0; j < kPacketSize; j++) {
+        if (!(lanes & (1 << j)))
+            continue;
+
+        const Ray& ray = packet.rays[j];
+        double 	t;
+        Normal 	normal;
+        bool 	inside;
+
+        if (!hit_box(ray, p0, p1, t, normal, inside))
+            continue;
+
+        if (inside) {
+            fallback |= 1 << j;
+            continue;
+        }
+
+        // the hit point must lie on the flat part of the face, clear of the bevels
+
+        Point3D p = ray.o + t * ray.d;
+
+        bool flat = (normal.x != 0.0 || (p.x >= p0.x + rb && p.x <= p1.x - rb))
+                 && (normal.y != 0.0 || (p.y >= p0.y + rb && p.y <= p1.y - rb))
+                 && (normal.z != 0.0 || (p.z >= p0.z + rb && p.z <= p1.z - rb));
+
+        if (!flat)
+            fallback |= 1 << j;
+        else if (t < hits.t_hit[j])
+            hits.record(j, t, normal, p, material_ptr);
+    }
+
+    if (fallback)
+        hit_lanes(this, packet, hits, fallback);
+}
@@ -0,0 +1,74 @@
+#ifndef __PACKET_BEVELED_BOX__
+#define __PACKET_BEVELED_BOX__
+
+// A BeveledBox that can also be hit by a RayPacket.
+// The flat faces of a bevelled box lie on the faces of its bounding box, inset by the bevel
+// radius, and the solid is convex; so a ray that enters the bounding box through the flat
+// part of a face hits that face first. Those lanes are resolved by one slab test; lanes that
+// enter near an edge or corner, or start inside the box, fall back to BeveledBox::hit.
+
+#include "BeveledBox.h"
+#include "GeometricObjects/PacketPrimitive.h"
+#include "Utilities/SceneArena.h"
+
+class PacketBeveledBox: public BeveledBox, public PacketPrimitive, public ArenaAllocated {
+    public:
+
+        PacketBeveledBox(void);
+
+        PacketBeveledBox(const Point3D& bottom, const Point3D& top, const double bevel_radius);
+
+        PacketBeveledBox(const PacketBeveledBox& box);
+
+        virtual PacketBeveledBox*
+        clone(void) const;
+
+        PacketBeveledBox&
+        operator= (const PacketBeveledBox& rhs);
+
+        virtual
+        ~PacketBeveledBox(void);
+
+        Point3D
+        get_p0(void) const;
+
+        Point3D
+        get_p1(void) const;
+
+        double
+        get_bevel_radius(void) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+    private:
+
+        Point3D 	p0, p1;				// minimum and maximum corners
+        double 		rb;					// bevel radius
+};
+
+
+// ---------------------------------------------------------------- get_p0
+
+inline Point3D
+PacketBeveledBox::get_p0(void) const {
+    return (p0);
+}
+
+
+// ---------------------------------------------------------------- get_p1
+
+inline Point3D
+PacketBeveledBox::get_p1(void) const {
+    return (p1);
+}
+
+
+// ---------------------------------------------------------------- get_bevel_radius
+
+inline double
+PacketBeveledBox::get_bevel_radius(void) const {
+    return (rb);
+}
+
+#endif
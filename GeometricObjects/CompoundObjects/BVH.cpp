@@ -0,0 +1,713 @@
+#include "BVH.h"
+
+#include <algorithm>
+
+#include "GeometricObjects/HitMaterial.h"
+#include "GeometricObjects/Instance.h"
+#include "GeometricObjects/Placement.h"
+#include "Utilities/Constants.h"
+#include "Utilities/RenderStats.h"
+
+// number of centroid bins used to evaluate the surface area heuristic
+static const int kNumBins = 12;
+
+// relative cost of visiting an interior node compared with testing one child
+static const double kTraversalCost = 0.125;
+
+// ---------------------------------------------------------------- enclose
+
+static void
+enclose(BBox& b, const BBox& c) {
+    b.x0 = std::min(b.x0, c.x0); b.x1 = std::max(b.x1, c.x1);
+    b.y0 = std::min(b.y0, c.y0); b.y1 = std::max(b.y1, c.y1);
+    b.z0 = std::min(b.z0, c.z0); b.z1 = std::max(b.z1, c.z1);
+}
+
+
+// ---------------------------------------------------------------- empty_box
+
+static BBox
+empty_box(void) {
+    return (BBox(kHugeValue, -kHugeValue, kHugeValue, -kHugeValue, kHugeValue, -kHugeValue));
+}
+
+
+// ---------------------------------------------------------------- pop_node
+// pops the next deferred node that can still hold a hit nearer than tmin
+
+static inline bool
+pop_node(const int stack[], const double stack_t[], int& top, const double tmin, int& node_index) {
+    while (top > 0) {
+        --top;
+        if (stack_t[top] < tmin) {
+            node_index = stack[top];
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+BVH::BVH(void)
+    : 	Group(),
+        nodes(),
+        packet_objects(),
+        occluder_objects(),
+        bbox(),
+        max_leaf_size(2),
+        built_area(0.0)
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+// Compound clones the children in order, so the node array stays valid for the copy
+
+BVH::BVH(const BVH& bvh)
+    : 	Group(bvh),
+        nodes(bvh.nodes),
+        packet_objects(),
+        occluder_objects(),
+        bbox(bvh.bbox),
+        max_leaf_size(bvh.max_leaf_size),
+        built_area(bvh.built_area)
+{
+    find_packet_objects();
+}
+
+
+// ---------------------------------------------------------------- clone
+
+BVH*
+BVH::clone(void) const {
+    return (new BVH(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+BVH&
+BVH::operator= (const BVH& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Group::operator= (rhs);
+
+    nodes 			= rhs.nodes;
+    bbox 			= rhs.bbox;
+    max_leaf_size 	= rhs.max_leaf_size;
+    built_area 		= rhs.built_area;
+
+    find_packet_objects();
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+// the children are deleted by Compound
+
+BVH::~BVH(void) {}
+
+
+// ---------------------------------------------------------------- get_bounding_box
+
+BBox
+BVH::get_bounding_box(void) {
+    return (bbox);
+}
+
+
+// ---------------------------------------------------------------- surface_area
+
+double
+BVH::surface_area(const BBox& b) {
+    double dx = b.x1 - b.x0;
+    double dy = b.y1 - b.y0;
+    double dz = b.z1 - b.z0;
+
+    if (dx < 0.0 || dy < 0.0 || dz < 0.0)
+        return (0.0);
+
+    return (2.0 * (dx * dy + dy * dz + dz * dx));
+}
+
+
+// ---------------------------------------------------------------- setup_hierarchy
+// builds the tree over the current children and reorders them so that every leaf
+// refers to a contiguous run of the objects array
+// Instance children have their bounding boxes refreshed and Placement children are
+// collapsed here, so they must already carry their final transforms, and nested BVHs
+// must already be set up
+
+void
+BVH::setup_hierarchy(void) {
+    nodes.clear();
+
+    int num_objects = objects.size();
+    if (num_objects == 0) {
+        bbox 		= BBox(0, 0, 0, 0, 0, 0);
+        built_area 	= 0.0;
+        return;
+    }
+
+    std::vector<BBox> 	boxes(num_objects);
+    std::vector<int> 	indices;
+
+    for (int j = 0; j < num_objects; j++) {
+        Instance* instance_ptr = dynamic_cast<Instance*>(objects[j]);
+        if (instance_ptr)
+            instance_ptr->compute_bounding_box();
+
+        Placement* placement_ptr = dynamic_cast<Placement*>(objects[j]);
+        if (placement_ptr)
+            placement_ptr->collapse();
+
+        boxes[j] = objects[j]->get_bounding_box();
+    }
+
+    build_tree(boxes, max_leaf_size, nodes, indices);
+
+    std::vector<GeometricObject*> ordered(num_objects);
+    for (int j = 0; j < num_objects; j++)
+        ordered[j] = objects[indices[j]];
+    objects.swap(ordered);
+
+    find_packet_objects();
+
+    const BVHNode& root = nodes[0];
+    bbox 		= BBox(root.x0, root.x1, root.y0, root.y1, root.z0, root.z1);
+    built_area 	= node_area();
+}
+
+
+// ---------------------------------------------------------------- refit
+// nodes are stored parent first, so a reverse sweep sees both children of an interior
+// node before the node itself: its first child follows it, the second is at offset
+// children are updated as setup_hierarchy updates them, except that placements are not
+// collapsed again; nested BVHs must be refitted first
+
+double
+BVH::refit(void) {
+    if (nodes.empty())
+        return (1.0);
+
+    for (int j = nodes.size() - 1; j >= 0; j--) {
+        BVHNode& node 	= nodes[j];
+        BBox b 			= empty_box();
+
+        if (node.count > 0) {
+            for (int k = node.offset; k < node.offset + node.count; k++) {
+                Instance* instance_ptr = dynamic_cast<Instance*>(objects[k]);
+                if (instance_ptr)
+                    instance_ptr->compute_bounding_box();
+
+                enclose(b, objects[k]->get_bounding_box());
+            }
+        }
+        else {
+            const BVHNode& first 	= nodes[j + 1];
+            const BVHNode& second 	= nodes[node.offset];
+
+            enclose(b, BBox(first.x0, first.x1, first.y0, first.y1, first.z0, first.z1));
+            enclose(b, BBox(second.x0, second.x1, second.y0, second.y1, second.z0, second.z1));
+        }
+
+        node.x0 = b.x0; node.x1 = b.x1;
+        node.y0 = b.y0; node.y1 = b.y1;
+        node.z0 = b.z0; node.z1 = b.z1;
+    }
+
+    const BVHNode& root = nodes[0];
+    bbox = BBox(root.x0, root.x1, root.y0, root.y1, root.z0, root.z1);
+
+    return (built_area > 0.0 ? node_area() / built_area : 1.0);
+}
+
+
+// ---------------------------------------------------------------- node_area
+// the summed surface area of the nodes, which is what a ray pays for in the SAH
+
+double
+BVH::node_area(void) const {
+    double area = 0.0;
+
+    for (const BVHNode& node : nodes)
+        area += surface_area(BBox(node.x0, node.x1, node.y0, node.y1, node.z0, node.z1));
+
+    return (area);
+}
+
+
+// ---------------------------------------------------------------- find_packet_objects
+// and the occluders, which are looked up the same way
+
+void
+BVH::find_packet_objects(void) {
+    packet_objects.resize(objects.size());
+    occluder_objects.resize(objects.size());
+
+    for (int j = 0; j < (int) objects.size(); j++) {
+        packet_objects[j] 	= dynamic_cast<const PacketPrimitive*>(objects[j]);
+        occluder_objects[j] = dynamic_cast<const Occluder*>(objects[j]);
+    }
+}
+
+
+// ---------------------------------------------------------------- build_tree
+// builds nodes over boxes; order receives the box indices in leaf order, so that every
+// leaf refers to a contiguous run of it
+
+void
+BVH::build_tree(const std::vector<BBox>& boxes, const int max_leaf_size,
+                std::vector<BVHNode>& nodes, std::vector<int>& order) {
+    int count = boxes.size();
+
+    std::vector<Point3D> centroids(count);
+    order.resize(count);
+
+    for (int j = 0; j < count; j++) {
+        centroids[j] = Point3D(	0.5 * (boxes[j].x0 + boxes[j].x1),
+                                0.5 * (boxes[j].y0 + boxes[j].y1),
+                                0.5 * (boxes[j].z0 + boxes[j].z1));
+        order[j] = j;
+    }
+
+    nodes.clear();
+    nodes.reserve(2 * count);
+
+    if (count > 0)
+        build_node(order, boxes, centroids, max_leaf_size, nodes, 0, count, 0);
+}
+
+
+// ---------------------------------------------------------------- build_node
+// binned SAH split of indices[first, first + count)
+// returns the index of the new node
+
+int
+BVH::build_node(std::vector<int>& indices, const std::vector<BBox>& boxes,
+                const std::vector<Point3D>& centroids, const int max_leaf_size, std::vector<BVHNode>& nodes,
+                const int first, const int count, const int depth) {
+    int node_index = nodes.size();
+    nodes.push_back(BVHNode());
+
+    BBox bounds = empty_box();
+    BBox centroid_bounds = empty_box();
+
+    for (int j = first; j < first + count; j++) {
+        const Point3D& c = centroids[indices[j]];
+        enclose(bounds, boxes[indices[j]]);
+        enclose(centroid_bounds, BBox(c.x, c.x, c.y, c.y, c.z, c.z));
+    }
+
+    BVHNode leaf;
+    leaf.x0 = bounds.x0; leaf.x1 = bounds.x1;
+    leaf.y0 = bounds.y0; leaf.y1 = bounds.y1;
+    leaf.z0 = bounds.z0; leaf.z1 = bounds.z1;
+    leaf.offset = first;
+    leaf.count 	= count;
+
+    if (count <= max_leaf_size || depth >= kBVHStackSize - 1) {
+        nodes[node_index] = leaf;
+        return (node_index);
+    }
+
+    // split along the axis with the widest spread of centroids
+
+    double extent[3] = {	centroid_bounds.x1 - centroid_bounds.x0,
+                            centroid_bounds.y1 - centroid_bounds.y0,
+                            centroid_bounds.z1 - centroid_bounds.z0 };
+    double lower[3] = { centroid_bounds.x0, centroid_bounds.y0, centroid_bounds.z0 };
+
+    int axis = 0;
+    if (extent[1] > extent[axis]) axis = 1;
+    if (extent[2] > extent[axis]) axis = 2;
+
+    int mid = first + count / 2;
+
+    if (extent[axis] > kEpsilon) {
+        int 	bin_count[kNumBins] = { 0 };
+        BBox 	bin_bounds[kNumBins];
+
+        for (int b = 0; b < kNumBins; b++)
+            bin_bounds[b] = empty_box();
+
+        double scale = kNumBins / extent[axis];
+
+        for (int j = first; j < first + count; j++) {
+            const Point3D& c = centroids[indices[j]];
+            double value = (axis == 0) ? c.x : (axis == 1) ? c.y : c.z;
+            int b = std::min(kNumBins - 1, (int) ((value - lower[axis]) * scale));
+            bin_count[b]++;
+            enclose(bin_bounds[b], boxes[indices[j]]);
+        }
+
+        // sweep from the right to get the area and count of every right-hand side
+
+        double 	right_area[kNumBins];
+        int 	right_count[kNumBins];
+        BBox 	sweep = empty_box();
+        int 	n = 0;
+
+        for (int b = kNumBins - 1; b > 0; b--) {
+            enclose(sweep, bin_bounds[b]);
+            n += bin_count[b];
+            right_area[b] 	= surface_area(sweep);
+            right_count[b] 	= n;
+        }
+
+        double 	parent_area = surface_area(bounds);
+        double 	best_cost 	= kHugeValue;
+        int 	best_split 	= -1;
+
+        sweep = empty_box();
+        n = 0;
+
+        for (int b = 0; b < kNumBins - 1; b++) {
+            enclose(sweep, bin_bounds[b]);
+            n += bin_count[b];
+
+            if (n == 0 || right_count[b + 1] == 0)
+                continue;
+
+            double cost = kTraversalCost;
+            if (parent_area > 0.0)
+                cost += (surface_area(sweep) * n + right_area[b + 1] * right_count[b + 1]) / parent_area;
+
+            if (cost < best_cost) {
+                best_cost 	= cost;
+                best_split 	= b;
+            }
+        }
+
+        // a leaf is cheaper than any split: keep the children together
+
+        if (best_split < 0 || (best_cost >= count && count <= 4 * max_leaf_size)) {
+            nodes[node_index] = leaf;
+            return (node_index);
+        }
+
+        std::vector<int>::iterator split = std::partition(	indices.begin() + first,
+                                                            indices.begin() + first + count,
+                                                            [&](int index) {
+            const Point3D& c = centroids[index];
+            double value = (axis == 0) ? c.x : (axis == 1) ? c.y : c.z;
+            return (std::min(kNumBins - 1, (int) ((value - lower[axis]) * scale)) <= best_split);
+        });
+
+        mid = split - indices.begin();
+    }
+
+    if (mid == first || mid == first + count) {
+        // coincident centroids: fall back to a median split
+        mid = first + count / 2;
+        std::nth_element(	indices.begin() + first, indices.begin() + mid, indices.begin() + first + count,
+                            [&](int a, int b) {
+            const Point3D& ca = centroids[a];
+            const Point3D& cb = centroids[b];
+            return ((axis == 0) ? ca.x < cb.x : (axis == 1) ? ca.y < cb.y : ca.z < cb.z);
+        });
+    }
+
+    build_node(indices, boxes, centroids, max_leaf_size, nodes, first, mid - first, depth + 1);	// first child follows its parent
+    int second = build_node(indices, boxes, centroids, max_leaf_size, nodes, mid, first + count - mid, depth + 1);
+
+    leaf.offset = second;
+    leaf.count 	= 0;
+    nodes[node_index] = leaf;
+
+    return (node_index);
+}
+
+
+// ---------------------------------------------------------------- hit
+// front-to-back traversal; nodes that start beyond the nearest hit found so far are skipped
+
+bool
+BVH::hit(const Ray& ray, double& tmin, ShadeRec& sr) const {
+    if (nodes.empty())
+        return (false);
+
+    RENDER_COUNT(RenderCounts& counts = RenderStats::local());
+
+    double 	inv_d[3] = { 1.0 / ray.d.x, 1.0 / ray.d.y, 1.0 / ray.d.z };
+    double	t;
+    double 	tnear;
+    Normal	normal;
+    Point3D	local_hit_point;
+    std::shared_ptr<Material> material;
+    int 	nearest = -1;
+
+    tmin = kHugeValue;
+    RENDER_COUNT(counts.node_tests++);
+
+    if (!nodes[0].entry(ray.o, inv_d, tmin, tnear))
+        return (false);
+
+    int 	stack[kBVHStackSize];
+    double 	stack_t[kBVHStackSize];
+    int 	top = 0;
+    int 	node_index = 0;
+
+    while (true) {
+        const BVHNode& node = nodes[node_index];
+
+        if (node.count > 0) {
+            RENDER_COUNT(counts.object_tests += node.count);
+
+            for (int j = node.offset; j < node.offset + node.count; j++)
+                if (objects[j]->hit(ray, t, sr) && (t < tmin)) {
+                    tmin			= t;
+                    nearest			= j;
+                    normal			= sr.normal;
+                    local_hit_point	= sr.local_hit_point;
+                    material 		= HitMaterial::take(objects[j], t, sr);
+                }
+        }
+        else {
+            int 	left 	= node_index + 1;
+            int 	right 	= node.offset;
+            double 	t_left, t_right;
+            bool 	hit_left 	= nodes[left].entry(ray.o, inv_d, tmin, t_left);
+            bool 	hit_right 	= nodes[right].entry(ray.o, inv_d, tmin, t_right);
+
+            RENDER_COUNT(counts.node_tests += 2);
+
+            if (hit_left && hit_right) {
+                if (t_right < t_left) {
+                    std::swap(left, right);
+                    std::swap(t_left, t_right);
+                }
+                stack[top] 		= right;
+                stack_t[top++] 	= t_right;
+                node_index 		= left;
+                continue;
+            }
+
+            if (hit_left) 	{ node_index = left;  continue; }
+            if (hit_right) 	{ node_index = right; continue; }
+        }
+
+        if (!pop_node(stack, stack_t, top, tmin, node_index))
+            break;
+    }
+
+    if (nearest < 0)
+        return (false);
+
+    HitMaterial::set(sr, tmin, material);
+    sr.normal 			= normal;
+    sr.local_hit_point 	= local_hit_point;
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- shadow_hit
+// nearest occluder, so that point lights can compare it with their distance
+
+bool
+BVH::shadow_hit(const Ray& ray, float& tmin) const {
+    if (nodes.empty())
+        return (false);
+
+    RENDER_COUNT(RenderCounts& counts = RenderStats::local());
+
+    double 	inv_d[3] = { 1.0 / ray.d.x, 1.0 / ray.d.y, 1.0 / ray.d.z };
+    double 	tnear;
+    float 	t;
+    bool 	hit = false;
+
+    tmin = kHugeValue;
+    RENDER_COUNT(counts.node_tests++);
+
+    if (!nodes[0].entry(ray.o, inv_d, tmin, tnear))
+        return (false);
+
+    int 	stack[kBVHStackSize];
+    double 	stack_t[kBVHStackSize];
+    int 	top = 0;
+    int 	node_index = 0;
+
+    while (true) {
+        const BVHNode& node = nodes[node_index];
+
+        if (node.count > 0) {
+            RENDER_COUNT(counts.object_tests += node.count);
+
+            for (int j = node.offset; j < node.offset + node.count; j++)
+                if (objects[j]->shadow_hit(ray, t) && (t < tmin)) {
+                    tmin 	= t;
+                    hit 	= true;
+                }
+        }
+        else {
+            int 	left 	= node_index + 1;
+            int 	right 	= node.offset;
+            double 	t_left, t_right;
+            bool 	hit_left 	= nodes[left].entry(ray.o, inv_d, tmin, t_left);
+            bool 	hit_right 	= nodes[right].entry(ray.o, inv_d, tmin, t_right);
+
+            RENDER_COUNT(counts.node_tests += 2);
+
+            if (hit_left && hit_right) {
+                if (t_right < t_left) {
+                    std::swap(left, right);
+                    std::swap(t_left, t_right);
+                }
+                stack[top] 		= right;
+                stack_t[top++] 	= t_right;
+                node_index 		= left;
+                continue;
+            }
+
+            if (hit_left) 	{ node_index = left;  continue; }
+            if (hit_right) 	{ node_index = right; continue; }
+        }
+
+        if (!pop_node(stack, stack_t, top, tmin, node_index))
+            return (hit);
+    }
+}
+
+
+// ---------------------------------------------------------------- occluded
+// any blocker will do, so nodes are visited in storage order and none are skipped for
+// lying behind a hit
+
+bool
+BVH::occluded(const Ray& ray, const double tmax, Occlusion& occlusion) const {
+    if (nodes.empty())
+        return (false);
+
+    RENDER_COUNT(RenderCounts& counts = RenderStats::local());
+
+    double 	inv_d[3] = { 1.0 / ray.d.x, 1.0 / ray.d.y, 1.0 / ray.d.z };
+    double 	tnear;
+    int 	stack[kBVHStackSize];
+    int 	top = 0;
+    int 	node_index = 0;
+
+    RENDER_COUNT(counts.node_tests++);
+
+    if (!nodes[0].entry(ray.o, inv_d, tmax, tnear))
+        return (false);
+
+    while (true) {
+        const BVHNode& node = nodes[node_index];
+
+        if (node.count > 0) {
+            for (int j = node.offset; j < node.offset + node.count; j++) {
+                RENDER_COUNT(counts.object_tests++);
+
+                if (test_object(objects[j], occluder_objects[j], ray, tmax, occlusion))
+                    return (true);
+            }
+        }
+        else {
+            int 	left 	= node_index + 1;
+            int 	right 	= node.offset;
+            bool 	hit_left 	= nodes[left].entry(ray.o, inv_d, tmax, tnear);
+            bool 	hit_right 	= nodes[right].entry(ray.o, inv_d, tmax, tnear);
+
+            RENDER_COUNT(counts.node_tests += 2);
+
+            if (hit_left && hit_right) {
+                stack[top++] 	= right;
+                node_index 		= left;
+                continue;
+            }
+
+            if (hit_left) 	{ node_index = left;  continue; }
+            if (hit_right) 	{ node_index = right; continue; }
+        }
+
+        if (top == 0)
+            return (false);
+
+        node_index = stack[--top];
+    }
+}
+
+
+// ---------------------------------------------------------------- hit_packet
+// depth-first over the nodes that any ray of the packet enters; when both children are
+// entered, the one nearer along the first active ray is visited first
+// deferred nodes are tested again when they are popped, as the packet's hits may have
+// moved closer in the meantime
+
+void
+BVH::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    if (nodes.empty() || !packet.active)
+        return;
+
+    RENDER_COUNT(RenderCounts& counts = RenderStats::local());
+    RENDER_COUNT(int num_active = lane_count(packet.active));
+
+    int first = 0;
+    while (!(packet.active & (1 << first)))
+        first++;
+
+    const Vector3D& d = packet.rays[first].d;
+
+    int 	stack[kBVHStackSize];
+    int 	top = 0;
+    int 	node_index = 0;
+
+    RENDER_COUNT(counts.node_tests += num_active);
+
+    if (!enter_box(packet, hits, nodes[0].x0, nodes[0].x1, nodes[0].y0, nodes[0].y1, nodes[0].z0, nodes[0].z1))
+        return;
+
+    while (true) {
+        const BVHNode& node = nodes[node_index];
+
+        if (node.count > 0) {
+            RENDER_COUNT(counts.object_tests += node.count * num_active);
+
+            for (int j = node.offset; j < node.offset + node.count; j++)
+                hit_object(objects[j], packet_objects[j], packet, hits);
+        }
+        else {
+            int 		left 	= node_index + 1;
+            int 		right 	= node.offset;
+            const BVHNode& l 	= nodes[left];
+            const BVHNode& r 	= nodes[right];
+            bool hit_left 		= enter_box(packet, hits, l.x0, l.x1, l.y0, l.y1, l.z0, l.z1) != 0;
+            bool hit_right 		= enter_box(packet, hits, r.x0, r.x1, r.y0, r.y1, r.z0, r.z1) != 0;
+
+            RENDER_COUNT(counts.node_tests += 2 * num_active);
+
+            if (hit_left && hit_right) {
+                double along = 	(r.x0 + r.x1 - l.x0 - l.x1) * d.x +
+                                (r.y0 + r.y1 - l.y0 - l.y1) * d.y +
+                                (r.z0 + r.z1 - l.z0 - l.z1) * d.z;
+                if (along < 0.0)
+                    std::swap(left, right);
+                stack[top++] 	= right;
+                node_index 		= left;
+                continue;
+            }
+
+            if (hit_left) 	{ node_index = left;  continue; }
+            if (hit_right) 	{ node_index = right; continue; }
+        }
+
+        bool found = false;
+
+        while (!found && top > 0) {
+            const BVHNode& n = nodes[stack[--top]];
+            RENDER_COUNT(counts.node_tests += num_active);
+            if (enter_box(packet, hits, n.x0, n.x1, n.y0, n.y1, n.z0, n.z1)) {
+                node_index 	= stack[top];
+                found 		= true;
+            }
+        }
+
+        if (!found)
+            return;
+    }
+}
@@ -0,0 +1,155 @@
+#ifndef __BVH__
+#define __BVH__
+
+// A bounding volume hierarchy over the children of a Compound.
+// The tree is built with the surface area heuristic (binned over the child centroids)
+// and stored as a flat array of nodes in depth-first order, so a BVH can stand in for
+// a Compound at any level of a scene: fill it with add_object, then call
+// setup_hierarchy once all children have their final transforms.
+// Children must report finite bounding boxes - keep infinite planes out of it, as with Grid.
+// refit keeps the tree and only recomputes the node bounds from the children, for frames in
+// which children have moved; it is much cheaper than setup_hierarchy, but the tree degrades as
+// the children drift from where it was built, which its return value measures.
+// build_tree is the same build over bare boxes, for structures that keep their own
+// primitives (FlatScene).
+// A BVH is also a PacketPrimitive: a packet descends the tree while any of its rays enter a
+// node, and children without a packet path are tested one ray at a time.
+// It is also an Occluder: a shadow ray descends in storage order, without sorting the
+// children or shrinking tmax, and stops at the first child that blocks it.
+
+#include <algorithm>
+#include <vector>
+
+#include "Group.h"
+#include "GeometricObjects/Occluder.h"
+#include "GeometricObjects/PacketPrimitive.h"
+#include "Utilities/BBox.h"
+#include "Utilities/Constants.h"
+
+// the build stops splitting at this depth, which bounds the traversal stack
+const int kBVHStackSize = 64;
+
+struct BVHNode {
+    double	x0, x1, y0, y1, z0, z1;		// node bounds
+    int		offset;						// leaf: first child in objects; interior: index of the second child node
+    int		count;						// number of children in a leaf, 0 for interior nodes
+
+    bool
+    entry(const Point3D& o, const double inv_d[3], const double tmax, double& tnear) const;
+};
+
+class BVH: public Group, public PacketPrimitive, public Occluder {
+    public:
+
+        BVH(void);
+
+        BVH(const BVH& bvh);
+
+        virtual BVH*
+        clone(void) const;
+
+        BVH&
+        operator= (const BVH& rhs);
+
+        virtual
+        ~BVH(void);
+
+        virtual BBox
+        get_bounding_box(void);
+
+        void
+        set_max_leaf_size(const int size);
+
+        void
+        setup_hierarchy(void);
+
+        double
+        refit(void);									// returns the node area over the area at the last build
+
+        int
+        get_num_nodes(void) const;
+
+        virtual bool
+        hit(const Ray& ray, double& tmin, ShadeRec& sr) const;
+
+        virtual bool
+        shadow_hit(const Ray& ray, float& tmin) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+        virtual bool
+        occluded(const Ray& ray, const double tmax, Occlusion& occlusion) const;
+
+        static void
+        build_tree(const std::vector<BBox>& boxes, const int max_leaf_size,
+                   std::vector<BVHNode>& nodes, std::vector<int>& order);
+
+    private:
+
+        std::vector<BVHNode>				nodes;
+        std::vector<const PacketPrimitive*>	packet_objects;		// objects[j] as a PacketPrimitive, or null
+        std::vector<const Occluder*>		occluder_objects;	// objects[j] as an Occluder, or null
+        BBox					bbox;
+        int						max_leaf_size;
+        double					built_area;				// summed node surface area at the last build
+
+        static int
+        build_node(std::vector<int>& indices, const std::vector<BBox>& boxes,
+                   const std::vector<Point3D>& centroids, const int max_leaf_size, std::vector<BVHNode>& nodes,
+                   const int first, const int count, const int depth);
+
+        void
+        find_packet_objects(void);
+
+        double
+        node_area(void) const;
+
+        static double
+        surface_area(const BBox& b);
+};
+
+
+// ---------------------------------------------------------------- set_max_leaf_size
+
+inline void
+BVH::set_max_leaf_size(const int size) {
+    max_leaf_size = size < 1 ? 1 : size;
+}
+
+
+// ---------------------------------------------------------------- get_num_nodes
+
+inline int
+BVH::get_num_nodes(void) const {
+    return (nodes.size());
+}
+
+
+
+// ---------------------------------------------------------------- entry
+// slab test of a ray against the node bounds, using the precomputed inverse direction
+// returns the entry distance in tnear when the ray enters the node before tmax
+
+inline bool
+BVHNode::entry(const Point3D& o, const double inv_d[3], const double tmax, double& tnear) const {
+    double tx0 = (x0 - o.x) * inv_d[0];
+    double tx1 = (x1 - o.x) * inv_d[0];
+    if (tx0 > tx1) std::swap(tx0, tx1);
+
+    double ty0 = (y0 - o.y) * inv_d[1];
+    double ty1 = (y1 - o.y) * inv_d[1];
+    if (ty0 > ty1) std::swap(ty0, ty1);
+
+    double tz0 = (z0 - o.z) * inv_d[2];
+    double tz1 = (z1 - o.z) * inv_d[2];
+    if (tz0 > tz1) std::swap(tz0, tz1);
+
+    double t0 = std::max(tx0, std::max(ty0, tz0));
+    double t1 = std::min(tx1, std::min(ty1, tz1));
+
+    tnear = t0;
+    return (t0 <= t1 && t1 > kEpsilon && t0 < tmax);
+}
+
+#endif
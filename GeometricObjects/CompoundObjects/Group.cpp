@@ -0,0 +1,77 @@
+#include "Group.h"
+
+#include "GeometricObjects/HitMaterial.h"
+#include "Utilities/Constants.h"
+#include "Utilities/ShadeRec.h"
+
+// ---------------------------------------------------------------- default constructor
+
+Group::Group(void)
+    : 	Compound()
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+Group::Group(const Group& group)
+    : 	Compound(group)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+Group*
+Group::clone(void) const {
+    return (new Group(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+Group&
+Group::operator= (const Group& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Compound::operator= (rhs);
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+// the children are deleted by Compound
+
+Group::~Group(void) {}
+
+
+// ---------------------------------------------------------------- hit
+
+bool
+Group::hit(const Ray& ray, double& tmin, ShadeRec& sr) const {
+    double 	t;
+    Normal 	normal;
+    Point3D local_hit_point;
+    std::shared_ptr<Material> material;
+    bool 	hit = false;
+
+    tmin = kHugeValue;
+
+    for (GeometricObject* object_ptr : objects)
+        if (object_ptr->hit(ray, t, sr) && (t < tmin)) {
+            hit 			= true;
+            tmin 			= t;
+            normal 			= sr.normal;
+            local_hit_point = sr.local_hit_point;
+            material 		= HitMaterial::take(object_ptr, t, sr);
+        }
+
+    if (!hit)
+        return (false);
+
+    HitMaterial::set(sr, tmin, material);
+    sr.normal 			= normal;
+    sr.local_hit_point 	= local_hit_point;
+
+    return (true);
+}
@@ -0,0 +1,47 @@
+#ifndef __GROUP__
+#define __GROUP__
+
+// A Compound whose children can be read back, and whose hit leaves the group itself alone.
+// Compound keeps its children protected, with no getter; get_objects gives the scene writer
+// and the scene cache the children of a group, BVH or MailboxGrid, which all derive from it.
+// Compound::hit stores the material of the child it hit in the compound; Group::hit hands it
+// back through the ShadeRec instead (see HitMaterial), so render threads share nothing.
+// The scene reader builds its compound blocks as groups.
+
+#include <vector>
+
+#include "Compound.h"
+#include "Utilities/SceneArena.h"
+
+class Group: public Compound, public ArenaAllocated {
+    public:
+
+        Group(void);
+
+        Group(const Group& group);
+
+        virtual Group*
+        clone(void) const;
+
+        Group&
+        operator= (const Group& rhs);
+
+        virtual
+        ~Group(void);
+
+        virtual bool
+        hit(const Ray& ray, double& tmin, ShadeRec& sr) const;
+
+        const std::vector<GeometricObject*>&
+        get_objects(void) const;
+};
+
+
+// ---------------------------------------------------------------- get_objects
+
+inline const std::vector<GeometricObject*>&
+Group::get_objects(void) const {
+    return (objects);
+}
+
+#endif
@@ -0,0 +1,459 @@
+#include "MailboxGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "GeometricObjects/HitMaterial.h"
+#include "GeometricObjects/Instance.h"
+#include "GeometricObjects/Placement.h"
+#include "Utilities/Constants.h"
+#include "Utilities/RenderStats.h"
+#include "Utilities/ShadeRec.h"
+
+// entries in a ray's mailbox; children are hashed into it by index, so two children that
+// share a slot may both be tested more than once, which costs time but never a hit
+static const int kMailboxSize = 64;
+
+
+// ---------------------------------------------------------------- Walk
+// the state of one ray through the grid: the nearest hit so far and the mailbox
+
+struct MailboxGrid::Walk {
+    bool 			shadow;
+    ShadeRec* 		sr;
+    double 			tmin;
+    int 			nearest;
+    Normal 			normal;
+    Point3D 		local_hit_point;
+    std::shared_ptr<Material> material;
+    int 			mailbox[kMailboxSize];
+#ifdef RENDER_STATS
+    RenderCounts& 	counts;
+#endif
+
+    Walk(const bool shadow_ray, ShadeRec* sr_ptr)
+        : 	shadow(shadow_ray),
+            sr(sr_ptr),
+            tmin(kHugeValue),
+            nearest(-1)
+#ifdef RENDER_STATS
+            , counts(RenderStats::local())
+#endif
+    {
+        std::fill(mailbox, mailbox + kMailboxSize, -1);
+    }
+};
+
+
+// ---------------------------------------------------------------- clamp
+
+static inline int
+clamp(const int x, const int low, const int high) {
+    return (x < low ? low : (x > high ? high : x));
+}
+
+
+// ---------------------------------------------------------------- cell_index
+// the cell of coordinate x along an axis [x0, x1] cut into n cells
+
+static inline int
+cell_index(const double x, const double x0, const double x1, const int n) {
+    if (x1 <= x0)
+        return (0);
+
+    return (clamp((int) ((x - x0) * n / (x1 - x0)), 0, n - 1));
+}
+
+
+// ---------------------------------------------------------------- resolution
+// Grid's heuristic: about multiplier cells per cube root of the volume per child
+
+static inline int
+resolution(const double w, const double s, const double multiplier, const int max_resolution) {
+    return (clamp((int) (multiplier * w / s) + 1, 1, max_resolution));
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+MailboxGrid::MailboxGrid(void)
+    : 	Group(),
+        levels(),
+        cells(),
+        items(),
+        bbox(),
+        multiplier(2.0),
+        max_resolution(128),
+        subgrid_threshold(16)
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+// Compound clones the children in order, so the cells stay valid for the copy
+
+MailboxGrid::MailboxGrid(const MailboxGrid& grid)
+    : 	Group(grid),
+        levels(grid.levels),
+        cells(grid.cells),
+        items(grid.items),
+        bbox(grid.bbox),
+        multiplier(grid.multiplier),
+        max_resolution(grid.max_resolution),
+        subgrid_threshold(grid.subgrid_threshold)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+MailboxGrid*
+MailboxGrid::clone(void) const {
+    return (new MailboxGrid(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+MailboxGrid&
+MailboxGrid::operator= (const MailboxGrid& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Group::operator= (rhs);
+
+    levels 				= rhs.levels;
+    cells 				= rhs.cells;
+    items 				= rhs.items;
+    bbox 				= rhs.bbox;
+    multiplier 			= rhs.multiplier;
+    max_resolution 		= rhs.max_resolution;
+    subgrid_threshold 	= rhs.subgrid_threshold;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+// the children are deleted by Compound
+
+MailboxGrid::~MailboxGrid(void) {}
+
+
+// ---------------------------------------------------------------- get_bounding_box
+
+BBox
+MailboxGrid::get_bounding_box(void) {
+    return (bbox);
+}
+
+
+// ---------------------------------------------------------------- setup_cells
+// Instance children have their bounding boxes refreshed and Placement children are
+// collapsed here, so they must already carry their final transforms
+
+void
+MailboxGrid::setup_cells(void) {
+    levels.clear();
+    cells.clear();
+    items.clear();
+
+    int num_objects = objects.size();
+    if (num_objects == 0) {
+        bbox = BBox(0, 0, 0, 0, 0, 0);
+        return;
+    }
+
+    std::vector<BBox> 	boxes(num_objects);
+    std::vector<int> 	indices(num_objects);
+
+    bbox = BBox(kHugeValue, -kHugeValue, kHugeValue, -kHugeValue, kHugeValue, -kHugeValue);
+
+    for (int j = 0; j < num_objects; j++) {
+        Instance* instance_ptr = dynamic_cast<Instance*>(objects[j]);
+        if (instance_ptr)
+            instance_ptr->compute_bounding_box();
+
+        Placement* placement_ptr = dynamic_cast<Placement*>(objects[j]);
+        if (placement_ptr)
+            placement_ptr->collapse();
+
+        boxes[j] 	= objects[j]->get_bounding_box();
+        indices[j] 	= j;
+
+        bbox.x0 = std::min(bbox.x0, boxes[j].x0); bbox.x1 = std::max(bbox.x1, boxes[j].x1);
+        bbox.y0 = std::min(bbox.y0, boxes[j].y0); bbox.y1 = std::max(bbox.y1, boxes[j].y1);
+        bbox.z0 = std::min(bbox.z0, boxes[j].z0); bbox.z1 = std::max(bbox.z1, boxes[j].z1);
+    }
+
+    bbox.x0 -= kEpsilon; bbox.y0 -= kEpsilon; bbox.z0 -= kEpsilon;
+    bbox.x1 += kEpsilon; bbox.y1 += kEpsilon; bbox.z1 += kEpsilon;
+
+    build_level(bbox, indices, boxes, true);
+}
+
+
+// ---------------------------------------------------------------- build_level
+// cuts bounds into cells and files the children whose boxes overlap each cell
+// on the top level, a cell with more than subgrid_threshold children, not all of which
+// cover the whole cell, gets a level of its own instead
+// returns the index of the new level
+
+int
+MailboxGrid::build_level(	const BBox& bounds, const std::vector<int>& indices,
+                            const std::vector<BBox>& boxes, const bool top) {
+    double wx = bounds.x1 - bounds.x0;
+    double wy = bounds.y1 - bounds.y0;
+    double wz = bounds.z1 - bounds.z0;
+    double volume = wx * wy * wz;
+    double s = volume > 0.0 ? pow(volume / indices.size(), 1.0 / 3.0) : (wx + wy + wz) / 3.0;
+
+    Level level;
+    level.x0 = bounds.x0; level.x1 = bounds.x1;
+    level.y0 = bounds.y0; level.y1 = bounds.y1;
+    level.z0 = bounds.z0; level.z1 = bounds.z1;
+    level.nx = s > 0.0 ? resolution(wx, s, multiplier, max_resolution) : 1;
+    level.ny = s > 0.0 ? resolution(wy, s, multiplier, max_resolution) : 1;
+    level.nz = s > 0.0 ? resolution(wz, s, multiplier, max_resolution) : 1;
+    level.first_cell = cells.size();
+
+    int level_index = levels.size();
+    int num_cells 	= level.nx * level.ny * level.nz;
+
+    levels.push_back(level);
+    cells.resize(cells.size() + num_cells);
+
+    std::vector<std::vector<int>> cell_objects(num_cells);
+
+    for (int index : indices) {
+        const BBox& b = boxes[index];
+
+        int ix0 = cell_index(b.x0, level.x0, level.x1, level.nx), ix1 = cell_index(b.x1, level.x0, level.x1, level.nx);
+        int iy0 = cell_index(b.y0, level.y0, level.y1, level.ny), iy1 = cell_index(b.y1, level.y0, level.y1, level.ny);
+        int iz0 = cell_index(b.z0, level.z0, level.z1, level.nz), iz1 = cell_index(b.z1, level.z0, level.z1, level.nz);
+
+        for (int iz = iz0; iz <= iz1; iz++)
+            for (int iy = iy0; iy <= iy1; iy++)
+                for (int ix = ix0; ix <= ix1; ix++)
+                    cell_objects[ix + level.nx * (iy + level.ny * iz)].push_back(index);
+    }
+
+    double cx = wx / level.nx, cy = wy / level.ny, cz = wz / level.nz;
+
+    for (int c = 0; c < num_cells; c++) {
+        const std::vector<int>& contents = cell_objects[c];
+        Cell cell;
+        cell.child = -1;
+
+        if (top && subgrid_threshold > 0 && (int) contents.size() > subgrid_threshold) {
+            int ix = c % level.nx, iy = (c / level.nx) % level.ny, iz = c / (level.nx * level.ny);
+
+            BBox cell_box(	level.x0 + ix * cx, level.x0 + (ix + 1) * cx,
+                            level.y0 + iy * cy, level.y0 + (iy + 1) * cy,
+                            level.z0 + iz * cz, level.z0 + (iz + 1) * cz);
+
+            int covering = 0;
+
+            for (int index : contents) {
+                const BBox& b = boxes[index];
+                if (b.x0 <= cell_box.x0 && b.x1 >= cell_box.x1 && b.y0 <= cell_box.y0 &&
+                    b.y1 >= cell_box.y1 && b.z0 <= cell_box.z0 && b.z1 >= cell_box.z1)
+                    covering++;
+            }
+
+            if (covering < (int) contents.size())
+                cell.child = build_level(cell_box, contents, boxes, false);
+        }
+
+        cell.first 	= items.size();
+        cell.count 	= 0;
+
+        if (cell.child < 0) {
+            items.insert(items.end(), contents.begin(), contents.end());
+            cell.count = contents.size();
+        }
+
+        cells[level.first_cell + c] = cell;
+    }
+
+    return (level_index);
+}
+
+
+// ---------------------------------------------------------------- hit
+
+bool
+MailboxGrid::hit(const Ray& ray, double& tmin, ShadeRec& sr) const {
+    if (levels.empty())
+        return (false);
+
+    Walk state(false, &sr);
+    walk(0, ray, 0.0, kHugeValue, state);
+
+    if (state.nearest < 0)
+        return (false);
+
+    tmin 				= state.tmin;
+    HitMaterial::set(sr, state.tmin, state.material);
+    sr.normal 			= state.normal;
+    sr.local_hit_point 	= state.local_hit_point;
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- shadow_hit
+// nearest occluder, so that point lights can compare it with their distance
+
+bool
+MailboxGrid::shadow_hit(const Ray& ray, float& tmin) const {
+    if (levels.empty())
+        return (false);
+
+    Walk state(true, NULL);
+    walk(0, ray, 0.0, kHugeValue, state);
+
+    if (state.nearest < 0)
+        return (false);
+
+    tmin = state.tmin;
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- walk
+// 3D DDA through one level over [t_enter, t_exit], as in Grid::hit; cells with a sublevel
+// walk it over the part of the ray inside the cell
+// returns true once the nearest hit lies inside a visited cell, which ends the walk
+
+bool
+MailboxGrid::walk(	const int level_index, const Ray& ray, const double t_enter, const double t_exit,
+                    Walk& state) const {
+    const Level& level = levels[level_index];
+
+    double ox = ray.o.x, oy = ray.o.y, oz = ray.o.z;
+    double dx = ray.d.x, dy = ray.d.y, dz = ray.d.z;
+    double tx_min, ty_min, tz_min, tx_max, ty_max, tz_max;
+
+    double a = 1.0 / dx;
+    if (a >= 0) { tx_min = (level.x0 - ox) * a; tx_max = (level.x1 - ox) * a; }
+    else 		{ tx_min = (level.x1 - ox) * a; tx_max = (level.x0 - ox) * a; }
+
+    double b = 1.0 / dy;
+    if (b >= 0) { ty_min = (level.y0 - oy) * b; ty_max = (level.y1 - oy) * b; }
+    else 		{ ty_min = (level.y1 - oy) * b; ty_max = (level.y0 - oy) * b; }
+
+    double c = 1.0 / dz;
+    if (c >= 0) { tz_min = (level.z0 - oz) * c; tz_max = (level.z1 - oz) * c; }
+    else 		{ tz_min = (level.z1 - oz) * c; tz_max = (level.z0 - oz) * c; }
+
+    double start 	= std::max(std::max(tx_min, ty_min), std::max(tz_min, t_enter));
+    double stop 	= std::min(std::min(tx_max, ty_max), std::min(tz_max, t_exit));
+
+    if (start > stop)
+        return (false);
+
+    int ix = cell_index(ox + start * dx, level.x0, level.x1, level.nx);
+    int iy = cell_index(oy + start * dy, level.y0, level.y1, level.ny);
+    int iz = cell_index(oz + start * dz, level.z0, level.z1, level.nz);
+
+    double dtx = (tx_max - tx_min) / level.nx;
+    double dty = (ty_max - ty_min) / level.ny;
+    double dtz = (tz_max - tz_min) / level.nz;
+
+    double 	tx_next, ty_next, tz_next;
+    int 	ix_step, iy_step, iz_step;
+    int 	ix_stop, iy_stop, iz_stop;
+
+    if (dx > 0) 		{ tx_next = tx_min + (ix + 1) * dtx; 			ix_step = +1; ix_stop = level.nx; }
+    else if (dx < 0) 	{ tx_next = tx_min + (level.nx - ix) * dtx; 	ix_step = -1; ix_stop = -1; }
+    else 				{ tx_next = kHugeValue; 						ix_step = -1; ix_stop = -1; }
+
+    if (dy > 0) 		{ ty_next = ty_min + (iy + 1) * dty; 			iy_step = +1; iy_stop = level.ny; }
+    else if (dy < 0) 	{ ty_next = ty_min + (level.ny - iy) * dty; 	iy_step = -1; iy_stop = -1; }
+    else 				{ ty_next = kHugeValue; 						iy_step = -1; iy_stop = -1; }
+
+    if (dz > 0) 		{ tz_next = tz_min + (iz + 1) * dtz; 			iz_step = +1; iz_stop = level.nz; }
+    else if (dz < 0) 	{ tz_next = tz_min + (level.nz - iz) * dtz; 	iz_step = -1; iz_stop = -1; }
+    else 				{ tz_next = kHugeValue; 						iz_step = -1; iz_stop = -1; }
+
+    double t_cell = start;
+
+    while (true) {
+        const Cell& cell 	= cells[level.first_cell + ix + level.nx * (iy + level.ny * iz)];
+        double t_next 		= std::min(tx_next, std::min(ty_next, tz_next));
+        double t_cell_exit 	= std::min(t_next, stop);
+
+        RENDER_COUNT(state.counts.node_tests++);
+
+        if (cell.child >= 0)
+            walk(cell.child, ray, t_cell, t_cell_exit, state);
+        else if (cell.count > 0)
+            test_cell(cell, ray, state);
+
+        if (state.nearest >= 0 && state.tmin <= t_cell_exit)
+            return (true);
+
+        if (t_next >= stop)
+            return (false);
+
+        t_cell = t_next;
+
+        if (tx_next < ty_next && tx_next < tz_next) {
+            ix += ix_step;
+            if (ix == ix_stop)
+                return (false);
+            tx_next += dtx;
+        }
+        else if (ty_next < tz_next) {
+            iy += iy_step;
+            if (iy == iy_stop)
+                return (false);
+            ty_next += dty;
+        }
+        else {
+            iz += iz_step;
+            if (iz == iz_stop)
+                return (false);
+            tz_next += dtz;
+        }
+    }
+}
+
+
+// ---------------------------------------------------------------- test_cell
+// tests the children of a cell that are not already in the ray's mailbox
+// every child tested is kept as the nearest if it is, wherever its hit lies, so a child
+// skipped in a later cell has already had its say
+
+void
+MailboxGrid::test_cell(const Cell& cell, const Ray& ray, Walk& state) const {
+    for (int j = cell.first; j < cell.first + cell.count; j++) {
+        int index 	= items[j];
+        int& slot 	= state.mailbox[index & (kMailboxSize - 1)];
+
+        if (slot == index)
+            continue;
+
+        slot = index;
+        RENDER_COUNT(state.counts.object_tests++);
+
+        if (state.shadow) {
+            float t;
+
+            if (objects[index]->shadow_hit(ray, t) && t < state.tmin) {
+                state.tmin 		= t;
+                state.nearest 	= index;
+            }
+        }
+        else {
+            double t;
+
+            if (objects[index]->hit(ray, t, *state.sr) && t < state.tmin) {
+                state.tmin 				= t;
+                state.nearest 			= index;
+                state.normal 			= state.sr->normal;
+                state.local_hit_point 	= state.sr->local_hit_point;
+                state.material 			= HitMaterial::take(objects[index], t, *state.sr);
+            }
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef __MAILBOX_GRID__
+#define __MAILBOX_GRID__
+
+// A uniform grid over the children of a Compound, like Grid, with three additions:
+// - mailboxing: a ray remembers which children it has already tested, so a child that
+//   overlaps many cells (a long thin box, say) is tested once per ray, not once per cell;
+// - a second level: a cell holding more than subgrid_threshold children gets a grid of
+//   its own, so dense clusters do not force a fine grid over the whole scene;
+// - a configurable resolution: multiplier scales the cells per unit length, as in Grid's
+//   heuristic, and max_resolution caps the cells along each axis.
+// Fill it with add_object, then call setup_cells once all children have their final
+// transforms. Children must report finite bounding boxes.
+
+#include <vector>
+
+#include "Group.h"
+#include "Utilities/BBox.h"
+
+class MailboxGrid: public Group {
+    public:
+
+        MailboxGrid(void);
+
+        MailboxGrid(const MailboxGrid& grid);
+
+        virtual MailboxGrid*
+        clone(void) const;
+
+        MailboxGrid&
+        operator= (const MailboxGrid& rhs);
+
+        virtual
+        ~MailboxGrid(void);
+
+        virtual BBox
+        get_bounding_box(void);
+
+        void
+        set_multiplier(const double m);					// 2 by default, as in Grid
+
+        void
+        set_max_resolution(const int n);				// 128 cells per axis by default
+
+        void
+        set_subgrid_threshold(const int n);				// 16 by default; 0 keeps one level
+
+        void
+        setup_cells(void);
+
+        int
+        get_num_cells(void) const;
+
+        virtual bool
+        hit(const Ray& ray, double& tmin, ShadeRec& sr) const;
+
+        virtual bool
+        shadow_hit(const Ray& ray, float& tmin) const;
+
+    private:
+
+        struct Level {
+            double 	x0, x1, y0, y1, z0, z1;
+            int 	nx, ny, nz;
+            int 	first_cell;							// index of cell (0, 0, 0) in cells
+        };
+
+        struct Cell {
+            int 	first, count;						// run of object indices in items
+            int 	child;								// sublevel index, or -1
+        };
+
+        struct Walk;
+
+        std::vector<Level> 	levels;						// levels[0] covers the whole grid
+        std::vector<Cell> 	cells;
+        std::vector<int> 	items;
+        BBox 				bbox;
+        double 				multiplier;
+        int 				max_resolution;
+        int 				subgrid_threshold;
+
+        int
+        build_level(const BBox& bounds, const std::vector<int>& indices,
+                    const std::vector<BBox>& boxes, const bool top);
+
+        bool
+        walk(const int level_index, const Ray& ray, const double t_enter, const double t_exit,
+             Walk& state) const;
+
+        void
+        test_cell(const Cell& cell, const Ray& ray, Walk& state) const;
+};
+
+
+// ---------------------------------------------------------------- set_multiplier
+
+inline void
+MailboxGrid::set_multiplier(const double m) {
+    multiplier = m > 0.0 ? m : 2.0;
+}
+
+
+// ---------------------------------------------------------------- set_max_resolution
+
+inline void
+MailboxGrid::set_max_resolution(const int n) {
+    max_resolution = n < 1 ? 1 : n;
+}
+
+
+// ---------------------------------------------------------------- set_subgrid_threshold
+
+inline void
+MailboxGrid::set_subgrid_threshold(const int n) {
+    subgrid_threshold = n < 0 ? 0 : n;
+}
+
+
+// ---------------------------------------------------------------- get_num_cells
+
+inline int
+MailboxGrid::get_num_cells(void) const {
+    return (cells.size());
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "PacketBox.h"
+
+#include <algorithm>
+
+
+// ---------------------------------------------------------------- default constructor
+
+PacketBox::PacketBox(void)
+    : 	Box(Point3D(-1.0), Point3D(1.0)),
+        p0(-1.0),
+        p1(1.0)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+PacketBox::PacketBox(const Point3D& a, const Point3D& b)
+    : 	Box(a, b),
+        p0(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z)),
+        p1(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z))
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+PacketBox::PacketBox(const PacketBox& box)
+    : 	Box(box),
+        p0(box.p0),
+        p1(box.p1)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+PacketBox*
+PacketBox::clone(void) const {
+    return (new PacketBox(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+PacketBox&
+PacketBox::operator= (const PacketBox& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Box::operator=(rhs);
+
+    p0 = rhs.p0;
+    p1 = rhs.p1;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+PacketBox::~PacketBox(void) {}
+
+
+// ---------------------------------------------------------------- hit_packet
+
+void
+PacketBox::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    int lanes = enter_box(packet, hits, p0.x, p1.x, p0.y, p1.y, p0.z, p1.z);
+
+    for (int j = 0; j < kPacketSize; j++) {
+        if (!(lanes & (1 << j)))
+            continue;
+
+        const Ray& ray = packet.rays[j];
+        double 	t;
+        Normal 	normal;
+        bool 	inside;
+
+        if (hit_box(ray, p0, p1, t, normal, inside) && t < hits.t_hit[j])
+            hits.record(j, t, normal, ray.o + t * ray.d, material_ptr);
+    }
+}
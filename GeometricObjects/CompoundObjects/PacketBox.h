@@ -0,0 +1,60 @@
+#ifndef __PACKET_BOX__
+#define __PACKET_BOX__
+
+// An axis-aligned Box that can also be hit by a RayPacket.
+// A packet is tested against the six faces with one slab test, which gives the same hit
+// and outward normal as the Box's faces.
+
+#include "Box.h"
+#include "GeometricObjects/PacketPrimitive.h"
+#include "Utilities/SceneArena.h"
+
+class PacketBox: public Box, public PacketPrimitive, public ArenaAllocated {
+    public:
+
+        PacketBox(void);
+
+        PacketBox(const Point3D& p0, const Point3D& p1);
+
+        PacketBox(const PacketBox& box);
+
+        virtual PacketBox*
+        clone(void) const;
+
+        PacketBox&
+        operator= (const PacketBox& rhs);
+
+        virtual
+        ~PacketBox(void);
+
+        Point3D
+        get_p0(void) const;
+
+        Point3D
+        get_p1(void) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+    private:
+
+        Point3D 	p0, p1;				// minimum and maximum corners
+};
+
+
+// ---------------------------------------------------------------- get_p0
+
+inline Point3D
+PacketBox::get_p0(void) const {
+    return (p0);
+}
+
+
+// ---------------------------------------------------------------- get_p1
+
+inline Point3D
+PacketBox::get_p1(void) const {
+    return (p1);
+}
+
+#endif
@@ -0,0 +1,668 @@
+#include "FlatScene.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "HitMaterial.h"
+#include "GeometricObjects/Primitives/Cone.h"
+#include "GeometricObjects/Primitives/Tube.h"
+#include "Utilities/Constants.h"
+#include "Utilities/RenderStats.h"
+#include "Utilities/ShadeRec.h"
+
+// Parameters of each type, in FlatPrimitive::p:
+//	SPHERE 			centre (0-2), radius (3)
+//	PLANE 			point (0-2), normal (3-5)
+//	DISK 			centre (0-2), normal (3-5), radius squared (6)
+//	TRIANGLE 		v0 (0-2), v1 (3-5), v2 (6-8)
+//	BOX 			p0 (0-2), p1 (3-5), with p0 the minimum corner
+//	BEVELED_BOX 	p0 (0-2), p1 (3-5), bevel radius (6)
+//	TUBE 			bottom (0), top (1), inner radius (2), outer radius (3), around the y axis
+//	CONE 			height (0), base radius (1), 1 if closed (2), around the y axis
+
+
+// ---------------------------------------------------------------- point_at
+
+static inline Point3D
+point_at(const double* p) {
+    return (Point3D(p[0], p[1], p[2]));
+}
+
+
+// ---------------------------------------------------------------- transform_point
+
+static inline Point3D
+transform_point(const double m[3][4], const Point3D& p) {
+    return (Point3D(m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+                    m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+                    m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3]));
+}
+
+
+// ---------------------------------------------------------------- transform_vector
+
+static inline Vector3D
+transform_vector(const double m[3][4], const Vector3D& v) {
+    return (Vector3D(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+                     m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+                     m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z));
+}
+
+
+// ---------------------------------------------------------------- transform_normal
+// by the transpose of the inverse
+
+static inline Normal
+transform_normal(const double inverse[3][4], const Normal& n) {
+    Normal result(	inverse[0][0] * n.x + inverse[1][0] * n.y + inverse[2][0] * n.z,
+                    inverse[0][1] * n.x + inverse[1][1] * n.y + inverse[2][1] * n.z,
+                    inverse[0][2] * n.x + inverse[1][2] * n.y + inverse[2][2] * n.z);
+    result.normalize();
+    return (result);
+}
+
+
+// ---------------------------------------------------------------- hit_sphere
+// the nearer root in front of the ray, as Sphere::hit
+
+static bool
+hit_sphere(const Ray& ray, const Point3D& c, const double r, double& tmin, Normal& normal) {
+    Vector3D 	temp 	= ray.o - c;
+    double 		a 		= ray.d * ray.d;
+    double 		b 		= 2.0 * (temp * ray.d);
+    double 		cc 		= temp * temp - r * r;
+    double 		disc 	= b * b - 4.0 * a * cc;
+
+    if (disc < 0.0)
+        return (false);
+
+    double e = sqrt(disc);
+    double denom = 2.0 * a;
+    double t = (-b - e) / denom;
+
+    if (t <= kEpsilon)
+        t = (-b + e) / denom;
+
+    if (t <= kEpsilon)
+        return (false);
+
+    tmin 	= t;
+    normal 	= Normal((temp + t * ray.d) / r);
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- hit_plane
+
+static bool
+hit_plane(const Ray& ray, const Point3D& a, const Normal& n, double& tmin) {
+    double t = ((a - ray.o) * n) / (ray.d * n);
+
+    if (t <= kEpsilon)
+        return (false);
+
+    tmin = t;
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- hit_triangle
+// Cramer's rule, as Triangle::hit
+
+static bool
+hit_triangle(const Ray& ray, const double* v, double& tmin, Normal& normal) {
+    double a = v[0] - v[3], b = v[0] - v[6], c = ray.d.x, d = v[0] - ray.o.x;
+    double e = v[1] - v[4], f = v[1] - v[7], g = ray.d.y, h = v[1] - ray.o.y;
+    double i = v[2] - v[5], j = v[2] - v[8], k = ray.d.z, l = v[2] - ray.o.z;
+
+    double m = f * k - g * j, n = h * k - g * l, p = f * l - h * j;
+    double q = g * i - e * k, s = e * j - f * i;
+
+    double inv_denom = 1.0 / (a * m + b * q + c * s);
+
+    double beta = (d * m - b * n - c * p) * inv_denom;
+    if (beta < 0.0)
+        return (false);
+
+    double r = e * l - h * i;
+    double gamma = (a * n + d * q + c * r) * inv_denom;
+    if (gamma < 0.0 || beta + gamma > 1.0)
+        return (false);
+
+    double t = (a * p - b * r + d * s) * inv_denom;
+    if (t < kEpsilon)
+        return (false);
+
+    Vector3D edge1(v[3] - v[0], v[4] - v[1], v[5] - v[2]);
+    Vector3D edge2(v[6] - v[0], v[7] - v[1], v[8] - v[2]);
+
+    tmin 	= t;
+    normal 	= Normal(edge1 ^ edge2);
+    normal.normalize();
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- hit_edge
+// the open cylinder of radius r around the line through (cu, cv) along axis, between
+// lo and hi on that axis; the other two axes are u and v
+
+static bool
+hit_edge(const Ray& ray, const int axis, const double cu, const double cv, const double lo, const double hi,
+         const double r, double& tmin, Normal& normal) {
+    const double o[3] = { ray.o.x, ray.o.y, ray.o.z };
+    const double d[3] = { ray.d.x, ray.d.y, ray.d.z };
+    int u = (axis + 1) % 3;
+    int v = (axis + 2) % 3;
+
+    double ou = o[u] - cu, ov = o[v] - cv;
+    double a = d[u] * d[u] + d[v] * d[v];
+    double b = 2.0 * (ou * d[u] + ov * d[v]);
+    double c = ou * ou + ov * ov - r * r;
+    double disc = b * b - 4.0 * a * c;
+
+    if (a == 0.0 || disc < 0.0)
+        return (false);
+
+    double e = sqrt(disc);
+
+    for (int root = 0; root < 2; root++) {
+        double t = (root == 0 ? -b - e : -b + e) / (2.0 * a);
+        double along = o[axis] + t * d[axis];
+
+        if (t > kEpsilon && along >= lo && along <= hi) {
+            double n[3];
+            n[axis] = 0.0;
+            n[u] 	= (ou + t * d[u]) / r;
+            n[v] 	= (ov + t * d[v]) / r;
+
+            tmin 	= t;
+            normal 	= Normal(n[0], n[1], n[2]);
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+
+// ---------------------------------------------------------------- hit_beveled_box
+// the surfaces BeveledBox is made of: six flat faces inset by the bevel radius, twelve
+// edge cylinders and eight corner spheres; the nearest of them is the hit
+
+static bool
+hit_beveled_box(const Ray& ray, const Point3D& p0, const Point3D& p1, const double rb,
+                double& tmin, Normal& normal) {
+    const double lo[3] = { p0.x + rb, p0.y + rb, p0.z + rb };
+    const double hi[3] = { p1.x - rb, p1.y - rb, p1.z - rb };
+    const double o[3] 	= { ray.o.x, ray.o.y, ray.o.z };
+    const double d[3] 	= { ray.d.x, ray.d.y, ray.d.z };
+    const double face[2][3] = { { p0.x, p0.y, p0.z }, { p1.x, p1.y, p1.z } };
+
+    double 	t;
+    Normal 	n;
+    bool 	hit = false;
+
+    tmin = kHugeValue;
+
+    for (int axis = 0; axis < 3; axis++) {
+        int u = (axis + 1) % 3;
+        int v = (axis + 2) % 3;
+
+        // the two flat faces across this axis
+
+        if (d[axis] != 0.0)
+            for (int side = 0; side < 2; side++) {
+                t = (face[side][axis] - o[axis]) / d[axis];
+                if (t <= kEpsilon || t >= tmin)
+                    continue;
+
+                double pu = o[u] + t * d[u];
+                double pv = o[v] + t * d[v];
+
+                if (pu >= lo[u] && pu <= hi[u] && pv >= lo[v] && pv <= hi[v]) {
+                    double m[3] = { 0.0, 0.0, 0.0 };
+                    m[axis] = side ? 1.0 : -1.0;
+
+                    tmin 	= t;
+                    normal 	= Normal(m[0], m[1], m[2]);
+                    hit 	= true;
+                }
+            }
+
+        // the four edges along this axis
+
+        for (int corner = 0; corner < 4; corner++) {
+            double cu = (corner & 1) ? hi[u] : lo[u];
+            double cv = (corner & 2) ? hi[v] : lo[v];
+
+            if (hit_edge(ray, axis, cu, cv, lo[axis], hi[axis], rb, t, n) && t < tmin) {
+                tmin 	= t;
+                normal 	= n;
+                hit 	= true;
+            }
+        }
+    }
+
+    for (int corner = 0; corner < 8; corner++) {
+        Point3D c((corner & 1) ? hi[0] : lo[0], (corner & 2) ? hi[1] : lo[1], (corner & 4) ? hi[2] : lo[2]);
+
+        if (hit_sphere(ray, c, rb, t, n) && t < tmin) {
+            tmin 	= t;
+            normal 	= n;
+            hit 	= true;
+        }
+    }
+
+    return (hit);
+}
+
+
+// ---------------------------------------------------------------- pop_node
+// pops the next deferred node that can still hold a hit nearer than tmin
+
+static inline bool
+pop_node(const int stack[], const double stack_t[], int& top, const double tmin, int& node_index) {
+    while (top > 0) {
+        --top;
+        if (stack_t[top] < tmin) {
+            node_index = stack[top];
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+FlatScene::FlatScene(void)
+    : 	GeometricObject(),
+        primitives(NULL),
+        num_primitives(0),
+        num_unbounded(0),
+        transforms(NULL),
+        nodes(NULL),
+        num_nodes(0),
+        storage(),
+        materials()
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+// the arrays are shared with scene, which storage keeps alive for both
+
+FlatScene::FlatScene(const FlatScene& scene)
+    : 	GeometricObject(scene),
+        primitives(scene.primitives),
+        num_primitives(scene.num_primitives),
+        num_unbounded(scene.num_unbounded),
+        transforms(scene.transforms),
+        nodes(scene.nodes),
+        num_nodes(scene.num_nodes),
+        storage(scene.storage),
+        materials(scene.materials)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+FlatScene*
+FlatScene::clone(void) const {
+    return (new FlatScene(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+FlatScene&
+FlatScene::operator= (const FlatScene& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    GeometricObject::operator=(rhs);
+
+    primitives 		= rhs.primitives;
+    num_primitives 	= rhs.num_primitives;
+    num_unbounded 	= rhs.num_unbounded;
+    transforms 		= rhs.transforms;
+    nodes 			= rhs.nodes;
+    num_nodes 		= rhs.num_nodes;
+    storage 		= rhs.storage;
+    materials 		= rhs.materials;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+FlatScene::~FlatScene(void) {}
+
+
+// ---------------------------------------------------------------- set_geometry
+
+void
+FlatScene::set_geometry(const FlatPrimitive* primitive_ptr, const int count, const int unbounded,
+                        const FlatTransform* transform_ptr, const BVHNode* node_ptr, const int node_count,
+                        const std::shared_ptr<const void>& owner) {
+    primitives 		= primitive_ptr;
+    num_primitives 	= count;
+    num_unbounded 	= unbounded;
+    transforms 		= transform_ptr;
+    nodes 			= node_ptr;
+    num_nodes 		= node_count;
+    storage 		= owner;
+}
+
+
+// ---------------------------------------------------------------- set_materials
+
+void
+FlatScene::set_materials(const std::vector<std::shared_ptr<Material> >& resolved) {
+    materials = resolved;
+}
+
+
+// ---------------------------------------------------------------- get_bounding_box
+// the bounded primitives only; planes have no box, as in Grid and BVH
+
+BBox
+FlatScene::get_bounding_box(void) {
+    if (num_nodes == 0)
+        return (BBox(0, 0, 0, 0, 0, 0));
+
+    return (BBox(nodes[0].x0, nodes[0].x1, nodes[0].y0, nodes[0].y1, nodes[0].z0, nodes[0].z1));
+}
+
+
+// ---------------------------------------------------------------- primitive_bounds
+// the eight corners of the box in the primitive's space are transformed and enclosed again
+
+BBox
+FlatScene::primitive_bounds(const FlatPrimitive& primitive, const FlatTransform* transform_ptr) {
+    const double* p = primitive.p;
+    double lo[3], hi[3];
+
+    switch (primitive.type) {
+        case FlatPrimitive::SPHERE:
+            for (int a = 0; a < 3; a++) {
+                lo[a] = p[a] - p[3];
+                hi[a] = p[a] + p[3];
+            }
+            break;
+
+        case FlatPrimitive::DISK:
+            for (int a = 0; a < 3; a++) {
+                double extent = sqrt(p[6] * std::max(0.0, 1.0 - p[3 + a] * p[3 + a]));
+                lo[a] = p[a] - extent;
+                hi[a] = p[a] + extent;
+            }
+            break;
+
+        case FlatPrimitive::TRIANGLE:
+            for (int a = 0; a < 3; a++) {
+                lo[a] = std::min(p[a], std::min(p[3 + a], p[6 + a]));
+                hi[a] = std::max(p[a], std::max(p[3 + a], p[6 + a]));
+            }
+            break;
+
+        case FlatPrimitive::BOX:
+        case FlatPrimitive::BEVELED_BOX:
+            for (int a = 0; a < 3; a++) {
+                lo[a] = p[a];
+                hi[a] = p[3 + a];
+            }
+            break;
+
+        case FlatPrimitive::TUBE:
+            lo[0] = lo[2] = -p[3];
+            hi[0] = hi[2] = p[3];
+            lo[1] = p[0];
+            hi[1] = p[1];
+            break;
+
+        case FlatPrimitive::CONE:
+            lo[0] = lo[2] = -p[1];
+            hi[0] = hi[2] = p[1];
+            lo[1] = std::min(0.0, p[0]);
+            hi[1] = std::max(0.0, p[0]);
+            break;
+
+        default:
+            return (BBox(-kHugeValue, kHugeValue, -kHugeValue, kHugeValue, -kHugeValue, kHugeValue));
+    }
+
+    if (primitive.transform < 0)
+        return (BBox(lo[0], hi[0], lo[1], hi[1], lo[2], hi[2]));
+
+    const FlatTransform& transform = transform_ptr[primitive.transform];
+
+    double x0 = kHugeValue, y0 = kHugeValue, z0 = kHugeValue;
+    double x1 = -kHugeValue, y1 = -kHugeValue, z1 = -kHugeValue;
+
+    for (int j = 0; j < 8; j++) {
+        Point3D corner(j & 1 ? hi[0] : lo[0], j & 2 ? hi[1] : lo[1], j & 4 ? hi[2] : lo[2]);
+        Point3D q = transform_point(transform.forward, corner);
+
+        x0 = std::min(x0, q.x); x1 = std::max(x1, q.x);
+        y0 = std::min(y0, q.y); y1 = std::max(y1, q.y);
+        z0 = std::min(z0, q.z); z1 = std::max(z1, q.z);
+    }
+
+    return (BBox(x0, x1, y0, y1, z0, z1));
+}
+
+
+// ---------------------------------------------------------------- hit_primitive
+// normal in world space; the local hit point in the primitive's space
+
+bool
+FlatScene::hit_primitive(const FlatPrimitive& primitive, const Ray& ray, double& t, Normal& normal,
+                         Point3D& local_hit_point) const {
+    const FlatTransform* transform_ptr = primitive.transform < 0 ? NULL : &transforms[primitive.transform];
+    const double* p = primitive.p;
+
+    Ray local_ray(ray);
+    if (transform_ptr) {
+        local_ray.o = transform_point(transform_ptr->inverse, ray.o);
+        local_ray.d = transform_vector(transform_ptr->inverse, ray.d);
+    }
+
+    bool hit = false;
+
+    switch (primitive.type) {
+        case FlatPrimitive::SPHERE:
+            hit = hit_sphere(local_ray, point_at(p), p[3], t, normal);
+            break;
+
+        case FlatPrimitive::PLANE:
+            normal 	= Normal(p[3], p[4], p[5]);
+            hit 	= hit_plane(local_ray, point_at(p), normal, t);
+            break;
+
+        case FlatPrimitive::DISK:
+            normal = Normal(p[3], p[4], p[5]);
+            if (hit_plane(local_ray, point_at(p), normal, t)) {
+                Point3D q = local_ray.o + t * local_ray.d;
+                hit = (q - point_at(p)) * (q - point_at(p)) < p[6];
+            }
+            break;
+
+        case FlatPrimitive::TRIANGLE:
+            hit = hit_triangle(local_ray, p, t, normal);
+            break;
+
+        case FlatPrimitive::BOX: {
+            bool inside;
+            hit = PacketPrimitive::hit_box(local_ray, point_at(p), point_at(p + 3), t, normal, inside);
+            break;
+        }
+
+        case FlatPrimitive::BEVELED_BOX:
+            hit = hit_beveled_box(local_ray, point_at(p), point_at(p + 3), p[6], t, normal);
+            break;
+
+        case FlatPrimitive::TUBE:
+            hit = Tube::hit_tube(local_ray, p[0], p[1], p[2], p[3], t, normal);
+            break;
+
+        case FlatPrimitive::CONE:
+            hit = Cone::hit_cone(local_ray, p[0], p[1], p[2] != 0.0, t, normal);
+            break;
+    }
+
+    if (!hit)
+        return (false);
+
+    local_hit_point = local_ray.o + t * local_ray.d;
+
+    if (transform_ptr)
+        normal = transform_normal(transform_ptr->inverse, normal);
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- nearest_hit
+// planes first, then a front-to-back walk of the tree as in BVH::hit; with shadow set,
+// primitives that cast no shadows are skipped
+
+bool
+FlatScene::nearest_hit(const Ray& ray, const bool shadow, double& tmin, Normal& normal,
+                       Point3D& local_hit_point, int& material) const {
+    RENDER_COUNT(RenderCounts& counts = RenderStats::local());
+
+    double 	t;
+    Normal 	n;
+    Point3D p;
+    int 	nearest = -1;
+
+    tmin = kHugeValue;
+    RENDER_COUNT(counts.object_tests += num_unbounded);
+
+    for (int j = 0; j < num_unbounded; j++)
+        if ((!shadow || primitives[j].shadows) && hit_primitive(primitives[j], ray, t, n, p) && t < tmin) {
+            tmin 			= t;
+            nearest 		= j;
+            normal 			= n;
+            local_hit_point = p;
+        }
+
+    double 	inv_d[3] = { 1.0 / ray.d.x, 1.0 / ray.d.y, 1.0 / ray.d.z };
+    double 	tnear;
+    int 	stack[kBVHStackSize];
+    double 	stack_t[kBVHStackSize];
+    int 	top = 0;
+    int 	node_index = 0;
+
+    RENDER_COUNT(counts.node_tests++);
+
+    if (num_nodes > 0 && nodes[0].entry(ray.o, inv_d, tmin, tnear))
+        while (true) {
+            const BVHNode& node = nodes[node_index];
+
+            if (node.count > 0) {
+                RENDER_COUNT(counts.object_tests += node.count);
+
+                for (int j = node.offset; j < node.offset + node.count; j++)
+                    if ((!shadow || primitives[j].shadows) && hit_primitive(primitives[j], ray, t, n, p) && t < tmin) {
+                        tmin 			= t;
+                        nearest 		= j;
+                        normal 			= n;
+                        local_hit_point = p;
+                    }
+            }
+            else {
+                int 	left 	= node_index + 1;
+                int 	right 	= node.offset;
+                double 	t_left, t_right;
+                bool 	hit_left 	= nodes[left].entry(ray.o, inv_d, tmin, t_left);
+                bool 	hit_right 	= nodes[right].entry(ray.o, inv_d, tmin, t_right);
+
+                RENDER_COUNT(counts.node_tests += 2);
+
+                if (hit_left && hit_right) {
+                    if (t_right < t_left) {
+                        std::swap(left, right);
+                        std::swap(t_left, t_right);
+                    }
+                    stack[top] 		= right;
+                    stack_t[top++] 	= t_right;
+                    node_index 		= left;
+                    continue;
+                }
+
+                if (hit_left) 	{ node_index = left;  continue; }
+                if (hit_right) 	{ node_index = right; continue; }
+            }
+
+            if (!pop_node(stack, stack_t, top, tmin, node_index))
+                break;
+        }
+
+    if (nearest < 0)
+        return (false);
+
+    material = primitives[nearest].material;
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- hit
+
+bool
+FlatScene::hit(const Ray& ray, double& tmin, ShadeRec& sr) const {
+    Normal 	normal;
+    Point3D local_hit_point;
+    int 	material;
+
+    if (!nearest_hit(ray, false, tmin, normal, local_hit_point, material))
+        return (false);
+
+    HitMaterial::set(sr, tmin, material < 0 ? material_ptr : materials[material]);
+    sr.normal 			= normal;
+    sr.local_hit_point 	= local_hit_point;
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- shadow_hit
+// nearest occluder, so that point lights can compare it with their distance
+
+bool
+FlatScene::shadow_hit(const Ray& ray, float& tmin) const {
+    double 	t;
+    Normal 	normal;
+    Point3D local_hit_point;
+    int 	material;
+
+    if (!nearest_hit(ray, true, t, normal, local_hit_point, material))
+        return (false);
+
+    tmin = t;
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- hit_packet
+// one lane at a time; each hit is recorded against its material's tag, so that lanes hitting
+// different materials shade correctly
+
+void
+FlatScene::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    for (int j = 0; j < kPacketSize; j++) {
+        if (!(packet.active & (1 << j)))
+            continue;
+
+        double 	t;
+        Normal 	normal;
+        Point3D local_hit_point;
+        int 	material;
+
+        if (nearest_hit(packet.rays[j], false, t, normal, local_hit_point, material) && t < hits.t_hit[j])
+            hits.record(j, t, normal, local_hit_point, material < 0 ? material_ptr : materials[material]);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef __FLAT_SCENE__
+#define __FLAT_SCENE__
+
+// Geometry flattened into plain arrays, as the scene cache stores it: every primitive is
+// either in world space or under one affine transform, which replaces the chain of
+// placements it was built under, and a BVH (BVH::build_tree) is built over the bounded ones.
+// Unbounded primitives (planes) come first and are tested one by one.
+// The arrays are not copied: a flat scene points into memory that storage keeps alive,
+// typically a mapped cache file, so loading one costs no construction at all.
+// Materials are resolved once, when the scene is loaded, and set with set_materials.
+// As with Placement, the local hit point of a transformed primitive is left in its own space.
+
+#include <memory>
+#include <vector>
+
+#include "GeometricObject.h"
+#include "PacketPrimitive.h"
+#include "GeometricObjects/CompoundObjects/BVH.h"
+#include "Utilities/BBox.h"
+#include "Utilities/SceneArena.h"
+
+struct FlatPrimitive {
+    enum Type { SPHERE, PLANE, DISK, TRIANGLE, BOX, BEVELED_BOX, TUBE, CONE };
+
+    int 	type;
+    int 	material;						// index into the materials, -1 for none
+    int 	transform;						// index into the transforms, -1 for world space
+    int 	shadows;						// 1 if it casts shadows
+    double 	p[10];							// the parameters of the type, laid out as in FlatScene.cpp
+};
+
+struct FlatTransform {
+    double 	forward[3][4];					// primitive space to world space
+    double 	inverse[3][4];
+};
+
+class FlatScene: public GeometricObject, public PacketPrimitive, public ArenaAllocated {
+    public:
+
+        FlatScene(void);
+
+        FlatScene(const FlatScene& scene);
+
+        virtual FlatScene*
+        clone(void) const;
+
+        FlatScene&
+        operator= (const FlatScene& rhs);
+
+        virtual
+        ~FlatScene(void);
+
+        void
+        set_geometry(	const FlatPrimitive* primitive_ptr, const int count, const int unbounded,
+                        const FlatTransform* transform_ptr, const BVHNode* node_ptr, const int node_count,
+                        const std::shared_ptr<const void>& owner);
+
+        void
+        set_materials(const std::vector<std::shared_ptr<Material> >& resolved);
+
+        int
+        get_num_primitives(void) const;
+
+        virtual BBox
+        get_bounding_box(void);
+
+        virtual bool
+        hit(const Ray& ray, double& tmin, ShadeRec& sr) const;
+
+        virtual bool
+        shadow_hit(const Ray& ray, float& tmin) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+        static BBox
+        primitive_bounds(const FlatPrimitive& primitive, const FlatTransform* transform_ptr);
+
+    private:
+
+        const FlatPrimitive* 								primitives;
+        int 												num_primitives;
+        int 												num_unbounded;		// planes, at the start of primitives
+        const FlatTransform* 								transforms;
+        const BVHNode* 										nodes;				// leaf offsets index primitives
+        int 												num_nodes;
+        std::shared_ptr<const void> 						storage;
+        std::vector<std::shared_ptr<Material> > 			materials;
+
+        bool
+        nearest_hit(const Ray& ray, const bool shadow, double& tmin, Normal& normal,
+                    Point3D& local_hit_point, int& material) const;
+
+        bool
+        hit_primitive(const FlatPrimitive& primitive, const Ray& ray, double& t, Normal& normal,
+                      Point3D& local_hit_point) const;
+};
+
+
+// ---------------------------------------------------------------- get_num_primitives
+
+inline int
+FlatScene::get_num_primitives(void) const {
+    return (num_primitives);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef __HIT_MATERIAL__
+#define __HIT_MATERIAL__
+
+// How a hit hands the material of the surface it found back to its caller.
+// The library's compounds remember the material of their nearest child in their own
+// material_ptr, which every render thread then writes at once. The objects in this tree leave
+// themselves alone: their hit puts the material in the ShadeRec, whose thread owns it, and
+// stamps sr.t with the hit's t.
+// take() reads it back after a child has reported a hit at t. When sr.t does not match, the
+// material in the ShadeRec belongs to another, farther child (a library Compound calling its
+// children in turn, say), and the child's own material is taken instead.
+
+#include <memory>
+#include <utility>
+
+#include "GeometricObject.h"
+#include "Utilities/ShadeRec.h"
+
+struct HitMaterial {
+    static void
+    set(ShadeRec& sr, const double t, const std::shared_ptr<Material>& material) {
+        sr.material_ptr = material;
+        sr.t 			= t;
+    }
+
+    static std::shared_ptr<Material>
+    take(const GeometricObject* object_ptr, const double t, ShadeRec& sr) {
+        if (sr.material_ptr && sr.t == t)
+            return (std::move(sr.material_ptr));
+
+        return (object_ptr->get_material());
+    }
+};
+
+#endif
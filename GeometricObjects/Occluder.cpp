@@ -0,0 +1,90 @@
+#include "Occluder.h"
+
+#include "GeometricObjects/GeometricObject.h"
+#include "World/World.h"
+
+
+// ---------------------------------------------------------------- destructor
+
+Occluder::~Occluder(void) {}
+
+
+// ---------------------------------------------------------------- test_object
+// occluder_ptr is object_ptr seen as an Occluder, or null
+
+bool
+Occluder::test_object(const GeometricObject* object_ptr, const Occluder* occluder_ptr,
+                      const Ray& ray, const double tmax, Occlusion& occlusion) {
+    if (occluder_ptr)
+        return (occluder_ptr->occluded(ray, tmax, occlusion));
+
+    float t;
+
+    if (!object_ptr->shadow_hit(ray, t) || t >= tmax)
+        return (false);
+
+    occlusion.object_ptr 	= object_ptr;
+    occlusion.transformed 	= false;
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- retest
+// a transformed ray keeps its parameterisation, so t can still be compared with tmax
+
+bool
+Occluder::retest(const Occlusion& occlusion, const Ray& ray, const double tmax) {
+    if (!occlusion.object_ptr)
+        return (false);
+
+    Ray 	local_ray(ray);
+    float 	t;
+
+    if (occlusion.transformed) {
+        local_ray.o = occlusion.to_object * ray.o;
+        local_ray.d = occlusion.to_object * ray.d;
+    }
+
+    return (occlusion.object_ptr->shadow_hit(local_ray, t) && t < tmax);
+}
+
+
+// ---------------------------------------------------------------- OccluderList constructor
+
+OccluderList::OccluderList(void)
+    : 	world_ptr(NULL),
+        occluders()
+{}
+
+
+// ---------------------------------------------------------------- resolve
+
+void
+OccluderList::resolve(const World& w) {
+    world_ptr = &w;
+    occluders.resize(w.objects.size());
+
+    for (int j = 0; j < (int) w.objects.size(); j++)
+        occluders[j] = dynamic_cast<const Occluder*>(w.objects[j]);
+}
+
+
+// ---------------------------------------------------------------- occluded
+// the resolved list is only trusted while it still matches the world's objects one for one
+
+bool
+OccluderList::occluded(const World& w, const Ray& ray, const double tmax, Occlusion& occlusion) const {
+    int 	num_objects = w.objects.size();
+    bool 	resolved 	= world_ptr == &w && (int) occluders.size() == num_objects;
+
+    for (int j = 0; j < num_objects; j++) {
+        const GeometricObject* 	object_ptr 		= w.objects[j];
+        const Occluder* 		occluder_ptr 	= resolved ? occluders[j] : dynamic_cast<const Occluder*>(object_ptr);
+
+        if (Occluder::test_object(object_ptr, occluder_ptr, ray, tmax, occlusion))
+            return (true);
+    }
+
+    return (false);
+}
@@ -0,0 +1,78 @@
+#ifndef __OCCLUDER__
+#define __OCCLUDER__
+
+// Interface for objects with a dedicated occlusion query for shadow rays.
+// occluded reports whether anything blocks the ray between kEpsilon and tmax. Unlike
+// shadow_hit it stops at the first blocker it finds instead of looking for the nearest,
+// and it never looks at materials.
+// The blocker is returned in an Occlusion: the leaf object that was hit, with the matrix
+// that takes the ray into that leaf's space, so that a light can try the same leaf first
+// for the next, coherent, shadow ray (retest) without going through the hierarchy again.
+// It is mixed into a GeometricObject subclass, as PacketPrimitive is; test_object is the
+// fallback for objects without it, through their shadow_hit.
+// OccluderList is mixed into the lights whose shadow rays take the query. resolve looks up
+// each world object's Occluder once, before rendering (TileRenderer::prepare calls it), as
+// a BVH does for its children at setup; occluded then walks the world's objects with them.
+// A light rendered without resolve, or for another world, looks them up per object.
+
+#include <vector>
+
+#include "Utilities/Matrix.h"
+#include "Utilities/Ray.h"
+
+class GeometricObject;
+class World;
+
+struct Occlusion {
+    const GeometricObject* 	object_ptr;			// the leaf that blocked the ray, or null
+    Matrix 					to_object;			// from the ray's space into the leaf's
+    bool 					transformed;		// false while to_object is the identity
+
+    Occlusion(void);
+};
+
+class Occluder {
+    public:
+
+        virtual
+        ~Occluder(void);
+
+        virtual bool
+        occluded(const Ray& ray, const double tmax, Occlusion& occlusion) const = 0;
+
+        static bool
+        test_object(const GeometricObject* object_ptr, const Occluder* occluder_ptr,
+                    const Ray& ray, const double tmax, Occlusion& occlusion);
+
+        static bool
+        retest(const Occlusion& occlusion, const Ray& ray, const double tmax);
+};
+
+class OccluderList {
+    public:
+
+        OccluderList(void);
+
+        void
+        resolve(const World& w);
+
+        bool
+        occluded(const World& w, const Ray& ray, const double tmax, Occlusion& occlusion) const;	// by any world object
+
+    private:
+
+        const World* 					world_ptr;		// the world resolved for, or null
+        std::vector<const Occluder*> 	occluders;		// one per world object, null for those without the query
+};
+
+
+// ---------------------------------------------------------------- default constructor
+
+inline
+Occlusion::Occlusion(void)
+    : 	object_ptr(NULL),
+        to_object(),
+        transformed(false)
+{}
+
+#endif
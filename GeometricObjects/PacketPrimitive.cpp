@@ -0,0 +1,155 @@
+#include "PacketPrimitive.h"
+
+#include "GeometricObjects/GeometricObject.h"
+#include "GeometricObjects/HitMaterial.h"
+#include "Utilities/ShadeRec.h"
+
+
+// ---------------------------------------------------------------- destructor
+
+PacketPrimitive::~PacketPrimitive(void) {}
+
+
+// ---------------------------------------------------------------- hit_lanes
+// lanes is a mask of the lanes to test, usually packet.active
+
+void
+PacketPrimitive::hit_lanes(const GeometricObject* object_ptr, const RayPacket& packet, PacketHit& hits, int lanes) {
+    ShadeRec& sr = *hits.scratch;
+    double t;
+
+    for (int j = 0; j < kPacketSize; j++)
+        if ((lanes & (1 << j)) && object_ptr->hit(packet.rays[j], t, sr) && t < hits.t_hit[j])
+            hits.record(j, t, sr.normal, sr.local_hit_point, HitMaterial::take(object_ptr, t, sr));
+}
+
+
+// ---------------------------------------------------------------- hit_object
+// packet_ptr is object_ptr seen as a PacketPrimitive, or null
+
+void
+PacketPrimitive::hit_object(const GeometricObject* object_ptr, const PacketPrimitive* packet_ptr,
+                            const RayPacket& packet, PacketHit& hits) {
+    if (packet_ptr)
+        packet_ptr->hit_packet(packet, hits);
+    else
+        hit_lanes(object_ptr, packet, hits, packet.active);
+}
+
+
+// ---------------------------------------------------------------- enter_box
+// returns the active lanes whose rays meet the box ahead of them and before their current
+// nearest hit
+
+int
+PacketPrimitive::enter_box(	const RayPacket& packet, const PacketHit& hits,
+                            const double x0, const double x1, const double y0, const double y1,
+                            const double z0, const double z1) {
+    PacketFloat ox = PacketFloat::load(packet.ox);
+    PacketFloat oy = PacketFloat::load(packet.oy);
+    PacketFloat oz = PacketFloat::load(packet.oz);
+    PacketFloat ix = PacketFloat::load(packet.inv_dx);
+    PacketFloat iy = PacketFloat::load(packet.inv_dy);
+    PacketFloat iz = PacketFloat::load(packet.inv_dz);
+
+    PacketFloat tx0 = (PacketFloat(x0) - ox) * ix;
+    PacketFloat tx1 = (PacketFloat(x1) - ox) * ix;
+    PacketFloat ty0 = (PacketFloat(y0) - oy) * iy;
+    PacketFloat ty1 = (PacketFloat(y1) - oy) * iy;
+    PacketFloat tz0 = (PacketFloat(z0) - oz) * iz;
+    PacketFloat tz1 = (PacketFloat(z1) - oz) * iz;
+
+    PacketFloat t0 = max(min(tx0, tx1), max(min(ty0, ty1), min(tz0, tz1)));
+    PacketFloat t1 = min(max(tx0, tx1), min(max(ty0, ty1), max(tz0, tz1)));
+
+    PacketFloat m = (t0 <= t1) & (t1 > PacketFloat(kEpsilon)) & (t0 < PacketFloat::load(hits.t));
+
+    return (m.mask() & packet.active);
+}
+
+
+// ---------------------------------------------------------------- hit_box
+// the axis-aligned box between p0 and p1, with outward normals; inside is set when the ray
+// starts inside the box and leaves through the face that was hit
+
+bool
+PacketPrimitive::hit_box(const Ray& ray, const Point3D& p0, const Point3D& p1, double& tmin, Normal& normal, bool& inside) {
+    double tx_min, ty_min, tz_min;
+    double tx_max, ty_max, tz_max;
+    int face_in, face_out;
+
+    double a = 1.0 / ray.d.x;
+    if (a >= 0) {
+        tx_min = (p0.x - ray.o.x) * a;
+        tx_max = (p1.x - ray.o.x) * a;
+    }
+    else {
+        tx_min = (p1.x - ray.o.x) * a;
+        tx_max = (p0.x - ray.o.x) * a;
+    }
+
+    double b = 1.0 / ray.d.y;
+    if (b >= 0) {
+        ty_min = (p0.y - ray.o.y) * b;
+        ty_max = (p1.y - ray.o.y) * b;
+    }
+    else {
+        ty_min = (p1.y - ray.o.y) * b;
+        ty_max = (p0.y - ray.o.y) * b;
+    }
+
+    double c = 1.0 / ray.d.z;
+    if (c >= 0) {
+        tz_min = (p0.z - ray.o.z) * c;
+        tz_max = (p1.z - ray.o.z) * c;
+    }
+    else {
+        tz_min = (p1.z - ray.o.z) * c;
+        tz_max = (p0.z - ray.o.z) * c;
+    }
+
+    // faces 0, 1, 2 are the -x, -y, -z faces and 3, 4, 5 the +x, +y, +z faces
+
+    double t0, t1;
+
+    if (tx_min > ty_min) {
+        t0 = tx_min;
+        face_in = (a >= 0.0) ? 0 : 3;
+    }
+    else {
+        t0 = ty_min;
+        face_in = (b >= 0.0) ? 1 : 4;
+    }
+
+    if (tz_min > t0) {
+        t0 = tz_min;
+        face_in = (c >= 0.0) ? 2 : 5;
+    }
+
+    if (tx_max < ty_max) {
+        t1 = tx_max;
+        face_out = (a >= 0.0) ? 3 : 0;
+    }
+    else {
+        t1 = ty_max;
+        face_out = (b >= 0.0) ? 4 : 1;
+    }
+
+    if (tz_max < t1) {
+        t1 = tz_max;
+        face_out = (c >= 0.0) ? 5 : 2;
+    }
+
+    if (t0 >= t1 || t1 <= kEpsilon)
+        return (false);
+
+    inside 	= t0 <= kEpsilon;
+    tmin 	= inside ? t1 : t0;
+
+    int face = inside ? face_out : face_in;
+    double sign = face < 3 ? -1.0 : 1.0;
+
+    normal = Normal(face % 3 == 0 ? sign : 0.0, face % 3 == 1 ? sign : 0.0, face % 3 == 2 ? sign : 0.0);
+
+    return (true);
+}
@@ -0,0 +1,45 @@
+#ifndef __PACKET_PRIMITIVE__
+#define __PACKET_PRIMITIVE__
+
+// Interface for objects that can intersect a whole RayPacket at once.
+// It is mixed into a GeometricObject subclass; the scalar hit remains the reference and
+// hit_packet must find the same hits, lane by lane.
+// hit_packet only records hits nearer than the lane's current PacketHit::t, which lets
+// a caller test several objects against one packet just as World::hit_objects does.
+// hit_lanes is the fallback for objects without a packet path: it calls their scalar hit
+// once per active lane.
+// Packet tests work in single precision and only pick the candidate lanes; each candidate
+// is then intersected in double precision, so recorded hits match the scalar path.
+
+#include "Utilities/Normal.h"
+#include "Utilities/Point3D.h"
+#include "Utilities/RayPacket.h"
+
+class GeometricObject;
+
+class PacketPrimitive {
+    public:
+
+        virtual
+        ~PacketPrimitive(void);
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const = 0;
+
+        static void
+        hit_lanes(const GeometricObject* object_ptr, const RayPacket& packet, PacketHit& hits, int lanes);
+
+        static void
+        hit_object(const GeometricObject* object_ptr, const PacketPrimitive* packet_ptr,
+                   const RayPacket& packet, PacketHit& hits);
+
+        static int
+        enter_box(	const RayPacket& packet, const PacketHit& hits,
+                    const double x0, const double x1, const double y0, const double y1,
+                    const double z0, const double z1);
+
+        static bool
+        hit_box(const Ray& ray, const Point3D& p0, const Point3D& p1, double& tmin, Normal& normal, bool& inside);
+};
+
+#endif
@@ -0,0 +1,578 @@
+#include "Placement.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "HitMaterial.h"
+#include "Utilities/Constants.h"
+
+
+// ---------------------------------------------------------------- transform_normal
+// n is multiplied by the normal matrix as an ordinary 3 x 3 product
+
+static inline Normal
+transform_normal(const Matrix& m, const Normal& n) {
+    return (Normal(	m.m[0][0] * n.x + m.m[0][1] * n.y + m.m[0][2] * n.z,
+                    m.m[1][0] * n.x + m.m[1][1] * n.y + m.m[1][2] * n.z,
+                    m.m[2][0] * n.x + m.m[2][1] * n.y + m.m[2][2] * n.z));
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+Placement::Placement(void)
+    : 	GeometricObject(),
+        prototype_ptr(),
+        packet_ptr(NULL),
+        occluder_ptr(NULL),
+        forward_matrix(),
+        inv_matrix(),
+        normal_matrix(),
+        inv_offset(0),
+        translation_only(true),
+        bounded(false),
+        local_bounds(),
+        world_bounds()
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+Placement::Placement(const std::shared_ptr<GeometricObject>& prototype)
+    : 	GeometricObject(),
+        prototype_ptr(prototype),
+        packet_ptr(dynamic_cast<const PacketPrimitive*>(prototype.get())),
+        occluder_ptr(dynamic_cast<const Occluder*>(prototype.get())),
+        forward_matrix(),
+        inv_matrix(),
+        normal_matrix(),
+        inv_offset(0),
+        translation_only(true),
+        bounded(false),
+        local_bounds(),
+        world_bounds()
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+Placement::Placement(const std::shared_ptr<GeometricObject>& prototype, const Vector3D& offset)
+    : 	GeometricObject(),
+        prototype_ptr(prototype),
+        packet_ptr(dynamic_cast<const PacketPrimitive*>(prototype.get())),
+        occluder_ptr(dynamic_cast<const Occluder*>(prototype.get())),
+        forward_matrix(),
+        inv_matrix(),
+        normal_matrix(),
+        inv_offset(0),
+        translation_only(true),
+        bounded(false),
+        local_bounds(),
+        world_bounds()
+{
+    translate(offset);
+}
+
+
+// ---------------------------------------------------------------- copy constructor
+// the copy shares the prototype
+
+Placement::Placement(const Placement& placement)
+    : 	GeometricObject(placement),
+        prototype_ptr(placement.prototype_ptr),
+        packet_ptr(placement.packet_ptr),
+        occluder_ptr(placement.occluder_ptr),
+        forward_matrix(placement.forward_matrix),
+        inv_matrix(placement.inv_matrix),
+        normal_matrix(placement.normal_matrix),
+        inv_offset(placement.inv_offset),
+        translation_only(placement.translation_only),
+        bounded(placement.bounded),
+        local_bounds(placement.local_bounds),
+        world_bounds(placement.world_bounds)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+Placement*
+Placement::clone(void) const {
+    return (new Placement(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+Placement&
+Placement::operator= (const Placement& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    GeometricObject::operator=(rhs);
+
+    prototype_ptr 		= rhs.prototype_ptr;
+    packet_ptr 			= rhs.packet_ptr;
+    occluder_ptr 		= rhs.occluder_ptr;
+    forward_matrix 		= rhs.forward_matrix;
+    inv_matrix 			= rhs.inv_matrix;
+    normal_matrix 		= rhs.normal_matrix;
+    inv_offset 			= rhs.inv_offset;
+    translation_only 	= rhs.translation_only;
+    bounded 			= rhs.bounded;
+    local_bounds 		= rhs.local_bounds;
+    world_bounds 		= rhs.world_bounds;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+Placement::~Placement(void) {}
+
+
+// ---------------------------------------------------------------- set_prototype
+
+void
+Placement::set_prototype(const std::shared_ptr<GeometricObject>& prototype) {
+    prototype_ptr 	= prototype;
+    packet_ptr 		= dynamic_cast<const PacketPrimitive*>(prototype.get());
+    occluder_ptr 	= dynamic_cast<const Occluder*>(prototype.get());
+}
+
+
+// ---------------------------------------------------------------- apply
+// each new step is applied after the transformation built so far
+
+void
+Placement::apply(const Matrix& forward_step, const Matrix& inverse_step, const bool translation) {
+    forward_matrix 		= forward_step * forward_matrix;
+    inv_matrix 			= inv_matrix * inverse_step;
+    translation_only 	= translation_only && translation;
+
+    update_cache();
+}
+
+
+// ---------------------------------------------------------------- update_cache
+
+void
+Placement::update_cache(void) {
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            normal_matrix.m[i][j] = inv_matrix.m[j][i];
+
+    inv_offset = Vector3D(inv_matrix.m[0][3], inv_matrix.m[1][3], inv_matrix.m[2][3]);
+
+    if (bounded)
+        world_bounds = transform_box(local_bounds);
+}
+
+
+// ---------------------------------------------------------------- set_bounds
+
+void
+Placement::set_bounds(const BBox& bounds) {
+    bounded 		= true;
+    local_bounds 	= bounds;
+    world_bounds 	= transform_box(local_bounds);
+}
+
+
+// ---------------------------------------------------------------- transform_box
+// the eight corners of b are transformed and enclosed again
+
+BBox
+Placement::transform_box(const BBox& b) const {
+    double x0 = kHugeValue, y0 = kHugeValue, z0 = kHugeValue;
+    double x1 = -kHugeValue, y1 = -kHugeValue, z1 = -kHugeValue;
+
+    for (int j = 0; j < 8; j++) {
+        Point3D corner(j & 1 ? b.x1 : b.x0, j & 2 ? b.y1 : b.y0, j & 4 ? b.z1 : b.z0);
+        Point3D p = forward_matrix * corner;
+
+        x0 = std::min(x0, p.x); x1 = std::max(x1, p.x);
+        y0 = std::min(y0, p.y); y1 = std::max(y1, p.y);
+        z0 = std::min(z0, p.z); z1 = std::max(z1, p.z);
+    }
+
+    return (BBox(x0, x1, y0, y1, z0, z1));
+}
+
+
+// ---------------------------------------------------------------- translate
+
+void
+Placement::translate(const Vector3D& trans) {
+    translate(trans.x, trans.y, trans.z);
+}
+
+
+// ---------------------------------------------------------------- translate
+
+void
+Placement::translate(const double dx, const double dy, const double dz) {
+    Matrix forward_step;
+    forward_step.m[0][3] = dx;
+    forward_step.m[1][3] = dy;
+    forward_step.m[2][3] = dz;
+
+    Matrix inverse_step;
+    inverse_step.m[0][3] = -dx;
+    inverse_step.m[1][3] = -dy;
+    inverse_step.m[2][3] = -dz;
+
+    apply(forward_step, inverse_step, true);
+}
+
+
+// ---------------------------------------------------------------- scale
+
+void
+Placement::scale(const Vector3D& s) {
+    scale(s.x, s.y, s.z);
+}
+
+
+// ---------------------------------------------------------------- scale
+
+void
+Placement::scale(const double a, const double b, const double c) {
+    Matrix forward_step;
+    forward_step.m[0][0] = a;
+    forward_step.m[1][1] = b;
+    forward_step.m[2][2] = c;
+
+    Matrix inverse_step;
+    inverse_step.m[0][0] = 1.0 / a;
+    inverse_step.m[1][1] = 1.0 / b;
+    inverse_step.m[2][2] = 1.0 / c;
+
+    apply(forward_step, inverse_step, false);
+}
+
+
+// ---------------------------------------------------------------- rotate_x
+
+void
+Placement::rotate_x(const double theta) {
+    double sin_theta = sin(theta * PI_ON_180);
+    double cos_theta = cos(theta * PI_ON_180);
+
+    Matrix forward_step;
+    forward_step.m[1][1] = cos_theta;
+    forward_step.m[1][2] = -sin_theta;
+    forward_step.m[2][1] = sin_theta;
+    forward_step.m[2][2] = cos_theta;
+
+    Matrix inverse_step;
+    inverse_step.m[1][1] = cos_theta;
+    inverse_step.m[1][2] = sin_theta;
+    inverse_step.m[2][1] = -sin_theta;
+    inverse_step.m[2][2] = cos_theta;
+
+    apply(forward_step, inverse_step, false);
+}
+
+
+// ---------------------------------------------------------------- rotate_y
+
+void
+Placement::rotate_y(const double theta) {
+    double sin_theta = sin(theta * PI_ON_180);
+    double cos_theta = cos(theta * PI_ON_180);
+
+    Matrix forward_step;
+    forward_step.m[0][0] = cos_theta;
+    forward_step.m[0][2] = sin_theta;
+    forward_step.m[2][0] = -sin_theta;
+    forward_step.m[2][2] = cos_theta;
+
+    Matrix inverse_step;
+    inverse_step.m[0][0] = cos_theta;
+    inverse_step.m[0][2] = -sin_theta;
+    inverse_step.m[2][0] = sin_theta;
+    inverse_step.m[2][2] = cos_theta;
+
+    apply(forward_step, inverse_step, false);
+}
+
+
+// ---------------------------------------------------------------- rotate_z
+
+void
+Placement::rotate_z(const double theta) {
+    double sin_theta = sin(theta * PI_ON_180);
+    double cos_theta = cos(theta * PI_ON_180);
+
+    Matrix forward_step;
+    forward_step.m[0][0] = cos_theta;
+    forward_step.m[0][1] = -sin_theta;
+    forward_step.m[1][0] = sin_theta;
+    forward_step.m[1][1] = cos_theta;
+
+    Matrix inverse_step;
+    inverse_step.m[0][0] = cos_theta;
+    inverse_step.m[0][1] = sin_theta;
+    inverse_step.m[1][0] = -sin_theta;
+    inverse_step.m[1][1] = cos_theta;
+
+    apply(forward_step, inverse_step, false);
+}
+
+
+// ---------------------------------------------------------------- transform
+// the inverse of the linear part is its adjugate over its determinant; a singular
+// matrix is ignored
+
+void
+Placement::transform(const Matrix& m) {
+    const double (*a)[4] = m.m;
+
+    double c00 = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+    double c01 = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+    double c02 = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+    double det = a[0][0] * c00 + a[0][1] * c01 + a[0][2] * c02;
+
+    if (det == 0.0)
+        return;
+
+    double inv_det = 1.0 / det;
+
+    Matrix forward_step;
+    Matrix inverse_step;
+
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 4; j++)
+            forward_step.m[i][j] = a[i][j];
+
+    inverse_step.m[0][0] = c00 * inv_det;
+    inverse_step.m[1][0] = c01 * inv_det;
+    inverse_step.m[2][0] = c02 * inv_det;
+    inverse_step.m[0][1] = (a[0][2] * a[2][1] - a[0][1] * a[2][2]) * inv_det;
+    inverse_step.m[1][1] = (a[0][0] * a[2][2] - a[0][2] * a[2][0]) * inv_det;
+    inverse_step.m[2][1] = (a[0][1] * a[2][0] - a[0][0] * a[2][1]) * inv_det;
+    inverse_step.m[0][2] = (a[0][1] * a[1][2] - a[0][2] * a[1][1]) * inv_det;
+    inverse_step.m[1][2] = (a[0][2] * a[1][0] - a[0][0] * a[1][2]) * inv_det;
+    inverse_step.m[2][2] = (a[0][0] * a[1][1] - a[0][1] * a[1][0]) * inv_det;
+
+    for (int i = 0; i < 3; i++)
+        inverse_step.m[i][3] = -(inverse_step.m[i][0] * a[0][3] + inverse_step.m[i][1] * a[1][3] + inverse_step.m[i][2] * a[2][3]);
+
+    bool translation = a[0][0] == 1.0 && a[1][1] == 1.0 && a[2][2] == 1.0
+                    && a[0][1] == 0.0 && a[0][2] == 0.0 && a[1][0] == 0.0
+                    && a[1][2] == 0.0 && a[2][0] == 0.0 && a[2][1] == 0.0;
+
+    apply(forward_step, inverse_step, translation);
+}
+
+
+// ---------------------------------------------------------------- reset_transform
+
+void
+Placement::reset_transform(void) {
+    forward_matrix 		= Matrix();
+    inv_matrix 			= Matrix();
+    translation_only 	= true;
+
+    update_cache();
+}
+
+
+// ---------------------------------------------------------------- append_transform
+
+void
+Placement::append_transform(const Placement& outer) {
+    apply(outer.forward_matrix, outer.inv_matrix, outer.translation_only);
+}
+
+
+// ---------------------------------------------------------------- collapse
+// the inner placement's transformation is applied first, so it sits on the right of ours;
+// the outer material, when there is one, wins as it does for nested Instances. This runs while
+// the hierarchy is set up, before any ray is traced, and takes the inner placement's own
+// material; what the prototype hits is resolved per hit.
+// Bounds given to the inner placement are in the new prototype's space and are kept; bounds
+// given to this one are in the inner placement's space, which goes away, so they are dropped
+
+void
+Placement::collapse(void) {
+    Placement* inner_ptr = dynamic_cast<Placement*>(prototype_ptr.get());
+
+    while (inner_ptr) {
+        std::shared_ptr<GeometricObject> inner = prototype_ptr;	// keeps inner_ptr alive below
+
+        forward_matrix 		= forward_matrix * inner_ptr->forward_matrix;
+        inv_matrix 			= inner_ptr->inv_matrix * inv_matrix;
+        translation_only 	= translation_only && inner_ptr->translation_only;
+
+        if (!material_ptr)
+            material_ptr = inner_ptr->material_ptr;
+
+        bounded 		= inner_ptr->bounded;
+        local_bounds 	= inner_ptr->local_bounds;
+
+        prototype_ptr 	= inner_ptr->prototype_ptr;
+        packet_ptr 		= inner_ptr->packet_ptr;
+        occluder_ptr 	= inner_ptr->occluder_ptr;
+        inner_ptr 		= dynamic_cast<Placement*>(prototype_ptr.get());
+    }
+
+    update_cache();
+}
+
+
+// ---------------------------------------------------------------- get_bounding_box
+// the prototype's own box, or the one given to set_bounds, in world space
+
+BBox
+Placement::get_bounding_box(void) {
+    if (bounded)
+        return (world_bounds);
+
+    if (!prototype_ptr)
+        return (BBox());
+
+    return (transform_box(prototype_ptr->get_bounding_box()));
+}
+
+
+// ---------------------------------------------------------------- hit
+// a pure translation leaves directions and normals unchanged, so only the origin moves;
+// without a material of its own, the placement hands back the one the prototype hit
+
+bool
+Placement::hit(const Ray& ray, double& tmin, ShadeRec& sr) const {
+    if (bounded && !world_bounds.hit(ray))
+        return (false);
+
+    Ray local_ray(ray);
+
+    if (translation_only)
+        local_ray.o = ray.o + inv_offset;
+    else {
+        local_ray.o = inv_matrix * ray.o;
+        local_ray.d = inv_matrix * ray.d;
+    }
+
+    if (!prototype_ptr->hit(local_ray, tmin, sr))
+        return (false);
+
+    if (!translation_only) {
+        sr.normal = transform_normal(normal_matrix, sr.normal);
+        sr.normal.normalize();
+    }
+
+    if (material_ptr)
+        HitMaterial::set(sr, tmin, material_ptr);
+    else
+        HitMaterial::set(sr, tmin, HitMaterial::take(prototype_ptr.get(), tmin, sr));
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- shadow_hit
+
+bool
+Placement::shadow_hit(const Ray& ray, float& tmin) const {
+    if (bounded && !world_bounds.hit(ray))
+        return (false);
+
+    Ray local_ray(ray);
+
+    if (translation_only)
+        local_ray.o = ray.o + inv_offset;
+    else {
+        local_ray.o = inv_matrix * ray.o;
+        local_ray.d = inv_matrix * ray.d;
+    }
+
+    return (prototype_ptr->shadow_hit(local_ray, tmin));
+}
+
+
+// ---------------------------------------------------------------- occluded
+
+bool
+Placement::occluded(const Ray& ray, const double tmax, Occlusion& occlusion) const {
+    if (bounded && !world_bounds.hit(ray))
+        return (false);
+
+    Ray local_ray(ray);
+
+    if (translation_only)
+        local_ray.o = ray.o + inv_offset;
+    else {
+        local_ray.o = inv_matrix * ray.o;
+        local_ray.d = inv_matrix * ray.d;
+    }
+
+    if (!test_object(prototype_ptr.get(), occluder_ptr, local_ray, tmax, occlusion))
+        return (false);
+
+    occlusion.to_object 	= occlusion.transformed ? occlusion.to_object * inv_matrix : inv_matrix;
+    occlusion.transformed 	= true;
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- hit_packet
+// lanes whose hit the prototype moved closer get their normals back in world space, and
+// this placement's material when it has one
+
+void
+Placement::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    int lanes = packet.active;
+
+    if (bounded) {
+        lanes = enter_box(	packet, hits, world_bounds.x0, world_bounds.x1, world_bounds.y0, world_bounds.y1,
+                            world_bounds.z0, world_bounds.z1);
+        if (!lanes)
+            return;
+    }
+
+    if (!packet_ptr) {
+        hit_lanes(this, packet, hits, lanes);
+        return;
+    }
+
+    RayPacket 	local_packet;
+    double 		t_before[kPacketSize];
+
+    for (int j = 0; j < kPacketSize; j++) {
+        t_before[j] = hits.t_hit[j];
+
+        if (!(lanes & (1 << j)))
+            continue;
+
+        const Ray& ray = packet.rays[j];
+        Ray local_ray(ray);
+
+        if (translation_only)
+            local_ray.o = ray.o + inv_offset;
+        else {
+            local_ray.o = inv_matrix * ray.o;
+            local_ray.d = inv_matrix * ray.d;
+        }
+
+        local_packet.set(j, local_ray);
+    }
+
+    local_packet.fill_inactive();
+    packet_ptr->hit_packet(local_packet, hits);
+
+    for (int j = 0; j < kPacketSize; j++) {
+        if (hits.t_hit[j] >= t_before[j])
+            continue;
+
+        if (!translation_only) {
+            hits.normal[j] = transform_normal(normal_matrix, hits.normal[j]);
+            hits.normal[j].normalize();
+        }
+
+        if (material_ptr)
+            hits.material[j] = material_ptr;
+    }
+}
@@ -0,0 +1,177 @@
+#ifndef __PLACEMENT__
+#define __PLACEMENT__
+
+// A lightweight instance of a shared prototype object.
+// Unlike Instance, which owns its object, a placement holds a reference-counted prototype,
+// one affine transformation and its own material, so many identical parts (the keys of a
+// keyboard) can share one piece of geometry.
+// The transformation is built with the same calls as Instance. The inverse and the normal
+// matrix are kept up to date as it is built, and a placement that has only been translated
+// is flagged so that its rays take a cheap path that only moves the origin.
+// collapse folds a chain of nested placements into a single matrix; BVH::setup_hierarchy
+// collapses its children, so each leaf costs one transformation per ray however it was built.
+// As with Instance, the local hit point is left in the prototype's space.
+// A placement without a material of its own shows whatever its prototype hit shows; hits
+// hand that material back without storing it in the placement.
+// A placement passes packets on to a prototype that takes them, moving each ray into the
+// prototype's space; otherwise its lanes are hit one at a time.
+// Shadow rays take the prototype's occlusion query in the same way, and a blocker found
+// inside the prototype is reported with this placement's inverse folded into its matrix.
+// set_bounds gives the prototype's box in its own space (see AnalyticBounds). The placement
+// then keeps that box carried through its transformation, reports it as its bounding box,
+// and tests every ray against it before transforming the ray, so that a ray which misses
+// never reaches the prototype's solver. That holds inside a Compound, a BVH or the world.
+
+#include <memory>
+
+#include "GeometricObject.h"
+#include "Occluder.h"
+#include "PacketPrimitive.h"
+#include "Utilities/BBox.h"
+#include "Utilities/Matrix.h"
+#include "Utilities/SceneArena.h"
+#include "Utilities/Vector3D.h"
+
+class Placement: public GeometricObject, public PacketPrimitive, public Occluder, public ArenaAllocated {
+    public:
+
+        Placement(void);
+
+        Placement(const std::shared_ptr<GeometricObject>& prototype);
+
+        Placement(const std::shared_ptr<GeometricObject>& prototype, const Vector3D& offset);
+
+        Placement(const Placement& placement);
+
+        virtual Placement*
+        clone(void) const;
+
+        Placement&
+        operator= (const Placement& rhs);
+
+        virtual
+        ~Placement(void);
+
+        void
+        set_prototype(const std::shared_ptr<GeometricObject>& prototype);
+
+        const std::shared_ptr<GeometricObject>&
+        get_prototype(void) const;
+
+        void
+        translate(const Vector3D& trans);
+
+        void
+        translate(const double dx, const double dy, const double dz);
+
+        void
+        scale(const Vector3D& s);
+
+        void
+        scale(const double a, const double b, const double c);
+
+        void
+        rotate_x(const double r);
+
+        void
+        rotate_y(const double r);
+
+        void
+        rotate_z(const double r);
+
+        void
+        transform(const Matrix& m);						// applies an affine matrix; the bottom row is ignored
+
+        void
+        reset_transform(void);							// back to the identity, for animation
+
+        void
+        append_transform(const Placement& outer);		// applies outer's transformation after this one's
+
+        const Matrix&
+        get_matrix(void) const;							// prototype space to world space
+
+        const Matrix&
+        get_inverse_matrix(void) const;
+
+        void
+        collapse(void);									// folds nested placements into this one
+
+        bool
+        is_translation(void) const;
+
+        void
+        set_bounds(const BBox& local_bounds);			// the prototype's box, in prototype space
+
+        virtual BBox
+        get_bounding_box(void);
+
+        virtual bool
+        hit(const Ray& ray, double& tmin, ShadeRec& sr) const;
+
+        virtual bool
+        shadow_hit(const Ray& ray, float& tmin) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+        virtual bool
+        occluded(const Ray& ray, const double tmax, Occlusion& occlusion) const;
+
+    private:
+
+        std::shared_ptr<GeometricObject> 	prototype_ptr;
+        const PacketPrimitive* 				packet_ptr;			// the prototype as a PacketPrimitive, or null
+        const Occluder* 					occluder_ptr;		// the prototype as an Occluder, or null
+        Matrix 								forward_matrix;		// prototype space to world space
+        Matrix 								inv_matrix;			// world space to prototype space
+        Matrix 								normal_matrix;		// transpose of inv_matrix, for normals
+        Vector3D 							inv_offset;			// translation part of inv_matrix
+        bool 								translation_only;
+        bool 								bounded;			// set_bounds was called
+        BBox 								local_bounds;
+        BBox 								world_bounds;		// local_bounds through forward_matrix
+
+        void
+        apply(const Matrix& forward_step, const Matrix& inverse_step, const bool translation);
+
+        void
+        update_cache(void);
+
+        BBox
+        transform_box(const BBox& b) const;
+};
+
+
+// ---------------------------------------------------------------- get_prototype
+
+inline const std::shared_ptr<GeometricObject>&
+Placement::get_prototype(void) const {
+    return (prototype_ptr);
+}
+
+
+// ---------------------------------------------------------------- get_matrix
+
+inline const Matrix&
+Placement::get_matrix(void) const {
+    return (forward_matrix);
+}
+
+
+// ---------------------------------------------------------------- get_inverse_matrix
+
+inline const Matrix&
+Placement::get_inverse_matrix(void) const {
+    return (inv_matrix);
+}
+
+
+// ---------------------------------------------------------------- is_translation
+
+inline bool
+Placement::is_translation(void) const {
+    return (translation_only);
+}
+
+#endif
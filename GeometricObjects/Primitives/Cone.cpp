@@ -0,0 +1,190 @@
+#include "Cone.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "GeometricObjects/HitMaterial.h"
+#include "Utilities/Constants.h"
+#include "Utilities/ShadeRec.h"
+
+
+// ---------------------------------------------------------------- default constructor
+
+Cone::Cone(void)
+    : 	GeometricObject(),
+        height(1.0),
+        radius(1.0),
+        closed(true)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+Cone::Cone(const double h, const double r, const bool c)
+    : 	GeometricObject(),
+        height(h),
+        radius(r),
+        closed(c)
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+Cone::Cone(const Cone& cone)
+    : 	GeometricObject(cone),
+        height(cone.height),
+        radius(cone.radius),
+        closed(cone.closed)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+Cone*
+Cone::clone(void) const {
+    return (new Cone(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+Cone&
+Cone::operator= (const Cone& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    GeometricObject::operator=(rhs);
+
+    height 	= rhs.height;
+    radius 	= rhs.radius;
+    closed 	= rhs.closed;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+Cone::~Cone(void) {}
+
+
+// ---------------------------------------------------------------- get_bounding_box
+
+BBox
+Cone::get_bounding_box(void) {
+    return (BBox(-radius - kEpsilon, radius + kEpsilon, std::min(0.0, height) - kEpsilon,
+                 std::max(0.0, height) + kEpsilon, -radius - kEpsilon, radius + kEpsilon));
+}
+
+
+// ---------------------------------------------------------------- hit_cone
+// the side is x^2 + z^2 = k^2 (height - y)^2 with k = radius / height, between the base and
+// the apex; the nearer root on it, then the base disk when the cone is closed
+
+bool
+Cone::hit_cone(	const Ray& ray, const double height, const double radius, const bool closed,
+                double& tmin, Normal& normal) {
+    double 	k2 	= (radius * radius) / (height * height);
+    double 	y0 	= std::min(0.0, height);
+    double 	y1 	= std::max(0.0, height);
+    double 	s 	= height - ray.o.y;
+    bool 	hit = false;
+
+    tmin = kHugeValue;
+
+    double a = ray.d.x * ray.d.x + ray.d.z * ray.d.z - k2 * ray.d.y * ray.d.y;
+    double b = 2.0 * (ray.o.x * ray.d.x + ray.o.z * ray.d.z + k2 * s * ray.d.y);
+    double c = ray.o.x * ray.o.x + ray.o.z * ray.o.z - k2 * s * s;
+    double roots[2];
+    int 	num_roots = 0;
+
+    if (a != 0.0) {
+        double disc = b * b - 4.0 * a * c;
+
+        if (disc >= 0.0) {
+            double e = sqrt(disc);
+            roots[0] = (-b - e) / (2.0 * a);
+            roots[1] = (-b + e) / (2.0 * a);
+            if (roots[0] > roots[1])
+                std::swap(roots[0], roots[1]);
+            num_roots = 2;
+        }
+    }
+    else if (b != 0.0) {		// parallel to a line of the side: one crossing
+        roots[0] 	= -c / b;
+        num_roots 	= 1;
+    }
+
+    for (int j = 0; j < num_roots; j++) {
+        double t = roots[j];
+        double y = ray.o.y + t * ray.d.y;
+
+        if (t > kEpsilon && y >= y0 && y <= y1) {
+            double x = ray.o.x + t * ray.d.x;
+            double z = ray.o.z + t * ray.d.z;
+
+            tmin 	= t;
+            normal 	= Normal(x, k2 * (height - y), z);
+            normal.normalize();
+            hit 	= true;
+            break;
+        }
+    }
+
+    if (closed && ray.d.y != 0.0) {
+        double t = -ray.o.y / ray.d.y;
+
+        if (t > kEpsilon && t < tmin) {
+            double x = ray.o.x + t * ray.d.x;
+            double z = ray.o.z + t * ray.d.z;
+
+            if (x * x + z * z <= radius * radius) {
+                tmin 	= t;
+                normal 	= Normal(0.0, height > 0.0 ? -1.0 : 1.0, 0.0);
+                hit 	= true;
+            }
+        }
+    }
+
+    if (hit && !closed && normal * ray.d > 0.0)
+        normal = -normal;
+
+    return (hit);
+}
+
+
+// ---------------------------------------------------------------- hit
+
+bool
+Cone::hit(const Ray& ray, double& tmin, ShadeRec& sr) const {
+    double 	t;
+    Normal 	normal;
+
+    if (!hit_cone(ray, height, radius, closed, t, normal))
+        return (false);
+
+    tmin 				= t;
+    sr.normal 			= normal;
+    sr.local_hit_point 	= ray.o + t * ray.d;
+    HitMaterial::set(sr, t, material_ptr);
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- shadow_hit
+
+bool
+Cone::shadow_hit(const Ray& ray, float& tmin) const {
+    if (!shadows)
+        return (false);
+
+    double 	t;
+    Normal 	normal;
+
+    if (!hit_cone(ray, height, radius, closed, t, normal))
+        return (false);
+
+    tmin = t;
+    return (true);
+}
@@ -0,0 +1,86 @@
+#ifndef __CONE__
+#define __CONE__
+
+// A right circular cone around the y axis, with a base of the given radius in the plane
+// y = 0 and its apex at y = height. Closed, with its base disk, it is a SolidCone(height,
+// radius); open, it is the bare side of an OpenCone(height, radius), whose normal is turned
+// towards the ray, as the library's open surfaces do.
+// As with Tube, a hit stores nothing in the object and the parameters can be read back for
+// the scene cache; hit_cone is shared with FlatScene.
+
+#include "GeometricObjects/GeometricObject.h"
+#include "Utilities/BBox.h"
+#include "Utilities/SceneArena.h"
+
+class Cone: public GeometricObject, public ArenaAllocated {
+    public:
+
+        Cone(void);
+
+        Cone(const double height, const double radius, const bool closed);
+
+        Cone(const Cone& cone);
+
+        virtual Cone*
+        clone(void) const;
+
+        Cone&
+        operator= (const Cone& rhs);
+
+        virtual
+        ~Cone(void);
+
+        double
+        get_height(void) const;
+
+        double
+        get_radius(void) const;
+
+        bool
+        is_closed(void) const;
+
+        virtual BBox
+        get_bounding_box(void);
+
+        virtual bool
+        hit(const Ray& ray, double& tmin, ShadeRec& sr) const;
+
+        virtual bool
+        shadow_hit(const Ray& ray, float& tmin) const;
+
+        static bool
+        hit_cone(	const Ray& ray, const double height, const double radius, const bool closed,
+                    double& tmin, Normal& normal);
+
+    private:
+
+        double 		height;
+        double 		radius;
+        bool 		closed;
+};
+
+
+// ---------------------------------------------------------------- get_height
+
+inline double
+Cone::get_height(void) const {
+    return (height);
+}
+
+
+// ---------------------------------------------------------------- get_radius
+
+inline double
+Cone::get_radius(void) const {
+    return (radius);
+}
+
+
+// ---------------------------------------------------------------- is_closed
+
+inline bool
+Cone::is_closed(void) const {
+    return (closed);
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include "PacketDisk.h"
+
+
+// ---------------------------------------------------------------- default constructor
+
+PacketDisk::PacketDisk(void)
+    : 	Disk(Point3D(0.0), Normal(0, 1, 0), 1.0),
+        center(0.0),
+        normal(0, 1, 0),
+        r_squared(1.0)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+PacketDisk::PacketDisk(const Point3D& c, const Normal& n, const double r)
+    : 	Disk(c, n, r),
+        center(c),
+        normal(n),
+        r_squared(r * r)
+{
+    normal.normalize();
+}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+PacketDisk::PacketDisk(const PacketDisk& disk)
+    : 	Disk(disk),
+        center(disk.center),
+        normal(disk.normal),
+        r_squared(disk.r_squared)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+PacketDisk*
+PacketDisk::clone(void) const {
+    return (new PacketDisk(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+PacketDisk&
+PacketDisk::operator= (const PacketDisk& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Disk::operator=(rhs);
+
+    center 		= rhs.center;
+    normal 		= rhs.normal;
+    r_squared 	= rhs.r_squared;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+PacketDisk::~PacketDisk(void) {}
+
+
+// ---------------------------------------------------------------- hit_packet
+
+void
+PacketDisk::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    PacketFloat nx(normal.x), ny(normal.y), nz(normal.z);
+    PacketFloat ox = PacketFloat::load(packet.ox);
+    PacketFloat oy = PacketFloat::load(packet.oy);
+    PacketFloat oz = PacketFloat::load(packet.oz);
+    PacketFloat dx = PacketFloat::load(packet.dx);
+    PacketFloat dy = PacketFloat::load(packet.dy);
+    PacketFloat dz = PacketFloat::load(packet.dz);
+
+    PacketFloat t = ((PacketFloat(center.x) - ox) * nx + (PacketFloat(center.y) - oy) * ny + (PacketFloat(center.z) - oz) * nz)
+                  / (dx * nx + dy * ny + dz * nz);
+
+    PacketFloat px = ox + t * dx - PacketFloat(center.x);
+    PacketFloat py = oy + t * dy - PacketFloat(center.y);
+    PacketFloat pz = oz + t * dz - PacketFloat(center.z);
+
+    // a little slack on the radius: the exact test below has the last word
+
+    PacketFloat inside = (px * px + py * py + pz * pz) < PacketFloat(r_squared * 1.001 + kEpsilon);
+
+    int lanes = ((t > PacketFloat(kEpsilon)) & (t < PacketFloat::load(hits.t)) & inside).mask() & packet.active;
+
+    for (int j = 0; j < kPacketSize; j++) {
+        if (!(lanes & (1 << j)))
+            continue;
+
+        const Ray& ray 	= packet.rays[j];
+        double t 		= (center - ray.o) * normal / (ray.d * normal);
+
+        if (t <= kEpsilon || t >= hits.t_hit[j])
+            continue;
+
+        Point3D p = ray.o + t * ray.d;
+
+        if (center.d_squared(p) < r_squared)
+            hits.record(j, t, normal, p, material_ptr);
+    }
+}
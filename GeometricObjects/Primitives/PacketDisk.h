@@ -0,0 +1,74 @@
+#ifndef __PACKET_DISK__
+#define __PACKET_DISK__
+
+// A Disk that can also be hit by a RayPacket.
+// The centre, normal and radius are kept here as well, because Disk's own are private.
+
+#include <cmath>
+
+#include "Disk.h"
+#include "GeometricObjects/PacketPrimitive.h"
+#include "Utilities/SceneArena.h"
+
+class PacketDisk: public Disk, public PacketPrimitive, public ArenaAllocated {
+    public:
+
+        PacketDisk(void);
+
+        PacketDisk(const Point3D& c, const Normal& n, const double r);
+
+        PacketDisk(const PacketDisk& disk);
+
+        virtual PacketDisk*
+        clone(void) const;
+
+        PacketDisk&
+        operator= (const PacketDisk& rhs);
+
+        virtual
+        ~PacketDisk(void);
+
+        Point3D
+        get_center(void) const;
+
+        Normal
+        get_normal(void) const;
+
+        double
+        get_radius(void) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+    private:
+
+        Point3D 	center;
+        Normal 		normal;
+        double 		r_squared;
+};
+
+
+// ---------------------------------------------------------------- get_center
+
+inline Point3D
+PacketDisk::get_center(void) const {
+    return (center);
+}
+
+
+// ---------------------------------------------------------------- get_normal
+
+inline Normal
+PacketDisk::get_normal(void) const {
+    return (normal);
+}
+
+
+// ---------------------------------------------------------------- get_radius
+
+inline double
+PacketDisk::get_radius(void) const {
+    return (sqrt(r_squared));
+}
+
+#endif
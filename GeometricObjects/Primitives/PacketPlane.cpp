@@ -0,0 +1,88 @@
+#include "PacketPlane.h"
+
+
+// ---------------------------------------------------------------- default constructor
+
+PacketPlane::PacketPlane(void)
+    : 	Plane(Point3D(0.0), Normal(0, 1, 0)),
+        a(0.0),
+        n(0, 1, 0)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+PacketPlane::PacketPlane(const Point3D& point, const Normal& normal)
+    : 	Plane(point, normal),
+        a(point),
+        n(normal)
+{
+    n.normalize();
+}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+PacketPlane::PacketPlane(const PacketPlane& plane)
+    : 	Plane(plane),
+        a(plane.a),
+        n(plane.n)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+PacketPlane*
+PacketPlane::clone(void) const {
+    return (new PacketPlane(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+PacketPlane&
+PacketPlane::operator= (const PacketPlane& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Plane::operator=(rhs);
+
+    a = rhs.a;
+    n = rhs.n;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+PacketPlane::~PacketPlane(void) {}
+
+
+// ---------------------------------------------------------------- hit_packet
+
+void
+PacketPlane::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    PacketFloat nx(n.x), ny(n.y), nz(n.z);
+
+    PacketFloat num = 	(PacketFloat(a.x) - PacketFloat::load(packet.ox)) * nx +
+                        (PacketFloat(a.y) - PacketFloat::load(packet.oy)) * ny +
+                        (PacketFloat(a.z) - PacketFloat::load(packet.oz)) * nz;
+    PacketFloat den = 	PacketFloat::load(packet.dx) * nx +
+                        PacketFloat::load(packet.dy) * ny +
+                        PacketFloat::load(packet.dz) * nz;
+    PacketFloat t 	= num / den;
+
+    int lanes = ((t > PacketFloat(kEpsilon)) & (t < PacketFloat::load(hits.t))).mask() & packet.active;
+
+    for (int j = 0; j < kPacketSize; j++) {
+        if (!(lanes & (1 << j)))
+            continue;
+
+        const Ray& ray 	= packet.rays[j];
+        double t 		= (a - ray.o) * n / (ray.d * n);
+
+        if (t > kEpsilon && t < hits.t_hit[j])
+            hits.record(j, t, n, ray.o + t * ray.d, material_ptr);
+    }
+}
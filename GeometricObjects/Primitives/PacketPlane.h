@@ -0,0 +1,60 @@
+#ifndef __PACKET_PLANE__
+#define __PACKET_PLANE__
+
+// A Plane that can also be hit by a RayPacket.
+// The point and normal are kept here as well, because Plane's own are private.
+
+#include "Plane.h"
+#include "GeometricObjects/PacketPrimitive.h"
+#include "Utilities/SceneArena.h"
+
+class PacketPlane: public Plane, public PacketPrimitive, public ArenaAllocated {
+    public:
+
+        PacketPlane(void);
+
+        PacketPlane(const Point3D& point, const Normal& normal);
+
+        PacketPlane(const PacketPlane& plane);
+
+        virtual PacketPlane*
+        clone(void) const;
+
+        PacketPlane&
+        operator= (const PacketPlane& rhs);
+
+        virtual
+        ~PacketPlane(void);
+
+        Point3D
+        get_point(void) const;
+
+        Normal
+        get_normal(void) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+    private:
+
+        Point3D 	a;				// point through which the plane passes
+        Normal 		n;				// normal to the plane
+};
+
+
+// ---------------------------------------------------------------- get_point
+
+inline Point3D
+PacketPlane::get_point(void) const {
+    return (a);
+}
+
+
+// ---------------------------------------------------------------- get_normal
+
+inline Normal
+PacketPlane::get_normal(void) const {
+    return (n);
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include "PacketSphere.h"
+
+#include <cmath>
+
+
+// ---------------------------------------------------------------- default constructor
+
+PacketSphere::PacketSphere(void)
+    : 	Sphere(Point3D(0.0), 1.0),
+        center(0.0),
+        radius(1.0)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+PacketSphere::PacketSphere(const Point3D& c, const double r)
+    : 	Sphere(c, r),
+        center(c),
+        radius(r)
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+PacketSphere::PacketSphere(const PacketSphere& sphere)
+    : 	Sphere(sphere),
+        center(sphere.center),
+        radius(sphere.radius)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+PacketSphere*
+PacketSphere::clone(void) const {
+    return (new PacketSphere(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+PacketSphere&
+PacketSphere::operator= (const PacketSphere& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Sphere::operator=(rhs);
+
+    center 	= rhs.center;
+    radius 	= rhs.radius;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+PacketSphere::~PacketSphere(void) {}
+
+
+// ---------------------------------------------------------------- set_center
+
+void
+PacketSphere::set_center(const Point3D& c) {
+    Sphere::set_center(c);
+    center = c;
+}
+
+
+// ---------------------------------------------------------------- set_radius
+
+void
+PacketSphere::set_radius(const double r) {
+    Sphere::set_radius(r);
+    radius = r;
+}
+
+
+// ---------------------------------------------------------------- hit_packet
+
+void
+PacketSphere::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    PacketFloat tx = PacketFloat::load(packet.ox) - PacketFloat(center.x);
+    PacketFloat ty = PacketFloat::load(packet.oy) - PacketFloat(center.y);
+    PacketFloat tz = PacketFloat::load(packet.oz) - PacketFloat(center.z);
+    PacketFloat dx = PacketFloat::load(packet.dx);
+    PacketFloat dy = PacketFloat::load(packet.dy);
+    PacketFloat dz = PacketFloat::load(packet.dz);
+
+    PacketFloat a 		= dx * dx + dy * dy + dz * dz;
+    PacketFloat b 		= (tx * dx + ty * dy + tz * dz) * PacketFloat(2.0f);
+    PacketFloat c 		= tx * tx + ty * ty + tz * tz - PacketFloat(radius * radius);
+    PacketFloat disc 	= b * b - a * c * PacketFloat(4.0f);
+    PacketFloat e 		= sqrt(max(disc, PacketFloat(0.0f)));
+    PacketFloat far_t 	= (e - b) / (a * PacketFloat(2.0f));
+
+    // the far root bounds both: a lane can only hit if it lies ahead of the ray
+
+    int lanes = ((disc >= PacketFloat(0.0f)) & (far_t > PacketFloat(kEpsilon))).mask() & packet.active;
+
+    for (int j = 0; j < kPacketSize; j++) {
+        if (!(lanes & (1 << j)))
+            continue;
+
+        const Ray& ray 	= packet.rays[j];
+        Vector3D temp 	= ray.o - center;
+        double a 		= ray.d * ray.d;
+        double b 		= 2.0 * temp * ray.d;
+        double c 		= temp * temp - radius * radius;
+        double disc 	= b * b - 4.0 * a * c;
+
+        if (disc < 0.0)
+            continue;
+
+        double e 		= sqrt(disc);
+        double denom 	= 2.0 * a;
+        double t 		= (-b - e) / denom;
+
+        if (t <= kEpsilon)
+            t = (-b + e) / denom;
+
+        if (t > kEpsilon && t < hits.t_hit[j])
+            hits.record(j, t, (temp + t * ray.d) / radius, ray.o + t * ray.d, material_ptr);
+    }
+}
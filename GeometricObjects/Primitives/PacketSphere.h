@@ -0,0 +1,66 @@
+#ifndef __PACKET_SPHERE__
+#define __PACKET_SPHERE__
+
+// A Sphere that can also be hit by a RayPacket.
+// The centre and radius are kept here as well, because Sphere's own are private.
+
+#include "Sphere.h"
+#include "GeometricObjects/PacketPrimitive.h"
+#include "Utilities/SceneArena.h"
+
+class PacketSphere: public Sphere, public PacketPrimitive, public ArenaAllocated {
+    public:
+
+        PacketSphere(void);
+
+        PacketSphere(const Point3D& c, const double r);
+
+        PacketSphere(const PacketSphere& sphere);
+
+        virtual PacketSphere*
+        clone(void) const;
+
+        PacketSphere&
+        operator= (const PacketSphere& rhs);
+
+        virtual
+        ~PacketSphere(void);
+
+        void
+        set_center(const Point3D& c);
+
+        void
+        set_radius(const double r);
+
+        Point3D
+        get_center(void) const;
+
+        double
+        get_radius(void) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+    private:
+
+        Point3D 	center;
+        double 		radius;
+};
+
+
+// ---------------------------------------------------------------- get_center
+
+inline Point3D
+PacketSphere::get_center(void) const {
+    return (center);
+}
+
+
+// ---------------------------------------------------------------- get_radius
+
+inline double
+PacketSphere::get_radius(void) const {
+    return (radius);
+}
+
+#endif
@@ -0,0 +1,365 @@
+#include "PacketTorus.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utilities/RenderStats.h"
+#include "Utilities/ShadeRec.h"
+
+// the packet march hands its lanes to the scalar march within this fraction of the tube radius
+static const double kTolerance = 1.0e-3;
+
+// the scalar march's shortest step, as a fraction of the tube radius; only a chord shorter
+// than this, which dips less than about 1e-9 of the tube radius into the tube, can be missed
+static const double kMinStep = 1.0e-4;
+
+
+// ---------------------------------------------------------------- default constructor
+
+PacketTorus::PacketTorus(void)
+    : 	Torus(),
+        PacketPrimitive(),
+        a(2.0),
+        b(0.5)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+PacketTorus::PacketTorus(const double a, const double b)
+    : 	Torus(a, b),
+        PacketPrimitive(),
+        a(a),
+        b(b)
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+PacketTorus::PacketTorus(const PacketTorus& torus)
+    : 	Torus(torus),
+        PacketPrimitive(),
+        a(torus.a),
+        b(torus.b)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+PacketTorus*
+PacketTorus::clone(void) const {
+    return (new PacketTorus(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+PacketTorus&
+PacketTorus::operator= (const PacketTorus& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Torus::operator=(rhs);
+
+    a = rhs.a;
+    b = rhs.b;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+PacketTorus::~PacketTorus(void) {}
+
+
+// ---------------------------------------------------------------- implicit
+// negative inside the tube
+
+double
+PacketTorus::implicit(const Point3D& p) const {
+    double s = p.x * p.x + p.y * p.y + p.z * p.z + a * a - b * b;
+
+    return (s * s - 4.0 * a * a * (p.x * p.x + p.z * p.z));
+}
+
+
+// ---------------------------------------------------------------- distance
+// unsigned distance to the surface; it never exceeds the distance along any ray
+
+double
+PacketTorus::distance(const Point3D& p) const {
+    double q = sqrt(p.x * p.x + p.z * p.z) - a;
+
+    return (fabs(sqrt(q * q + p.y * p.y) - b));
+}
+
+
+// ---------------------------------------------------------------- compute_normal
+// the gradient of the implicit function, as Torus computes it
+
+Normal
+PacketTorus::compute_normal(const Point3D& p) const {
+    double param_squared 	= a * a + b * b;
+    double sum_squared 		= p.x * p.x + p.y * p.y + p.z * p.z;
+
+    Normal normal(	4.0 * p.x * (sum_squared - param_squared),
+                    4.0 * p.y * (sum_squared - param_squared + 2.0 * a * a),
+                    4.0 * p.z * (sum_squared - param_squared));
+    normal.normalize();
+
+    return (normal);
+}
+
+
+// ---------------------------------------------------------------- clip
+// the part of the ray ahead of kEpsilon that lies in the bounding sphere and between the
+// planes y = -b and y = b
+
+bool
+PacketTorus::clip(const Ray& ray, double& t0, double& t1) const {
+    double r 	= a + b + kEpsilon;
+    double dd 	= ray.d * ray.d;
+    double od 	= ray.o.x * ray.d.x + ray.o.y * ray.d.y + ray.o.z * ray.d.z;
+    double c 	= ray.o.x * ray.o.x + ray.o.y * ray.o.y + ray.o.z * ray.o.z - r * r;
+    double disc = od * od - dd * c;
+
+    if (disc < 0.0)
+        return (false);
+
+    double e = sqrt(disc);
+    t0 = (-od - e) / dd;
+    t1 = (-od + e) / dd;
+
+    double h = b + kEpsilon;
+
+    if (ray.d.y != 0.0) {
+        double ty0 = (-h - ray.o.y) / ray.d.y;
+        double ty1 = (h - ray.o.y) / ray.d.y;
+
+        t0 = std::max(t0, std::min(ty0, ty1));
+        t1 = std::min(t1, std::max(ty0, ty1));
+    }
+    else if (fabs(ray.o.y) > h)
+        return (false);
+
+    t0 = std::max(t0, kEpsilon);
+
+    return (t0 <= t1);
+}
+
+
+// ---------------------------------------------------------------- march
+// steps from t towards t_end by the distance to the surface, but at least kMinStep. The
+// distance is 1-Lipschitz, so a step no longer than it cannot pass through the tube; each
+// step checks the sign of the implicit function at its end, and a change brackets the
+// crossing for refine. A ray grazing the tube takes ever shorter steps, runs out of them,
+// and is left to Torus::hit
+
+PacketTorus::March
+PacketTorus::march(const Ray& ray, double t, const double t_end, double& tmin) const {
+    double len 		= sqrt(ray.d * ray.d);
+    double min_step = kMinStep * b;
+    Point3D p 		= ray.o + t * ray.d;
+    bool inside 	= implicit(p) < 0.0;
+
+    for (int step = 0; step < kMaxSteps; step++) {
+        if (t >= t_end)
+            return (kMiss);
+
+        double t_next 	= std::min(t + std::max(distance(p), min_step) / len, t_end);
+        Point3D p_next 	= ray.o + t_next * ray.d;
+
+        if ((implicit(p_next) < 0.0) != inside) {
+            tmin = refine(ray, t, t_next);
+            return (kHit);
+        }
+
+        t = t_next;
+        p = p_next;
+    }
+
+    return (kUndecided);
+}
+
+
+// ---------------------------------------------------------------- refine
+// Newton steps on the quartic along the ray, kept inside the bracket [lo, hi] by falling
+// back to bisection
+
+double
+PacketTorus::refine(const Ray& ray, double lo, double hi) const {
+    bool 	inside_lo 	= implicit(ray.o + lo * ray.d) < 0.0;
+    double 	t 			= 0.5 * (lo + hi);
+
+    for (int j = 0; j < 32; j++) {
+        Point3D p 	= ray.o + t * ray.d;
+        double s 	= p.x * p.x + p.y * p.y + p.z * p.z + a * a - b * b;
+        double f 	= s * s - 4.0 * a * a * (p.x * p.x + p.z * p.z);
+        double df 	= 4.0 * s * (p.x * ray.d.x + p.y * ray.d.y + p.z * ray.d.z)
+                    - 8.0 * a * a * (p.x * ray.d.x + p.z * ray.d.z);
+
+        if ((f < 0.0) == inside_lo)
+            lo = t;
+        else
+            hi = t;
+
+        double t_new = df != 0.0 ? t - f / df : lo;
+
+        if (!(t_new > lo && t_new < hi))
+            t_new = 0.5 * (lo + hi);
+
+        if (fabs(t_new - t) <= 1.0e-12 * (1.0 + t))
+            return (t_new);
+
+        t = t_new;
+    }
+
+    return (t);
+}
+
+
+// ---------------------------------------------------------------- hit
+
+bool
+PacketTorus::hit(const Ray& ray, double& tmin, ShadeRec& sr) const {
+    double t0, t1, t;
+
+    if (!clip(ray, t0, t1))
+        return (false);
+
+    March result = march(ray, t0, t1, t);
+
+    if (result == kMiss)
+        return (false);
+
+    if (result == kUndecided) {
+        RENDER_COUNT(RenderStats::local().torus_fallbacks++);
+        return (Torus::hit(ray, tmin, sr));
+    }
+
+    tmin 				= t;
+    sr.local_hit_point 	= ray.o + t * ray.d;
+    sr.normal 			= compute_normal(sr.local_hit_point);
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- shadow_hit
+
+bool
+PacketTorus::shadow_hit(const Ray& ray, float& tmin) const {
+    if (!shadows)
+        return (false);
+
+    double t0, t1, t;
+
+    if (!clip(ray, t0, t1))
+        return (false);
+
+    March result = march(ray, t0, t1, t);
+
+    if (result == kMiss)
+        return (false);
+
+    if (result == kUndecided) {
+        RENDER_COUNT(RenderStats::local().torus_fallbacks++);
+        return (Torus::shadow_hit(ray, tmin));
+    }
+
+    tmin = t;
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- hit_packet
+// all lanes march together in single precision until each has reached the surface, left
+// the bounding sphere or run out of steps; the first are finished by the scalar march from
+// just short of where they stopped, the last by Torus::hit
+
+void
+PacketTorus::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    PacketFloat ox = PacketFloat::load(packet.ox);
+    PacketFloat oy = PacketFloat::load(packet.oy);
+    PacketFloat oz = PacketFloat::load(packet.oz);
+    PacketFloat dx = PacketFloat::load(packet.dx);
+    PacketFloat dy = PacketFloat::load(packet.dy);
+    PacketFloat dz = PacketFloat::load(packet.dz);
+    PacketFloat zero(0.0f);
+
+    float r = a + b + kEpsilon;
+
+    // the chord is measured from the point of the ray nearest the centre; the textbook
+    // discriminant cancels badly in single precision once a squashing placement has put
+    // the origin far away in the torus's space
+
+    PacketFloat dd 		= dx * dx + dy * dy + dz * dz;
+    PacketFloat tc 		= (zero - (ox * dx + oy * dy + oz * dz)) / dd;
+    PacketFloat cx 		= ox + tc * dx;
+    PacketFloat cy 		= oy + tc * dy;
+    PacketFloat cz 		= oz + tc * dz;
+    PacketFloat disc 	= PacketFloat(r * r) - (cx * cx + cy * cy + cz * cz);
+    PacketFloat e 		= sqrt(max(disc, zero) / dd);
+    PacketFloat t 		= max(tc - e, PacketFloat(kEpsilon));
+    PacketFloat t_end 	= min(tc + e, PacketFloat::load(hits.t));
+
+    int lanes = ((disc >= zero) & (t <= t_end)).mask() & packet.active;
+
+    if (!lanes)
+        return;
+
+    PacketFloat inv_len = PacketFloat(1.0f) / sqrt(dd);
+    PacketFloat sa(a);
+    PacketFloat sb(b);
+    PacketFloat tol(kTolerance * b);
+    int 		live = lanes;
+
+    for (int step = 0; live && step < kMaxSteps; step++) {
+        PacketFloat px 	= ox + t * dx;
+        PacketFloat py 	= oy + t * dy;
+        PacketFloat pz 	= oz + t * dz;
+        PacketFloat q 	= sqrt(px * px + pz * pz) - sa;
+        PacketFloat d 	= sqrt(q * q + py * py) - sb;
+        PacketFloat away = max(d, zero - d) >= tol;
+
+        t 		= t + select(away, max(d, zero - d) * inv_len, zero);
+        live 	&= (away & (t <= t_end)).mask();
+    }
+
+    alignas(32) float t_lane[kPacketSize];
+    alignas(32) float t_end_lane[kPacketSize];
+    t.store(t_lane);
+    t_end.store(t_end_lane);
+
+    ShadeRec& sr = *hits.scratch;
+
+    for (int j = 0; j < kPacketSize; j++) {
+        if (!(lanes & (1 << j)))
+            continue;
+
+        const Ray& ray 	= packet.rays[j];
+        March result 	= kUndecided;
+        double t0, t1, t_hit;
+
+        if (!(live & (1 << j))) {
+            if (t_lane[j] > t_end_lane[j] || !clip(ray, t0, t1))
+                continue;
+
+            double back = 2.0 * kTolerance * b / sqrt(ray.d * ray.d);
+            result = march(ray, std::max(t0, t_lane[j] - back), std::min(t1, hits.t_hit[j]), t_hit);
+        }
+
+        if (result == kHit) {
+            Point3D p = ray.o + t_hit * ray.d;
+            hits.record(j, t_hit, compute_normal(p), p, material_ptr);
+        }
+        else if (result == kUndecided) {
+            RENDER_COUNT(RenderStats::local().torus_fallbacks++);
+
+            if (Torus::hit(ray, t_hit, sr) && t_hit < hits.t_hit[j])
+                hits.record(j, t_hit, sr.normal, sr.local_hit_point, material_ptr);
+        }
+    }
+}
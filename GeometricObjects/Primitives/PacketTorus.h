@@ -0,0 +1,101 @@
+#ifndef __PACKET_TORUS__
+#define __PACKET_TORUS__
+
+// A Torus with its own intersector, which can also be hit by a RayPacket.
+// Torus::hit expands the ray into a quartic and hands it to the general solver, which is
+// slow and loses the near root when a placement squashes the torus (scale(3, 1, 0.1) in the
+// voyager). Here the ray is first clipped to the bounding sphere and to the slab |y| <= b,
+// then marched by the torus's distance function, which is 1-Lipschitz, so a step of that
+// distance never passes the surface; each step checks the sign of the implicit quartic, and
+// the crossing it brackets is refined by safeguarded Newton steps.
+// Steps are never shorter than kMinStep (1e-4) of the tube radius, so a chord through the
+// tube shorter than that, dipping less than about 1e-9 of the tube radius into it, can be
+// stepped over and missed. Rays that would need more than kMaxSteps steps (those grazing
+// the tube, whose steps shrink as they near it) fall back to Torus::hit.
+// hit_packet marches all lanes at once in single precision and refines the lanes that reach
+// the surface in double precision.
+// The torus lies in the xz plane about the y axis, as Torus's does: a is the swept radius,
+// b the tube radius.
+
+#include "Torus.h"
+#include "GeometricObjects/PacketPrimitive.h"
+#include "Utilities/SceneArena.h"
+
+class PacketTorus: public Torus, public PacketPrimitive, public ArenaAllocated {
+    public:
+
+        PacketTorus(void);
+
+        PacketTorus(const double a, const double b);
+
+        PacketTorus(const PacketTorus& torus);
+
+        virtual PacketTorus*
+        clone(void) const;
+
+        PacketTorus&
+        operator= (const PacketTorus& rhs);
+
+        virtual
+        ~PacketTorus(void);
+
+        double
+        get_swept_radius(void) const;
+
+        double
+        get_tube_radius(void) const;
+
+        virtual bool
+        hit(const Ray& ray, double& tmin, ShadeRec& sr) const;
+
+        virtual bool
+        shadow_hit(const Ray& ray, float& tmin) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+        static const int kMaxSteps = 96;
+
+    private:
+
+        enum March { kMiss, kHit, kUndecided };
+
+        double 		a;					// swept radius
+        double 		b;					// tube radius
+
+        bool
+        clip(const Ray& ray, double& t0, double& t1) const;
+
+        March
+        march(const Ray& ray, double t, const double t_end, double& tmin) const;
+
+        double
+        refine(const Ray& ray, double lo, double hi) const;
+
+        double
+        implicit(const Point3D& p) const;
+
+        double
+        distance(const Point3D& p) const;
+
+        Normal
+        compute_normal(const Point3D& p) const;
+};
+
+
+// ---------------------------------------------------------------- get_swept_radius
+
+inline double
+PacketTorus::get_swept_radius(void) const {
+    return (a);
+}
+
+
+// ---------------------------------------------------------------- get_tube_radius
+
+inline double
+PacketTorus::get_tube_radius(void) const {
+    return (b);
+}
+
+#endif
@@ -0,0 +1,482 @@
+#include "SphereSet.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "GeometricObjects/HitMaterial.h"
+#include "Utilities/Constants.h"
+#include "Utilities/RenderStats.h"
+#include "Utilities/ShadeRec.h"
+
+
+// ---------------------------------------------------------------- pop_node
+// pops the next deferred node that can still hold a hit nearer than tmin
+
+static inline bool
+pop_node(const int stack[], const double stack_t[], int& top, const double tmin, int& node_index) {
+    while (top > 0) {
+        --top;
+        if (stack_t[top] < tmin) {
+            node_index = stack[top];
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+SphereSet::SphereSet(void)
+    : 	GeometricObject(),
+        centers(),
+        radii(),
+        material_of(),
+        xs(), ys(), zs(), rs(),
+        nodes(),
+        materials(),
+        bbox()
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+SphereSet::SphereSet(const SphereSet& set)
+    : 	GeometricObject(set),
+        centers(set.centers),
+        radii(set.radii),
+        material_of(set.material_of),
+        xs(set.xs), ys(set.ys), zs(set.zs), rs(set.rs),
+        nodes(set.nodes),
+        materials(set.materials),
+        bbox(set.bbox)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+SphereSet*
+SphereSet::clone(void) const {
+    return (new SphereSet(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+SphereSet&
+SphereSet::operator= (const SphereSet& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    GeometricObject::operator=(rhs);
+
+    centers 		= rhs.centers;
+    radii 			= rhs.radii;
+    material_of 	= rhs.material_of;
+    xs 				= rhs.xs;
+    ys 				= rhs.ys;
+    zs 				= rhs.zs;
+    rs 				= rhs.rs;
+    nodes 			= rhs.nodes;
+    materials 		= rhs.materials;
+    bbox 			= rhs.bbox;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+SphereSet::~SphereSet(void) {}
+
+
+// ---------------------------------------------------------------- add_sphere
+// returns the sphere's index until the next setup, which reorders the spheres
+
+int
+SphereSet::add_sphere(const Point3D& center, const double radius, const std::shared_ptr<Material>& material) {
+    int index = -1;
+
+    if (material) {
+        for (int j = 0; j < (int) materials.size() && index < 0; j++)
+            if (materials[j] == material)
+                index = j;
+
+        if (index < 0) {
+            index = materials.size();
+            materials.push_back(material);
+        }
+    }
+
+    centers.push_back(center);
+    radii.push_back(radius);
+    material_of.push_back(index);
+
+    return (centers.size() - 1);
+}
+
+
+// ---------------------------------------------------------------- setup
+// builds the tree over the spheres' boxes, puts the spheres in leaf order and makes the
+// single precision copies; the copies run kPacketSize past the last sphere, so that a leaf
+// can always be loaded whole
+
+void
+SphereSet::setup(void) {
+    int count = centers.size();
+
+    std::vector<BBox> boxes(count);
+
+    for (int j = 0; j < count; j++) {
+        const Point3D& c = centers[j];
+        double r = radii[j];
+        boxes[j] = BBox(c.x - r, c.x + r, c.y - r, c.y + r, c.z - r, c.z + r);
+    }
+
+    std::vector<int> order;
+    BVH::build_tree(boxes, kPacketSize, nodes, order);
+
+    std::vector<Point3D> 	sorted_centers(count);
+    std::vector<double> 	sorted_radii(count);
+    std::vector<int> 		sorted_materials(count);
+
+    for (int j = 0; j < count; j++) {
+        sorted_centers[j] 	= centers[order[j]];
+        sorted_radii[j] 	= radii[order[j]];
+        sorted_materials[j] = material_of[order[j]];
+    }
+
+    centers.swap(sorted_centers);
+    radii.swap(sorted_radii);
+    material_of.swap(sorted_materials);
+
+    xs.assign(count + kPacketSize, 0.0f);
+    ys.assign(count + kPacketSize, 0.0f);
+    zs.assign(count + kPacketSize, 0.0f);
+    rs.assign(count + kPacketSize, 0.0f);
+
+    for (int j = 0; j < count; j++) {
+        xs[j] = centers[j].x;
+        ys[j] = centers[j].y;
+        zs[j] = centers[j].z;
+        rs[j] = radii[j];
+    }
+
+    if (nodes.empty())
+        bbox = BBox();
+    else
+        bbox = BBox(nodes[0].x0, nodes[0].x1, nodes[0].y0, nodes[0].y1, nodes[0].z0, nodes[0].z1);
+}
+
+
+// ---------------------------------------------------------------- get_sphere_material
+
+std::shared_ptr<Material>
+SphereSet::get_sphere_material(const int j) const {
+    return (material_of[j] < 0 ? std::shared_ptr<Material>() : materials[material_of[j]]);
+}
+
+
+// ---------------------------------------------------------------- get_bounding_box
+
+BBox
+SphereSet::get_bounding_box(void) {
+    return (bbox);
+}
+
+
+// ---------------------------------------------------------------- normal_at
+
+Normal
+SphereSet::normal_at(const int j, const Point3D& p) const {
+    return ((p - centers[j]) / radii[j]);
+}
+
+
+// ---------------------------------------------------------------- hit_leaf
+// one SIMD pass per kPacketSize spheres picks those the ray may hit before tmin; the chord
+// is measured from the point of the ray nearest each centre, which keeps the single
+// precision test close to the double precision one
+
+bool
+SphereSet::hit_leaf(const Ray& ray, const BVHNode& node, double& tmin, int& nearest) const {
+    PacketFloat ox(ray.o.x);
+    PacketFloat oy(ray.o.y);
+    PacketFloat oz(ray.o.z);
+    PacketFloat dx(ray.d.x);
+    PacketFloat dy(ray.d.y);
+    PacketFloat dz(ray.d.z);
+    PacketFloat zero(0.0f);
+    PacketFloat dd(ray.d * ray.d);
+
+    bool found = false;
+    int end = node.offset + node.count;
+
+    for (int first = node.offset; first < end; first += kPacketSize) {
+        PacketFloat tx = ox - PacketFloat::load_unaligned(&xs[first]);
+        PacketFloat ty = oy - PacketFloat::load_unaligned(&ys[first]);
+        PacketFloat tz = oz - PacketFloat::load_unaligned(&zs[first]);
+        PacketFloat r 	= PacketFloat::load_unaligned(&rs[first]);
+
+        PacketFloat tc 		= (zero - (tx * dx + ty * dy + tz * dz)) / dd;
+        PacketFloat px 		= tx + tc * dx;
+        PacketFloat py 		= ty + tc * dy;
+        PacketFloat pz 		= tz + tc * dz;
+        PacketFloat disc 	= r * r - (px * px + py * py + pz * pz);
+        PacketFloat e 		= sqrt(max(disc, zero) / dd);
+
+        int lanes = ((disc >= zero) & (tc + e > PacketFloat(kEpsilon)) & (tc - e < PacketFloat(tmin))).mask();
+        lanes &= (1 << std::min(kPacketSize, end - first)) - 1;
+
+        for (int k = 0; lanes; k++, lanes >>= 1) {
+            if (!(lanes & 1))
+                continue;
+
+            int j 			= first + k;
+            Vector3D temp 	= ray.o - centers[j];
+            double a 		= ray.d * ray.d;
+            double b 		= 2.0 * temp * ray.d;
+            double c 		= temp * temp - radii[j] * radii[j];
+            double disc 	= b * b - 4.0 * a * c;
+
+            if (disc < 0.0)
+                continue;
+
+            double e 		= sqrt(disc);
+            double denom 	= 2.0 * a;
+            double t 		= (-b - e) / denom;
+
+            if (t <= kEpsilon)
+                t = (-b + e) / denom;
+
+            if (t > kEpsilon && t < tmin) {
+                tmin 	= t;
+                nearest = j;
+                found 	= true;
+            }
+        }
+    }
+
+    return (found);
+}
+
+
+// ---------------------------------------------------------------- nearest_hit
+// a front-to-back walk of the tree, as in BVH::hit, for the nearest sphere before tmax;
+// with any set, the first sphere found before tmax will do
+
+bool
+SphereSet::nearest_hit(const Ray& ray, const bool any, const double tmax, double& tmin, int& nearest) const {
+    if (nodes.empty())
+        return (false);
+
+    RENDER_COUNT(RenderCounts& counts = RenderStats::local());
+
+    double 	inv_d[3] = { 1.0 / ray.d.x, 1.0 / ray.d.y, 1.0 / ray.d.z };
+    double 	tnear;
+    int 	stack[kBVHStackSize];
+    double 	stack_t[kBVHStackSize];
+    int 	top = 0;
+    int 	node_index = 0;
+
+    tmin 	= tmax;
+    nearest = -1;
+
+    RENDER_COUNT(counts.node_tests++);
+
+    if (!nodes[0].entry(ray.o, inv_d, tmin, tnear))
+        return (false);
+
+    while (true) {
+        const BVHNode& node = nodes[node_index];
+
+        if (node.count > 0) {
+            RENDER_COUNT(counts.object_tests += node.count);
+
+            if (hit_leaf(ray, node, tmin, nearest) && any)
+                return (true);
+        }
+        else {
+            int 	left 	= node_index + 1;
+            int 	right 	= node.offset;
+            double 	t_left, t_right;
+            bool 	hit_left 	= nodes[left].entry(ray.o, inv_d, tmin, t_left);
+            bool 	hit_right 	= nodes[right].entry(ray.o, inv_d, tmin, t_right);
+
+            RENDER_COUNT(counts.node_tests += 2);
+
+            if (hit_left && hit_right) {
+                if (t_right < t_left) {
+                    std::swap(left, right);
+                    std::swap(t_left, t_right);
+                }
+                stack[top] 		= right;
+                stack_t[top++] 	= t_right;
+                node_index 		= left;
+                continue;
+            }
+
+            if (hit_left) 	{ node_index = left;  continue; }
+            if (hit_right) 	{ node_index = right; continue; }
+        }
+
+        if (!pop_node(stack, stack_t, top, tmin, node_index))
+            break;
+    }
+
+    return (nearest >= 0);
+}
+
+
+// ---------------------------------------------------------------- hit
+
+bool
+SphereSet::hit(const Ray& ray, double& tmin, ShadeRec& sr) const {
+    int nearest;
+
+    if (!nearest_hit(ray, false, kHugeValue, tmin, nearest))
+        return (false);
+
+    HitMaterial::set(sr, tmin, material_of[nearest] < 0 ? material_ptr : materials[material_of[nearest]]);
+    sr.local_hit_point 	= ray.o + tmin * ray.d;
+    sr.normal 			= normal_at(nearest, sr.local_hit_point);
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- shadow_hit
+// nearest occluder, so that point lights can compare it with their distance
+
+bool
+SphereSet::shadow_hit(const Ray& ray, float& tmin) const {
+    if (!shadows)
+        return (false);
+
+    double 	t;
+    int 	nearest;
+
+    if (!nearest_hit(ray, false, kHugeValue, t, nearest))
+        return (false);
+
+    tmin = t;
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- occluded
+// the set itself is the blocker a light remembers: a retest walks the tree again, which
+// for spheres costs little more than finding the one sphere
+
+bool
+SphereSet::occluded(const Ray& ray, const double tmax, Occlusion& occlusion) const {
+    if (!shadows)
+        return (false);
+
+    double 	t;
+    int 	nearest;
+
+    if (!nearest_hit(ray, true, tmax, t, nearest))
+        return (false);
+
+    occlusion.object_ptr 	= this;
+    occlusion.transformed 	= false;
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- hit_packet
+// the packet descends the tree as in BVH::hit_packet; at a leaf, each ray that enters it
+// is tested against the leaf's spheres, and hits are recorded against the material's tag
+
+void
+SphereSet::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    if (nodes.empty() || !packet.active)
+        return;
+
+    RENDER_COUNT(RenderCounts& counts = RenderStats::local());
+
+    int first = 0;
+    while (!(packet.active & (1 << first)))
+        first++;
+
+    const Vector3D& d = packet.rays[first].d;
+
+    int 	stack[kBVHStackSize];
+    int 	top = 0;
+    int 	node_index = 0;
+    int 	lanes;
+
+    RENDER_COUNT(int num_active = lane_count(packet.active));
+    RENDER_COUNT(counts.node_tests += num_active);
+
+    if (!(lanes = enter_box(packet, hits, nodes[0].x0, nodes[0].x1, nodes[0].y0, nodes[0].y1, nodes[0].z0, nodes[0].z1)))
+        return;
+
+    while (true) {
+        const BVHNode& node = nodes[node_index];
+
+        if (node.count > 0) {
+            for (int j = 0; j < kPacketSize; j++) {
+                if (!(lanes & (1 << j)))
+                    continue;
+
+                double 	t = hits.t_hit[j];
+                int 	nearest;
+
+                RENDER_COUNT(counts.object_tests += node.count);
+
+                if (hit_leaf(packet.rays[j], node, t, nearest)) {
+                    const Ray& ray 	= packet.rays[j];
+                    Point3D p 		= ray.o + t * ray.d;
+                    int material 	= material_of[nearest];
+
+                    hits.record(j, t, normal_at(nearest, p), p, material < 0 ? material_ptr : materials[material]);
+                }
+            }
+        }
+        else {
+            int 		left 	= node_index + 1;
+            int 		right 	= node.offset;
+            const BVHNode& l 	= nodes[left];
+            const BVHNode& r 	= nodes[right];
+            int lanes_left 		= enter_box(packet, hits, l.x0, l.x1, l.y0, l.y1, l.z0, l.z1);
+            int lanes_right 	= enter_box(packet, hits, r.x0, r.x1, r.y0, r.y1, r.z0, r.z1);
+
+            RENDER_COUNT(counts.node_tests += 2 * num_active);
+
+            if (lanes_left && lanes_right) {
+                double along = 	(r.x0 + r.x1 - l.x0 - l.x1) * d.x +
+                                (r.y0 + r.y1 - l.y0 - l.y1) * d.y +
+                                (r.z0 + r.z1 - l.z0 - l.z1) * d.z;
+                if (along < 0.0) {
+                    std::swap(left, right);
+                    std::swap(lanes_left, lanes_right);
+                }
+                stack[top++] 	= right;
+                node_index 		= left;
+                lanes 			= lanes_left;
+                continue;
+            }
+
+            if (lanes_left) 	{ node_index = left;  lanes = lanes_left;  continue; }
+            if (lanes_right) 	{ node_index = right; lanes = lanes_right; continue; }
+        }
+
+        // deferred nodes are entered again, as the packet's hits may have moved closer
+
+        lanes = 0;
+
+        while (!lanes && top > 0) {
+            const BVHNode& n = nodes[stack[--top]];
+            RENDER_COUNT(counts.node_tests += num_active);
+            lanes = enter_box(packet, hits, n.x0, n.x1, n.y0, n.y1, n.z0, n.z1);
+            node_index = &n - &nodes[0];
+        }
+
+        if (!lanes)
+            break;
+    }
+}
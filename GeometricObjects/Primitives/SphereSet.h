@@ -0,0 +1,120 @@
+#ifndef __SPHERE_SET__
+#define __SPHERE_SET__
+
+// Many spheres as one object, for sphere-heavy scenes.
+// Instead of one heap-allocated PacketSphere per sphere, each tested through a virtual hit,
+// the spheres are kept as plain arrays: centres, radii and material indices, with the
+// centres and radii also in single precision, one array per component, so that a leaf of
+// the set's own BVH (BVH::build_tree) is tested against a ray with one SIMD pass over
+// kPacketSize spheres. Candidates are then intersected in double precision, as in
+// PacketSphere, so the hits are those of the individual spheres.
+// Fill it with add_sphere, then call setup once all spheres are added, as with a BVH;
+// setup puts the spheres in tree order. A SphereSet is a single leaf to any Compound, Grid
+// or BVH it is added to.
+// Materials are per sphere. A hit, scalar or packet, hands back the material of the sphere hit.
+// Shadows are cast or not by the whole set (set_shadows).
+
+#include <memory>
+#include <vector>
+
+#include "GeometricObjects/CompoundObjects/BVH.h"
+#include "GeometricObjects/GeometricObject.h"
+#include "GeometricObjects/Occluder.h"
+#include "GeometricObjects/PacketPrimitive.h"
+#include "Utilities/BBox.h"
+#include "Utilities/SceneArena.h"
+
+class SphereSet: public GeometricObject, public PacketPrimitive, public Occluder, public ArenaAllocated {
+    public:
+
+        SphereSet(void);
+
+        SphereSet(const SphereSet& set);
+
+        virtual SphereSet*
+        clone(void) const;
+
+        SphereSet&
+        operator= (const SphereSet& rhs);
+
+        virtual
+        ~SphereSet(void);
+
+        int
+        add_sphere(const Point3D& center, const double radius, const std::shared_ptr<Material>& material);
+
+        void
+        setup(void);
+
+        int
+        get_num_spheres(void) const;
+
+        Point3D
+        get_center(const int j) const;
+
+        double
+        get_radius(const int j) const;
+
+        std::shared_ptr<Material>
+        get_sphere_material(const int j) const;
+
+        virtual BBox
+        get_bounding_box(void);
+
+        virtual bool
+        hit(const Ray& ray, double& tmin, ShadeRec& sr) const;
+
+        virtual bool
+        shadow_hit(const Ray& ray, float& tmin) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+        virtual bool
+        occluded(const Ray& ray, const double tmax, Occlusion& occlusion) const;
+
+    private:
+
+        std::vector<Point3D> 								centers;
+        std::vector<double> 								radii;
+        std::vector<int> 									material_of;		// index into materials, -1 for none
+        std::vector<float> 									xs, ys, zs, rs;		// single precision copies, padded by kPacketSize
+        std::vector<BVHNode> 								nodes;				// leaf offsets index the spheres
+        std::vector<std::shared_ptr<Material> > 			materials;
+        BBox 												bbox;
+
+        bool
+        nearest_hit(const Ray& ray, const bool any, const double tmax, double& tmin, int& nearest) const;
+
+        bool
+        hit_leaf(const Ray& ray, const BVHNode& node, double& tmin, int& nearest) const;
+
+        Normal
+        normal_at(const int j, const Point3D& p) const;
+};
+
+
+// ---------------------------------------------------------------- get_num_spheres
+
+inline int
+SphereSet::get_num_spheres(void) const {
+    return (centers.size());
+}
+
+
+// ---------------------------------------------------------------- get_center
+
+inline Point3D
+SphereSet::get_center(const int j) const {
+    return (centers[j]);
+}
+
+
+// ---------------------------------------------------------------- get_radius
+
+inline double
+SphereSet::get_radius(const int j) const {
+    return (radii[j]);
+}
+
+#endif
@@ -0,0 +1,190 @@
+#include "Tube.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "GeometricObjects/HitMaterial.h"
+#include "Utilities/Constants.h"
+#include "Utilities/ShadeRec.h"
+
+
+// ---------------------------------------------------------------- default constructor
+
+Tube::Tube(void)
+    : 	GeometricObject(),
+        bottom(0.0),
+        top(1.0),
+        inner(0.0),
+        outer(1.0)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+Tube::Tube(const double b, const double t, const double r)
+    : 	GeometricObject(),
+        bottom(std::min(b, t)),
+        top(std::max(b, t)),
+        inner(0.0),
+        outer(r)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+Tube::Tube(const double b, const double t, const double i, const double o)
+    : 	GeometricObject(),
+        bottom(std::min(b, t)),
+        top(std::max(b, t)),
+        inner(i),
+        outer(o)
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+Tube::Tube(const Tube& tube)
+    : 	GeometricObject(tube),
+        bottom(tube.bottom),
+        top(tube.top),
+        inner(tube.inner),
+        outer(tube.outer)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+Tube*
+Tube::clone(void) const {
+    return (new Tube(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+Tube&
+Tube::operator= (const Tube& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    GeometricObject::operator=(rhs);
+
+    bottom 	= rhs.bottom;
+    top 	= rhs.top;
+    inner 	= rhs.inner;
+    outer 	= rhs.outer;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+Tube::~Tube(void) {}
+
+
+// ---------------------------------------------------------------- get_bounding_box
+
+BBox
+Tube::get_bounding_box(void) {
+    return (BBox(-outer - kEpsilon, outer + kEpsilon, bottom - kEpsilon, top + kEpsilon, -outer - kEpsilon, outer + kEpsilon));
+}
+
+
+// ---------------------------------------------------------------- hit_tube
+// the nearest of the two walls, whose nearer root inside [bottom, top] is taken, and the
+// two annular ends
+
+bool
+Tube::hit_tube(	const Ray& ray, const double bottom, const double top, const double inner, const double outer,
+                double& tmin, Normal& normal) {
+    bool hit = false;
+
+    tmin = kHugeValue;
+
+    double a = ray.d.x * ray.d.x + ray.d.z * ray.d.z;
+    double b = 2.0 * (ray.o.x * ray.d.x + ray.o.z * ray.d.z);
+
+    if (a > 0.0)
+        for (int wall = 0; wall < (inner > 0.0 ? 2 : 1); wall++) {
+            double r 	= wall == 0 ? outer : inner;
+            double c 	= ray.o.x * ray.o.x + ray.o.z * ray.o.z - r * r;
+            double disc = b * b - 4.0 * a * c;
+
+            if (disc < 0.0)
+                continue;
+
+            double e = sqrt(disc);
+
+            for (int root = 0; root < 2; root++) {
+                double t = (root == 0 ? -b - e : -b + e) / (2.0 * a);
+                double y = ray.o.y + t * ray.d.y;
+
+                if (t > kEpsilon && t < tmin && y >= bottom && y <= top) {
+                    double sign = wall == 0 ? 1.0 : -1.0;
+
+                    tmin 	= t;
+                    normal 	= Normal(sign * (ray.o.x + t * ray.d.x) / r, 0.0, sign * (ray.o.z + t * ray.d.z) / r);
+                    hit 	= true;
+                    break;
+                }
+            }
+        }
+
+    if (ray.d.y != 0.0)
+        for (int end = 0; end < 2; end++) {
+            double t = ((end == 0 ? bottom : top) - ray.o.y) / ray.d.y;
+
+            if (t <= kEpsilon || t >= tmin)
+                continue;
+
+            double x 	= ray.o.x + t * ray.d.x;
+            double z 	= ray.o.z + t * ray.d.z;
+            double rr 	= x * x + z * z;
+
+            if (rr <= outer * outer && rr >= inner * inner) {
+                tmin 	= t;
+                normal 	= Normal(0.0, end == 0 ? -1.0 : 1.0, 0.0);
+                hit 	= true;
+            }
+        }
+
+    return (hit);
+}
+
+
+// ---------------------------------------------------------------- hit
+
+bool
+Tube::hit(const Ray& ray, double& tmin, ShadeRec& sr) const {
+    double 	t;
+    Normal 	normal;
+
+    if (!hit_tube(ray, bottom, top, inner, outer, t, normal))
+        return (false);
+
+    tmin 				= t;
+    sr.normal 			= normal;
+    sr.local_hit_point 	= ray.o + t * ray.d;
+    HitMaterial::set(sr, t, material_ptr);
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- shadow_hit
+
+bool
+Tube::shadow_hit(const Ray& ray, float& tmin) const {
+    if (!shadows)
+        return (false);
+
+    double 	t;
+    Normal 	normal;
+
+    if (!hit_tube(ray, bottom, top, inner, outer, t, normal))
+        return (false);
+
+    tmin = t;
+    return (true);
+}
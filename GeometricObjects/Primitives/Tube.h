@@ -0,0 +1,99 @@
+#ifndef __TUBE__
+#define __TUBE__
+
+// A closed tube around the y axis: the solid between two cylinders, from bottom to top,
+// with flat annular ends. With an inner radius of 0 it is a SolidCylinder(bottom, top,
+// outer); otherwise it is a ThickRing(bottom, top, inner, outer).
+// Unlike those two, which are library Compounds, a tube is one surface: its hit stores
+// nothing in the object, and its parameters can be read back, so the scene cache can store
+// it. hit_tube is the intersection itself, shared with FlatScene.
+// The normals point out of the solid, so the inner wall's point at the axis.
+
+#include "GeometricObjects/GeometricObject.h"
+#include "Utilities/BBox.h"
+#include "Utilities/SceneArena.h"
+
+class Tube: public GeometricObject, public ArenaAllocated {
+    public:
+
+        Tube(void);
+
+        Tube(const double bottom, const double top, const double outer);					// solid
+
+        Tube(const double bottom, const double top, const double inner, const double outer);
+
+        Tube(const Tube& tube);
+
+        virtual Tube*
+        clone(void) const;
+
+        Tube&
+        operator= (const Tube& rhs);
+
+        virtual
+        ~Tube(void);
+
+        double
+        get_bottom(void) const;
+
+        double
+        get_top(void) const;
+
+        double
+        get_inner_radius(void) const;
+
+        double
+        get_outer_radius(void) const;
+
+        virtual BBox
+        get_bounding_box(void);
+
+        virtual bool
+        hit(const Ray& ray, double& tmin, ShadeRec& sr) const;
+
+        virtual bool
+        shadow_hit(const Ray& ray, float& tmin) const;
+
+        static bool
+        hit_tube(	const Ray& ray, const double bottom, const double top, const double inner, const double outer,
+                    double& tmin, Normal& normal);
+
+    private:
+
+        double 		bottom, top;			// bottom <= top
+        double 		inner, outer;
+};
+
+
+// ---------------------------------------------------------------- get_bottom
+
+inline double
+Tube::get_bottom(void) const {
+    return (bottom);
+}
+
+
+// ---------------------------------------------------------------- get_top
+
+inline double
+Tube::get_top(void) const {
+    return (top);
+}
+
+
+// ---------------------------------------------------------------- get_inner_radius
+
+inline double
+Tube::get_inner_radius(void) const {
+    return (inner);
+}
+
+
+// ---------------------------------------------------------------- get_outer_radius
+
+inline double
+Tube::get_outer_radius(void) const {
+    return (outer);
+}
+
+#endif
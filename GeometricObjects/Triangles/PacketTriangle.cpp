@@ -0,0 +1,136 @@
+#include "PacketTriangle.h"
+
+
+// ---------------------------------------------------------------- default constructor
+
+PacketTriangle::PacketTriangle(void)
+    : 	Triangle(Point3D(0, 0, 0), Point3D(0, 0, 1), Point3D(1, 0, 0)),
+        v0(0, 0, 0),
+        v1(0, 0, 1),
+        v2(1, 0, 0),
+        normal(0, 1, 0)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+PacketTriangle::PacketTriangle(const Point3D& a, const Point3D& b, const Point3D& c)
+    : 	Triangle(a, b, c),
+        v0(a),
+        v1(b),
+        v2(c),
+        normal((v1 - v0) ^ (v2 - v0))
+{
+    normal.normalize();
+}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+PacketTriangle::PacketTriangle(const PacketTriangle& triangle)
+    : 	Triangle(triangle),
+        v0(triangle.v0),
+        v1(triangle.v1),
+        v2(triangle.v2),
+        normal(triangle.normal)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+PacketTriangle*
+PacketTriangle::clone(void) const {
+    return (new PacketTriangle(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+PacketTriangle&
+PacketTriangle::operator= (const PacketTriangle& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Triangle::operator=(rhs);
+
+    v0 		= rhs.v0;
+    v1 		= rhs.v1;
+    v2 		= rhs.v2;
+    normal 	= rhs.normal;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+PacketTriangle::~PacketTriangle(void) {}
+
+
+// ---------------------------------------------------------------- hit_packet
+// Moller-Trumbore over the packet, with a small tolerance on the barycentric tests;
+// candidates are then tested exactly as Triangle::hit does
+
+void
+PacketTriangle::hit_packet(const RayPacket& packet, PacketHit& hits) const {
+    const float tolerance = 1.0e-4f;
+
+    PacketFloat e1x(v1.x - v0.x), e1y(v1.y - v0.y), e1z(v1.z - v0.z);
+    PacketFloat e2x(v2.x - v0.x), e2y(v2.y - v0.y), e2z(v2.z - v0.z);
+    PacketFloat dx = PacketFloat::load(packet.dx);
+    PacketFloat dy = PacketFloat::load(packet.dy);
+    PacketFloat dz = PacketFloat::load(packet.dz);
+
+    PacketFloat px = dy * e2z - dz * e2y;
+    PacketFloat py = dz * e2x - dx * e2z;
+    PacketFloat pz = dx * e2y - dy * e2x;
+    PacketFloat inv_det = PacketFloat(1.0f) / (e1x * px + e1y * py + e1z * pz);
+
+    PacketFloat tx = PacketFloat::load(packet.ox) - PacketFloat(v0.x);
+    PacketFloat ty = PacketFloat::load(packet.oy) - PacketFloat(v0.y);
+    PacketFloat tz = PacketFloat::load(packet.oz) - PacketFloat(v0.z);
+    PacketFloat u = (tx * px + ty * py + tz * pz) * inv_det;
+
+    PacketFloat qx = ty * e1z - tz * e1y;
+    PacketFloat qy = tz * e1x - tx * e1z;
+    PacketFloat qz = tx * e1y - ty * e1x;
+    PacketFloat v = (dx * qx + dy * qy + dz * qz) * inv_det;
+    PacketFloat t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+
+    PacketFloat m = 	(u >= PacketFloat(-tolerance)) & (v >= PacketFloat(-tolerance)) &
+                        (u + v <= PacketFloat(1.0f + tolerance)) &
+                        (t > PacketFloat(kEpsilon)) & (t < PacketFloat::load(hits.t));
+
+    int lanes = m.mask() & packet.active;
+
+    for (int j = 0; j < kPacketSize; j++) {
+        if (!(lanes & (1 << j)))
+            continue;
+
+        const Ray& ray = packet.rays[j];
+
+        double a = v0.x - v1.x, b = v0.x - v2.x, c = ray.d.x, d = v0.x - ray.o.x;
+        double e = v0.y - v1.y, f = v0.y - v2.y, g = ray.d.y, h = v0.y - ray.o.y;
+        double i = v0.z - v1.z, k = v0.z - v2.z, l = ray.d.z, n = v0.z - ray.o.z;
+
+        double m1 = f * l - g * k, m2 = h * l - g * n, m3 = f * n - h * k;
+        double q = g * i - e * l, s = e * k - f * i;
+
+        double inv_denom 	= 1.0 / (a * m1 + b * q + c * s);
+        double beta 		= (d * m1 - b * m2 - c * m3) * inv_denom;
+
+        if (beta < 0.0)
+            continue;
+
+        double r 		= e * n - h * i;
+        double gamma 	= (a * m2 + d * q + c * r) * inv_denom;
+
+        if (gamma < 0.0 || beta + gamma > 1.0)
+            continue;
+
+        double t_hit = (a * m3 - b * r + d * s) * inv_denom;
+
+        if (t_hit > kEpsilon && t_hit < hits.t_hit[j])
+            hits.record(j, t_hit, normal, ray.o + t_hit * ray.d, material_ptr);
+    }
+}
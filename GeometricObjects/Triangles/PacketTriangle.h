@@ -0,0 +1,71 @@
+#ifndef __PACKET_TRIANGLE__
+#define __PACKET_TRIANGLE__
+
+// A Triangle that can also be hit by a RayPacket.
+// The vertices and normal are kept here as well, because Triangle's own are private.
+
+#include "Triangle.h"
+#include "GeometricObjects/PacketPrimitive.h"
+#include "Utilities/SceneArena.h"
+
+class PacketTriangle: public Triangle, public PacketPrimitive, public ArenaAllocated {
+    public:
+
+        PacketTriangle(void);
+
+        PacketTriangle(const Point3D& a, const Point3D& b, const Point3D& c);
+
+        PacketTriangle(const PacketTriangle& triangle);
+
+        virtual PacketTriangle*
+        clone(void) const;
+
+        PacketTriangle&
+        operator= (const PacketTriangle& rhs);
+
+        virtual
+        ~PacketTriangle(void);
+
+        Point3D
+        get_v0(void) const;
+
+        Point3D
+        get_v1(void) const;
+
+        Point3D
+        get_v2(void) const;
+
+        virtual void
+        hit_packet(const RayPacket& packet, PacketHit& hits) const;
+
+    private:
+
+        Point3D 	v0, v1, v2;
+        Normal 		normal;
+};
+
+
+// ---------------------------------------------------------------- get_v0
+
+inline Point3D
+PacketTriangle::get_v0(void) const {
+    return (v0);
+}
+
+
+// ---------------------------------------------------------------- get_v1
+
+inline Point3D
+PacketTriangle::get_v1(void) const {
+    return (v1);
+}
+
+
+// ---------------------------------------------------------------- get_v2
+
+inline Point3D
+PacketTriangle::get_v2(void) const {
+    return (v2);
+}
+
+#endif
@@ -0,0 +1,201 @@
+#include "SceneCatalogue.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "World/DeskLights.h"
+#include "World/SphereField.h"
+#include "World/Viewpoints.h"
+#include "World/World.h"
+#include "World/Worlds.h"
+
+// ---------------------------------------------------------------- to_choice
+
+static CHOICE
+to_choice(const std::string& argument) {
+    if (argument.size() == 1 && argument[0] >= 'A' && argument[0] <= 'E')
+        return ((CHOICE) (A + (argument[0] - 'A')));
+
+    throw new std::invalid_argument("Invalid choice: " + argument + "\n");
+}
+
+
+// ---------------------------------------------------------------- to_viewpoint
+
+static const char* viewpoint_names[] = { "OVERHEAD", "FRONT", "BACK", "LEFT", "LEFT_TOP", "RIGHT", "RIGHT_TOP", "UNDERNEATH" };
+static const int 	num_viewpoints 		= 8;
+
+static VIEWPOINT
+to_viewpoint(const std::string& argument) {
+    for (int j = 0; j < num_viewpoints; j++)
+        if (argument == viewpoint_names[j])
+            return ((VIEWPOINT) j);
+
+    throw new std::invalid_argument("Invalid viewpoint: " + argument + "\n");
+}
+
+
+// ---------------------------------------------------------------- to_number
+
+static double
+to_number(const std::string& argument) {
+    char* end = nullptr;
+    double value = strtod(argument.c_str(), &end);
+
+    if (argument.empty() || *end != '\0')
+        throw new std::invalid_argument("Invalid number: " + argument + "\n");
+
+    return (value);
+}
+
+
+// ---------------------------------------------------------------- to_numbers
+// comma separated list, e.g. the sundial's height,radius,latitude
+
+static std::vector<double>
+to_numbers(const std::string& argument, const unsigned int count) {
+    std::vector<double> values;
+    std::string::size_type start = 0;
+
+    while (start <= argument.size()) {
+        std::string::size_type comma = argument.find(',', start);
+        if (comma == std::string::npos)
+            comma = argument.size();
+        values.push_back(to_number(argument.substr(start, comma - start)));
+        start = comma + 1;
+    }
+
+    if (values.size() != count)
+        throw new std::invalid_argument("Expected " + std::to_string(count) + " numbers: " + argument + "\n");
+
+    return (values);
+}
+
+
+// ---------------------------------------------------------------- entries
+
+const std::vector<SceneEntry>&
+SceneCatalogue::entries(void) {
+    static const std::vector<SceneEntry> catalogue = {
+        { "build_sphere_world", "", "",
+            [](World* w, const std::string&) { build_sphere_world(w); } },
+        { "build_sphere_field_world", "number of spheres", "100000",
+            [](World* w, const std::string& a) {
+                build_sphere_world(w);
+                add_sphere_field(w, (int) to_number(a));
+            } },
+        { "build_city_world", "view distance", "1000",
+            [](World* w, const std::string& a) { build_city_world(w, to_number(a)); } },
+        { "build_practical_world", "view distance", "800",
+            [](World* w, const std::string& a) { build_practical_world(w, to_number(a)); } },
+        { "build_sphere_triangle_box_world", "CHOICE A-C", "A",
+            [](World* w, const std::string& a) { build_sphere_triangle_box_world(w, to_choice(a)); } },
+        { "build_olympic_rings_world", "", "",
+            [](World* w, const std::string&) { build_olympic_rings_world(w); } },
+        { "build_thinlens", "focal distance", "74",
+            [](World* w, const std::string& a) { build_thinlens(w, to_number(a)); } },
+        { "build_fisheye", "CHOICE A-E", "B",
+            [](World* w, const std::string& a) { build_fisheye(w, to_choice(a)); } },
+        { "build_stereo", "CHOICE A-B", "A",
+            [](World* w, const std::string& a) { build_stereo(w, to_choice(a)); } },
+        { "build_mcdonalds_world", "", "",
+            [](World* w, const std::string&) { build_mcdonalds_world(w); } },
+        { "build_mcdonalds_alberto", "", "",
+            [](World* w, const std::string&) { build_mcdonalds_alberto(w); } },
+        { "build_figure_10_10", "CHOICE A-C", "A",
+            [](World* w, const std::string& a) { build_figure_10_10(w, to_choice(a)); } },
+        { "build_figure_11_7", "CHOICE A-E", "A",
+            [](World* w, const std::string& a) { build_figure_11_7(w, to_choice(a)); } },
+        { "build_figure_12_12", "CHOICE A-B", "A",
+            [](World* w, const std::string& a) { build_figure_12_12(w, to_choice(a)); } },
+        { "build_sundial_world", "height,radius,latitude", "10,15,40",
+            [](World* w, const std::string& a) {
+                std::vector<double> v = to_numbers(a, 3);
+                build_sundial_world(w, v[0], v[1], v[2]);
+            } },
+        { "build_voyager_world", "view 0-3", "0",
+            [](World* w, const std::string& a) { build_voyager_world(w, (int) to_number(a)); } },
+        { "build_transparent_world", "", "",
+            [](World* w, const std::string&) { build_transparent_world(w); } },
+        { "build_working_desk_world", "VIEWPOINT name or angle in degrees", "OVERHEAD",
+            [](World* w, const std::string& a) {
+                if (!a.empty() && (isdigit(a[0]) || a[0] == '-' || a[0] == '.'))
+                    build_working_desk_world(w, to_number(a));
+                else
+                    build_working_desk_world(w, to_viewpoint(a));
+            } },
+        { "build_lit_desk_world", "number of lamps", "24",
+            [](World* w, const std::string& a) {
+                build_working_desk_world(w, OVERHEAD);
+                add_desk_lights(w, (int) to_number(a));
+            } }
+    };
+
+    return (catalogue);
+}
+
+
+// ---------------------------------------------------------------- find
+
+const SceneEntry*
+SceneCatalogue::find(const std::string& name) {
+    for (const SceneEntry& entry : entries())
+        if (name == entry.name)
+            return (&entry);
+
+    return (nullptr);
+}
+
+
+// ---------------------------------------------------------------- build
+
+void
+SceneCatalogue::build(World* w, const std::string& name, const std::string& argument) {
+    const SceneEntry* entry = find(name);
+    if (!entry)
+        throw new std::invalid_argument("Unknown scene: " + name + "\n");
+
+    entry->build(w, argument.empty() ? entry->default_argument : argument);
+}
+
+
+// ---------------------------------------------------------------- viewpoint_cameras
+
+std::vector<Camera*>
+SceneCatalogue::viewpoint_cameras(const std::string& name, std::vector<std::string>& viewpoints) {
+    std::vector<std::string> 	names;
+    std::vector<VIEWPOINT> 		choices;
+
+    for (const std::string& viewpoint : viewpoints) {
+        if (viewpoint == "all")
+            names.insert(names.end(), viewpoint_names, viewpoint_names + num_viewpoints);
+        else
+            names.push_back(viewpoint);
+    }
+
+    for (const std::string& viewpoint : names)
+        choices.push_back(to_viewpoint(viewpoint));
+
+    viewpoints = names;
+
+    if (name == "build_working_desk_world" || name == "build_lit_desk_world")
+        return (working_desk_viewpoints(choices));
+    else if (name == "build_transparent_world")
+        return (transparent_viewpoints(choices));
+
+    throw new std::invalid_argument("Scene has no viewpoints: " + name + "\n");
+}
+
+
+// ---------------------------------------------------------------- orbit_camera
+
+Camera*
+SceneCatalogue::orbit_camera(const std::string& name, const double azimuth) {
+    if (name == "build_working_desk_world" || name == "build_lit_desk_world")
+        return (working_desk_orbit(azimuth));
+    else if (name == "build_transparent_world")
+        return (transparent_orbit(azimuth));
+
+    throw new std::invalid_argument("Scene has no viewpoints: " + name + "\n");
+}
@@ -0,0 +1,44 @@
+#ifndef __SCENE_CATALOGUE__
+#define __SCENE_CATALOGUE__
+
+// Name-addressable list of the build_* functions in Worlds.cpp, for drivers that run
+// without the Qt shell (the headless renderer and the benchmarks).
+// Each entry takes the builder's own argument as text: a CHOICE letter (A, B, ...),
+// a VIEWPOINT name (OVERHEAD, FRONT, ...), a voyager view index or a number.
+// viewpoint_cameras gives the cameras of a scene's VIEWPOINTs, for rendering several views
+// of one built world; "all" asks for every viewpoint and is expanded into their names.
+// orbit_camera circles the same scenes, for turntables.
+
+#include <string>
+#include <vector>
+
+class Camera;
+class World;
+
+struct SceneEntry {
+    const char*	name;
+    const char*	argument;						// description of the argument, empty if none
+    const char*	default_argument;
+    void 		(*build)(World* w, const std::string& argument);
+};
+
+class SceneCatalogue {
+    public:
+
+        static const std::vector<SceneEntry>&
+        entries(void);
+
+        static const SceneEntry*
+        find(const std::string& name);
+
+        static void
+        build(World* w, const std::string& name, const std::string& argument);	// throws on unknown names or arguments
+
+        static std::vector<Camera*>
+        viewpoint_cameras(const std::string& name, std::vector<std::string>& viewpoints);	// caller owns the cameras
+
+        static Camera*
+        orbit_camera(const std::string& name, const double azimuth);		// degrees; caller owns the camera
+};
+
+#endif
@@ -0,0 +1,39 @@
+# Sources shared by the headless renderer and the benchmarks, for qmake.
+# This directory and its neighbours hold the renderer's own code. The ray tracer it builds on
+# (World, the cameras, lights, materials, BRDFs, samplers, textures and library objects, with
+# World_builder.h) comes from the full project checkout and is not part of this tree; set
+# LIBRARY_DIR to that checkout if it is not the directory above this one:
+#
+#	qmake LIBRARY_DIR=/path/to/checkout Headless/headless.pro
+#
+# Every .cpp of the library's directories is compiled, which takes in this tree's files in the
+# same directories. Of the files at the top of the checkout only Worlds.cpp and Transparent.cpp
+# are, so the Qt shell (its main and window classes) stays out and Qt is never linked.
+# Packets are 4 lanes wide with SSE 4.1 and 8 with AVX2; without either they fall back to
+# plain floats. SSE 4.1 is turned on for x86 targets only, so other architectures build the
+# plain-float packets; AVX2 is left to the user (QMAKE_CXXFLAGS+=-mavx2 on the qmake line).
+
+isEmpty(LIBRARY_DIR): LIBRARY_DIR = $$PWD/..
+
+LIBRARY_DIRS = 	BRDFs BTDFs Cameras GeometricObjects GeometricObjects/BeveledObjects \
+                GeometricObjects/CompoundObjects GeometricObjects/PartObjects \
+                GeometricObjects/Primitives GeometricObjects/Triangles Lights Mappings \
+                Materials Noises Samplers Textures Tracers Utilities World
+
+INCLUDEPATH += $$LIBRARY_DIR
+
+for(dir, LIBRARY_DIRS) {
+    INCLUDEPATH += $$LIBRARY_DIR/$$dir
+    SOURCES 	+= $$files($$LIBRARY_DIR/$$dir/*.cpp)
+}
+
+SOURCES += 	$$LIBRARY_DIR/Worlds.cpp \
+            $$LIBRARY_DIR/Transparent.cpp \
+            $$PWD/SceneCatalogue.cpp
+
+CONFIG 	+= console c++14 thread
+CONFIG 	-= app_bundle qt
+
+!msvc {
+    contains(QT_ARCH, i386)|contains(QT_ARCH, x86_64): QMAKE_CXXFLAGS += -msse4.1
+}
@@ -0,0 +1,8 @@
+# The headless batch renderer; see headless.pri for the sources it needs.
+
+TEMPLATE 	= app
+TARGET 		= headless
+
+include(headless.pri)
+
+SOURCES += $$PWD/main.cpp
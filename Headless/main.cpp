@@ -0,0 +1,455 @@
+// Headless batch renderer.
+// Builds one scene from Worlds.cpp by name, renders it with the TileRenderer and writes
+// the image to disk. Nothing here touches Qt, so it runs on display-less servers and many
+// copies can run side by side.
+// Headless/headless.pro builds it, and lists the sources it needs from the full checkout.
+// With -p the image is rendered progressively and rewritten after every pass, so a bad
+// framing shows up in the first preview; -v sets the per-tile variance at which a tile stops.
+// With -a the samples are spread adaptively, budget being the mean number of samples per pixel.
+// A scene whose name ends in .scene is read from that file with SceneReader instead; -e writes
+// the built scene out in that format and exits without rendering.
+// With -c the scene is loaded from a SceneCache file in that directory, named after the scene
+// and its argument; the first run builds the scene and writes the file.
+// With -V the scene is built once and rendered from each of the listed VIEWPOINTs (or all of
+// them) in one job; each view is written next to the output file, suffixed with its name.
+// With -T the built scene is rendered as a turntable of that many frames, the camera circling
+// it once; frame N is written, suffixed with its number, while frame N + 1 renders. The first
+// placement found in a BVH (the desk's pen) bobs up and down meanwhile, so that BVH is
+// refitted every frame.
+// With -A the scene is built into a SceneArena, so its placements, BVHs and packet primitives
+// are carved from a few large chunks instead of taking one heap block each.
+//
+//	usage: headless <scene|file.scene> [argument] [-o file.ppm|png|exr] [-t threads] [-s seed] [-p]
+//	                [-v variance] [-a budget] [-e file.scene] [-c cache directory]
+//	                [-V viewpoint,viewpoint,...|all] [-T frames] [-A]
+//	       headless --list
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Cameras/Camera.h"
+#include "GeometricObjects/CompoundObjects/BVH.h"
+#include "GeometricObjects/Placement.h"
+#include "Headless/SceneCatalogue.h"
+#include "Utilities/Constants.h"
+#include "Utilities/ImageWriter.h"
+#include "Utilities/SceneArena.h"
+#include "World/Animation.h"
+#include "World/SceneCache.h"
+#include "World/SceneReader.h"
+#include "World/SceneWriter.h"
+#include "World/TileRenderer.h"
+#include "World/World.h"
+
+// ---------------------------------------------------------------- print_usage
+
+static void
+print_usage(void) {
+    fprintf(stderr, "usage: headless <scene|file.scene> [argument] [-o file.ppm|png|exr] [-t threads] [-s seed] [-p]\n");
+    fprintf(stderr, "                [-v variance] [-a budget] [-e file.scene] [-c cache directory]\n");
+    fprintf(stderr, "                [-V viewpoint,viewpoint,...|all] [-T frames] [-A]\n");
+    fprintf(stderr, "       headless --list\n");
+}
+
+
+// ---------------------------------------------------------------- list_scenes
+
+static void
+list_scenes(void) {
+    for (const SceneEntry& entry : SceneCatalogue::entries()) {
+        if (entry.argument[0])
+            printf("%-34s <%s>, default %s\n", entry.name, entry.argument, entry.default_argument);
+        else
+            printf("%s\n", entry.name);
+    }
+}
+
+
+// ---------------------------------------------------------------- split
+// comma separated list
+
+static std::vector<std::string>
+split(const std::string& list) {
+    std::vector<std::string> words;
+    std::string::size_type start = 0;
+
+    while (start <= list.size()) {
+        std::string::size_type comma = list.find(',', start);
+        if (comma == std::string::npos)
+            comma = list.size();
+        words.push_back(list.substr(start, comma - start));
+        start = comma + 1;
+    }
+
+    return (words);
+}
+
+
+// ---------------------------------------------------------------- view_file
+// output name for one of several views: image.png -> image_FRONT.png
+
+static std::string
+view_file(const std::string& output, const std::string& view) {
+    std::string::size_type dot 		= output.rfind('.');
+    std::string::size_type slash 	= output.find_last_of("/\\");
+
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return (output + "_" + view);
+
+    return (output.substr(0, dot) + "_" + view + output.substr(dot));
+}
+
+
+// ---------------------------------------------------------------- render_views
+// renders the built world from every camera and writes one image per view
+
+static int
+render_views(World* w, const std::string& scene, std::vector<Camera*>& cameras,
+             const std::vector<std::string>& views, const std::string& output,
+             const int num_threads, const unsigned seed) {
+    TileRenderer renderer;
+    renderer.set_num_threads(num_threads);
+    renderer.set_seed(seed);
+
+    ImageWriter writer;
+    writer.set_gamma(w->vp.gamma);
+    writer.set_gamut_display(w->vp.show_out_of_gamut);
+
+    std::vector<const Camera*> 	view_cameras(cameras.begin(), cameras.end());
+    std::vector<Framebuffer> 	fbs;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    renderer.render_views(*w, view_cameras, fbs);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int status = 0;
+
+    for (int j = 0; j < (int) cameras.size(); j++) {
+        std::string file = view_file(output, views[j]);
+
+        if (fbs[j].pixels.empty()) {
+            fprintf(stderr, "%s: view %s cannot be rendered headless\n", scene.c_str(), views[j].c_str());
+            status = 1;
+        }
+        else if (!writer.write(fbs[j], file)) {
+            fprintf(stderr, "could not write %s\n", file.c_str());
+            status = 1;
+        }
+        else
+            printf("%s -> %s\n", views[j].c_str(), file.c_str());
+
+        delete cameras[j];
+    }
+
+    printf("%s: %d views of %dx%d on %d threads in %.3f s\n",
+           scene.c_str(), (int) cameras.size(), w->vp.hres, w->vp.vres, renderer.get_num_threads(), seconds);
+
+    return (status);
+}
+
+
+// ---------------------------------------------------------------- add_moving_part
+// makes a track of the first placement inside a BVH that is a world object, or that a world
+// object places, and adds that BVH for refitting; returns the placement, or null
+
+static Placement*
+add_moving_part(World* w, Animation& animation) {
+    for (GeometricObject* object_ptr : w->objects) {
+        Placement* 	placement_ptr 	= dynamic_cast<Placement*>(object_ptr);
+        BVH* 		bvh_ptr 		= dynamic_cast<BVH*>(placement_ptr ? placement_ptr->get_prototype().get() : object_ptr);
+
+        if (!bvh_ptr)
+            continue;
+
+        for (GeometricObject* child_ptr : bvh_ptr->get_objects()) {
+            Placement* part_ptr = dynamic_cast<Placement*>(child_ptr);
+
+            if (part_ptr) {
+                animation.add_track(part_ptr);
+                animation.add_hierarchy(bvh_ptr);
+                return (part_ptr);
+            }
+        }
+    }
+
+    return (NULL);
+}
+
+
+// ---------------------------------------------------------------- render_turntable
+// the camera goes once round the scene, and the moving part, if there is one, rises and
+// falls by half its height once; cameras are made on the animation's own thread
+
+static int
+render_turntable(World* w, const std::string& scene, const int num_frames, const std::string& output,
+                 const int num_threads, const unsigned seed) {
+    TileRenderer renderer;
+    renderer.set_num_threads(num_threads);
+    renderer.set_seed(seed);
+
+    ImageWriter writer;
+    writer.set_gamma(w->vp.gamma);
+    writer.set_gamut_display(w->vp.show_out_of_gamut);
+
+    Animation 	animation(w);
+    Placement* 	part_ptr 	= add_moving_part(w, animation);
+    double 		amplitude 	= 0.0;
+
+    if (part_ptr) {
+        BBox box 	= part_ptr->get_bounding_box();
+        amplitude 	= 0.5 * (box.z1 - box.z0);
+    }
+
+    FrameFunction describe = [&, amplitude](const int frame, AnimationFrame& state) {
+        double angle = 360.0 * frame / num_frames;
+
+        state.camera_ptr.reset(SceneCatalogue::orbit_camera(scene, angle));
+
+        if (!state.transforms.empty())
+            state.transforms[0].m[2][3] = amplitude * sin(angle * PI_ON_180);
+    };
+
+    FrameCallback done = [&](const Framebuffer& fb, const int frame) {
+        char number[16];
+        snprintf(number, sizeof(number), "%04d", frame);
+
+        std::string file = view_file(output, number);
+        if (!writer.write(fb, file)) {
+            fprintf(stderr, "could not write %s\n", file.c_str());
+            return (false);
+        }
+
+        return (true);
+    };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int rendered = animation.render(renderer, num_frames, describe, done);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%s: %d of %d frames of %dx%d on %d threads in %.3f s, %d rebuilds\n",
+           scene.c_str(), rendered, num_frames, w->vp.hres, w->vp.vres, renderer.get_num_threads(), seconds,
+           animation.get_num_rebuilds());
+
+    return (rendered == num_frames ? 0 : 1);
+}
+
+
+// ---------------------------------------------------------------- main
+
+int
+main(int argc, char* argv[]) {
+    std::string scene;
+    std::string argument;
+    std::string output;
+    int 		num_threads = 0;
+    unsigned 	seed = 0;
+    bool 		progressive = false;
+    float 		variance = 0.0f;
+    bool 		adaptive = false;
+    float 		budget = 0.0f;
+    std::string export_file;
+    std::string cache_directory;
+    std::string view_list;
+    int 		num_frames = 0;
+    bool 		use_arena = false;
+
+    for (int j = 1; j < argc; j++) {
+        std::string arg = argv[j];
+
+        if (arg == "--list") {
+            list_scenes();
+            return (0);
+        }
+        else if (arg == "-o" && j + 1 < argc)
+            output = argv[++j];
+        else if (arg == "-t" && j + 1 < argc)
+            num_threads = atoi(argv[++j]);
+        else if (arg == "-s" && j + 1 < argc)
+            seed = strtoul(argv[++j], nullptr, 10);
+        else if (arg == "-p")
+            progressive = true;
+        else if (arg == "-v" && j + 1 < argc)
+            variance = atof(argv[++j]);
+        else if (arg == "-a" && j + 1 < argc) {
+            adaptive = true;
+            budget = atof(argv[++j]);
+        }
+        else if (arg == "-e" && j + 1 < argc)
+            export_file = argv[++j];
+        else if (arg == "-c" && j + 1 < argc)
+            cache_directory = argv[++j];
+        else if (arg == "-V" && j + 1 < argc)
+            view_list = argv[++j];
+        else if (arg == "-T" && j + 1 < argc)
+            num_frames = atoi(argv[++j]);
+        else if (arg == "-A")
+            use_arena = true;
+        else if (scene.empty())
+            scene = arg;
+        else if (argument.empty())
+            argument = arg;
+        else {
+            print_usage();
+            return (1);
+        }
+    }
+
+    if (scene.empty()) {
+        print_usage();
+        return (1);
+    }
+
+    bool from_file = scene.size() > 6 && scene.compare(scene.size() - 6, 6, ".scene") == 0;
+
+    if (output.empty())
+        output = (from_file ? scene.substr(0, scene.size() - 6) : scene)
+               + (argument.empty() ? "" : "_" + argument) + ".ppm";
+
+    std::vector<std::string> 	views;
+    std::vector<Camera*> 		cameras;
+
+    if (!view_list.empty()) {
+        views = split(view_list);
+
+        try {
+            cameras = SceneCatalogue::viewpoint_cameras(scene, views);
+        }
+        catch (std::invalid_argument* e) {
+            fprintf(stderr, "%s", e->what());
+            delete e;
+            return (1);
+        }
+    }
+
+    if (num_frames > 0) {
+        try {
+            delete SceneCatalogue::orbit_camera(scene, 0.0);		// fails early for scenes without viewpoints
+        }
+        catch (std::invalid_argument* e) {
+            fprintf(stderr, "%s", e->what());
+            delete e;
+            return (1);
+        }
+    }
+
+    SceneArena 	arena(use_arena ? SceneArena::kDefaultChunkSize : 0);		// declared before w, so it outlives it
+    World* 		w = new World;
+
+    std::string cache_file;
+    std::string reason;
+    bool 		cached = false;
+
+    {
+        SceneArena::Scope scope(arena);
+
+        if (!cache_directory.empty()) {
+            std::string name = (from_file ? scene.substr(0, scene.size() - 6) : scene)
+                             + (argument.empty() ? "" : "_" + argument);
+            for (char& c : name)
+                if (c == '/' || c == '\\')
+                    c = '_';
+
+            cache_file 	= cache_directory + "/" + name + ".cache";
+            cached 		= SceneCache::load(w, cache_file, reason);
+        }
+
+        try {
+            if (from_file && !cached)
+                SceneReader(w).read(scene);
+            else if (!cached)
+                SceneCatalogue::build(w, scene, argument);
+        }
+        catch (std::invalid_argument* e) {
+            fprintf(stderr, "%s", e->what());
+            delete e;
+            delete w;
+            for (Camera* camera_ptr : cameras)
+                delete camera_ptr;
+            return (1);
+        }
+    }
+
+    if (!cache_file.empty() && !cached && !SceneCache::write(w, cache_file, reason))
+        fprintf(stderr, "%s: not cached, %s\n", scene.c_str(), reason.c_str());
+
+    if (num_frames > 0) {
+        int status = render_turntable(w, scene, num_frames, output, num_threads, seed);
+        delete w;
+        return (status);
+    }
+
+    if (!cameras.empty()) {
+        int status = render_views(w, scene, cameras, views, output, num_threads, seed);
+        delete w;
+        return (status);
+    }
+
+    if (!export_file.empty()) {
+        std::string reason;
+        bool exported = SceneWriter(w).write(export_file, reason);
+        delete w;
+
+        if (!exported) {
+            fprintf(stderr, "could not write %s: %s\n", export_file.c_str(), reason.c_str());
+            return (1);
+        }
+
+        printf("%s -> %s\n", scene.c_str(), export_file.c_str());
+        return (0);
+    }
+
+    TileRenderer renderer;
+    renderer.set_num_threads(num_threads);
+    renderer.set_seed(seed);
+    renderer.set_variance_threshold(variance);
+    renderer.set_sample_budget(budget);
+
+    ImageWriter writer;
+    writer.set_gamma(w->vp.gamma);
+    writer.set_gamut_display(w->vp.show_out_of_gamut);
+
+    Framebuffer fb;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    ProgressCallback publish = [&](const Framebuffer& image, const int pass, const int active_tiles) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fprintf(stderr, "pass %d: %d tiles still refining, %.3f s\n", pass + 1, active_tiles, elapsed);
+        return (writer.write(image, output));
+    };
+
+    bool rendered;
+
+    if (adaptive)
+        rendered = renderer.render_adaptive(*w, fb, progressive ? publish : ProgressCallback());
+    else if (progressive)
+        rendered = renderer.render_progressive(*w, fb, publish);
+    else
+        rendered = renderer.render(*w, fb);
+
+    if (!rendered) {
+        fprintf(stderr, "%s: the camera of this scene cannot be rendered headless\n", scene.c_str());
+        delete w;
+        return (1);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool written = writer.write(fb, output);
+    delete w;
+
+    if (!written) {
+        fprintf(stderr, "could not write %s\n", output.c_str());
+        return (1);
+    }
+
+    printf("%s: %dx%d on %d threads in %.3f s -> %s\n",
+           scene.c_str(), fb.hres, fb.vres, renderer.get_num_threads(), seconds, output.c_str());
+
+    return (0);
+}
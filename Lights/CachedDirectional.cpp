@@ -0,0 +1,100 @@
+#include "CachedDirectional.h"
+
+#include <atomic>
+
+#include "Utilities/Constants.h"
+#include "Utilities/RenderStats.h"
+#include "Utilities/ShadeRec.h"
+
+// per-thread cache slots; lights whose ids share a slot just evict each other
+static const int kCacheSlots = 8;
+
+struct CachedOccluder {
+    unsigned int 	light_id;
+    Occlusion 		occlusion;
+};
+
+static std::atomic<unsigned int> next_id(1);
+
+
+// ---------------------------------------------------------------- cache_slot
+
+static CachedOccluder&
+cache_slot(const unsigned int id) {
+    static thread_local CachedOccluder slots[kCacheSlots];
+
+    CachedOccluder& slot = slots[id % kCacheSlots];
+
+    if (slot.light_id != id) {
+        slot.light_id 	= id;
+        slot.occlusion 	= Occlusion();
+    }
+
+    return (slot);
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+CachedDirectional::CachedDirectional(void)
+    : 	Directional(),
+        OccluderList(),
+        id(next_id++)
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+// the copy gets its own cache
+
+CachedDirectional::CachedDirectional(const CachedDirectional& dl)
+    : 	Directional(dl),
+        OccluderList(dl),
+        id(next_id++)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+Light*
+CachedDirectional::clone(void) const {
+    return (new CachedDirectional(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+CachedDirectional&
+CachedDirectional::operator= (const CachedDirectional& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Directional::operator= (rhs);
+    OccluderList::operator= (rhs);
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+CachedDirectional::~CachedDirectional(void) {}
+
+
+// ---------------------------------------------------------------- in_shadow
+// a miss leaves the cached blocker in place: the ray may have slipped past its edge, and
+// the next one is likely to be blocked by it again
+
+bool
+CachedDirectional::in_shadow(const Ray& ray, const ShadeRec& sr) const {
+    Occlusion& last = cache_slot(id).occlusion;
+
+    RENDER_COUNT(RenderCounts& counts = RenderStats::local());
+    RENDER_COUNT(counts.shadow_rays++);
+
+    if (Occluder::retest(last, ray, kHugeValue)) {
+        RENDER_COUNT(counts.occluder_cache_hits++);
+        return (true);
+    }
+
+    return (occluded(sr.w, ray, kHugeValue, last));
+}
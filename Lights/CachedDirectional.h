@@ -0,0 +1,39 @@
+#ifndef __CACHED_DIRECTIONAL__
+#define __CACHED_DIRECTIONAL__
+
+// A Directional light whose shadow rays take the occlusion query (Occluder) instead of
+// shadow_hit: the first blocker ends the test, and no nearest hit is searched for.
+// Each thread remembers the last object that blocked this light and tries it before
+// anything else, since neighbouring shading points tend to be shadowed by the same part.
+// The world's occluders are resolved once per render (OccluderList).
+// The cache holds pointers into the world, so the light must not outlive its objects;
+// lights are deleted with their world, which keeps this true.
+
+#include "GeometricObjects/Occluder.h"
+#include "Lights/Directional.h"
+
+class CachedDirectional: public Directional, public OccluderList {
+    public:
+
+        CachedDirectional(void);
+
+        CachedDirectional(const CachedDirectional& dl);
+
+        virtual Light*
+        clone(void) const;
+
+        CachedDirectional&
+        operator= (const CachedDirectional& rhs);
+
+        virtual
+        ~CachedDirectional(void);
+
+        virtual bool
+        in_shadow(const Ray& ray, const ShadeRec& sr) const;
+
+    private:
+
+        unsigned int id;								// never reused, so a stale cache entry cannot match
+};
+
+#endif
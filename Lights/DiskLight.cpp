@@ -0,0 +1,266 @@
+#include "DiskLight.h"
+
+#include <atomic>
+#include <cmath>
+
+#include "Utilities/Constants.h"
+#include "Utilities/RandomStream.h"
+#include "Utilities/RenderStats.h"
+#include "Utilities/ShadeRec.h"
+
+// the batch evaluated for the hit being shaded on this thread
+struct DiskBatch {
+    unsigned int 	light_id;
+    bool 			lit;							// some point of the disk is visible
+    Vector3D 		wi;
+    RGBColor 		L;
+    Occlusion 		last;							// the last blocker, tried first
+};
+
+static std::atomic<unsigned int> next_id(1);
+
+
+// ---------------------------------------------------------------- local_batch
+
+static DiskBatch&
+local_batch(const unsigned int id) {
+    static thread_local DiskBatch batch;
+
+    if (batch.light_id != id) {
+        batch.light_id 	= id;
+        batch.lit 		= false;
+        batch.last 		= Occlusion();
+    }
+
+    return (batch);
+}
+
+
+// ---------------------------------------------------------------- concentric_disk
+// Shirley and Chiu's map from the unit square to the unit disk
+
+static void
+concentric_disk(const Point2D& sp, double& x, double& y) {
+    double a = 2.0 * sp.x - 1.0;
+    double b = 2.0 * sp.y - 1.0;
+    double r, phi;
+
+    if (a == 0.0 && b == 0.0) {
+        x = y = 0.0;
+        return;
+    }
+
+    if (a * a > b * b) {
+        r 	= a;
+        phi = (PI / 4.0) * (b / a);
+    }
+    else {
+        r 	= b;
+        phi = (PI / 2.0) - (PI / 4.0) * (a / b);
+    }
+
+    x = r * cos(phi);
+    y = r * sin(phi);
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+DiskLight::DiskLight(void)
+    : 	Light(),
+        OccluderList(),
+        color(1.0),
+        ls(1.0),
+        pattern(SamplePatternStore::get(MULTI_JITTERED_PATTERN, 16)),
+        id(next_id++)
+{
+    set_disk(Point3D(0.0), Normal(0, 0, -1), 1.0);
+}
+
+
+// ---------------------------------------------------------------- constructor
+
+DiskLight::DiskLight(const Point3D& center, const Normal& normal, const double radius)
+    : 	Light(),
+        OccluderList(),
+        color(1.0),
+        ls(1.0),
+        pattern(SamplePatternStore::get(MULTI_JITTERED_PATTERN, 16)),
+        id(next_id++)
+{
+    set_disk(center, normal, radius);
+}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+DiskLight::DiskLight(const DiskLight& dl)
+    : 	Light(dl),
+        OccluderList(dl),
+        center(dl.center),
+        normal(dl.normal),
+        radius(dl.radius),
+        u(dl.u),
+        v(dl.v),
+        color(dl.color),
+        ls(dl.ls),
+        pattern(dl.pattern),
+        id(next_id++)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+Light*
+DiskLight::clone(void) const {
+    return (new DiskLight(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+DiskLight&
+DiskLight::operator= (const DiskLight& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Light::operator= (rhs);
+    OccluderList::operator= (rhs);
+
+    center 	= rhs.center;
+    normal 	= rhs.normal;
+    radius 	= rhs.radius;
+    u 		= rhs.u;
+    v 		= rhs.v;
+    color 	= rhs.color;
+    ls 		= rhs.ls;
+    pattern = rhs.pattern;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+DiskLight::~DiskLight(void) {}
+
+
+// ---------------------------------------------------------------- set_disk
+
+void
+DiskLight::set_disk(const Point3D& c, const Normal& n, const double r) {
+    center 	= c;
+    normal 	= n;
+    normal.normalize();
+    radius 	= r;
+
+    Vector3D w(normal.x, normal.y, normal.z);
+    Vector3D up = std::fabs(w.x) < 0.9 ? Vector3D(1, 0, 0) : Vector3D(0, 1, 0);
+
+    u = up ^ w;
+    u.normalize();
+    v = w ^ u;
+}
+
+
+// ---------------------------------------------------------------- set_num_samples
+
+void
+DiskLight::set_num_samples(const int n) {
+    pattern = SamplePatternStore::get(MULTI_JITTERED_PATTERN, n < 1 ? 1 : n);
+}
+
+
+// ---------------------------------------------------------------- get_direction
+// evaluates the whole batch; L and in_shadow only report it
+
+Vector3D
+DiskLight::get_direction(ShadeRec& sr) {
+    DiskBatch& 		batch 		= local_batch(id);
+    int 			num_samples = pattern->get_num_samples();
+    double 			area 		= PI * radius * radius;
+    double 			sum 		= 0.0;
+    Vector3D 		direction(0.0);
+
+    SampleCursor cursor(pattern.get());
+    cursor.start(RandomStream::local());
+
+    for (int j = 0; j < num_samples; j++) {
+        double x, y;
+        concentric_disk(cursor.unit_square(j), x, y);
+
+        Point3D 	q 		= center + radius * (x * u + y * v);
+        Vector3D 	to_q 	= q - sr.hit_point;
+        double 		d 		= to_q.length();
+
+        if (d < kEpsilon)
+            continue;
+
+        Vector3D 	wi 			= to_q / d;
+        double 		cos_light 	= -(normal * wi);
+        double 		cos_surface = sr.normal * wi;
+
+        if (cos_light <= 0.0 || cos_surface <= 0.0)
+            continue;
+
+        if (shadows) {
+            Ray shadow_ray(sr.hit_point, wi);
+            RENDER_COUNT(RenderStats::local().shadow_rays++);
+
+            if (Occluder::retest(batch.last, shadow_ray, d) || occluded(sr.w, shadow_ray, d, batch.last))
+                continue;
+        }
+
+        double weight = cos_light * cos_surface / (d * d);
+        sum 		+= weight;
+        direction 	+= weight * wi;
+    }
+
+    batch.lit = sum > 0.0;
+
+    if (!batch.lit) {
+        batch.wi = Vector3D(sr.normal.x, sr.normal.y, sr.normal.z);
+        return (batch.wi);
+    }
+
+    direction.normalize();
+
+    batch.wi 	= direction;
+    batch.L 	= (float) (area * sum / (num_samples * (sr.normal * direction))) * ls * color;
+
+    return (batch.wi);
+}
+
+
+// ---------------------------------------------------------------- L
+
+RGBColor
+DiskLight::L(ShadeRec& sr) {
+    const DiskBatch& batch = local_batch(id);
+    return (batch.lit ? batch.L : black);
+}
+
+
+// ---------------------------------------------------------------- in_shadow
+// the batch has already been traced
+
+bool
+DiskLight::in_shadow(const Ray& ray, const ShadeRec& sr) const {
+    return (!local_batch(id).lit);
+}
+
+
+// ---------------------------------------------------------------- G
+
+float
+DiskLight::G(const ShadeRec& sr) const {
+    return (1.0);
+}
+
+
+// ---------------------------------------------------------------- pdf
+
+float
+DiskLight::pdf(const ShadeRec& sr) const {
+    return (1.0);
+}
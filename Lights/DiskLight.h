@@ -0,0 +1,154 @@
+#ifndef __DISK_LIGHT__
+#define __DISK_LIGHT__
+
+// A one-sided disk of uniform radiance, such as the opening of a lamp shade.
+// Unlike AreaLight, which draws one point of its object per call and leaves the averaging
+// to the pixel samples, a DiskLight takes a whole batch of points for each hit: one set of
+// a shared multi-jittered pattern, mapped concentrically onto the disk so the strata keep
+// their shape. get_direction traces the shadow rays of the batch (through the occlusion
+// query, trying the last blocker first), and then reports the mean direction to the visible
+// points and a radiance scaled so that f * L * (n . wi) is the batch's estimate of the
+// reflected light. That estimate is exact in expectation for diffuse materials; glossy
+// lobes see the batch through its mean direction.
+// G and pdf are 1, so the same numbers come out of shade and area_light_shade.
+// The cost per hit is num_samples shadow rays, set with set_num_samples; they walk the
+// world's occluders as resolved for the render (OccluderList).
+
+#include <memory>
+
+#include "GeometricObjects/Occluder.h"
+#include "Lights/Light.h"
+#include "Samplers/SamplePatternStore.h"
+#include "Utilities/Normal.h"
+#include "Utilities/Point3D.h"
+#include "Utilities/RGBColor.h"
+
+class DiskLight: public Light, public OccluderList {
+    public:
+
+        DiskLight(void);
+
+        DiskLight(const Point3D& center, const Normal& normal, const double radius);
+
+        DiskLight(const DiskLight& dl);
+
+        virtual Light*
+        clone(void) const;
+
+        DiskLight&
+        operator= (const DiskLight& rhs);
+
+        virtual
+        ~DiskLight(void);
+
+        void
+        set_disk(const Point3D& center, const Normal& normal, const double radius);	// normal is the lit side
+
+        Point3D
+        get_center(void) const;
+
+        Normal
+        get_normal(void) const;
+
+        double
+        get_radius(void) const;
+
+        void
+        set_color(const RGBColor& c);
+
+        RGBColor
+        get_radiance(void) const;						// ls * colour
+
+        void
+        scale_radiance(const float b);
+
+        void
+        set_num_samples(const int n);					// 16 by default
+
+        int
+        get_num_samples(void) const;
+
+        virtual Vector3D
+        get_direction(ShadeRec& sr);
+
+        virtual RGBColor
+        L(ShadeRec& sr);
+
+        virtual bool
+        in_shadow(const Ray& ray, const ShadeRec& sr) const;
+
+        virtual float
+        G(const ShadeRec& sr) const;
+
+        virtual float
+        pdf(const ShadeRec& sr) const;
+
+    private:
+
+        Point3D 							center;
+        Normal 								normal;
+        double 								radius;
+        Vector3D 							u, v;		// orthonormal axes in the plane of the disk
+        RGBColor 							color;
+        float 								ls;
+        std::shared_ptr<const SamplePattern> pattern;
+        unsigned int 						id;			// tells the thread's batch apart from another light's
+};
+
+
+// ---------------------------------------------------------------- get_center
+
+inline Point3D
+DiskLight::get_center(void) const {
+    return (center);
+}
+
+
+// ---------------------------------------------------------------- get_normal
+
+inline Normal
+DiskLight::get_normal(void) const {
+    return (normal);
+}
+
+
+// ---------------------------------------------------------------- get_radius
+
+inline double
+DiskLight::get_radius(void) const {
+    return (radius);
+}
+
+
+// ---------------------------------------------------------------- set_color
+
+inline void
+DiskLight::set_color(const RGBColor& c) {
+    color = c;
+}
+
+
+// ---------------------------------------------------------------- get_radiance
+
+inline RGBColor
+DiskLight::get_radiance(void) const {
+    return (ls * color);
+}
+
+
+// ---------------------------------------------------------------- scale_radiance
+
+inline void
+DiskLight::scale_radiance(const float b) {
+    ls = b;
+}
+
+
+// ---------------------------------------------------------------- get_num_samples
+
+inline int
+DiskLight::get_num_samples(void) const {
+    return (pattern->get_num_samples());
+}
+
+#endif
@@ -0,0 +1,304 @@
+#include "LightTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "Utilities/Constants.h"
+#include "Utilities/RandomStream.h"
+#include "Utilities/RenderStats.h"
+#include "Utilities/ShadeRec.h"
+
+// the emitter picked for the hit being shaded on this thread
+struct EmitterPick {
+    unsigned int 	tree_id;
+    int 			emitter;						// -1 when nothing can light the hit
+    float 			probability;
+    double 			distance;
+    Vector3D 		wi;								// unit vector towards the emitter
+};
+
+static std::atomic<unsigned int> next_id(1);
+
+
+// ---------------------------------------------------------------- local_pick
+
+static EmitterPick&
+local_pick(void) {
+    static thread_local EmitterPick pick = { 0, -1, 0.0f, 0.0, Vector3D(0, 0, 1) };
+    return (pick);
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+LightTree::LightTree(void)
+    : 	Light(),
+        OccluderList(),
+        emitters(),
+        nodes(),
+        id(next_id++)
+{}
+
+
+// ---------------------------------------------------------------- copy constructor
+
+LightTree::LightTree(const LightTree& lt)
+    : 	Light(lt),
+        OccluderList(lt),
+        emitters(lt.emitters),
+        nodes(lt.nodes),
+        id(next_id++)
+{}
+
+
+// ---------------------------------------------------------------- clone
+
+Light*
+LightTree::clone(void) const {
+    return (new LightTree(*this));
+}
+
+
+// ---------------------------------------------------------------- assignment operator
+
+LightTree&
+LightTree::operator= (const LightTree& rhs) {
+    if (this == &rhs)
+        return (*this);
+
+    Light::operator= (rhs);
+    OccluderList::operator= (rhs);
+
+    emitters 	= rhs.emitters;
+    nodes 		= rhs.nodes;
+
+    return (*this);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+LightTree::~LightTree(void) {}
+
+
+// ---------------------------------------------------------------- add_emitter
+
+void
+LightTree::add_emitter(const Point3D& position, const RGBColor& color, const float radiance) {
+    add_emitter(position, Vector3D(0), color, radiance);
+}
+
+
+// ---------------------------------------------------------------- add_emitter
+
+void
+LightTree::add_emitter(const Point3D& position, const Vector3D& facing, const RGBColor& color, const float radiance) {
+    Emitter emitter;
+    emitter.position 	= position;
+    emitter.facing 		= facing;
+    emitter.power 		= radiance * color;
+
+    if (facing.x != 0.0 || facing.y != 0.0 || facing.z != 0.0)
+        emitter.facing.normalize();
+
+    emitters.push_back(emitter);
+}
+
+
+// ---------------------------------------------------------------- build
+
+void
+LightTree::build(void) {
+    nodes.clear();
+
+    if (!emitters.empty()) {
+        nodes.reserve(2 * emitters.size());
+        build_node(0, emitters.size());
+    }
+}
+
+
+// ---------------------------------------------------------------- build_node
+// emitters[first, first + count) become the node; returns its index
+
+int
+LightTree::build_node(const int first, const int count) {
+    int node_index = nodes.size();
+    nodes.push_back(Node());
+
+    Node node;
+    node.x0 = node.y0 = node.z0 = kHugeValue;
+    node.x1 = node.y1 = node.z1 = -kHugeValue;
+    node.power = 0.0f;
+
+    for (int j = first; j < first + count; j++) {
+        const Point3D& p = emitters[j].position;
+
+        node.x0 = std::min(node.x0, p.x); node.x1 = std::max(node.x1, p.x);
+        node.y0 = std::min(node.y0, p.y); node.y1 = std::max(node.y1, p.y);
+        node.z0 = std::min(node.z0, p.z); node.z1 = std::max(node.z1, p.z);
+        node.power += emitters[j].power.average();
+    }
+
+    if (count == 1) {
+        node.offset 		= first;
+        node.count 			= 1;
+        nodes[node_index] 	= node;
+        return (node_index);
+    }
+
+    double extent[3] = { node.x1 - node.x0, node.y1 - node.y0, node.z1 - node.z0 };
+    int axis = 0;
+    if (extent[1] > extent[axis]) axis = 1;
+    if (extent[2] > extent[axis]) axis = 2;
+
+    int mid = first + count / 2;
+
+    std::nth_element(	emitters.begin() + first, emitters.begin() + mid, emitters.begin() + first + count,
+                        [axis](const Emitter& a, const Emitter& b) {
+        return ((axis == 0) ? a.position.x < b.position.x
+              : (axis == 1) ? a.position.y < b.position.y : a.position.z < b.position.z);
+    });
+
+    build_node(first, mid - first);											// first child follows its parent
+    node.offset 		= build_node(mid, first + count - mid);
+    node.count 			= 0;
+    nodes[node_index] 	= node;
+
+    return (node_index);
+}
+
+
+// ---------------------------------------------------------------- importance
+// n faces the side the hit is seen from; a cluster entirely behind the tangent plane
+// cannot light the hit
+
+float
+LightTree::importance(const Node& node, const Point3D& p, const Vector3D& n) const {
+    bool in_front = false;
+
+    for (int j = 0; j < 8 && !in_front; j++) {
+        double dx = (j & 1 ? node.x1 : node.x0) - p.x;
+        double dy = (j & 2 ? node.y1 : node.y0) - p.y;
+        double dz = (j & 4 ? node.z1 : node.z0) - p.z;
+        in_front = n.x * dx + n.y * dy + n.z * dz > 0.0;
+    }
+
+    if (!in_front)
+        return (0.0f);
+
+    double cx = 0.5 * (node.x0 + node.x1) - p.x;
+    double cy = 0.5 * (node.y0 + node.y1) - p.y;
+    double cz = 0.5 * (node.z0 + node.z1) - p.z;
+    double hx = 0.5 * (node.x1 - node.x0);
+    double hy = 0.5 * (node.y1 - node.y0);
+    double hz = 0.5 * (node.z1 - node.z0);
+
+    double d_squared = cx * cx + cy * cy + cz * cz;
+    double r_squared = std::max(hx * hx + hy * hy + hz * hz, kEpsilon);
+
+    return (node.power / std::max(d_squared, r_squared));
+}
+
+
+// ---------------------------------------------------------------- get_direction
+// picks the emitter for this hit; when nothing can light it, the direction is the normal
+// and L is black
+
+Vector3D
+LightTree::get_direction(ShadeRec& sr) {
+    EmitterPick& pick = local_pick();
+
+    Vector3D n(sr.normal.x, sr.normal.y, sr.normal.z);
+    if (n * sr.ray.d > 0.0)
+        n = -n;
+
+    pick.tree_id 		= id;
+    pick.emitter 		= -1;
+    pick.probability 	= 1.0f;
+    pick.wi 			= n;
+
+    if (nodes.empty())
+        return (pick.wi);
+
+    RandomStream& rng 	= RandomStream::local();
+    int node_index 		= 0;
+
+    if (importance(nodes[0], sr.hit_point, n) <= 0.0f)
+        return (pick.wi);
+
+    while (nodes[node_index].count == 0) {
+        int 	left 		= node_index + 1;
+        int 	right 		= nodes[node_index].offset;
+        float 	w_left 		= importance(nodes[left], sr.hit_point, n);
+        float 	w_right 	= importance(nodes[right], sr.hit_point, n);
+        float 	w_total 	= w_left + w_right;
+
+        if (w_total <= 0.0f)
+            return (pick.wi);
+
+        if (rng.next_float() * w_total < w_left) {
+            pick.probability *= w_left / w_total;
+            node_index = left;
+        }
+        else {
+            pick.probability *= w_right / w_total;
+            node_index = right;
+        }
+    }
+
+    pick.emitter = nodes[node_index].offset;
+
+    Vector3D to_emitter = emitters[pick.emitter].position - sr.hit_point;
+    pick.distance 		= to_emitter.length();
+
+    if (pick.distance < kEpsilon) {
+        pick.emitter = -1;
+        return (pick.wi);
+    }
+
+    pick.wi = to_emitter / pick.distance;
+
+    return (pick.wi);
+}
+
+
+// ---------------------------------------------------------------- L
+
+RGBColor
+LightTree::L(ShadeRec& sr) {
+    const EmitterPick& pick = local_pick();
+
+    if (pick.tree_id != id || pick.emitter < 0)
+        return (black);
+
+    const Emitter& emitter = emitters[pick.emitter];
+    float scale = 1.0f / (pick.probability * pick.distance * pick.distance);
+
+    if (emitter.facing.x != 0.0 || emitter.facing.y != 0.0 || emitter.facing.z != 0.0) {
+        double cos_theta = -(emitter.facing * pick.wi);
+        if (cos_theta <= 0.0)
+            return (black);
+        scale *= cos_theta;
+    }
+
+    return (scale * emitter.power);
+}
+
+
+// ---------------------------------------------------------------- in_shadow
+
+bool
+LightTree::in_shadow(const Ray& ray, const ShadeRec& sr) const {
+    const EmitterPick& pick = local_pick();
+
+    if (pick.tree_id != id || pick.emitter < 0)
+        return (true);
+
+    RENDER_COUNT(RenderStats::local().shadow_rays++);
+
+    Occlusion occlusion;
+
+    return (occluded(sr.w, ray, pick.distance, occlusion));
+}
@@ -0,0 +1,99 @@
+#ifndef __LIGHT_TREE__
+#define __LIGHT_TREE__
+
+// One Light standing for many small emitters (desk lamps, the cells of a glowing screen),
+// so that a scene can have dozens of them and still evaluate a single light per hit.
+// The emitters are kept in a binary tree of clusters, built top-down by splitting each
+// cluster at the median of its longest axis. get_direction picks one emitter by descending
+// the tree, taking each child with a probability proportional to its importance at the hit
+// point: the cluster's power over the squared distance to its centre (never less than its
+// own radius squared), or zero when the whole cluster lies behind the surface. L divides the
+// emitter's radiance by the probability of having picked it, so the estimate is unbiased and
+// its noise depends only on how well importance predicts the contribution.
+// The pick draws from RandomStream::local(), so it is repeatable per pixel, and is held per
+// thread between get_direction, in_shadow and L, which the materials call in that order.
+// Emitters fall off with the square of distance, unlike PointLight, and either shine in
+// every direction or only to the side their facing vector points to.
+// Shadow rays take the occlusion query (Occluder) up to the picked emitter, through the
+// world's occluders as resolved for the render (OccluderList).
+
+#include <vector>
+
+#include "GeometricObjects/Occluder.h"
+#include "Lights/Light.h"
+#include "Utilities/Point3D.h"
+#include "Utilities/RGBColor.h"
+#include "Utilities/Vector3D.h"
+
+class LightTree: public Light, public OccluderList {
+    public:
+
+        LightTree(void);
+
+        LightTree(const LightTree& lt);
+
+        virtual Light*
+        clone(void) const;
+
+        LightTree&
+        operator= (const LightTree& rhs);
+
+        virtual
+        ~LightTree(void);
+
+        void
+        add_emitter(const Point3D& position, const RGBColor& color, const float radiance);
+
+        void
+        add_emitter(const Point3D& position, const Vector3D& facing, const RGBColor& color, const float radiance);
+
+        void
+        build(void);									// after the last add_emitter
+
+        int
+        get_num_emitters(void) const;
+
+        virtual Vector3D
+        get_direction(ShadeRec& sr);
+
+        virtual RGBColor
+        L(ShadeRec& sr);
+
+        virtual bool
+        in_shadow(const Ray& ray, const ShadeRec& sr) const;
+
+    private:
+
+        struct Emitter {
+            Point3D 	position;
+            Vector3D 	facing;							// unit vector, or zero for every direction
+            RGBColor 	power;							// colour times radiance
+        };
+
+        struct Node {
+            double 	x0, x1, y0, y1, z0, z1;				// bounds of the emitter positions
+            float 	power;								// summed average power of the emitters
+            int 	offset;								// leaf: emitter index; interior: index of the second child
+            int 	count;								// 1 for a leaf, 0 for interior nodes
+        };
+
+        std::vector<Emitter> 	emitters;
+        std::vector<Node> 		nodes;
+        unsigned int 			id;						// tells the thread's pick apart from another tree's
+
+        int
+        build_node(const int first, const int count);
+
+        float
+        importance(const Node& node, const Point3D& p, const Vector3D& n) const;
+};
+
+
+// ---------------------------------------------------------------- get_num_emitters
+
+inline int
+LightTree::get_num_emitters(void) const {
+    return (emitters.size());
+}
+
+#endif
@@ -0,0 +1,223 @@
+#include "MaterialRegistry.h"
+
+#include <tuple>
+
+#include "GeometricObjects/Primitives/Sphere.h"
+#include "Materials/Matte.h"
+#include "Materials/Phong.h"
+#include "World_builder.h"
+
+// kinds of material that are not a MATERIAL_CHOICE
+static const int kWorldDefault 	= MaterialKey::WORLD_DEFAULT;		// World::set_material(obj, color)
+static const int kPhong 		= MaterialKey::PHONG_PARAMETERS;	// get_phong
+static const int kMatte 		= MaterialKey::MATTE_PARAMETERS;	// get_matte
+static const int kChecker 		= MaterialKey::CHECKER_PARAMETERS;	// get_checker
+
+
+// ---------------------------------------------------------------- make_key
+
+static MaterialKey
+make_key(const int choice, const RGBColor& color,
+         const float ka = 0.0, const float kd = 0.0, const float ks = 0.0, const float exp = 0.0) {
+    MaterialKey key;
+
+    key.choice 	= choice;
+    key.r 		= color.r;
+    key.g 		= color.g;
+    key.b 		= color.b;
+    key.ka 		= ka;
+    key.kd 		= kd;
+    key.ks 		= ks;
+    key.exp 	= exp;
+
+    return (key);
+}
+
+
+// ---------------------------------------------------------------- operator<
+
+bool
+MaterialKey::operator< (const MaterialKey& rhs) const {
+    return (std::tie(choice, r, g, b, ka, kd, ks, exp)
+          < std::tie(rhs.choice, rhs.r, rhs.g, rhs.b, rhs.ka, rhs.kd, rhs.ks, rhs.exp));
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+MaterialRegistry::MaterialRegistry(void)
+    : 	materials(),
+        mutex()
+{}
+
+
+// ---------------------------------------------------------------- find
+
+std::shared_ptr<Material>
+MaterialRegistry::find(const MaterialKey& key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::map<MaterialKey, std::shared_ptr<Material> >::const_iterator it = materials.find(key);
+    return (it == materials.end() ? std::shared_ptr<Material>() : it->second);
+}
+
+
+// ---------------------------------------------------------------- insert
+// keeps the first material stored under key if another thread got there first
+
+std::shared_ptr<Material>
+MaterialRegistry::insert(const MaterialKey& key, const std::shared_ptr<Material>& material_ptr) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (materials.insert(std::make_pair(key, material_ptr)).first->second);
+}
+
+
+// ---------------------------------------------------------------- get
+
+std::shared_ptr<Material>
+MaterialRegistry::get(World* w, const RGBColor& color) {
+    MaterialKey key = make_key(kWorldDefault, color);
+    std::shared_ptr<Material> material_ptr = find(key);
+
+    if (!material_ptr) {
+        Sphere probe;
+        w->set_material(&probe, color);
+        material_ptr = insert(key, probe.get_material());
+    }
+
+    return (material_ptr);
+}
+
+
+// ---------------------------------------------------------------- get
+
+std::shared_ptr<Material>
+MaterialRegistry::get(World* w, const MATERIAL_CHOICE choice, const RGBColor& color) {
+    MaterialKey key = make_key(choice, color);
+    std::shared_ptr<Material> material_ptr = find(key);
+
+    if (!material_ptr) {
+        Sphere probe;
+        w->set_material(&probe, choice, color);
+        material_ptr = insert(key, probe.get_material());
+    }
+
+    return (material_ptr);
+}
+
+
+// ---------------------------------------------------------------- get_phong
+
+std::shared_ptr<Material>
+MaterialRegistry::get_phong(const RGBColor& color, const float ka, const float kd, const float ks, const float exp) {
+    MaterialKey key = make_key(kPhong, color, ka, kd, ks, exp);
+    std::shared_ptr<Material> material_ptr = find(key);
+
+    if (!material_ptr) {
+        std::shared_ptr<Phong> phong = std::make_shared<Phong>();
+        phong->set_cd(color);
+        phong->set_ka(ka);
+        phong->set_kd(kd);
+        phong->set_ks(ks);
+        phong->set_exp(exp);
+        material_ptr = insert(key, phong);
+    }
+
+    return (material_ptr);
+}
+
+
+// ---------------------------------------------------------------- get_matte
+
+std::shared_ptr<Material>
+MaterialRegistry::get_matte(const RGBColor& color, const float ka, const float kd) {
+    MaterialKey key = make_key(kMatte, color, ka, kd);
+    std::shared_ptr<Material> material_ptr = find(key);
+
+    if (!material_ptr) {
+        std::shared_ptr<Matte> matte = std::make_shared<Matte>();
+        matte->set_cd(color);
+        matte->set_ka(ka);
+        matte->set_kd(kd);
+        material_ptr = insert(key, matte);
+    }
+
+    return (material_ptr);
+}
+
+
+// ---------------------------------------------------------------- get_checker
+
+std::shared_ptr<Material>
+MaterialRegistry::get_checker(const RGBColor& color1, const RGBColor& color2, const float size) {
+    MaterialKey key = make_key(kChecker, color1, color2.r, color2.g, color2.b, size);
+    std::shared_ptr<Material> material_ptr = find(key);
+
+    if (!material_ptr) {
+        Sphere probe;
+        build_checkerboard(&probe, color1, color2, size);
+        material_ptr = insert(key, probe.get_material());
+    }
+
+    return (material_ptr);
+}
+
+
+// ---------------------------------------------------------------- set_material
+
+void
+MaterialRegistry::set_material(World* w, GeometricObject* object_ptr, const RGBColor& color) {
+    object_ptr->set_material(get(w, color));
+}
+
+
+// ---------------------------------------------------------------- set_material
+
+void
+MaterialRegistry::set_material(World* w, GeometricObject* object_ptr, const MATERIAL_CHOICE choice, const RGBColor& color) {
+    object_ptr->set_material(get(w, choice, color));
+}
+
+
+// ---------------------------------------------------------------- find_key
+// linear in the number of materials; meant for writing scenes out, not for rendering
+
+bool
+MaterialRegistry::find_key(const Material* material_ptr, MaterialKey& key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto& entry : materials)
+        if (entry.second.get() == material_ptr) {
+            key = entry.first;
+            return (true);
+        }
+
+    return (false);
+}
+
+
+// ---------------------------------------------------------------- get_num_materials
+
+int
+MaterialRegistry::get_num_materials(void) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (materials.size());
+}
+
+
+// ---------------------------------------------------------------- clear
+
+void
+MaterialRegistry::clear(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    materials.clear();
+}
+
+
+// ---------------------------------------------------------------- shared
+
+MaterialRegistry&
+MaterialRegistry::shared(void) {
+    static MaterialRegistry registry;
+    return (registry);
+}
@@ -0,0 +1,88 @@
+#ifndef __MATERIAL_REGISTRY__
+#define __MATERIAL_REGISTRY__
+
+// Interns materials so that every object asking for the same (MATERIAL_CHOICE, colour,
+// parameters) shares one Material.
+// Materials coming from World::set_material are created once through that function, on a
+// probe object, so they are exactly what World::set_material would have built; checkers are
+// made the same way through build_checkerboard.
+// A material handed out by the registry is shared: set it on objects, never modify it.
+// shared() is the registry the scene builders and the scene reader intern into; find_key
+// recovers what a material was made from, for the scene writer and the scene cache.
+// shared() holds the materials of the last World built: the top-level builders in Worlds.cpp,
+// SceneReader::parse and SceneCache::load clear it before they make any, so that a World
+// never picks up a material an earlier World's probe made. Objects keep their materials
+// alive through a clear.
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "Utilities/RGBColor.h"
+#include "World/World.h"
+
+class GeometricObject;
+class Material;
+
+struct MaterialKey {
+    enum { WORLD_DEFAULT = -1, PHONG_PARAMETERS = -2, MATTE_PARAMETERS = -3, CHECKER_PARAMETERS = -4 };	// the registry's own kinds
+
+    int 	choice;						// a MATERIAL_CHOICE, or one of the registry's own kinds
+    float 	r, g, b;					// the first colour of a checker
+    float 	ka, kd, ks, exp;			// a checker's second colour and its size
+
+    bool
+    operator< (const MaterialKey& rhs) const;
+};
+
+class MaterialRegistry {
+    public:
+
+        MaterialRegistry(void);
+
+        std::shared_ptr<Material>
+        get(World* w, const RGBColor& color);								// as World::set_material(obj, color)
+
+        std::shared_ptr<Material>
+        get(World* w, const MATERIAL_CHOICE choice, const RGBColor& color);	// as World::set_material(obj, choice, color)
+
+        std::shared_ptr<Material>
+        get_phong(const RGBColor& color, const float ka, const float kd, const float ks, const float exp);
+
+        std::shared_ptr<Material>
+        get_matte(const RGBColor& color, const float ka, const float kd);
+
+        std::shared_ptr<Material>
+        get_checker(const RGBColor& color1, const RGBColor& color2, const float size);	// as build_checkerboard
+
+        void
+        set_material(World* w, GeometricObject* object_ptr, const RGBColor& color);
+
+        void
+        set_material(World* w, GeometricObject* object_ptr, const MATERIAL_CHOICE choice, const RGBColor& color);
+
+        bool
+        find_key(const Material* material_ptr, MaterialKey& key) const;
+
+        int
+        get_num_materials(void) const;
+
+        void
+        clear(void);
+
+        static MaterialRegistry&
+        shared(void);
+
+    private:
+
+        std::map<MaterialKey, std::shared_ptr<Material> > 	materials;
+        mutable std::mutex 									mutex;
+
+        std::shared_ptr<Material>
+        find(const MaterialKey& key) const;
+
+        std::shared_ptr<Material>
+        insert(const MaterialKey& key, const std::shared_ptr<Material>& material_ptr);
+};
+
+#endif
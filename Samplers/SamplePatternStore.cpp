@@ -0,0 +1,248 @@
+#include "SamplePatternStore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include "Samplers/Jittered.h"
+#include "Samplers/MultiJittered.h"
+#include "Samplers/Regular.h"
+#include "Utilities/RandomStream.h"
+
+// ---------------------------------------------------------------- random_int
+// in [low, high]
+
+static inline int
+random_int(RandomStream& rng, const int low, const int high) {
+    return (low + (int) (rng.next_uint() % (uint32_t) (high - low + 1)));
+}
+
+
+// ---------------------------------------------------------------- constructor
+// the patterns are seeded by their key, so a pattern is the same in every run
+
+SamplePattern::SamplePattern(const SamplePatternType pattern_type, const int ns, const int sets)
+    : 	type(pattern_type),
+        num_samples(std::max(1, ns)),
+        num_sets(std::max(1, sets)),
+        x(num_samples * num_sets),
+        y(num_samples * num_sets),
+        shuffled_indices()
+{
+    RandomStream rng(num_samples, (uint64_t) type * 1000003u + num_sets);
+
+    switch (type) {
+        case REGULAR_PATTERN:
+            generate_regular();
+            break;
+
+        case JITTERED_PATTERN:
+            generate_jittered(rng);
+            break;
+
+        case MULTI_JITTERED_PATTERN:
+            generate_multi_jittered(rng);
+            break;
+    }
+
+    setup_shuffled_indices(rng);
+}
+
+
+// ---------------------------------------------------------------- generate_regular
+// the centres of an n x n grid; as Regular, the sample count should be a square
+
+void
+SamplePattern::generate_regular(void) {
+    int n = (int) sqrt((float) num_samples);
+
+    for (int p = 0; p < num_sets; p++)
+        for (int j = 0; j < num_samples; j++) {
+            x[p * num_samples + j] = (j % n + 0.5f) / n;
+            y[p * num_samples + j] = (j / n % n + 0.5f) / n;
+        }
+}
+
+
+// ---------------------------------------------------------------- generate_jittered
+// one random point in every cell of an n x n grid; the samples beyond n * n, when the count
+// is not a square, are uniform
+
+void
+SamplePattern::generate_jittered(RandomStream& rng) {
+    int n = (int) sqrt((float) num_samples);
+
+    for (int p = 0; p < num_sets; p++)
+        for (int j = 0; j < num_samples; j++) {
+            int index = p * num_samples + j;
+
+            if (j < n * n) {
+                x[index] = (j % n + rng.next_float()) / n;
+                y[index] = (j / n + rng.next_float()) / n;
+            }
+            else {
+                x[index] = rng.next_float();
+                y[index] = rng.next_float();
+            }
+        }
+}
+
+
+// ---------------------------------------------------------------- generate_multi_jittered
+// Chiu, Shirley and Wang's multi-jittered points, as in MultiJittered::generate_samples:
+// the canonical arrangement, then x shuffled within columns and y within rows
+// a count that is not a square gets n-rooks points, stratified in x and in y
+
+void
+SamplePattern::generate_multi_jittered(RandomStream& rng) {
+    int n 				= (int) sqrt((float) num_samples);
+    float subcell_width = 1.0f / num_samples;
+
+    if (n * n != num_samples) {
+        for (int p = 0; p < num_sets; p++) {
+            float* px = &x[p * num_samples];
+            float* py = &y[p * num_samples];
+
+            for (int j = 0; j < num_samples; j++) {
+                px[j] = (j + rng.next_float()) * subcell_width;
+                py[j] = (j + rng.next_float()) * subcell_width;
+            }
+
+            for (int j = num_samples - 1; j > 0; j--)
+                std::swap(px[j], px[random_int(rng, 0, j)]);
+        }
+
+        return;
+    }
+
+    for (int p = 0; p < num_sets; p++) {
+        float* px = &x[p * num_samples];
+        float* py = &y[p * num_samples];
+
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++) {
+                px[i * n + j] = (i * n + j + rng.next_float()) * subcell_width;
+                py[i * n + j] = (j * n + i + rng.next_float()) * subcell_width;
+            }
+
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                std::swap(px[i * n + j], px[i * n + random_int(rng, j, n - 1)]);
+
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                std::swap(py[j * n + i], py[random_int(rng, j, n - 1) * n + i]);
+    }
+}
+
+
+// ---------------------------------------------------------------- setup_shuffled_indices
+// a random permutation of [0, num_samples) per set, as in Sampler::setup_shuffled_indices
+
+void
+SamplePattern::setup_shuffled_indices(RandomStream& rng) {
+    shuffled_indices.resize(num_samples * num_sets);
+
+    for (int p = 0; p < num_sets; p++) {
+        int* indices = &shuffled_indices[p * num_samples];
+
+        for (int j = 0; j < num_samples; j++)
+            indices[j] = j;
+
+        for (int j = num_samples - 1; j > 0; j--)
+            std::swap(indices[j], indices[random_int(rng, 0, j)]);
+    }
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+SampleCursor::SampleCursor(void)
+    : 	pattern_ptr(NULL),
+        set(0)
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+SampleCursor::SampleCursor(const SamplePattern* pattern)
+    : 	pattern_ptr(pattern),
+        set(0)
+{}
+
+
+// ---------------------------------------------------------------- start
+// draws nothing from rng when there is no pattern
+
+void
+SampleCursor::start(RandomStream& rng) {
+    if (pattern_ptr)
+        set = rng.next_uint() % (uint32_t) pattern_ptr->get_num_sets();
+}
+
+
+// ---------------------------------------------------------------- the store
+
+typedef std::tuple<int, int, int> PatternKey;
+
+static std::mutex 											store_mutex;
+static std::map<PatternKey, std::shared_ptr<const SamplePattern>> 	store;
+
+
+// ---------------------------------------------------------------- get
+// the pattern is built outside the lock; if two threads race, the first one stored wins
+
+std::shared_ptr<const SamplePattern>
+SamplePatternStore::get(const SamplePatternType type, const int num_samples, const int num_sets) {
+    PatternKey key(type, num_samples, num_sets);
+
+    {
+        std::lock_guard<std::mutex> lock(store_mutex);
+        auto found = store.find(key);
+        if (found != store.end())
+            return (found->second);
+    }
+
+    std::shared_ptr<const SamplePattern> pattern = std::make_shared<SamplePattern>(type, num_samples, num_sets);
+
+    std::lock_guard<std::mutex> lock(store_mutex);
+    return (store.insert(std::make_pair(key, pattern)).first->second);
+}
+
+
+// ---------------------------------------------------------------- get
+
+std::shared_ptr<const SamplePattern>
+SamplePatternStore::get(const Sampler* sampler_ptr, const int num_samples) {
+    if (dynamic_cast<const MultiJittered*>(sampler_ptr))
+        return (get(MULTI_JITTERED_PATTERN, num_samples));
+
+    if (dynamic_cast<const Jittered*>(sampler_ptr))
+        return (get(JITTERED_PATTERN, num_samples));
+
+    if (dynamic_cast<const Regular*>(sampler_ptr))
+        return (get(REGULAR_PATTERN, num_samples));
+
+    return (std::shared_ptr<const SamplePattern>());
+}
+
+
+// ---------------------------------------------------------------- size
+
+int
+SamplePatternStore::size(void) {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    return (store.size());
+}
+
+
+// ---------------------------------------------------------------- clear
+// patterns still held by a renderer stay alive until it lets go of them
+
+void
+SamplePatternStore::clear(void) {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    store.clear();
+}
@@ -0,0 +1,159 @@
+#ifndef __SAMPLE_PATTERN_STORE__
+#define __SAMPLE_PATTERN_STORE__
+
+// Precomputed sample patterns, shared read-only by every renderer thread.
+// A pattern is generated once per (type, sample count, set count) and kept in
+// structure-of-arrays form, with the shuffled index table next to it, and is never written
+// again, so threads read it without locking. A thread only keeps a SampleCursor that says
+// which set of the pattern the current pixel walks.
+// The Sampler classes keep their own tables for the cameras' render_scene loops; the
+// TileRenderer takes its samples from here instead.
+
+#include <memory>
+#include <vector>
+
+#include "Utilities/Point2D.h"
+
+class RandomStream;
+class Sampler;
+
+enum SamplePatternType { REGULAR_PATTERN, JITTERED_PATTERN, MULTI_JITTERED_PATTERN };
+
+
+// ---------------------------------------------------------------- SamplePattern
+
+class SamplePattern {
+    public:
+
+        SamplePattern(const SamplePatternType type, const int num_samples, const int num_sets);
+
+        SamplePatternType
+        get_type(void) const;
+
+        int
+        get_num_samples(void) const;
+
+        int
+        get_num_sets(void) const;
+
+        Point2D
+        unit_square(const int set, const int j) const;		// sample j of a set, in shuffled order
+
+    private:
+
+        SamplePatternType 	type;
+        int 				num_samples;
+        int 				num_sets;
+        std::vector<float> 	x, y;							// set after set, num_samples each
+        std::vector<int> 	shuffled_indices;
+
+        void
+        generate_regular(void);
+
+        void
+        generate_jittered(RandomStream& rng);
+
+        void
+        generate_multi_jittered(RandomStream& rng);
+
+        void
+        setup_shuffled_indices(RandomStream& rng);
+};
+
+
+// ---------------------------------------------------------------- SampleCursor
+// the per-thread state: a pattern and the set that the current pixel uses
+
+class SampleCursor {
+    public:
+
+        SampleCursor(void);
+
+        SampleCursor(const SamplePattern* pattern);
+
+        bool
+        has_pattern(void) const;
+
+        void
+        start(RandomStream& rng);							// picks a set for the next pixel
+
+        Point2D
+        unit_square(const int j) const;
+
+    private:
+
+        const SamplePattern* 	pattern_ptr;
+        int 					set;
+};
+
+
+// ---------------------------------------------------------------- SamplePatternStore
+
+class SamplePatternStore {
+    public:
+
+        static const int default_num_sets = 83;				// as in Sampler
+
+        static std::shared_ptr<const SamplePattern>
+        get(const SamplePatternType type, const int num_samples, const int num_sets = default_num_sets);
+
+        static std::shared_ptr<const SamplePattern>
+        get(const Sampler* sampler_ptr, const int num_samples);	// null unless the sampler is
+                                                                // Regular, Jittered or MultiJittered
+        static int
+        size(void);
+
+        static void
+        clear(void);
+};
+
+
+// ---------------------------------------------------------------- get_type
+
+inline SamplePatternType
+SamplePattern::get_type(void) const {
+    return (type);
+}
+
+
+// ---------------------------------------------------------------- get_num_samples
+
+inline int
+SamplePattern::get_num_samples(void) const {
+    return (num_samples);
+}
+
+
+// ---------------------------------------------------------------- get_num_sets
+
+inline int
+SamplePattern::get_num_sets(void) const {
+    return (num_sets);
+}
+
+
+// ---------------------------------------------------------------- unit_square
+
+inline Point2D
+SamplePattern::unit_square(const int set, const int j) const {
+    int index = set * num_samples + shuffled_indices[set * num_samples + j];
+    return (Point2D(x[index], y[index]));
+}
+
+
+// ---------------------------------------------------------------- has_pattern
+
+inline bool
+SampleCursor::has_pattern(void) const {
+    return (pattern_ptr != NULL);
+}
+
+
+// ---------------------------------------------------------------- unit_square
+
+inline Point2D
+SampleCursor::unit_square(const int j) const {
+    return (pattern_ptr->unit_square(set, j));
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include "CountingTracer.h"
+
+#include "Utilities/RenderStats.h"
+#include "World/World.h"
+
+// ---------------------------------------------------------------- constructor
+
+CountingTracer::CountingTracer(World* _world_ptr, Tracer* _tracer_ptr)
+    : 	Tracer(_world_ptr),
+        tracer_ptr(_tracer_ptr)
+{}
+
+
+// ---------------------------------------------------------------- destructor
+
+CountingTracer::~CountingTracer(void) {
+    if (tracer_ptr) {
+        delete tracer_ptr;
+        tracer_ptr = NULL;
+    }
+}
+
+
+// ---------------------------------------------------------------- count
+
+void
+CountingTracer::count(const int depth) const {
+    RenderCounts& counts = RenderStats::local();
+
+    if (depth == 0)
+        counts.primary_rays++;
+    else
+        counts.secondary_rays++;
+
+    counts.object_tests += world_ptr->objects.size();
+}
+
+
+// ---------------------------------------------------------------- trace_ray
+
+RGBColor
+CountingTracer::trace_ray(const Ray& ray) const {
+    count(0);
+    return (tracer_ptr->trace_ray(ray));
+}
+
+
+// ---------------------------------------------------------------- trace_ray
+
+RGBColor
+CountingTracer::trace_ray(const Ray ray, const int depth) const {
+    count(depth);
+    return (tracer_ptr->trace_ray(ray, depth));
+}
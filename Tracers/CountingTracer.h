@@ -0,0 +1,46 @@
+#ifndef __COUNTING_TRACER__
+#define __COUNTING_TRACER__
+
+// Wraps the tracer a scene was built with and counts every ray that passes through it.
+// Materials trace their secondary rays through sr.w.tracer_ptr, so installing the wrapper
+// in World::tracer_ptr sees reflected and transmitted rays as well as camera rays.
+// Rays at depth 0 are counted as primary, deeper ones as secondary; every traced ray is
+// also charged one test per top-level object, as World::hit_objects tests them all.
+// The wrapper owns the tracer it wraps.
+
+#include "Tracer.h"
+
+class CountingTracer: public Tracer {
+    public:
+
+        CountingTracer(World* _world_ptr, Tracer* _tracer_ptr);
+
+        virtual
+        ~CountingTracer(void);
+
+        virtual RGBColor
+        trace_ray(const Ray& ray) const;
+
+        virtual RGBColor
+        trace_ray(const Ray ray, const int depth) const;
+
+        const Tracer*
+        get_tracer(void) const;
+
+    private:
+
+        Tracer* tracer_ptr;
+
+        void
+        count(const int depth) const;
+};
+
+
+// ---------------------------------------------------------------- get_tracer
+
+inline const Tracer*
+CountingTracer::get_tracer(void) const {
+    return (tracer_ptr);
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include "ThreadSafeRayCast.h"
+
+#include "GeometricObjects/HitMaterial.h"
+#include "Materials/Material.h"
+#include "Utilities/Constants.h"
+#include "Utilities/ShadeRec.h"
+#include "World/World.h"
+
+// ---------------------------------------------------------------- constructor
+
+ThreadSafeRayCast::ThreadSafeRayCast(World* _world_ptr)
+    : 	RayCast(_world_ptr)
+{}
+
+
+// ---------------------------------------------------------------- destructor
+
+ThreadSafeRayCast::~ThreadSafeRayCast(void) {}
+
+
+// ---------------------------------------------------------------- trace_ray
+
+RGBColor
+ThreadSafeRayCast::trace_ray(const Ray& ray) const {
+    return (trace_ray(ray, 0));
+}
+
+
+// ---------------------------------------------------------------- trace_ray
+// the loop of World::hit_objects, with the material taken from the ShadeRec
+
+RGBColor
+ThreadSafeRayCast::trace_ray(const Ray ray, const int depth) const {
+    ShadeRec 	sr(*world_ptr);
+    double 		t;
+    double 		tmin = kHugeValue;
+    Normal 		normal;
+    Point3D 	local_hit_point;
+    std::shared_ptr<Material> material;
+
+    for (GeometricObject* object_ptr : world_ptr->objects)
+        if (object_ptr->hit(ray, t, sr) && (t < tmin)) {
+            tmin 			= t;
+            normal 			= sr.normal;
+            local_hit_point = sr.local_hit_point;
+            material 		= HitMaterial::take(object_ptr, t, sr);
+        }
+
+    if (!material)
+        return (world_ptr->background_color);
+
+    sr.hit_an_object 	= true;
+    sr.material_ptr 	= material;
+    sr.t 				= tmin;
+    sr.hit_point 		= ray.o + tmin * ray.d;
+    sr.normal 			= normal;
+    sr.local_hit_point 	= local_hit_point;
+    sr.ray 				= ray;
+    sr.depth 			= depth;
+
+    return (sr.material_ptr->shade(sr));
+}
@@ -0,0 +1,29 @@
+#ifndef __THREAD_SAFE_RAY_CAST__
+#define __THREAD_SAFE_RAY_CAST__
+
+// RayCast for scenes rendered on several threads at once.
+// World::hit_objects reads the material of the object hit with get_material(), which for the
+// library's compounds is the material their hit last stored in the object itself, whichever
+// thread stored it. This tracer runs the same loop over the world's objects but takes the
+// material the hit handed back in the ShadeRec (see HitMaterial), so a thread only ever reads
+// what its own rays found. The ShadeRec is given the ray's depth, which RayCast leaves unset.
+// It is a RayCast, so TileRenderer still traces its coherent rows as packets.
+
+#include "RayCast.h"
+
+class ThreadSafeRayCast: public RayCast {
+    public:
+
+        ThreadSafeRayCast(World* _world_ptr);
+
+        virtual
+        ~ThreadSafeRayCast(void);
+
+        virtual RGBColor
+        trace_ray(const Ray& ray) const;
+
+        virtual RGBColor
+        trace_ray(const Ray ray, const int depth) const;
+};
+
+#endif
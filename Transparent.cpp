@@ -1,7 +1,10 @@
 #include "Transparent.h"
 
+#include <algorithm>
 #include <cmath>
 
+#include "Utilities/RandomStream.h"
+
 // ---------------------------------------------------------------- default constructor
 Transparent::Transparent(void)
 : Phong(),
@@ -19,12 +22,17 @@ Transparent& Transparent::operator=(const Transparent& other) {
     return *this;
 }
 
+// the BRDF and BTDF are owned, so the ones being replaced are deleted, including
+// the pair the copy constructor's delegated default constructor has just made
 void Transparent::copy(const Transparent& other) {
     Phong::operator=(other);
 
     PerfectSpecular* prefl = other.reflective_brdf;
     PerfectTransmitter* pspec = other.specular_btdf;
 
+    delete reflective_brdf;
+    delete specular_btdf;
+
     reflective_brdf = prefl ? prefl->clone() : NULL;
     specular_btdf   = pspec ? pspec->clone() : NULL;
 }
@@ -38,46 +46,170 @@ Transparent::~Transparent(void) {
 // ---------------------------------------------------------------- clone
 Transparent* Transparent::clone(void) const { return new Transparent(*this); }
 
-RGBColor Transparent::shade(ShadeRec& sr) {
-     RGBColor L(Phong::shade(sr));
-
-     Vector3D wo = -sr.ray.d;
-     Vector3D wi;
-     RGBColor fr = reflective_brdf->sample_f(sr, wo, wi);     // computes wi
-     Ray reflected_ray(sr.hit_point, wi);
-
-     if (specular_btdf->tir(sr)) {
-//     if (specular_btdf) {
-          L += sr.w.tracer_ptr->trace_ray(reflected_ray, sr.depth + 1);
-     } else {    // kr = 1.0
-          Vector3D wt;
-          RGBColor ft = specular_btdf->sample_f(sr, wo, wt);     // computes wt
-          Ray transmuted_ray(sr.hit_point, wt);
-
-          L += fr * sr.w.tracer_ptr->trace_ray(reflected_ray, sr.depth + 1) * std::fabs(sr.normal.dot(wi));
-          //L += ft * sr.w.tracer_ptr->trace_ray(transmuted_ray, sr.depth + 1) * std::fabs(sr.normal.dot(wt));
-     }
-     return L;
+// ---------------------------------------------------------------- path state
+// Paths through glass are ended by Russian roulette on their throughput rather than by a
+// fixed depth. The throughput travels with the ray: a Transparent hit records it for the
+// depth it is about to trace and restores the previous record afterwards, so a hit only
+// trusts the record when its parent was itself a Transparent hit; otherwise it starts
+// from full throughput, which can only make a path live longer.
+// The depth of a hit is sr.depth, or the recorded depth when that is larger: a tracer that
+// leaves sr.depth at 0 still sees each Transparent hit one deeper than the one that traced
+// it, so the depth limits hold whatever the tracer.
+
+struct PathState {
+    int depth; // depth of the ray the throughput belongs to
+    float throughput;
+};
+
+static thread_local PathState path_state = { -1, 1.0f };
+
+// both the reflected and the transmitted ray are traced up to this depth; deeper
+// hits follow a single branch chosen in proportion to its weight
+static const int kBranchingDepth = 2;
+
+// Russian roulette starts at this depth
+static const int kRouletteDepth = 3;
+
+// safety net for paths that roulette keeps alive, e.g. internal reflection in a closed body
+static const int kMaxPathDepth = 64;
+
+// ---------------------------------------------------------------- trace_branch
+// traces one secondary ray, from a hit at depth, whose path throughput is throughput
+static RGBColor trace_branch(ShadeRec& sr, const int depth, const Ray& ray, const float throughput) {
+    PathState saved = path_state;
+
+    path_state.depth = depth + 1;
+    path_state.throughput = throughput;
+
+    RGBColor L = sr.w.tracer_ptr->trace_ray(ray, depth + 1);
+
+    path_state = saved;
+
+    return L;
 }
 
-RGBColor Transparent::area_light_shade(ShadeRec& sr) {
-//Original code
-    RGBColor L(Phong::shade(sr));
+// ---------------------------------------------------------------- relative_eta
+// the ratio of the indices of refraction across the surface at this hit, in the direction
+// of travel. PerfectTransmitter keeps its index to itself, so it is read back through
+// Snell's law from the transmitter's own refraction of a ray entering at 30 degrees, on a
+// copy of the hit
+static double relative_eta(const ShadeRec& sr, const PerfectTransmitter* specular_btdf, const double cos_i) {
+    ShadeRec probe(sr);
+    probe.normal = Normal(0, 0, 1);
+
+    Vector3D wo(0.5, 0.0, std::sqrt(0.75));
+    Vector3D wt;
+    specular_btdf->sample_f(probe, wo, wt);
+
+    double sin_t = std::sqrt(wt.x * wt.x + wt.y * wt.y) / wt.length();
+    double ior = sin_t > 0.0 ? 0.5 / sin_t : 1.0;
+
+    return cos_i < 0.0 ? 1.0 / ior : ior;
+}
+
+// ---------------------------------------------------------------- fresnel
+// unpolarised dielectric reflectance, as FresnelReflector computes it; 1 under total
+// internal reflection
+static double fresnel(const double cos_theta_i, const double eta) {
+    double cos_i = std::fabs(cos_theta_i);
+    double temp = 1.0 - (1.0 - cos_i * cos_i) / (eta * eta);
+
+    if (temp <= 0.0)
+        return 1.0;
+
+    double cos_t = std::sqrt(temp);
+    double r_parallel = (eta * cos_i - cos_t) / (eta * cos_i + cos_t);
+    double r_perpendicular = (cos_i - eta * cos_t) / (cos_i + eta * cos_t);
+
+    return 0.5 * (r_parallel * r_parallel + r_perpendicular * r_perpendicular);
+}
+
+// ---------------------------------------------------------------- specular_paths
+// radiance arriving along the reflected and transmitted directions, weighted by the
+// Fresnel reflectance F and by 1 - F; the BRDF and BTDF only give the directions, so
+// their kr and kt are not applied on top
+static RGBColor specular_paths(ShadeRec& sr, const PerfectSpecular* reflective_brdf, const PerfectTransmitter* specular_btdf) {
+    int depth = std::max(sr.depth, path_state.depth);
+
+    if (depth >= kMaxPathDepth)
+        return black;
+
+    float throughput = (path_state.depth == depth) ? path_state.throughput : 1.0;
 
     Vector3D wo = -sr.ray.d;
     Vector3D wi;
-    RGBColor fr = reflective_brdf->sample_f(sr, wo, wi);     // computes wi
+    reflective_brdf->sample_f(sr, wo, wi); // computes wi
     Ray reflected_ray(sr.hit_point, wi);
+    Ray transmitted_ray;
 
-    if (!specular_btdf) { // not !
-         L += sr.w.tracer_ptr->trace_ray(reflected_ray, sr.depth + 1);
-    } else {    // kr = 1.0
-         Vector3D wt;
-         RGBColor ft = specular_btdf->sample_f(sr, wo, wt);     // computes wt
-         Ray transmitted_ray(sr.hit_point, wt);
+    double cos_i = sr.normal.dot(wo);
+    double F = 1.0; // total internal reflection
 
-         L += fr * sr.w.tracer_ptr->trace_ray(reflected_ray, sr.depth + 1) * std::fabs(sr.normal.dot(wi));
-         //L += ft * sr.w.tracer_ptr->trace_ray(transmitted_ray, sr.depth + 1) * std::fabs(sr.normal.dot(wt));
+    if (!specular_btdf->tir(sr)) {
+        Vector3D wt;
+        specular_btdf->sample_f(sr, wo, wt); // computes wt
+        transmitted_ray = Ray(sr.hit_point, wt);
+        F = fresnel(cos_i, relative_eta(sr, specular_btdf, cos_i));
     }
+
+    RGBColor reflected_weight(F);
+    RGBColor transmitted_weight(1.0 - F);
+
+    float pr = F;
+    float pt = 1.0 - F;
+
+    if (pr + pt <= 0.0)
+        return black;
+
+    if (depth < kBranchingDepth) {
+        RGBColor L(0.0);
+
+        if (pr > 0.0)
+            L += reflected_weight * trace_branch(sr, depth, reflected_ray, throughput * pr);
+        if (pt > 0.0)
+            L += transmitted_weight * trace_branch(sr, depth, transmitted_ray, throughput * pt);
+
+        return L;
+    }
+
+    // follow one branch, picked in proportion to its weight
+
+    RandomStream& rng = RandomStream::local();
+
+    bool reflect = rng.next_float() * (pr + pt) < pr;
+    float probability = (reflect ? pr : pt) / (pr + pt);
+    RGBColor weight = (reflect ? reflected_weight : transmitted_weight) / probability;
+    float next_throughput = throughput * (reflect ? pr : pt) / probability;
+
+    // then let the path survive with a probability that follows its throughput
+
+    if (depth >= kRouletteDepth) {
+        float survival = std::min(1.0f, next_throughput);
+
+        if (rng.next_float() >= survival)
+            return black;
+
+        weight = weight / survival;
+        next_throughput = next_throughput / survival;
+    }
+
+    return weight * trace_branch(sr, depth, reflect ? reflected_ray : transmitted_ray, next_throughput);
+}
+
+// ---------------------------------------------------------------- shade
+RGBColor Transparent::shade(ShadeRec& sr) {
+    RGBColor L(Phong::shade(sr));
+
+    L += specular_paths(sr, reflective_brdf, specular_btdf);
+
+    return L;
+}
+
+// ---------------------------------------------------------------- area_light_shade
+RGBColor Transparent::area_light_shade(ShadeRec& sr) {
+    RGBColor L(Phong::area_light_shade(sr));
+
+    L += specular_paths(sr, reflective_brdf, specular_btdf);
+
     return L;
 }
@@ -0,0 +1,321 @@
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// ---------------------------------------------------------------- put_u32_be
+
+static void
+put_u32_be(std::vector<unsigned char>& out, const uint32_t value) {
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+
+// ---------------------------------------------------------------- put_le
+
+template <typename T>
+static void
+put_le(std::vector<unsigned char>& out, const T value) {
+    unsigned char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+
+    uint16_t probe = 1;
+    bool little_endian = *reinterpret_cast<unsigned char*>(&probe) == 1;
+
+    for (unsigned int j = 0; j < sizeof(T); j++)
+        out.push_back(bytes[little_endian ? j : sizeof(T) - 1 - j]);
+}
+
+
+// ---------------------------------------------------------------- put_string
+
+static void
+put_string(std::vector<unsigned char>& out, const char* s) {
+    while (*s)
+        out.push_back(*s++);
+    out.push_back(0);
+}
+
+
+// ---------------------------------------------------------------- crc32
+
+static uint32_t
+crc32(const unsigned char* data, const size_t length, uint32_t crc = 0) {
+    static uint32_t table[256];
+    static bool 	initialised = false;
+
+    if (!initialised) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        initialised = true;
+    }
+
+    crc = ~crc;
+    for (size_t j = 0; j < length; j++)
+        crc = table[(crc ^ data[j]) & 0xff] ^ (crc >> 8);
+
+    return (~crc);
+}
+
+
+// ---------------------------------------------------------------- write_file
+
+static bool
+write_file(const std::string& file_name, const std::vector<unsigned char>& bytes) {
+    std::ofstream file(file_name.c_str(), std::ios::binary);
+    if (!file)
+        return (false);
+
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return (file.good());
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+ImageWriter::ImageWriter(void)
+    : 	inv_gamma(1.0),
+        show_out_of_gamut(false)
+{}
+
+
+// ---------------------------------------------------------------- to_bytes
+// the same mapping as World::display_pixel
+
+void
+ImageWriter::to_bytes(const RGBColor& c, unsigned char rgb[3]) const {
+    RGBColor mapped_color;
+
+    if (show_out_of_gamut) {
+        mapped_color = c;
+        if (c.r > 1.0 || c.g > 1.0 || c.b > 1.0)
+            mapped_color = RGBColor(1.0, 0.0, 0.0);
+    }
+    else {
+        float max_value = std::max(c.r, std::max(c.g, c.b));
+        mapped_color = max_value > 1.0 ? c / max_value : c;
+    }
+
+    float channels[3] = { mapped_color.r, mapped_color.g, mapped_color.b };
+
+    for (int j = 0; j < 3; j++) {
+        float value = std::max(0.0f, channels[j]);
+        if (inv_gamma != 1.0)
+            value = pow(value, inv_gamma);
+        rgb[j] = (unsigned char) std::min(255, (int) (value * 255.0 + 0.5));
+    }
+}
+
+
+// ---------------------------------------------------------------- write
+// by extension: .ppm, .png or .exr
+
+bool
+ImageWriter::write(const Framebuffer& fb, const std::string& file_name) const {
+    std::string::size_type dot = file_name.rfind('.');
+    std::string extension = dot == std::string::npos ? "" : file_name.substr(dot + 1);
+
+    for (char& ch : extension)
+        ch = tolower(ch);
+
+    if (extension == "png")
+        return (write_png(fb, file_name));
+    if (extension == "exr")
+        return (write_exr(fb, file_name));
+
+    return (write_ppm(fb, file_name));
+}
+
+
+// ---------------------------------------------------------------- write_ppm
+// binary P6, top row first
+
+bool
+ImageWriter::write_ppm(const Framebuffer& fb, const std::string& file_name) const {
+    std::string header = "P6\n" + std::to_string(fb.hres) + " " + std::to_string(fb.vres) + "\n255\n";
+    std::vector<unsigned char> bytes(header.begin(), header.end());
+
+    bytes.reserve(bytes.size() + 3 * fb.hres * fb.vres);
+
+    for (int r = fb.vres - 1; r >= 0; r--)
+        for (int c = 0; c < fb.hres; c++) {
+            unsigned char rgb[3];
+            to_bytes(fb.at(r, c), rgb);
+            bytes.insert(bytes.end(), rgb, rgb + 3);
+        }
+
+    return (write_file(file_name, bytes));
+}
+
+
+// ---------------------------------------------------------------- write_png
+// 8-bit RGB; the image data goes into stored (uncompressed) deflate blocks,
+// which keeps the writer free of zlib
+
+bool
+ImageWriter::write_png(const Framebuffer& fb, const std::string& file_name) const {
+    std::vector<unsigned char> raw;
+    raw.reserve((3 * fb.hres + 1) * fb.vres);
+
+    for (int r = fb.vres - 1; r >= 0; r--) {
+        raw.push_back(0);							// filter type: none
+        for (int c = 0; c < fb.hres; c++) {
+            unsigned char rgb[3];
+            to_bytes(fb.at(r, c), rgb);
+            raw.insert(raw.end(), rgb, rgb + 3);
+        }
+    }
+
+    // zlib stream
+
+    std::vector<unsigned char> z;
+    z.push_back(0x78);
+    z.push_back(0x01);
+
+    size_t offset = 0;
+    do {
+        size_t length = std::min((size_t) 65535, raw.size() - offset);
+        bool last = offset + length == raw.size();
+
+        z.push_back(last ? 1 : 0);
+        z.push_back(length & 0xff);
+        z.push_back(length >> 8);
+        z.push_back(~length & 0xff);
+        z.push_back((~length >> 8) & 0xff);
+        z.insert(z.end(), raw.begin() + offset, raw.begin() + offset + length);
+
+        offset += length;
+    } while (offset < raw.size());
+
+    uint32_t a = 1, b = 0;
+    for (unsigned char byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_u32_be(z, (b << 16) | a);
+
+    // chunks
+
+    std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+    auto put_chunk = [&png](const char* type, const std::vector<unsigned char>& data) {
+        put_u32_be(png, data.size());
+        size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        put_u32_be(png, crc32(&png[start], png.size() - start));
+    };
+
+    std::vector<unsigned char> ihdr;
+    put_u32_be(ihdr, fb.hres);
+    put_u32_be(ihdr, fb.vres);
+    ihdr.push_back(8);								// bit depth
+    ihdr.push_back(2);								// colour type: RGB
+    ihdr.push_back(0);								// compression
+    ihdr.push_back(0);								// filter
+    ihdr.push_back(0);								// interlace
+
+    put_chunk("IHDR", ihdr);
+    put_chunk("IDAT", z);
+    put_chunk("IEND", std::vector<unsigned char>());
+
+    return (write_file(file_name, png));
+}
+
+
+// ---------------------------------------------------------------- write_exr
+// single-part scanline file, no compression, FLOAT B, G, R channels
+
+bool
+ImageWriter::write_exr(const Framebuffer& fb, const std::string& file_name) const {
+    std::vector<unsigned char> exr;
+
+    put_le<uint32_t>(exr, 20000630);				// magic number
+    put_le<uint32_t>(exr, 2);						// version 2, scanline
+
+    // channels, in alphabetical order
+
+    put_string(exr, "channels");
+    put_string(exr, "chlist");
+    put_le<int32_t>(exr, 3 * 18 + 1);
+    const char* names[3] = { "B", "G", "R" };
+    for (int j = 0; j < 3; j++) {
+        put_string(exr, names[j]);
+        put_le<int32_t>(exr, 2);					// FLOAT
+        put_le<uint32_t>(exr, 0);					// pLinear and reserved
+        put_le<int32_t>(exr, 1);					// x sampling
+        put_le<int32_t>(exr, 1);					// y sampling
+    }
+    exr.push_back(0);
+
+    put_string(exr, "compression");
+    put_string(exr, "compression");
+    put_le<int32_t>(exr, 1);
+    exr.push_back(0);								// NO_COMPRESSION
+
+    for (const char* window : { "dataWindow", "displayWindow" }) {
+        put_string(exr, window);
+        put_string(exr, "box2i");
+        put_le<int32_t>(exr, 16);
+        put_le<int32_t>(exr, 0);
+        put_le<int32_t>(exr, 0);
+        put_le<int32_t>(exr, fb.hres - 1);
+        put_le<int32_t>(exr, fb.vres - 1);
+    }
+
+    put_string(exr, "lineOrder");
+    put_string(exr, "lineOrder");
+    put_le<int32_t>(exr, 1);
+    exr.push_back(0);								// INCREASING_Y
+
+    put_string(exr, "pixelAspectRatio");
+    put_string(exr, "float");
+    put_le<int32_t>(exr, 4);
+    put_le<float>(exr, 1.0f);
+
+    put_string(exr, "screenWindowCenter");
+    put_string(exr, "v2f");
+    put_le<int32_t>(exr, 8);
+    put_le<float>(exr, 0.0f);
+    put_le<float>(exr, 0.0f);
+
+    put_string(exr, "screenWindowWidth");
+    put_string(exr, "float");
+    put_le<int32_t>(exr, 4);
+    put_le<float>(exr, 1.0f);
+
+    exr.push_back(0);								// end of header
+
+    // line offset table, then one block per scanline, top row first
+
+    uint64_t line_size 	= 3 * 4 * fb.hres;
+    uint64_t first_line = exr.size() + 8 * fb.vres;
+
+    for (int y = 0; y < fb.vres; y++)
+        put_le<uint64_t>(exr, first_line + y * (8 + line_size));
+
+    for (int y = 0; y < fb.vres; y++) {
+        int r = fb.vres - 1 - y;
+
+        put_le<int32_t>(exr, y);
+        put_le<int32_t>(exr, line_size);
+
+        for (int c = 0; c < fb.hres; c++) put_le<float>(exr, fb.at(r, c).b);
+        for (int c = 0; c < fb.hres; c++) put_le<float>(exr, fb.at(r, c).g);
+        for (int c = 0; c < fb.hres; c++) put_le<float>(exr, fb.at(r, c).r);
+    }
+
+    return (write_file(file_name, exr));
+}
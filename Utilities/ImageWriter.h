@@ -0,0 +1,61 @@
+#ifndef __IMAGE_WRITER__
+#define __IMAGE_WRITER__
+
+// Writes a Framebuffer to disk without any GUI toolkit.
+// PPM and PNG are 8-bit and tone mapped the way World::display_pixel maps colours
+// (out-of-gamut colours are scaled or clamped, then gamma corrected);
+// EXR keeps the linear radiance as 32-bit floats.
+
+#include <string>
+
+#include "World/Framebuffer.h"
+
+class ImageWriter {
+    public:
+
+        ImageWriter(void);
+
+        void
+        set_gamma(const float g);
+
+        void
+        set_gamut_display(const bool show);
+
+        bool
+        write(const Framebuffer& fb, const std::string& file_name) const;		// picks the format from the extension
+
+        bool
+        write_ppm(const Framebuffer& fb, const std::string& file_name) const;
+
+        bool
+        write_png(const Framebuffer& fb, const std::string& file_name) const;
+
+        bool
+        write_exr(const Framebuffer& fb, const std::string& file_name) const;
+
+    private:
+
+        float	inv_gamma;
+        bool	show_out_of_gamut;
+
+        void
+        to_bytes(const RGBColor& c, unsigned char rgb[3]) const;
+};
+
+
+// ---------------------------------------------------------------- set_gamma
+
+inline void
+ImageWriter::set_gamma(const float g) {
+    inv_gamma = 1.0 / g;
+}
+
+
+// ---------------------------------------------------------------- set_gamut_display
+
+inline void
+ImageWriter::set_gamut_display(const bool show) {
+    show_out_of_gamut = show;
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include "MappedFile.h"
+
+#include <cstdio>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+// ---------------------------------------------------------------- default constructor
+
+MappedFile::MappedFile(void)
+    : 	bytes(NULL),
+        length(0),
+        mapped(false),
+        buffer()
+{}
+
+
+// ---------------------------------------------------------------- destructor
+
+MappedFile::~MappedFile(void) {
+    close();
+}
+
+
+// ---------------------------------------------------------------- open
+
+bool
+MappedFile::open(const std::string& file_name) {
+    close();
+
+#if !defined(_WIN32)
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+        return (false);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return (false);
+    }
+
+    void* address = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (address == MAP_FAILED)
+        return (false);
+
+    bytes 	= (const char*) address;
+    length 	= info.st_size;
+    mapped 	= true;
+    return (true);
+#else
+    FILE* file = fopen(file_name.c_str(), "rb");
+    if (!file)
+        return (false);
+
+    char 	chunk[65536];
+    size_t 	n;
+
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        buffer.insert(buffer.end(), chunk, chunk + n);
+
+    fclose(file);
+
+    bytes 	= buffer.data();
+    length 	= buffer.size();
+    return (length > 0);
+#endif
+}
+
+
+// ---------------------------------------------------------------- close
+
+void
+MappedFile::close(void) {
+#if !defined(_WIN32)
+    if (mapped)
+        munmap((void*) bytes, length);
+#endif
+
+    bytes 	= NULL;
+    length 	= 0;
+    mapped 	= false;
+    buffer.clear();
+}
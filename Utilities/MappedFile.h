@@ -0,0 +1,59 @@
+#ifndef __MAPPED_FILE__
+#define __MAPPED_FILE__
+
+// A read-only view of a whole file. On POSIX systems the file is memory mapped, so its
+// pages are read on first touch and shared between processes that map the same file;
+// elsewhere it is read into memory. The data stays valid while the MappedFile lives.
+
+#include <string>
+#include <vector>
+
+class MappedFile {
+    public:
+
+        MappedFile(void);
+
+        ~MappedFile(void);
+
+        bool
+        open(const std::string& file_name);
+
+        void
+        close(void);
+
+        const char*
+        data(void) const;
+
+        size_t
+        size(void) const;
+
+    private:
+
+        const char* 		bytes;
+        size_t 				length;
+        bool 				mapped;				// bytes came from mmap rather than from buffer
+        std::vector<char> 	buffer;
+
+        MappedFile(const MappedFile&);
+
+        MappedFile&
+        operator= (const MappedFile&);
+};
+
+
+// ---------------------------------------------------------------- data
+
+inline const char*
+MappedFile::data(void) const {
+    return (bytes);
+}
+
+
+// ---------------------------------------------------------------- size
+
+inline size_t
+MappedFile::size(void) const {
+    return (length);
+}
+
+#endif
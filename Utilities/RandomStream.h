@@ -0,0 +1,95 @@
+#ifndef __RANDOM_STREAM__
+#define __RANDOM_STREAM__
+
+// A small PCG32 generator.
+// Unlike rand_float in Maths.h, a stream can be seeded per pixel, so anything drawn while
+// shading a pixel is the same no matter which thread renders it or in which order.
+// The renderer reseeds the calling thread's stream with local().seed before every pixel.
+
+#include <cstdint>
+
+class RandomStream {
+    public:
+
+        RandomStream(void);
+
+        RandomStream(const uint64_t index, const uint64_t sequence = 0);
+
+        void
+        seed(const uint64_t index, const uint64_t sequence = 0);
+
+        uint32_t
+        next_uint(void);
+
+        float
+        next_float(void);				// in [0, 1)
+
+        static RandomStream&
+        local(void);					// the calling thread's stream
+
+    private:
+
+        uint64_t state;
+        uint64_t increment;
+};
+
+
+// ---------------------------------------------------------------- default constructor
+
+inline
+RandomStream::RandomStream(void) {
+    seed(0);
+}
+
+
+// ---------------------------------------------------------------- constructor
+
+inline
+RandomStream::RandomStream(const uint64_t index, const uint64_t sequence) {
+    seed(index, sequence);
+}
+
+
+// ---------------------------------------------------------------- seed
+
+inline void
+RandomStream::seed(const uint64_t index, const uint64_t sequence) {
+    state 		= 0u;
+    increment 	= (sequence << 1u) | 1u;
+    next_uint();
+    state += index + 0x853c49e6748fea9bULL;
+    next_uint();
+}
+
+
+// ---------------------------------------------------------------- next_uint
+
+inline uint32_t
+RandomStream::next_uint(void) {
+    uint64_t old_state = state;
+    state = old_state * 6364136223846793005ULL + increment;
+
+    uint32_t xorshifted = (uint32_t) (((old_state >> 18u) ^ old_state) >> 27u);
+    uint32_t rot 		= (uint32_t) (old_state >> 59u);
+
+    return ((xorshifted >> rot) | (xorshifted << ((~rot + 1u) & 31)));
+}
+
+
+// ---------------------------------------------------------------- next_float
+
+inline float
+RandomStream::next_float(void) {
+    return ((next_uint() >> 8) * (1.0f / 16777216.0f));
+}
+
+
+// ---------------------------------------------------------------- local
+
+inline RandomStream&
+RandomStream::local(void) {
+    static thread_local RandomStream stream;
+    return (stream);
+}
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef __RAY_PACKET__
+#define __RAY_PACKET__
+
+// Ray packets for coherent rays (a Pinhole camera's primary rays).
+// PacketFloat wraps one SIMD register: 8 lanes with AVX2, 4 lanes with SSE4.1, and a plain
+// array of 4 floats when neither is enabled, so the packet code compiles everywhere.
+// A RayPacket keeps its rays twice: in single precision, one array per component, for the
+// SIMD tests, and as ordinary Rays for objects that have no packet path and for shading.
+// A PacketHit records, for every lane, the nearest hit found so far and the material of the
+// surface hit, taken when the hit is recorded, in the form a ShadeRec would hold them.
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PACKET_AVX2
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define PACKET_SSE
+#endif
+
+#include <cmath>
+#include <memory>
+
+#include "Utilities/Constants.h"
+#include "Utilities/Normal.h"
+#include "Utilities/Point3D.h"
+#include "Utilities/Ray.h"
+
+#if defined(PACKET_AVX2)
+const int kPacketSize = 8;
+#else
+const int kPacketSize = 4;
+#endif
+
+const int kPacketAll = (1 << kPacketSize) - 1;
+
+
+// ---------------------------------------------------------------- lane_count
+// the number of lanes set in a mask
+
+inline int
+lane_count(int mask) {
+    int n = 0;
+
+    for (; mask; mask &= mask - 1)
+        n++;
+
+    return (n);
+}
+
+class Material;
+class ShadeRec;
+
+
+// ---------------------------------------------------------------- PacketFloat
+
+class PacketFloat {
+    public:
+
+#if defined(PACKET_AVX2)
+        __m256 v;
+
+        PacketFloat(void) {}
+        PacketFloat(const __m256 a) : v(a) {}
+        explicit PacketFloat(const float a) : v(_mm256_set1_ps(a)) {}
+
+        static PacketFloat load(const float* p) 		{ return (_mm256_load_ps(p)); }
+        static PacketFloat load_unaligned(const float* p) 	{ return (_mm256_loadu_ps(p)); }
+        void store(float* p) const 						{ _mm256_store_ps(p, v); }
+
+        PacketFloat operator+ (const PacketFloat& b) const 	{ return (_mm256_add_ps(v, b.v)); }
+        PacketFloat operator- (const PacketFloat& b) const 	{ return (_mm256_sub_ps(v, b.v)); }
+        PacketFloat operator* (const PacketFloat& b) const 	{ return (_mm256_mul_ps(v, b.v)); }
+        PacketFloat operator/ (const PacketFloat& b) const 	{ return (_mm256_div_ps(v, b.v)); }
+
+        // comparisons return a lane mask with every bit set where the test holds
+        PacketFloat operator< (const PacketFloat& b) const 	{ return (_mm256_cmp_ps(v, b.v, _CMP_LT_OQ)); }
+        PacketFloat operator> (const PacketFloat& b) const 	{ return (_mm256_cmp_ps(v, b.v, _CMP_GT_OQ)); }
+        PacketFloat operator<= (const PacketFloat& b) const { return (_mm256_cmp_ps(v, b.v, _CMP_LE_OQ)); }
+        PacketFloat operator>= (const PacketFloat& b) const { return (_mm256_cmp_ps(v, b.v, _CMP_GE_OQ)); }
+        PacketFloat operator& (const PacketFloat& b) const 	{ return (_mm256_and_ps(v, b.v)); }
+        PacketFloat operator| (const PacketFloat& b) const 	{ return (_mm256_or_ps(v, b.v)); }
+
+        int mask(void) const 							{ return (_mm256_movemask_ps(v)); }
+
+        friend PacketFloat min(const PacketFloat& a, const PacketFloat& b) 	{ return (_mm256_min_ps(a.v, b.v)); }
+        friend PacketFloat max(const PacketFloat& a, const PacketFloat& b) 	{ return (_mm256_max_ps(a.v, b.v)); }
+        friend PacketFloat sqrt(const PacketFloat& a) 						{ return (_mm256_sqrt_ps(a.v)); }
+        friend PacketFloat select(const PacketFloat& m, const PacketFloat& a, const PacketFloat& b)
+                                                                            { return (_mm256_blendv_ps(b.v, a.v, m.v)); }
+#elif defined(PACKET_SSE)
+        __m128 v;
+
+        PacketFloat(void) {}
+        PacketFloat(const __m128 a) : v(a) {}
+        explicit PacketFloat(const float a) : v(_mm_set1_ps(a)) {}
+
+        static PacketFloat load(const float* p) 		{ return (_mm_load_ps(p)); }
+        static PacketFloat load_unaligned(const float* p) 	{ return (_mm_loadu_ps(p)); }
+        void store(float* p) const 						{ _mm_store_ps(p, v); }
+
+        PacketFloat operator+ (const PacketFloat& b) const 	{ return (_mm_add_ps(v, b.v)); }
+        PacketFloat operator- (const PacketFloat& b) const 	{ return (_mm_sub_ps(v, b.v)); }
+        PacketFloat operator* (const PacketFloat& b) const 	{ return (_mm_mul_ps(v, b.v)); }
+        PacketFloat operator/ (const PacketFloat& b) const 	{ return (_mm_div_ps(v, b.v)); }
+
+        PacketFloat operator< (const PacketFloat& b) const 	{ return (_mm_cmplt_ps(v, b.v)); }
+        PacketFloat operator> (const PacketFloat& b) const 	{ return (_mm_cmpgt_ps(v, b.v)); }
+        PacketFloat operator<= (const PacketFloat& b) const { return (_mm_cmple_ps(v, b.v)); }
+        PacketFloat operator>= (const PacketFloat& b) const { return (_mm_cmpge_ps(v, b.v)); }
+        PacketFloat operator& (const PacketFloat& b) const 	{ return (_mm_and_ps(v, b.v)); }
+        PacketFloat operator| (const PacketFloat& b) const 	{ return (_mm_or_ps(v, b.v)); }
+
+        int mask(void) const 							{ return (_mm_movemask_ps(v)); }
+
+        friend PacketFloat min(const PacketFloat& a, const PacketFloat& b) 	{ return (_mm_min_ps(a.v, b.v)); }
+        friend PacketFloat max(const PacketFloat& a, const PacketFloat& b) 	{ return (_mm_max_ps(a.v, b.v)); }
+        friend PacketFloat sqrt(const PacketFloat& a) 						{ return (_mm_sqrt_ps(a.v)); }
+        friend PacketFloat select(const PacketFloat& m, const PacketFloat& a, const PacketFloat& b)
+                                                                            { return (_mm_blendv_ps(b.v, a.v, m.v)); }
+#else
+        float v[kPacketSize];
+
+        PacketFloat(void) {}
+        explicit PacketFloat(const float a) 			{ for (int j = 0; j < kPacketSize; j++) v[j] = a; }
+
+        static PacketFloat load(const float* p) 		{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = p[j]; return (r); }
+        static PacketFloat load_unaligned(const float* p) 	{ return (load(p)); }
+        void store(float* p) const 						{ for (int j = 0; j < kPacketSize; j++) p[j] = v[j]; }
+
+        PacketFloat operator+ (const PacketFloat& b) const 	{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = v[j] + b.v[j]; return (r); }
+        PacketFloat operator- (const PacketFloat& b) const 	{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = v[j] - b.v[j]; return (r); }
+        PacketFloat operator* (const PacketFloat& b) const 	{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = v[j] * b.v[j]; return (r); }
+        PacketFloat operator/ (const PacketFloat& b) const 	{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = v[j] / b.v[j]; return (r); }
+
+        // masks hold 1.0 where the test holds and 0.0 elsewhere
+        PacketFloat operator< (const PacketFloat& b) const 	{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = v[j] < b.v[j]; return (r); }
+        PacketFloat operator> (const PacketFloat& b) const 	{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = v[j] > b.v[j]; return (r); }
+        PacketFloat operator<= (const PacketFloat& b) const { PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = v[j] <= b.v[j]; return (r); }
+        PacketFloat operator>= (const PacketFloat& b) const { PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = v[j] >= b.v[j]; return (r); }
+        PacketFloat operator& (const PacketFloat& b) const 	{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = v[j] != 0.0f && b.v[j] != 0.0f; return (r); }
+        PacketFloat operator| (const PacketFloat& b) const 	{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = v[j] != 0.0f || b.v[j] != 0.0f; return (r); }
+
+        int mask(void) const 							{ int m = 0; for (int j = 0; j < kPacketSize; j++) m |= (v[j] != 0.0f) << j; return (m); }
+
+        friend PacketFloat min(const PacketFloat& a, const PacketFloat& b) 	{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = a.v[j] < b.v[j] ? a.v[j] : b.v[j]; return (r); }
+        friend PacketFloat max(const PacketFloat& a, const PacketFloat& b) 	{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = a.v[j] > b.v[j] ? a.v[j] : b.v[j]; return (r); }
+        friend PacketFloat sqrt(const PacketFloat& a) 						{ PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = std::sqrt(a.v[j]); return (r); }
+        friend PacketFloat select(const PacketFloat& m, const PacketFloat& a, const PacketFloat& b)
+                                                                            { PacketFloat r; for (int j = 0; j < kPacketSize; j++) r.v[j] = m.v[j] != 0.0f ? a.v[j] : b.v[j]; return (r); }
+#endif
+};
+
+
+// ---------------------------------------------------------------- RayPacket
+
+struct RayPacket {
+    alignas(32) float 	ox[kPacketSize], oy[kPacketSize], oz[kPacketSize];
+    alignas(32) float 	dx[kPacketSize], dy[kPacketSize], dz[kPacketSize];
+    alignas(32) float 	inv_dx[kPacketSize], inv_dy[kPacketSize], inv_dz[kPacketSize];
+    Ray 				rays[kPacketSize];
+    int 				active;							// bit j is set when lane j carries a ray
+
+    RayPacket(void);
+
+    void
+    set(const int lane, const Ray& ray);
+
+    void
+    fill_inactive(void);								// copies the first active lane into the others
+};
+
+
+// ---------------------------------------------------------------- PacketHit
+
+struct PacketHit {
+    alignas(32) float 		t[kPacketSize];				// for culling; kHugeValue while nothing is hit
+    double 					t_hit[kPacketSize];
+    Normal 					normal[kPacketSize];
+    Point3D 				local_hit_point[kPacketSize];
+    std::shared_ptr<Material> 	material[kPacketSize];	// null while nothing is hit
+    ShadeRec* 				scratch;					// for objects that have no packet path
+
+    PacketHit(ShadeRec& sr);
+
+    void
+    record(const int lane, const double t, const Normal& n, const Point3D& local_hit_point,
+           const std::shared_ptr<Material>& material_ptr);
+};
+
+
+// ---------------------------------------------------------------- default constructor
+
+inline
+RayPacket::RayPacket(void)
+    : 	active(0)
+{}
+
+
+// ---------------------------------------------------------------- set
+
+inline void
+RayPacket::set(const int lane, const Ray& ray) {
+    ox[lane] 		= ray.o.x;
+    oy[lane] 		= ray.o.y;
+    oz[lane] 		= ray.o.z;
+    dx[lane] 		= ray.d.x;
+    dy[lane] 		= ray.d.y;
+    dz[lane] 		= ray.d.z;
+    inv_dx[lane] 	= 1.0f / dx[lane];
+    inv_dy[lane] 	= 1.0f / dy[lane];
+    inv_dz[lane] 	= 1.0f / dz[lane];
+    rays[lane] 		= ray;
+    active 			|= 1 << lane;
+}
+
+
+// ---------------------------------------------------------------- fill_inactive
+// inactive lanes then compute harmless values, and their results are masked off
+
+inline void
+RayPacket::fill_inactive(void) {
+    int first = 0;
+    while (first < kPacketSize && !(active & (1 << first)))
+        first++;
+
+    if (first == kPacketSize)
+        return;
+
+    int mask = active;
+
+    for (int j = 0; j < kPacketSize; j++)
+        if (!(mask & (1 << j)))
+            set(j, rays[first]);
+
+    active = mask;
+}
+
+
+// ---------------------------------------------------------------- constructor
+
+inline
+PacketHit::PacketHit(ShadeRec& sr)
+    : 	scratch(&sr)
+{
+    for (int j = 0; j < kPacketSize; j++) {
+        t[j] 		= kHugeValue;
+        t_hit[j] 	= kHugeValue;
+    }
+}
+
+
+// ---------------------------------------------------------------- record
+
+inline void
+PacketHit::record(	const int lane, const double tmin, const Normal& n, const Point3D& p,
+                    const std::shared_ptr<Material>& material_ptr) {
+    t[lane] 				= tmin;
+    t_hit[lane] 			= tmin;
+    normal[lane] 			= n;
+    local_hit_point[lane] 	= p;
+    material[lane] 			= material_ptr;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include "RenderStats.h"
+
+#include <atomic>
+
+static std::atomic<uint64_t> total_primary_rays(0);
+static std::atomic<uint64_t> total_secondary_rays(0);
+static std::atomic<uint64_t> total_node_tests(0);
+static std::atomic<uint64_t> total_object_tests(0);
+static std::atomic<uint64_t> total_shadow_rays(0);
+static std::atomic<uint64_t> total_occluder_cache_hits(0);
+static std::atomic<uint64_t> total_torus_fallbacks(0);
+static std::atomic<uint64_t> total_allocations(0);
+
+
+// ---------------------------------------------------------------- flush
+
+void
+RenderStats::flush(void) {
+    RenderCounts& counts = local();
+
+    total_primary_rays 		+= counts.primary_rays;
+    total_secondary_rays 	+= counts.secondary_rays;
+    total_node_tests 		+= counts.node_tests;
+    total_object_tests 		+= counts.object_tests;
+    total_shadow_rays 		+= counts.shadow_rays;
+    total_occluder_cache_hits 	+= counts.occluder_cache_hits;
+    total_torus_fallbacks 		+= counts.torus_fallbacks;
+    total_allocations 			+= counts.allocations;
+
+    counts = RenderCounts();
+}
+
+
+// ---------------------------------------------------------------- total
+
+RenderCounts
+RenderStats::total(void) {
+    RenderCounts counts;
+
+    counts.primary_rays 	= total_primary_rays;
+    counts.secondary_rays 	= total_secondary_rays;
+    counts.node_tests 		= total_node_tests;
+    counts.object_tests 	= total_object_tests;
+    counts.shadow_rays 		= total_shadow_rays;
+    counts.occluder_cache_hits 	= total_occluder_cache_hits;
+    counts.torus_fallbacks 		= total_torus_fallbacks;
+    counts.allocations 			= total_allocations;
+
+    return (counts);
+}
+
+
+// ---------------------------------------------------------------- reset
+
+void
+RenderStats::reset(void) {
+    local() = RenderCounts();
+
+    total_primary_rays 		= 0;
+    total_secondary_rays 	= 0;
+    total_node_tests 		= 0;
+    total_object_tests 		= 0;
+    total_shadow_rays 		= 0;
+    total_occluder_cache_hits 	= 0;
+    total_torus_fallbacks 		= 0;
+    total_allocations 			= 0;
+}
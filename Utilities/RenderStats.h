@@ -0,0 +1,115 @@
+#ifndef __RENDER_STATS__
+#define __RENDER_STATS__
+
+// Ray and intersection counters.
+// Each thread counts into its own local() record without atomics; flush() adds the local
+// counts to the process-wide totals, which total() reads once rendering has finished.
+// The TileRenderer flushes every worker before it returns.
+// Node and object tests are counted per ray: a packet test adds one for each active lane it
+// covers, so that the packet path's counts compare with the scalar path's.
+// allocation_counter() is a per-thread count of operator new calls for a program that
+// replaces operator new to keep it (the benchmark does); it stays at zero otherwise. The
+// TileRenderer adds what it grows by while a worker traces a tile to allocations, so a render
+// can show that its rays allocate nothing.
+// The counting in the hot paths (the acceleration structures, the lights' shadow tests and
+// PacketTorus) is compiled in only when RENDER_STATS is defined, as the benchmark's build
+// does; RENDER_COUNT(statement) keeps its statement there and drops it from other builds.
+// The CountingTracer and the TileRenderer's tile counts are left in, as they are per ray or
+// per tile and the tracer is only installed by the benchmark.
+
+#include <cstdint>
+
+#ifdef RENDER_STATS
+    #define RENDER_COUNT(...) 	__VA_ARGS__
+#else
+    #define RENDER_COUNT(...)
+#endif
+
+struct RenderCounts {
+    uint64_t primary_rays;
+    uint64_t secondary_rays;
+    uint64_t node_tests;				// acceleration structure nodes tested against a ray
+    uint64_t object_tests;				// ray-object hit and shadow_hit calls
+    uint64_t shadow_rays;				// shadow tests of the lights that count them (CachedDirectional)
+    uint64_t occluder_cache_hits;		// shadow rays blocked by the light's last occluder
+    uint64_t torus_fallbacks;			// PacketTorus rays handed back to the quartic solver
+    uint64_t allocations;				// operator new calls made while tracing tiles
+
+    RenderCounts(void);
+
+    uint64_t
+    rays(void) const;
+
+    uint64_t
+    intersection_tests(void) const;
+};
+
+class RenderStats {
+    public:
+
+        static RenderCounts&
+        local(void);
+
+        static void
+        flush(void);
+
+        static RenderCounts
+        total(void);
+
+        static void
+        reset(void);					// clears the totals and the calling thread's counts
+
+        static uint64_t&
+        allocation_counter(void);
+};
+
+
+// ---------------------------------------------------------------- default constructor
+
+inline
+RenderCounts::RenderCounts(void)
+    : 	primary_rays(0),
+        secondary_rays(0),
+        node_tests(0),
+        object_tests(0),
+        shadow_rays(0),
+        occluder_cache_hits(0),
+        torus_fallbacks(0),
+        allocations(0)
+{}
+
+
+// ---------------------------------------------------------------- rays
+
+inline uint64_t
+RenderCounts::rays(void) const {
+    return (primary_rays + secondary_rays);
+}
+
+
+// ---------------------------------------------------------------- intersection_tests
+
+inline uint64_t
+RenderCounts::intersection_tests(void) const {
+    return (node_tests + object_tests);
+}
+
+
+// ---------------------------------------------------------------- local
+
+inline RenderCounts&
+RenderStats::local(void) {
+    static thread_local RenderCounts counts;
+    return (counts);
+}
+
+
+// ---------------------------------------------------------------- allocation_counter
+
+inline uint64_t&
+RenderStats::allocation_counter(void) {
+    static thread_local uint64_t count = 0;
+    return (count);
+}
+
+#endif
@@ -0,0 +1,260 @@
+#include "SceneArena.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Every node is preceded by a header that records the arena it came from, if any, and the
+// size of its block, so that release_node gives it back without searching for its owner.
+
+struct NodeHeader {
+    ArenaState* 	state;					// NULL for a node on the heap
+    size_t 			size;					// of the whole block, header included
+};
+
+static const size_t kGranule 	= 16;		// block sizes, and the alignment of every node
+static const size_t kHeaderSize = (sizeof(NodeHeader) + kGranule - 1) / kGranule * kGranule;
+
+// The bookkeeping of an arena lives here rather than in the SceneArena, so that nodes still
+// alive when the arena is destroyed can be given back later.
+// live counts the nodes not yet deleted, plus one for as long as the arena itself lives;
+// whichever drops it to zero frees the chunks.
+
+struct ArenaState {
+    std::mutex 				mutex;
+    size_t 					chunk_size;
+    std::vector<char*> 		chunks;
+    char* 					top;			// next free byte of the last chunk
+    char* 					end;
+    std::vector<char*> 		free_blocks;	// by block size in granules; each a list threaded through its blocks
+    size_t 					capacity;
+    size_t 					used;
+    size_t 					live;
+};
+
+static thread_local SceneArena* current_arena = NULL;
+
+
+// ---------------------------------------------------------------- free_state
+
+static void
+free_state(ArenaState* state) {
+    for (char* chunk : state->chunks)
+        free(chunk);
+
+    delete state;
+}
+
+
+// ---------------------------------------------------------------- take_block
+// a freed block of the size if there is one, otherwise the next bytes of the last chunk
+
+static char*
+take_block(ArenaState* state, const size_t size) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    char*& head 	= state->free_blocks[size / kGranule];
+    char* 	block 	= head;
+
+    if (block)
+        head = *(char**) block;
+    else {
+        if ((size_t) (state->end - state->top) < size) {
+            char* chunk = (char*) malloc(state->chunk_size);
+            if (!chunk)
+                return (NULL);
+
+            state->chunks.push_back(chunk);
+            state->top 		= chunk;
+            state->end 		= chunk + state->chunk_size;
+            state->capacity += state->chunk_size;
+        }
+
+        block 		= state->top;
+        state->top 	+= size;
+    }
+
+    state->used += size;
+    state->live++;
+
+    return (block);
+}
+
+
+// ---------------------------------------------------------------- Scope constructor
+
+SceneArena::Scope::Scope(SceneArena& arena)
+    : 	previous(current_arena)
+{
+    current_arena = &arena;
+}
+
+
+// ---------------------------------------------------------------- Scope destructor
+
+SceneArena::Scope::~Scope(void) {
+    current_arena = previous;
+}
+
+
+// ---------------------------------------------------------------- constructor
+
+SceneArena::SceneArena(const size_t chunk_size)
+    : 	state(NULL)
+{
+    if (chunk_size == 0)
+        return;
+
+    state = new ArenaState;
+    state->chunk_size 	= (chunk_size + kGranule - 1) / kGranule * kGranule;
+    state->top 			= NULL;
+    state->end 			= NULL;
+    state->capacity 	= 0;
+    state->used 		= 0;
+    state->live 		= 1;
+    state->free_blocks.assign(state->chunk_size / 4 / kGranule + 1, (char*) NULL);
+}
+
+
+// ---------------------------------------------------------------- destructor
+
+SceneArena::~SceneArena(void) {
+    if (current_arena == this)
+        current_arena = NULL;
+
+    if (!state)
+        return;
+
+    bool last;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        last = --state->live == 0;
+    }
+
+    if (last)
+        free_state(state);
+}
+
+
+// ---------------------------------------------------------------- get_capacity
+
+size_t
+SceneArena::get_capacity(void) const {
+    if (!state)
+        return (0);
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return (state->capacity);
+}
+
+
+// ---------------------------------------------------------------- get_used
+
+size_t
+SceneArena::get_used(void) const {
+    if (!state)
+        return (0);
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return (state->used);
+}
+
+
+// ---------------------------------------------------------------- get_live
+
+size_t
+SceneArena::get_live(void) const {
+    if (!state)
+        return (0);
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return (state->live - 1);
+}
+
+
+// ---------------------------------------------------------------- current
+
+SceneArena*
+SceneArena::current(void) {
+    return (current_arena);
+}
+
+
+// ---------------------------------------------------------------- allocate_node
+
+void*
+SceneArena::allocate_node(const size_t size) {
+    size_t 		block_size 	= (kHeaderSize + size + kGranule - 1) / kGranule * kGranule;
+    ArenaState* state 		= current_arena ? current_arena->state : NULL;
+    char* 		block 		= NULL;
+
+    if (state && block_size <= state->chunk_size / 4)
+        block = take_block(state, block_size);
+
+    if (!block) {
+        state = NULL;
+        block = (char*) malloc(block_size);
+        if (!block)
+            return (NULL);
+    }
+
+    NodeHeader* header = (NodeHeader*) block;
+    header->state 	= state;
+    header->size 	= block_size;
+
+    return (block + kHeaderSize);
+}
+
+
+// ---------------------------------------------------------------- release_node
+
+void
+SceneArena::release_node(void* p) {
+    if (!p)
+        return;
+
+    char* 		block 	= (char*) p - kHeaderSize;
+    ArenaState* state 	= ((NodeHeader*) block)->state;
+    size_t 		size 	= ((NodeHeader*) block)->size;
+
+    if (!state) {
+        free(block);
+        return;
+    }
+
+    bool last;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+
+        char*& head = state->free_blocks[size / kGranule];
+        *(char**) block = head;
+        head = block;
+
+        state->used -= size;
+        last = --state->live == 0;
+    }
+
+    if (last)
+        free_state(state);
+}
+
+
+// ---------------------------------------------------------------- ArenaAllocated operator new
+
+void*
+ArenaAllocated::operator new(const size_t size) {
+    void* p = SceneArena::allocate_node(size);
+    if (!p)
+        throw std::bad_alloc();
+
+    return (p);
+}
+
+
+// ---------------------------------------------------------------- ArenaAllocated operator delete
+
+void
+ArenaAllocated::operator delete(void* p) {
+    SceneArena::release_node(p);
+}
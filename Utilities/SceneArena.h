@@ -0,0 +1,89 @@
+#ifndef __SCENE_ARENA__
+#define __SCENE_ARENA__
+
+// Chunked allocation for the nodes of a scene.
+// The scene nodes of this tree (Placement, BVH, MailboxGrid, FlatScene, SphereSet and the
+// packet primitives) are ArenaAllocated: their class operator new takes memory from the
+// SceneArena of the calling thread's SceneArena::Scope while one is open, and from the heap
+// otherwise. Nothing else is affected: the library's objects, the materials and the vectors
+// inside the nodes are allocated as they always were.
+// An arena fills chunks of chunk_size bytes one after the other, so the nodes built in one
+// scope sit together, in the order they were built. A node deleted while its arena lives
+// gives its block back for the next node of the same size. The chunks are freed once both
+// the arena and every node allocated in it are gone, whichever goes last.
+// Nodes larger than a quarter of a chunk, and every node of an arena made with a chunk size
+// of 0, come from the heap.
+
+#include <cstddef>
+
+struct ArenaState;
+
+class SceneArena {
+    public:
+
+        class Scope {										// routes the calling thread's node allocations
+            public:
+
+                Scope(SceneArena& arena);
+
+                ~Scope(void);
+
+            private:
+
+                SceneArena* 	previous;
+
+                Scope(const Scope&);
+
+                Scope&
+                operator= (const Scope&);
+        };
+
+        SceneArena(const size_t chunk_size = kDefaultChunkSize);
+
+        ~SceneArena(void);
+
+        size_t
+        get_capacity(void) const;							// bytes in the chunks so far
+
+        size_t
+        get_used(void) const;								// bytes held by live nodes
+
+        size_t
+        get_live(void) const;								// nodes not yet deleted
+
+        static SceneArena*
+        current(void);										// the arena of the calling thread's scope, or NULL
+
+        static void*
+        allocate_node(const size_t size);					// from the current arena, or the heap; NULL if out of memory
+
+        static void
+        release_node(void* p);
+
+        static const size_t kDefaultChunkSize = (size_t) 1 << 20;
+
+    private:
+
+        ArenaState* 	state;								// NULL for a chunk size of 0
+
+        SceneArena(const SceneArena&);
+
+        SceneArena&
+        operator= (const SceneArena&);
+};
+
+
+// ---------------------------------------------------------------- ArenaAllocated
+// mixed into a scene node class; new and delete of the class go through the arena
+
+class ArenaAllocated {
+    public:
+
+        static void*
+        operator new(const size_t size);
+
+        static void
+        operator delete(void* p);
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "Animation.h"
+
+#include <future>
+
+#include "Cameras/Camera.h"
+#include "GeometricObjects/CompoundObjects/BVH.h"
+#include "GeometricObjects/Placement.h"
+#include "World/TileRenderer.h"
+#include "World/World.h"
+
+
+// ---------------------------------------------------------------- constructor
+
+Animation::Animation(World* w)
+    : 	w(w),
+        tracks(),
+        base_transforms(),
+        hierarchies(),
+        rebuild_growth(2.0),
+        num_rebuilds(0)
+{}
+
+
+// ---------------------------------------------------------------- add_track
+
+int
+Animation::add_track(Placement* placement_ptr) {
+    tracks.push_back(placement_ptr);
+    base_transforms.push_back(placement_ptr->get_matrix());
+
+    return (tracks.size() - 1);
+}
+
+
+// ---------------------------------------------------------------- add_hierarchy
+
+void
+Animation::add_hierarchy(BVH* bvh_ptr) {
+    hierarchies.push_back(bvh_ptr);
+}
+
+
+// ---------------------------------------------------------------- apply
+// moves the tracks and brings the trees up to date
+
+void
+Animation::apply(const AnimationFrame& state) {
+    for (int j = 0; j < (int) tracks.size(); j++) {
+        tracks[j]->reset_transform();
+        tracks[j]->transform(base_transforms[j]);
+        tracks[j]->transform(state.transforms[j]);
+    }
+
+    if (tracks.empty())
+        return;
+
+    for (BVH* bvh_ptr : hierarchies) {
+        if (bvh_ptr->refit() > rebuild_growth) {
+            bvh_ptr->setup_hierarchy();
+            num_rebuilds++;
+        }
+    }
+}
+
+
+// ---------------------------------------------------------------- render
+// two framebuffers alternate: the callback reads one while the next frame renders into
+// the other, and is waited for before that one is reused
+// a callback's false is only seen once the next frame has rendered; that frame is still
+// handed over, as the last
+
+int
+Animation::render(const TileRenderer& renderer, const int num_frames,
+                  const FrameFunction& describe, const FrameCallback& done) {
+    if (num_frames <= 0)
+        return (0);
+
+    int num_tracks = tracks.size();
+
+    auto describe_frame = [&describe, num_tracks](const int frame) {
+        AnimationFrame state;
+        state.transforms.assign(num_tracks, Matrix());
+        describe(frame, state);
+        return (state);
+    };
+
+    std::future<AnimationFrame> next = std::async(std::launch::async, describe_frame, 0);
+    std::future<bool> 			handed_over;
+    Framebuffer 				fbs[2];
+    int 						rendered = 0;
+
+    for (int frame = 0; frame < num_frames; frame++) {
+        AnimationFrame state = next.get();
+
+        if (frame + 1 < num_frames)
+            next = std::async(std::launch::async, describe_frame, frame + 1);
+
+        apply(state);
+
+        Framebuffer& fb = fbs[frame & 1];
+        bool ok 		= state.camera_ptr ? renderer.render(*w, state.camera_ptr.get(), fb) : renderer.render(*w, fb);
+        bool go_on 		= !handed_over.valid() || handed_over.get();
+
+        if (!ok)
+            break;
+
+        rendered++;
+        handed_over = std::async(std::launch::async, done, std::cref(fb), frame);
+
+        if (!go_on)
+            break;
+    }
+
+    if (handed_over.valid())
+        handed_over.get();
+
+    return (rendered);
+}
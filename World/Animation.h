@@ -0,0 +1,91 @@
+#ifndef __ANIMATION__
+#define __ANIMATION__
+
+// Renders a sequence of frames of one built world in which the camera and the transforms
+// of some placements change over time (a turntable, a craft on its way).
+// Each frame is described by an AnimationFrame: a camera and one matrix per track. A track
+// is a Placement; its matrix for the frame is applied after the transformation it had when
+// it was added. The BVHs that hold tracks are refitted, not rebuilt, when the tracks move,
+// and rebuilt only once refitting has loosened a tree by more than the rebuild growth.
+// Frames are pipelined: frame N + 1 is described on a second thread while frame N renders,
+// and frame N is handed to the callback (written to disk, say) while frame N + 1 renders.
+// The describing function must therefore not touch the world.
+// Add the tracks once the BVHs holding them are set up, since setup_hierarchy collapses
+// nested placements into their leaves.
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Utilities/Matrix.h"
+#include "World/Framebuffer.h"
+
+class BVH;
+class Camera;
+class Placement;
+class TileRenderer;
+class World;
+
+struct AnimationFrame {
+    std::unique_ptr<Camera> 	camera_ptr;			// null renders with the world's camera
+    std::vector<Matrix> 		transforms;			// one per track, the identity to leave it alone
+};
+
+// fills in frame number frame; runs on its own thread
+typedef std::function<void (const int frame, AnimationFrame& state)> FrameFunction;
+
+// called with every finished frame; return false to stop. The frame rendering meanwhile is
+// still handed over, and is the last
+typedef std::function<bool (const Framebuffer& fb, const int frame)> FrameCallback;
+
+class Animation {
+    public:
+
+        Animation(World* w);
+
+        int
+        add_track(Placement* placement_ptr);			// returns the track's index in transforms
+
+        void
+        add_hierarchy(BVH* bvh_ptr);					// refitted in the order added: inner trees first
+
+        void
+        set_rebuild_growth(const double growth);		// 2 by default
+
+        int
+        get_num_rebuilds(void) const;
+
+        int
+        render(const TileRenderer& renderer, const int num_frames,
+               const FrameFunction& describe, const FrameCallback& done);	// returns the frames handed over
+
+    private:
+
+        World* 					w;
+        std::vector<Placement*> tracks;
+        std::vector<Matrix> 	base_transforms;		// each track's transformation when it was added
+        std::vector<BVH*> 		hierarchies;
+        double 					rebuild_growth;
+        int 					num_rebuilds;
+
+        void
+        apply(const AnimationFrame& state);
+};
+
+
+// ---------------------------------------------------------------- set_rebuild_growth
+
+inline void
+Animation::set_rebuild_growth(const double growth) {
+    rebuild_growth = growth < 1.0 ? 1.0 : growth;
+}
+
+
+// ---------------------------------------------------------------- get_num_rebuilds
+
+inline int
+Animation::get_num_rebuilds(void) const {
+    return (num_rebuilds);
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef __DESK_LIGHTS__
+#define __DESK_LIGHTS__
+
+// Extra lighting for the working desk scene (Worlds.cpp): many lamps and the iPad's screen
+// as emitters of one LightTree, added to a desk that is already built.
+
+class LightTree;
+class World;
+
+LightTree* add_desk_lights(World* w, int num_lamps);
+
+#endif
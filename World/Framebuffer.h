@@ -0,0 +1,79 @@
+#ifndef __FRAMEBUFFER__
+#define __FRAMEBUFFER__
+
+// Linear radiance of a rendered frame, one RGBColor per pixel, before any tone mapping.
+// Pixels are addressed by (row, column) exactly as the cameras and ViewPlane address them,
+// with row 0 at the bottom of the image.
+
+#include <vector>
+
+#include "Utilities/RGBColor.h"
+
+class Framebuffer {
+    public:
+
+        int 					hres;
+        int 					vres;
+        std::vector<RGBColor> 	pixels;
+
+        Framebuffer(void);
+
+        Framebuffer(const int h, const int v);
+
+        void
+        resize(const int h, const int v);
+
+        RGBColor&
+        at(const int row, const int column);
+
+        const RGBColor&
+        at(const int row, const int column) const;
+};
+
+
+// ---------------------------------------------------------------- default constructor
+
+inline
+Framebuffer::Framebuffer(void)
+    : 	hres(0),
+        vres(0),
+        pixels()
+{}
+
+
+// ---------------------------------------------------------------- constructor
+
+inline
+Framebuffer::Framebuffer(const int h, const int v)
+    : 	hres(h),
+        vres(v),
+        pixels(h * v)
+{}
+
+
+// ---------------------------------------------------------------- resize
+
+inline void
+Framebuffer::resize(const int h, const int v) {
+    hres = h;
+    vres = v;
+    pixels.assign(h * v, RGBColor(0.0));
+}
+
+
+// ---------------------------------------------------------------- at
+
+inline RGBColor&
+Framebuffer::at(const int row, const int column) {
+    return (pixels[row * hres + column]);
+}
+
+
+// ---------------------------------------------------------------- at
+
+inline const RGBColor&
+Framebuffer::at(const int row, const int column) const {
+    return (pixels[row * hres + column]);
+}
+
+#endif
@@ -0,0 +1,613 @@
+#include "SceneCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <typeinfo>
+#include <vector>
+
+#include "GeometricObjects/BeveledObjects/PacketBeveledBox.h"
+#include "GeometricObjects/CompoundObjects/BVH.h"
+#include "GeometricObjects/CompoundObjects/Group.h"
+#include "GeometricObjects/CompoundObjects/PacketBox.h"
+#include "GeometricObjects/FlatScene.h"
+#include "GeometricObjects/Placement.h"
+#include "GeometricObjects/Primitives/Cone.h"
+#include "GeometricObjects/Primitives/PacketDisk.h"
+#include "GeometricObjects/Primitives/PacketPlane.h"
+#include "GeometricObjects/Primitives/PacketSphere.h"
+#include "GeometricObjects/Primitives/SphereSet.h"
+#include "GeometricObjects/Primitives/Tube.h"
+#include "GeometricObjects/Triangles/PacketTriangle.h"
+#include "Lights/Ambient.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialRegistry.h"
+#include "Tracers/ThreadSafeRayCast.h"
+#include "Utilities/MappedFile.h"
+#include "Utilities/ShadeRec.h"
+#include "World/SceneSettings.h"
+#include "World/World.h"
+
+static const char 		kMagic[8] 	= { 'W', 'D', 'R', 'S', 'C', 'E', 'N', 'E' };
+static const uint32_t 	kVersion 	= 2;
+
+// the view plane, background, camera and ambient light
+struct CachedView {
+    int32_t 	hres, vres, num_samples, show_out_of_gamut;
+    double 		pixel_size, gamma;
+    double 		background[3];
+    int32_t 	camera_model, has_ambient;
+    double 		eye[3], lookat[3], up[3];
+    double 		view_distance, zoom, focal_distance, lens_radius, fov;
+    double 		ambient[3];
+};
+
+struct CachedLight {
+    int32_t 	kind, shadows;
+    double 		v[3];
+    double 		radiance[3];
+    double 		normal[3];				// disk lights only
+    double 		radius;
+    int32_t 	num_samples, padding;
+};
+
+// each section starts on an 8 byte boundary; offsets are from the start of the file
+struct CacheHeader {
+    char 		magic[8];
+    uint32_t 	version;
+    uint32_t 	record_sizes[5];		// primitive, transform, node, material key, light
+    int32_t 	num_primitives, num_unbounded, num_transforms, num_nodes, num_materials, num_lights;
+    uint64_t 	primitives_offset, transforms_offset, nodes_offset, materials_offset, lights_offset;
+    CachedView 	view;
+};
+
+
+// ---------------------------------------------------------------- set_record_sizes
+
+static void
+set_record_sizes(uint32_t sizes[5]) {
+    sizes[0] = sizeof(FlatPrimitive);
+    sizes[1] = sizeof(FlatTransform);
+    sizes[2] = sizeof(BVHNode);
+    sizes[3] = sizeof(MaterialKey);
+    sizes[4] = sizeof(CachedLight);
+}
+
+
+// ---------------------------------------------------------------- to_flat
+// the 3 x 4 affine part of m
+
+static void
+to_flat(const Matrix& m, double flat[3][4]) {
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 4; j++)
+            flat[i][j] = m.m[i][j];
+}
+
+
+// ---------------------------------------------------------------- copy3
+
+static void
+copy3(double out[3], const double x, const double y, const double z) {
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+}
+
+
+// ---------------------------------------------------------------- Flattener
+// walks the objects of a world into primitive, transform and material records
+
+struct Flattener {
+    std::vector<FlatPrimitive> 			primitives;
+    std::vector<FlatTransform> 			transforms;
+    std::vector<MaterialKey> 			keys;
+    std::map<const Material*, int> 		material_indices;
+    std::string 						reason;
+
+    bool
+    add(GeometricObject* object_ptr, const Matrix& forward, const Matrix& inverse, const int transform,
+        const std::shared_ptr<Material>& outer_material);
+
+    bool
+    add_primitive(FlatPrimitive& primitive, GeometricObject* object_ptr, const int transform,
+                  const std::shared_ptr<Material>& outer_material);
+};
+
+
+// ---------------------------------------------------------------- add
+// the outermost placement with a material wins, as it does when the placements are hit
+
+bool
+Flattener::add(GeometricObject* object_ptr, const Matrix& forward, const Matrix& inverse, const int transform,
+               const std::shared_ptr<Material>& outer_material) {
+    FlatPrimitive primitive;
+    memset(&primitive, 0, sizeof(primitive));
+
+    if (PacketSphere* sphere_ptr = dynamic_cast<PacketSphere*>(object_ptr)) {
+        Point3D c = sphere_ptr->get_center();
+        primitive.type = FlatPrimitive::SPHERE;
+        copy3(primitive.p, c.x, c.y, c.z);
+        primitive.p[3] = sphere_ptr->get_radius();
+    }
+    else if (PacketPlane* plane_ptr = dynamic_cast<PacketPlane*>(object_ptr)) {
+        Point3D a = plane_ptr->get_point();
+        Normal n = plane_ptr->get_normal();
+        primitive.type = FlatPrimitive::PLANE;
+        copy3(primitive.p, a.x, a.y, a.z);
+        copy3(primitive.p + 3, n.x, n.y, n.z);
+    }
+    else if (PacketDisk* disk_ptr = dynamic_cast<PacketDisk*>(object_ptr)) {
+        Point3D c = disk_ptr->get_center();
+        Normal n = disk_ptr->get_normal();
+        double r = disk_ptr->get_radius();
+        primitive.type = FlatPrimitive::DISK;
+        copy3(primitive.p, c.x, c.y, c.z);
+        copy3(primitive.p + 3, n.x, n.y, n.z);
+        primitive.p[6] = r * r;
+    }
+    else if (PacketTriangle* triangle_ptr = dynamic_cast<PacketTriangle*>(object_ptr)) {
+        Point3D v0 = triangle_ptr->get_v0(), v1 = triangle_ptr->get_v1(), v2 = triangle_ptr->get_v2();
+        primitive.type = FlatPrimitive::TRIANGLE;
+        copy3(primitive.p, v0.x, v0.y, v0.z);
+        copy3(primitive.p + 3, v1.x, v1.y, v1.z);
+        copy3(primitive.p + 6, v2.x, v2.y, v2.z);
+    }
+    else if (PacketBox* box_ptr = dynamic_cast<PacketBox*>(object_ptr)) {
+        Point3D p0 = box_ptr->get_p0(), p1 = box_ptr->get_p1();
+        primitive.type = FlatPrimitive::BOX;
+        copy3(primitive.p, p0.x, p0.y, p0.z);
+        copy3(primitive.p + 3, p1.x, p1.y, p1.z);
+    }
+    else if (PacketBeveledBox* beveled_ptr = dynamic_cast<PacketBeveledBox*>(object_ptr)) {
+        Point3D p0 = beveled_ptr->get_p0(), p1 = beveled_ptr->get_p1();
+        primitive.type = FlatPrimitive::BEVELED_BOX;
+        copy3(primitive.p, p0.x, p0.y, p0.z);
+        copy3(primitive.p + 3, p1.x, p1.y, p1.z);
+        primitive.p[6] = beveled_ptr->get_bevel_radius();
+    }
+    else if (Tube* tube_ptr = dynamic_cast<Tube*>(object_ptr)) {
+        primitive.type = FlatPrimitive::TUBE;
+        primitive.p[0] = tube_ptr->get_bottom();
+        primitive.p[1] = tube_ptr->get_top();
+        primitive.p[2] = tube_ptr->get_inner_radius();
+        primitive.p[3] = tube_ptr->get_outer_radius();
+    }
+    else if (Cone* cone_ptr = dynamic_cast<Cone*>(object_ptr)) {
+        primitive.type = FlatPrimitive::CONE;
+        primitive.p[0] = cone_ptr->get_height();
+        primitive.p[1] = cone_ptr->get_radius();
+        primitive.p[2] = cone_ptr->is_closed() ? 1.0 : 0.0;
+    }
+    else if (SphereSet* set_ptr = dynamic_cast<SphereSet*>(object_ptr)) {
+        // each sphere becomes a primitive of its own, with its own material
+        primitive.type = FlatPrimitive::SPHERE;
+
+        for (int j = 0; j < set_ptr->get_num_spheres(); j++) {
+            Point3D c = set_ptr->get_center(j);
+            copy3(primitive.p, c.x, c.y, c.z);
+            primitive.p[3] = set_ptr->get_radius(j);
+
+            if (!add_primitive(primitive, object_ptr, transform, outer_material ? outer_material : set_ptr->get_sphere_material(j)))
+                return (false);
+        }
+        return (true);
+    }
+    else if (Placement* placement_ptr = dynamic_cast<Placement*>(object_ptr)) {
+        FlatTransform flat;
+        Matrix placement_forward = forward * placement_ptr->get_matrix();
+        Matrix placement_inverse = placement_ptr->get_inverse_matrix() * inverse;
+
+        to_flat(placement_forward, flat.forward);
+        to_flat(placement_inverse, flat.inverse);
+        transforms.push_back(flat);
+
+        return (add(placement_ptr->get_prototype().get(), placement_forward, placement_inverse,
+                    transforms.size() - 1, outer_material ? outer_material : placement_ptr->get_material()));
+    }
+    else if (Group* group_ptr = dynamic_cast<Group*>(object_ptr)) {
+        for (GeometricObject* child_ptr : group_ptr->get_objects())
+            if (!add(child_ptr, forward, inverse, transform, outer_material))
+                return (false);
+        return (true);
+    }
+    else {
+        reason = std::string("cannot cache a ") + typeid(*object_ptr).name();
+        return (false);
+    }
+
+    return (add_primitive(primitive, object_ptr, transform, outer_material));
+}
+
+
+// ---------------------------------------------------------------- add_primitive
+
+bool
+Flattener::add_primitive(FlatPrimitive& primitive, GeometricObject* object_ptr, const int transform,
+                         const std::shared_ptr<Material>& outer_material) {
+    std::shared_ptr<Material> material_ptr = outer_material ? outer_material : object_ptr->get_material();
+
+    primitive.transform = transform;
+    primitive.shadows 	= object_ptr->casts_shadows() ? 1 : 0;
+    primitive.material 	= -1;
+
+    if (material_ptr) {
+        std::map<const Material*, int>::const_iterator found = material_indices.find(material_ptr.get());
+
+        if (found != material_indices.end())
+            primitive.material = found->second;
+        else {
+            MaterialKey key;
+            if (!MaterialRegistry::shared().find_key(material_ptr.get(), key)) {
+                reason = std::string("cannot cache a material that is not in the registry: ") + typeid(*material_ptr).name();
+                return (false);
+            }
+
+            primitive.material = keys.size();
+            material_indices[material_ptr.get()] = primitive.material;
+            keys.push_back(key);
+        }
+    }
+
+    primitives.push_back(primitive);
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- write_section
+// pads the file to an 8 byte boundary first and returns where the section starts
+
+static uint64_t
+write_section(FILE* file, uint64_t& position, const void* data, const size_t size) {
+    static const char zeros[8] = { 0 };
+    size_t padding = (8 - position % 8) % 8;
+
+    fwrite(zeros, 1, padding, file);
+    position += padding;
+
+    uint64_t start = position;
+    if (size > 0)
+        fwrite(data, 1, size, file);
+    position += size;
+
+    return (start);
+}
+
+
+// ---------------------------------------------------------------- write
+
+bool
+SceneCache::write(World* w, const std::string& file_name, std::string& reason) {
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+
+    // view plane, camera and lights
+
+    CachedView& view = header.view;
+    view.hres 				= w->vp.hres;
+    view.vres 				= w->vp.vres;
+    view.num_samples 		= w->vp.num_samples;
+    view.show_out_of_gamut 	= w->vp.show_out_of_gamut;
+    view.pixel_size 		= w->vp.s;
+    view.gamma 				= w->vp.gamma;
+    copy3(view.background, w->background_color.r, w->background_color.g, w->background_color.b);
+
+    if (w->tracer_ptr && !dynamic_cast<RayCast*>(w->tracer_ptr)) {
+        reason = std::string("cannot cache the tracer ") + typeid(*w->tracer_ptr).name();
+        return (false);
+    }
+
+    CameraSettings camera;
+    if (w->camera_ptr && !camera.read(w->camera_ptr)) {
+        reason = std::string("cannot cache the camera ") + typeid(*w->camera_ptr).name();
+        return (false);
+    }
+
+    view.camera_model 	= w->camera_ptr ? camera.model : CameraSettings::NONE;
+    view.view_distance 	= camera.view_distance;
+    view.zoom 			= camera.zoom;
+    view.focal_distance = camera.focal_distance;
+    view.lens_radius 	= camera.lens_radius;
+    view.fov 			= camera.fov;
+    copy3(view.eye, camera.eye.x, camera.eye.y, camera.eye.z);
+    copy3(view.lookat, camera.lookat.x, camera.lookat.y, camera.lookat.z);
+    copy3(view.up, camera.up.x, camera.up.y, camera.up.z);
+
+    if (w->ambient_ptr) {
+        ShadeRec sr(*w);
+        RGBColor L = w->ambient_ptr->L(sr);
+        view.has_ambient = 1;
+        copy3(view.ambient, L.r, L.g, L.b);
+    }
+
+    std::vector<CachedLight> lights;
+
+    for (Light* light_ptr : w->lights) {
+        LightSettings settings;
+        if (!settings.read(w, light_ptr)) {
+            reason = std::string("cannot cache the light ") + typeid(*light_ptr).name();
+            return (false);
+        }
+
+        CachedLight light;
+        memset(&light, 0, sizeof(light));
+        light.kind 			= settings.kind;
+        light.shadows 		= settings.shadows;
+        light.radius 		= settings.radius;
+        light.num_samples 	= settings.num_samples;
+        copy3(light.v, settings.v.x, settings.v.y, settings.v.z);
+        copy3(light.radiance, settings.radiance.r, settings.radiance.g, settings.radiance.b);
+        copy3(light.normal, settings.normal.x, settings.normal.y, settings.normal.z);
+        lights.push_back(light);
+    }
+
+    // geometry
+
+    Flattener flattener;
+    Matrix identity;
+
+    for (GeometricObject* object_ptr : w->objects)
+        if (!flattener.add(object_ptr, identity, identity, -1, std::shared_ptr<Material>())) {
+            reason = flattener.reason;
+            return (false);
+        }
+
+    // planes first, then the bounded primitives in the order of the tree's leaves
+
+    std::vector<FlatPrimitive> 	ordered;
+    std::vector<FlatPrimitive> 	bounded;
+    std::vector<BBox> 			boxes;
+
+    for (const FlatPrimitive& primitive : flattener.primitives)
+        if (primitive.type == FlatPrimitive::PLANE)
+            ordered.push_back(primitive);
+        else {
+            bounded.push_back(primitive);
+            boxes.push_back(FlatScene::primitive_bounds(primitive, flattener.transforms.data()));
+        }
+
+    int num_unbounded = ordered.size();
+
+    std::vector<BVHNode> 	nodes;
+    std::vector<int> 		order;
+    BVH::build_tree(boxes, 2, nodes, order);
+
+    for (int index : order)
+        ordered.push_back(bounded[index]);
+
+    for (BVHNode& node : nodes)
+        if (node.count > 0)
+            node.offset += num_unbounded;
+
+    // the header is written last, once the offsets are known
+
+    FILE* file = fopen(file_name.c_str(), "wb");
+    if (!file) {
+        reason = "cannot create " + file_name;
+        return (false);
+    }
+
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version 			= kVersion;
+    set_record_sizes(header.record_sizes);
+    header.num_primitives 	= ordered.size();
+    header.num_unbounded 	= num_unbounded;
+    header.num_transforms 	= flattener.transforms.size();
+    header.num_nodes 		= nodes.size();
+    header.num_materials 	= flattener.keys.size();
+    header.num_lights 		= lights.size();
+
+    uint64_t position = 0;
+    write_section(file, position, &header, sizeof(header));
+
+    header.primitives_offset 	= write_section(file, position, ordered.data(), ordered.size() * sizeof(FlatPrimitive));
+    header.transforms_offset 	= write_section(file, position, flattener.transforms.data(),
+                                                flattener.transforms.size() * sizeof(FlatTransform));
+    header.nodes_offset 		= write_section(file, position, nodes.data(), nodes.size() * sizeof(BVHNode));
+    header.materials_offset 	= write_section(file, position, flattener.keys.data(), flattener.keys.size() * sizeof(MaterialKey));
+    header.lights_offset 		= write_section(file, position, lights.data(), lights.size() * sizeof(CachedLight));
+
+    bool written = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    written = fclose(file) == 0 && written;
+
+    if (!written) {
+        reason = "cannot write " + file_name;
+        remove(file_name.c_str());
+    }
+
+    return (written);
+}
+
+
+// ---------------------------------------------------------------- section_fits
+
+static bool
+section_fits(const uint64_t offset, const int32_t count, const size_t record_size, const size_t file_size) {
+    return (count >= 0 && offset % 8 == 0 && offset <= file_size
+         && (uint64_t) count * record_size <= file_size - offset);
+}
+
+
+// ---------------------------------------------------------------- records_valid
+// every index in the records must point inside its section, the planes must come first, and
+// the tree must only point forwards and be shallow enough for FlatScene's traversal stack
+
+static bool
+records_valid(const CacheHeader* header, const char* data) {
+    const FlatPrimitive* 	primitives 	= (const FlatPrimitive*) (data + header->primitives_offset);
+    const BVHNode* 			nodes 		= (const BVHNode*) (data + header->nodes_offset);
+    const MaterialKey* 		keys 		= (const MaterialKey*) (data + header->materials_offset);
+
+    for (int j = 0; j < header->num_primitives; j++) {
+        const FlatPrimitive& primitive = primitives[j];
+
+        if (primitive.type < FlatPrimitive::SPHERE || primitive.type > FlatPrimitive::CONE
+                || (primitive.type == FlatPrimitive::PLANE) != (j < header->num_unbounded)
+                || primitive.material < -1 || primitive.material >= header->num_materials
+                || primitive.transform < -1 || primitive.transform >= header->num_transforms)
+            return (false);
+    }
+
+    std::vector<int> depth(header->num_nodes, 0);
+
+    for (int j = 0; j < header->num_nodes; j++) {
+        const BVHNode& node = nodes[j];
+
+        if (depth[j] >= kBVHStackSize)
+            return (false);
+
+        if (node.count > 0) {
+            if (node.offset < header->num_unbounded || node.offset > header->num_primitives - node.count)
+                return (false);
+        }
+        else if (node.count < 0 || j + 1 >= header->num_nodes || node.offset <= j + 1 || node.offset >= header->num_nodes)
+            return (false);
+        else {
+            depth[j + 1] 		= std::max(depth[j + 1], depth[j] + 1);
+            depth[node.offset] 	= std::max(depth[node.offset], depth[j] + 1);
+        }
+    }
+
+    for (int j = 0; j < header->num_materials; j++)
+        if (keys[j].choice < MaterialKey::CHECKER_PARAMETERS || keys[j].choice > TRANSPARENTS)
+            return (false);
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- load
+// the World is only changed once the file has been checked
+
+bool
+SceneCache::load(World* w, const std::string& file_name, std::string& reason) {
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+
+    if (!file->open(file_name)) {
+        reason = "cannot open " + file_name;
+        return (false);
+    }
+
+    const char* data = file->data();
+    size_t 		size = file->size();
+
+    uint32_t sizes[5];
+    set_record_sizes(sizes);
+
+    const CacheHeader* header = (const CacheHeader*) data;
+
+    if (size < sizeof(CacheHeader) || memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+        reason = file_name + " is not a scene cache";
+        return (false);
+    }
+
+    if (header->version != kVersion || memcmp(header->record_sizes, sizes, sizeof(sizes)) != 0) {
+        reason = file_name + " was written by a different build";
+        return (false);
+    }
+
+    if (!section_fits(header->primitives_offset, header->num_primitives, sizeof(FlatPrimitive), size)
+            || !section_fits(header->transforms_offset, header->num_transforms, sizeof(FlatTransform), size)
+            || !section_fits(header->nodes_offset, header->num_nodes, sizeof(BVHNode), size)
+            || !section_fits(header->materials_offset, header->num_materials, sizeof(MaterialKey), size)
+            || !section_fits(header->lights_offset, header->num_lights, sizeof(CachedLight), size)
+            || header->num_unbounded < 0 || header->num_unbounded > header->num_primitives) {
+        reason = file_name + " is truncated";
+        return (false);
+    }
+
+    if (!records_valid(header, data)) {
+        reason = file_name + " is corrupt";
+        return (false);
+    }
+
+    // view plane, camera and lights
+
+    const CachedView& view = header->view;
+
+    w->vp.set_hres(view.hres);
+    w->vp.set_vres(view.vres);
+    w->vp.set_pixel_size(view.pixel_size);
+    w->vp.set_gamma(view.gamma);
+    w->vp.set_gamut_display(view.show_out_of_gamut != 0);
+    w->vp.set_samples(view.num_samples);
+    w->background_color = RGBColor(view.background[0], view.background[1], view.background[2]);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
+
+    if (view.camera_model != CameraSettings::NONE) {
+        CameraSettings camera;
+        camera.model 			= view.camera_model;
+        camera.eye 				= Point3D(view.eye[0], view.eye[1], view.eye[2]);
+        camera.lookat 			= Point3D(view.lookat[0], view.lookat[1], view.lookat[2]);
+        camera.up 				= Vector3D(view.up[0], view.up[1], view.up[2]);
+        camera.view_distance 	= view.view_distance;
+        camera.zoom 			= view.zoom;
+        camera.focal_distance 	= view.focal_distance;
+        camera.lens_radius 		= view.lens_radius;
+        camera.fov 				= view.fov;
+        w->set_camera(camera.make(view.num_samples));
+    }
+
+    if (view.has_ambient) {
+        Ambient* ambient_ptr = new Ambient;
+        ambient_ptr->scale_radiance(1.0);
+        ambient_ptr->set_color(RGBColor(view.ambient[0], view.ambient[1], view.ambient[2]));
+        w->set_ambient_light(ambient_ptr);
+    }
+
+    const CachedLight* lights = (const CachedLight*) (data + header->lights_offset);
+
+    for (int j = 0; j < header->num_lights; j++) {
+        LightSettings light;
+        light.kind 			= lights[j].kind;
+        light.shadows 		= lights[j].shadows != 0;
+        light.v 			= Vector3D(lights[j].v[0], lights[j].v[1], lights[j].v[2]);
+        light.radiance 		= RGBColor(lights[j].radiance[0], lights[j].radiance[1], lights[j].radiance[2]);
+        light.normal 		= Normal(lights[j].normal[0], lights[j].normal[1], lights[j].normal[2]);
+        light.radius 		= lights[j].radius;
+        light.num_samples 	= lights[j].num_samples;
+
+        if (Light* light_ptr = light.make())
+            w->add_light(light_ptr);
+    }
+
+    // materials, through the registry so that they are shared with anything built later;
+    // it is cleared first, as a top-level builder does
+
+    MaterialRegistry& registry = MaterialRegistry::shared();
+    registry.clear();
+    const MaterialKey* keys = (const MaterialKey*) (data + header->materials_offset);
+    std::vector<std::shared_ptr<Material> > materials;
+
+    for (int j = 0; j < header->num_materials; j++) {
+        const MaterialKey& key = keys[j];
+        RGBColor color(key.r, key.g, key.b);
+
+        if (key.choice == MaterialKey::WORLD_DEFAULT)
+            materials.push_back(registry.get(w, color));
+        else if (key.choice == MaterialKey::PHONG_PARAMETERS)
+            materials.push_back(registry.get_phong(color, key.ka, key.kd, key.ks, key.exp));
+        else if (key.choice == MaterialKey::MATTE_PARAMETERS)
+            materials.push_back(registry.get_matte(color, key.ka, key.kd));
+        else if (key.choice == MaterialKey::CHECKER_PARAMETERS)
+            materials.push_back(registry.get_checker(color, RGBColor(key.ka, key.kd, key.ks), key.exp));
+        else
+            materials.push_back(registry.get(w, (MATERIAL_CHOICE) key.choice, color));
+    }
+
+    // geometry, in place
+
+    FlatScene* scene_ptr = new FlatScene;
+    scene_ptr->set_geometry((const FlatPrimitive*) (data + header->primitives_offset),
+                            header->num_primitives, header->num_unbounded,
+                            (const FlatTransform*) (data + header->transforms_offset),
+                            (const BVHNode*) (data + header->nodes_offset), header->num_nodes,
+                            std::shared_ptr<const void>(file, file.get()));
+    scene_ptr->set_materials(materials);
+    w->add_object(scene_ptr);
+
+    return (true);
+}
@@ -0,0 +1,34 @@
+#ifndef __SCENE_CACHE__
+#define __SCENE_CACHE__
+
+// A binary image of a built World, so that a scene is constructed once and later runs start
+// rendering straight away.
+// write flattens the objects into FlatScene records (every placement chain resolved into one
+// transform per primitive), interns their materials by MaterialRegistry key, builds the BVH
+// over them and stores all of it, with the view plane, camera and lights, as fixed-size
+// records. load maps the file and points a FlatScene at the records in place: nothing is
+// parsed, and only the few materials, the camera and the lights are created.
+// Only what can be described exactly is cached: the packet primitives, tubes and cones,
+// placements, groups (Group, BVH, MailboxGrid), materials from the registry (checkers
+// included), the cameras and lights of CameraSettings and LightSettings (disk lights
+// included) and the RayCast tracer. write returns false, with the reason, for any other
+// scene, which then has to be built every time.
+// A cache file belongs to one machine's build: it is native-endian, and is rejected if its
+// version or record sizes differ, and if any index in its records points outside its section.
+// Delete it after changing the scene it was made from.
+
+#include <string>
+
+class World;
+
+class SceneCache {
+    public:
+
+        static bool
+        write(World* w, const std::string& file_name, std::string& reason);
+
+        static bool
+        load(World* w, const std::string& file_name, std::string& reason);
+};
+
+#endif
@@ -0,0 +1,536 @@
+#include "SceneReader.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "GeometricObjects/BeveledObjects/PacketBeveledBox.h"
+#include "GeometricObjects/CompoundObjects/BVH.h"
+#include "GeometricObjects/CompoundObjects/Group.h"
+#include "GeometricObjects/CompoundObjects/MailboxGrid.h"
+#include "GeometricObjects/CompoundObjects/PacketBox.h"
+#include "GeometricObjects/Placement.h"
+#include "GeometricObjects/Primitives/PacketDisk.h"
+#include "GeometricObjects/Primitives/PacketPlane.h"
+#include "GeometricObjects/Primitives/PacketSphere.h"
+#include "GeometricObjects/Triangles/PacketTriangle.h"
+#include "Lights/Ambient.h"
+#include "Materials/MaterialRegistry.h"
+#include "Tracers/ThreadSafeRayCast.h"
+#include "World/SceneSettings.h"
+#include "World/World.h"
+
+// the MATERIAL_CHOICE names, in enum order
+static const char* kChoices[] = { "DIELECTRIC", "EMISSIVE", "GLOSSYREFLECTOR", "MATTE", "PHONG",
+                                  "PLASTIC", "REFLECTIVE", "SV_MATTE", "TRANSPARENTS" };
+
+// longest number token read; %.9g never writes more than 16 characters
+static const int kMaxNumberLength = 63;
+
+
+// ---------------------------------------------------------------- constructor
+
+SceneReader::SceneReader(World* world)
+    : 	w(world),
+        source(),
+        line(0),
+        tokens(),
+        next(0),
+        blocks(),
+        materials(),
+        prototypes()
+{}
+
+
+// ---------------------------------------------------------------- read
+
+void
+SceneReader::read(const std::string& file_name) {
+    FILE* file = fopen(file_name.c_str(), "rb");
+    if (!file)
+        throw new std::invalid_argument("Cannot open scene file: " + file_name + "\n");
+
+    std::vector<char> text;
+    char 	buffer[65536];
+    size_t 	n;
+
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.insert(text.end(), buffer, buffer + n);
+
+    fclose(file);
+
+    parse(text.data(), text.size(), file_name);
+}
+
+
+// ---------------------------------------------------------------- parse
+// splits each line into tokens in place and runs its statement
+
+void
+SceneReader::parse(const char* text, const size_t size, const std::string& source_name) {
+    source 	= source_name;
+    line 	= 0;
+    blocks.clear();
+    MaterialRegistry::shared().clear();
+
+    const char* end = text + size;
+    const char* p 	= text;
+
+    while (p < end) {
+        const char* eol = (const char*) memchr(p, '\n', end - p);
+        if (!eol)
+            eol = end;
+
+        line++;
+        tokens.clear();
+        next = 0;
+
+        for (const char* q = p; q < eol; ) {
+            if (*q == '#')
+                break;
+
+            if (*q == ' ' || *q == '\t' || *q == '\r') {
+                q++;
+                continue;
+            }
+
+            Token token;
+            token.start = q;
+
+            while (q < eol && *q != ' ' && *q != '\t' && *q != '\r' && *q != '#')
+                q++;
+
+            token.length = q - token.start;
+            tokens.push_back(token);
+        }
+
+        if (!tokens.empty())
+            statement();
+
+        p = eol + 1;
+    }
+
+    if (!blocks.empty())
+        fail("unclosed " + blocks.back().kind + " block");
+
+    if (!w->tracer_ptr)
+        w->tracer_ptr = new ThreadSafeRayCast(w);
+}
+
+
+// ---------------------------------------------------------------- statement
+
+void
+SceneReader::statement(void) {
+    std::string keyword = word();
+
+    if (keyword == "}")
+        close_block();
+    else if (keyword == "viewplane") {
+        w->vp.set_hres(integer());
+        w->vp.set_vres(integer());
+        w->vp.set_pixel_size(number());
+        w->vp.set_samples(integer());
+        if (!at_end())
+            w->vp.set_gamma(number());
+    }
+    else if (keyword == "background")
+        w->background_color = color();
+    else if (keyword == "tracer") {
+        if (word() != "raycast")
+            fail("only the raycast tracer can be read");
+        w->tracer_ptr = new ThreadSafeRayCast(w);
+    }
+    else if (keyword == "camera")
+        read_camera();
+    else if (keyword == "ambient") {
+        Ambient* ambient_ptr = new Ambient;
+        ambient_ptr->scale_radiance(number());
+        ambient_ptr->set_color(color());
+        w->set_ambient_light(ambient_ptr);
+    }
+    else if (keyword == "light")
+        read_light();
+    else if (keyword == "material")
+        read_material();
+    else if (keyword == "sphere") {
+        std::shared_ptr<Material> material_ptr = material();
+        Point3D center = point();
+        add(new PacketSphere(center, number()), material_ptr);
+    }
+    else if (keyword == "plane") {
+        std::shared_ptr<Material> material_ptr = material();
+        Point3D a = point();
+        Vector3D n = direction();
+        add(new PacketPlane(a, Normal(n.x, n.y, n.z)), material_ptr);
+    }
+    else if (keyword == "disk") {
+        std::shared_ptr<Material> material_ptr = material();
+        Point3D center = point();
+        Vector3D n = direction();
+        add(new PacketDisk(center, Normal(n.x, n.y, n.z), number()), material_ptr);
+    }
+    else if (keyword == "triangle") {
+        std::shared_ptr<Material> material_ptr = material();
+        Point3D v0 = point();
+        Point3D v1 = point();
+        add(new PacketTriangle(v0, v1, point()), material_ptr);
+    }
+    else if (keyword == "box") {
+        std::shared_ptr<Material> material_ptr = material();
+        Point3D p0 = point();
+        add(new PacketBox(p0, point()), material_ptr);
+    }
+    else if (keyword == "beveled_box") {
+        std::shared_ptr<Material> material_ptr = material();
+        Point3D p0 = point();
+        Point3D p1 = point();
+        add(new PacketBeveledBox(p0, p1, number()), material_ptr);
+    }
+    else if (keyword == "instance")
+        read_instance();
+    else if (keyword == "bvh" || keyword == "grid" || keyword == "compound" || keyword == "prototype")
+        open_block(keyword);
+    else
+        fail("unknown statement '" + keyword + "'");
+
+    if (!at_end())
+        fail("unexpected '" + word() + "'");
+}
+
+
+// ---------------------------------------------------------------- read_camera
+
+void
+SceneReader::read_camera(void) {
+    CameraSettings camera;
+    std::string model = word();
+
+    camera.eye 		= point();
+    camera.lookat 	= point();
+    camera.up 		= direction();
+
+    if (model == "pinhole") {
+        camera.model 			= CameraSettings::PINHOLE;
+        camera.view_distance 	= number();
+        camera.zoom 			= number();
+    }
+    else if (model == "thinlens") {
+        camera.model 			= CameraSettings::THIN_LENS;
+        camera.view_distance 	= number();
+        camera.zoom 			= number();
+        camera.focal_distance 	= number();
+        camera.lens_radius 		= number();
+    }
+    else if (model == "fisheye") {
+        camera.model 	= CameraSettings::FISHEYE;
+        camera.fov 		= number();
+    }
+    else
+        fail("unknown camera '" + model + "'");
+
+    w->set_camera(camera.make(w->vp.num_samples));
+}
+
+
+// ---------------------------------------------------------------- read_light
+
+void
+SceneReader::read_light(void) {
+    LightSettings light;
+    std::string kind = word();
+
+    if (kind == "point")
+        light.kind = LightSettings::POINT;
+    else if (kind == "directional")
+        light.kind = LightSettings::DIRECTIONAL;
+    else
+        fail("unknown light '" + kind + "'");
+
+    light.v 			= direction();
+    float ls 			= number();
+    light.radiance 		= color() * ls;
+    light.shadows 		= integer() != 0;
+
+    w->add_light(light.make());
+}
+
+
+// ---------------------------------------------------------------- read_material
+
+void
+SceneReader::read_material(void) {
+    MaterialRegistry& registry = MaterialRegistry::shared();
+
+    std::string name = word();
+    std::string kind = word();
+    std::shared_ptr<Material> material_ptr;
+
+    if (kind == "default")
+        material_ptr = registry.get(w, color());
+    else if (kind == "phong") {
+        RGBColor c = color();
+        float ka = number(), kd = number(), ks = number();
+        material_ptr = registry.get_phong(c, ka, kd, ks, number());
+    }
+    else if (kind == "matte") {
+        RGBColor c = color();
+        float ka = number();
+        material_ptr = registry.get_matte(c, ka, number());
+    }
+    else if (kind == "checker") {
+        RGBColor c1 = color();
+        RGBColor c2 = color();
+        material_ptr = registry.get_checker(c1, c2, number());
+    }
+    else {
+        int choice = 0;
+        while (choice < (int) (sizeof(kChoices) / sizeof(kChoices[0])) && kind != kChoices[choice])
+            choice++;
+
+        if (choice == (int) (sizeof(kChoices) / sizeof(kChoices[0])))
+            fail("unknown material kind '" + kind + "'");
+
+        material_ptr = registry.get(w, (MATERIAL_CHOICE) choice, color());
+    }
+
+    materials[name] = material_ptr;
+}
+
+
+// ---------------------------------------------------------------- read_instance
+
+void
+SceneReader::read_instance(void) {
+    std::shared_ptr<Material> material_ptr = material();
+    std::string name = word();
+
+    std::map<std::string, std::shared_ptr<GeometricObject> >::const_iterator found = prototypes.find(name);
+    if (found == prototypes.end())
+        fail("unknown prototype '" + name + "'");
+
+    Placement* placement_ptr = new Placement(found->second);
+
+    while (!at_end()) {
+        std::string op = word();
+
+        if (op == "translate")
+            placement_ptr->translate(direction());
+        else if (op == "scale")
+            placement_ptr->scale(direction());
+        else if (op == "rotate_x")
+            placement_ptr->rotate_x(number());
+        else if (op == "rotate_y")
+            placement_ptr->rotate_y(number());
+        else if (op == "rotate_z")
+            placement_ptr->rotate_z(number());
+        else if (op == "matrix") {
+            Matrix m;
+            for (int i = 0; i < 3; i++)
+                for (int j = 0; j < 4; j++)
+                    m.m[i][j] = number();
+            placement_ptr->transform(m);
+        }
+        else {
+            delete placement_ptr;
+            fail("unknown transformation '" + op + "'");
+        }
+    }
+
+    add(placement_ptr, material_ptr);
+}
+
+
+// ---------------------------------------------------------------- open_block
+
+void
+SceneReader::open_block(const std::string& kind) {
+    Block block;
+    block.kind 			= kind;
+    block.compound_ptr 	= NULL;
+
+    std::shared_ptr<Material> material_ptr;
+
+    if (kind == "prototype")
+        block.name = word();
+    else
+        material_ptr = material();
+
+    if (word() != "{")
+        fail("expected '{'");
+
+    if (kind == "bvh")
+        block.compound_ptr = new BVH;
+    else if (kind == "grid")
+        block.compound_ptr = new MailboxGrid;
+    else if (kind == "compound")
+        block.compound_ptr = new Group;
+
+    if (block.compound_ptr && material_ptr)
+        block.compound_ptr->set_material(material_ptr);
+
+    blocks.push_back(block);
+}
+
+
+// ---------------------------------------------------------------- close_block
+// a compound's material is set when its block opens, so it applies to the children that
+// have none of their own only where Compound::set_material says so
+
+void
+SceneReader::close_block(void) {
+    if (blocks.empty())
+        fail("'}' without a block");
+
+    Block block = blocks.back();
+    blocks.pop_back();
+
+    if (block.kind == "prototype") {
+        if (block.members.empty())
+            fail("empty prototype '" + block.name + "'");
+
+        if (block.members.size() == 1)
+            prototypes[block.name] = std::shared_ptr<GeometricObject>(block.members[0]);
+        else {
+            BVH* bvh_ptr = new BVH;
+            for (GeometricObject* object_ptr : block.members)
+                bvh_ptr->add_object(object_ptr);
+            bvh_ptr->setup_hierarchy();
+            prototypes[block.name] = std::shared_ptr<GeometricObject>(bvh_ptr);
+        }
+
+        return;
+    }
+
+    if (block.kind == "bvh")
+        static_cast<BVH*>(block.compound_ptr)->setup_hierarchy();
+    else if (block.kind == "grid")
+        static_cast<MailboxGrid*>(block.compound_ptr)->setup_cells();
+
+    add(block.compound_ptr, std::shared_ptr<Material>());
+}
+
+
+// ---------------------------------------------------------------- add
+// into the innermost open block, or the world
+
+void
+SceneReader::add(GeometricObject* object_ptr, const std::shared_ptr<Material>& material_ptr) {
+    if (material_ptr)
+        object_ptr->set_material(material_ptr);
+
+    if (blocks.empty())
+        w->add_object(object_ptr);
+    else if (blocks.back().compound_ptr)
+        blocks.back().compound_ptr->add_object(object_ptr);
+    else
+        blocks.back().members.push_back(object_ptr);
+}
+
+
+// ---------------------------------------------------------------- word
+
+std::string
+SceneReader::word(void) {
+    if (at_end())
+        fail("statement ends too soon");
+
+    const Token& token = tokens[next++];
+    return (std::string(token.start, token.length));
+}
+
+
+// ---------------------------------------------------------------- number
+// tokens point into the source and are not terminated, so the token is copied out first
+
+double
+SceneReader::number(void) {
+    if (at_end())
+        fail("statement ends too soon");
+
+    const Token& token = tokens[next++];
+    char buffer[kMaxNumberLength + 1];
+
+    if (token.length > kMaxNumberLength)
+        fail("expected a number, not '" + std::string(token.start, token.length) + "'");
+
+    memcpy(buffer, token.start, token.length);
+    buffer[token.length] = '\0';
+
+    char* end;
+    double value = strtod(buffer, &end);
+
+    if (end != buffer + token.length)
+        fail("expected a number, not '" + std::string(token.start, token.length) + "'");
+
+    return (value);
+}
+
+
+// ---------------------------------------------------------------- integer
+
+int
+SceneReader::integer(void) {
+    return ((int) number());
+}
+
+
+// ---------------------------------------------------------------- point
+
+Point3D
+SceneReader::point(void) {
+    double x = number(), y = number();
+    return (Point3D(x, y, number()));
+}
+
+
+// ---------------------------------------------------------------- direction
+
+Vector3D
+SceneReader::direction(void) {
+    double x = number(), y = number();
+    return (Vector3D(x, y, number()));
+}
+
+
+// ---------------------------------------------------------------- color
+
+RGBColor
+SceneReader::color(void) {
+    float r = number(), g = number();
+    return (RGBColor(r, g, number()));
+}
+
+
+// ---------------------------------------------------------------- material
+// '-' is no material
+
+std::shared_ptr<Material>
+SceneReader::material(void) {
+    std::string name = word();
+    if (name == "-")
+        return (std::shared_ptr<Material>());
+
+    std::map<std::string, std::shared_ptr<Material> >::const_iterator found = materials.find(name);
+    if (found == materials.end())
+        fail("unknown material '" + name + "'");
+
+    return (found->second);
+}
+
+
+// ---------------------------------------------------------------- at_end
+
+bool
+SceneReader::at_end(void) const {
+    return (next >= (int) tokens.size());
+}
+
+
+// ---------------------------------------------------------------- fail
+
+void
+SceneReader::fail(const std::string& message) const {
+    throw new std::invalid_argument(source + ":" + std::to_string(line) + ": " + message + "\n");
+}
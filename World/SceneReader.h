@@ -0,0 +1,145 @@
+#ifndef __SCENE_READER__
+#define __SCENE_READER__
+
+// Builds a World from a scene file, so a layout can be changed without recompiling.
+// The format is line based: one statement per line, words separated by blanks, '#' starts
+// a comment. Points, vectors and colours are three numbers.
+//
+//	viewplane <hres> <vres> <pixel size> <samples> [<gamma>]
+//	background <colour>
+//	tracer raycast
+//	camera pinhole <eye> <lookat> <up> <view distance> <zoom>
+//	camera thinlens <eye> <lookat> <up> <view distance> <zoom> <focal distance> <lens radius>
+//	camera fisheye <eye> <lookat> <up> <fov>
+//	ambient <radiance> <colour>
+//	light point <location> <radiance> <colour> <shadows 0|1>
+//	light directional <direction> <radiance> <colour> <shadows 0|1>
+//	material <name> default <colour>						as World::set_material(obj, colour)
+//	material <name> <MATERIAL_CHOICE> <colour>				as World::set_material(obj, choice, colour)
+//	material <name> phong <colour> <ka> <kd> <ks> <exp>
+//	material <name> matte <colour> <ka> <kd>
+//	material <name> checker <colour> <colour> <size>		as build_checkerboard(obj, colour, colour, size)
+//	sphere <material> <centre> <radius>
+//	plane <material> <point> <normal>
+//	disk <material> <centre> <normal> <radius>
+//	triangle <material> <v0> <v1> <v2>
+//	box <material> <p0> <p1>
+//	beveled_box <material> <p0> <p1> <bevel radius>
+//	instance <material> <prototype> [translate <v> | scale <v> | rotate_x|rotate_y|rotate_z <degrees>
+//	                                 | matrix <12 numbers, row by row>]...
+//	bvh|grid|compound <material> {
+//		<objects>
+//	}
+//	prototype <name> {
+//		<objects>
+//	}
+//
+// A <material> is the name of a material defined earlier, or '-' for none. Objects inside
+// a block go into that compound, which is set up when the block closes. A prototype is
+// shared geometry for instances: a single object is used as it is, several are put in a BVH.
+// Materials are interned in MaterialRegistry::shared(), as the builders' are; parse clears
+// it first, as a top-level builder does.
+// The whole file is read into memory and parsed in place; errors throw
+// std::invalid_argument* naming the file and line, as the builders do for bad arguments.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Utilities/Point3D.h"
+#include "Utilities/RGBColor.h"
+#include "Utilities/Vector3D.h"
+
+class Compound;
+class GeometricObject;
+class Material;
+class World;
+
+class SceneReader {
+    public:
+
+        SceneReader(World* w);
+
+        void
+        read(const std::string& file_name);
+
+        void
+        parse(const char* text, const size_t size, const std::string& source_name);
+
+    private:
+
+        struct Token {
+            const char* 	start;
+            int 			length;
+        };
+
+        struct Block {
+            std::string 					kind;				// bvh, grid, compound or prototype
+            std::string 					name;				// prototype name
+            Compound* 						compound_ptr;
+            std::vector<GeometricObject*> 	members;			// prototype contents
+        };
+
+        World* 															w;
+        std::string 													source;
+        int 															line;
+        std::vector<Token> 												tokens;
+        int 															next;
+        std::vector<Block> 												blocks;
+        std::map<std::string, std::shared_ptr<Material> > 				materials;
+        std::map<std::string, std::shared_ptr<GeometricObject> > 		prototypes;
+
+        void
+        statement(void);
+
+        void
+        read_camera(void);
+
+        void
+        read_light(void);
+
+        void
+        read_material(void);
+
+        void
+        read_instance(void);
+
+        void
+        open_block(const std::string& kind);
+
+        void
+        close_block(void);
+
+        void
+        add(GeometricObject* object_ptr, const std::shared_ptr<Material>& material_ptr);
+
+        std::string
+        word(void);
+
+        double
+        number(void);
+
+        int
+        integer(void);
+
+        Point3D
+        point(void);
+
+        Vector3D
+        direction(void);
+
+        RGBColor
+        color(void);
+
+        std::shared_ptr<Material>
+        material(void);
+
+        bool
+        at_end(void) const;
+
+        void
+        fail(const std::string& message) const;
+};
+
+#endif
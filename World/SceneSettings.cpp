@@ -0,0 +1,217 @@
+#include "SceneSettings.h"
+
+#include <cmath>
+
+#include "Cameras/Fisheye.h"
+#include "Cameras/Pinhole.h"
+#include "Cameras/ThinLens.h"
+#include "Lights/CachedDirectional.h"
+#include "Lights/Directional.h"
+#include "Lights/DiskLight.h"
+#include "Lights/PointLight.h"
+#include "Samplers/MultiJittered.h"
+#include "Utilities/Constants.h"
+#include "Utilities/ShadeRec.h"
+#include "World/World.h"
+
+
+// ---------------------------------------------------------------- default constructor
+
+CameraSettings::CameraSettings(void)
+    : 	model(NONE),
+        eye(0, 0, 500),
+        lookat(0),
+        up(0, 1, 0),
+        view_distance(500),
+        zoom(1),
+        focal_distance(500),
+        lens_radius(1),
+        fov(180)
+{}
+
+
+// ---------------------------------------------------------------- read
+// the view distance comes from the slope of the ray through a pixel at x = 1, the focal
+// distance from the ray from a lens point at x = 1 through the centre, the field of view
+// from the ray at the fisheye's rim; up is written as v, which gives the same frame
+
+bool
+CameraSettings::read(const Camera* camera_ptr) {
+    Vector3D u = camera_ptr->get_u();
+    Vector3D w = camera_ptr->get_w();
+
+    eye 	= camera_ptr->get_eye();
+    lookat 	= camera_ptr->get_lookat();
+    up 		= camera_ptr->get_v();
+
+    if (const Pinhole* pinhole_ptr = dynamic_cast<const Pinhole*>(camera_ptr)) {
+        Vector3D dir = pinhole_ptr->get_direction(Point2D(1.0, 0.0));
+        model 			= PINHOLE;
+        view_distance 	= -(dir * w) / (dir * u);
+        zoom 			= pinhole_ptr->get_zoom();
+    }
+    else if (const ThinLens* thin_lens_ptr = dynamic_cast<const ThinLens*>(camera_ptr)) {
+        Vector3D pixel_dir = thin_lens_ptr->ray_direction(Point2D(1.0, 0.0), Point2D(0.0, 0.0));
+        Vector3D lens_dir = thin_lens_ptr->ray_direction(Point2D(0.0, 0.0), Point2D(1.0, 0.0));
+        model 			= THIN_LENS;
+        view_distance 	= -(pixel_dir * w) / (pixel_dir * u);
+        focal_distance 	= (lens_dir * w) / (lens_dir * u);
+        zoom 			= thin_lens_ptr->get_zoom();
+        lens_radius 	= thin_lens_ptr->get_lens_radius();
+    }
+    else if (const Fisheye* fisheye_ptr = dynamic_cast<const Fisheye*>(camera_ptr)) {
+        float r_squared;
+        Vector3D dir = fisheye_ptr->ray_direction(Point2D(1.0, 0.0), 2, 2, 1.0, r_squared);
+        model 	= FISHEYE;
+        fov 	= 2.0 * acos(-(dir * w)) * 180.0 / PI;
+    }
+    else
+        model = NONE;
+
+    return (model != NONE);
+}
+
+
+// ---------------------------------------------------------------- make
+
+Camera*
+CameraSettings::make(const int num_samples) const {
+    Camera* camera_ptr;
+
+    if (model == PINHOLE) {
+        Pinhole* pinhole_ptr = new Pinhole;
+        pinhole_ptr->set_view_distance(view_distance);
+        pinhole_ptr->set_zoom(zoom);
+        camera_ptr = pinhole_ptr;
+    }
+    else if (model == THIN_LENS) {
+        ThinLens* thin_lens_ptr = new ThinLens;
+        thin_lens_ptr->set_view_distance(view_distance);
+        thin_lens_ptr->set_zoom(zoom);
+        thin_lens_ptr->set_focal_distance(focal_distance);
+        thin_lens_ptr->set_lens_radius(lens_radius);
+        thin_lens_ptr->set_sampler(new MultiJittered(num_samples));
+        camera_ptr = thin_lens_ptr;
+    }
+    else if (model == FISHEYE) {
+        Fisheye* fisheye_ptr = new Fisheye;
+        fisheye_ptr->set_fov(fov);
+        camera_ptr = fisheye_ptr;
+    }
+    else
+        return (NULL);
+
+    camera_ptr->set_eye(eye);
+    camera_ptr->set_lookat(lookat);
+    camera_ptr->set_up_vector(up);
+    camera_ptr->compute_uvw();
+
+    return (camera_ptr);
+}
+
+
+// ---------------------------------------------------------------- default constructor
+
+LightSettings::LightSettings(void)
+    : 	kind(NONE),
+        v(0, 0, 1),
+        radiance(1.0),
+        shadows(false),
+        normal(0, 0, 1),
+        radius(1.0),
+        num_samples(16)
+{}
+
+
+// ---------------------------------------------------------------- read
+// a point light's location is where the directions seen from two probe points meet;
+// the probes are off any axis so that a light placed on one is still found
+
+bool
+LightSettings::read(World* w, Light* light_ptr) {
+    ShadeRec sr(*w);
+
+    radiance 	= light_ptr->L(sr);
+    shadows 	= light_ptr->casts_shadows();
+
+    if (dynamic_cast<PointLight*>(light_ptr)) {
+        const Point3D probes[3] = { Point3D(-1234.5, 987.25, 3141.5),
+                                    Point3D(2718.25, -1618.5, 577.75),
+                                    Point3D(-414.25, -2236.5, -1732.5) };
+        Vector3D dirs[3];
+
+        for (int j = 0; j < 3; j++) {
+            sr.hit_point = probes[j];
+            dirs[j] = light_ptr->get_direction(sr);
+        }
+
+        // use the pair of probes whose directions are furthest from parallel
+        int 	k = 1;
+        double 	b = dirs[0] * dirs[1];
+        if (fabs(dirs[0] * dirs[2]) < fabs(b)) {
+            k = 2;
+            b = dirs[0] * dirs[2];
+        }
+
+        Vector3D offset = probes[0] - probes[k];
+        double t = (b * (dirs[k] * offset) - dirs[0] * offset) / (1.0 - b * b);
+        Point3D location = probes[0] + t * dirs[0];
+
+        kind 	= POINT;
+        v 		= Vector3D(location.x, location.y, location.z);
+    }
+    else if (dynamic_cast<Directional*>(light_ptr)) {
+        kind 	= DIRECTIONAL;
+        v 		= light_ptr->get_direction(sr);
+    }
+    else if (DiskLight* disk_ptr = dynamic_cast<DiskLight*>(light_ptr)) {
+        // L reports a batch, so the disk is read through its getters
+        Point3D c = disk_ptr->get_center();
+
+        kind 		= DISK;
+        v 			= Vector3D(c.x, c.y, c.z);
+        normal 		= disk_ptr->get_normal();
+        radius 		= disk_ptr->get_radius();
+        num_samples = disk_ptr->get_num_samples();
+        radiance 	= disk_ptr->get_radiance();
+    }
+    else
+        kind = NONE;
+
+    return (kind != NONE);
+}
+
+
+// ---------------------------------------------------------------- make
+
+Light*
+LightSettings::make(void) const {
+    if (kind == POINT) {
+        PointLight* light_ptr = new PointLight;
+        light_ptr->set_location(Point3D(v.x, v.y, v.z));
+        light_ptr->scale_radiance(1.0);
+        light_ptr->set_color(radiance);
+        light_ptr->set_shadows(shadows);
+        return (light_ptr);
+    }
+
+    if (kind == DIRECTIONAL) {
+        Directional* light_ptr = new CachedDirectional;
+        light_ptr->set_direction(v);
+        light_ptr->scale_radiance(1.0);
+        light_ptr->set_color(radiance);
+        light_ptr->set_shadows(shadows);
+        return (light_ptr);
+    }
+
+    if (kind == DISK) {
+        DiskLight* light_ptr = new DiskLight(Point3D(v.x, v.y, v.z), normal, radius);
+        light_ptr->scale_radiance(1.0);
+        light_ptr->set_color(radiance);
+        light_ptr->set_num_samples(num_samples);
+        light_ptr->set_shadows(shadows);
+        return (light_ptr);
+    }
+
+    return (NULL);
+}
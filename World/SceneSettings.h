@@ -0,0 +1,61 @@
+#ifndef __SCENE_SETTINGS__
+#define __SCENE_SETTINGS__
+
+// The parameters of a camera or a light, as plain values, for the scene file and the
+// scene cache. read recovers them from a built camera or light; make builds a new one.
+// Cameras and lights have no getters for every parameter, so read probes them with a few
+// directions, which is exact for the models listed here; a DiskLight, whose L depends on the
+// batch it last traced, is read through its own getters. Any other model reads as NONE.
+
+#include "Utilities/Normal.h"
+#include "Utilities/Point3D.h"
+#include "Utilities/RGBColor.h"
+#include "Utilities/Vector3D.h"
+
+class Camera;
+class Light;
+class World;
+
+struct CameraSettings {
+    enum Model { NONE, PINHOLE, THIN_LENS, FISHEYE };
+
+    int 		model;
+    Point3D 	eye;
+    Point3D 	lookat;
+    Vector3D 	up;
+    double 		view_distance;
+    double 		zoom;
+    double 		focal_distance;				// thin lens only
+    double 		lens_radius;				// thin lens only
+    double 		fov;						// fisheye only, in degrees
+
+    CameraSettings(void);
+
+    bool
+    read(const Camera* camera_ptr);
+
+    Camera*
+    make(const int num_samples) const;		// num_samples is for the thin lens sampler
+};
+
+struct LightSettings {
+    enum Kind { NONE, POINT, DIRECTIONAL, DISK };
+
+    int 		kind;
+    Vector3D 	v;							// location of a point light, direction of a directional one, centre of a disk
+    RGBColor 	radiance;					// ls * colour
+    bool 		shadows;
+    Normal 		normal;						// disk only, the lit side
+    double 		radius;						// disk only
+    int 		num_samples;				// disk only
+
+    LightSettings(void);
+
+    bool
+    read(World* w, Light* light_ptr);
+
+    Light*
+    make(void) const;
+};
+
+#endif
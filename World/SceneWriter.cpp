@@ -0,0 +1,332 @@
+#include "SceneWriter.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <typeinfo>
+
+#include "GeometricObjects/BeveledObjects/PacketBeveledBox.h"
+#include "GeometricObjects/CompoundObjects/BVH.h"
+#include "GeometricObjects/CompoundObjects/Group.h"
+#include "GeometricObjects/CompoundObjects/MailboxGrid.h"
+#include "GeometricObjects/CompoundObjects/PacketBox.h"
+#include "GeometricObjects/Instance.h"
+#include "GeometricObjects/Placement.h"
+#include "GeometricObjects/Primitives/PacketDisk.h"
+#include "GeometricObjects/Primitives/PacketPlane.h"
+#include "GeometricObjects/Primitives/PacketSphere.h"
+#include "GeometricObjects/Primitives/SphereSet.h"
+#include "GeometricObjects/Triangles/PacketTriangle.h"
+#include "Lights/Ambient.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialRegistry.h"
+#include "Tracers/RayCast.h"
+#include "Utilities/ShadeRec.h"
+#include "World/SceneSettings.h"
+#include "World/World.h"
+
+// the MATERIAL_CHOICE names, in enum order, as SceneReader reads them
+static const char* kChoices[] = { "DIELECTRIC", "EMISSIVE", "GLOSSYREFLECTOR", "MATTE", "PHONG",
+                                  "PLASTIC", "REFLECTIVE", "SV_MATTE", "TRANSPARENTS" };
+
+
+// ---------------------------------------------------------------- append
+// printf onto a string; numbers use %.9g so that floats survive the round trip
+
+static void
+append(std::string& out, const char* format, ...) {
+    char buffer[512];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    out += buffer;
+}
+
+
+// ---------------------------------------------------------------- triple
+
+static std::string
+triple(const double x, const double y, const double z) {
+    std::string text;
+    append(text, "%.9g %.9g %.9g", x, y, z);
+    return (text);
+}
+
+
+// ---------------------------------------------------------------- constructor
+
+SceneWriter::SceneWriter(World* world)
+    : 	w(world),
+        failure(),
+        definitions(),
+        materials(),
+        prototypes()
+{}
+
+
+// ---------------------------------------------------------------- write
+
+bool
+SceneWriter::write(const std::string& file_name, std::string& reason) {
+    std::string text;
+
+    if (!to_string(text, reason))
+        return (false);
+
+    FILE* file = fopen(file_name.c_str(), "wb");
+    if (!file) {
+        reason = "cannot open " + file_name;
+        return (false);
+    }
+
+    bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+
+    if (fclose(file) != 0 || !written) {
+        reason = "cannot write " + file_name;
+        return (false);
+    }
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- to_string
+
+bool
+SceneWriter::to_string(std::string& text, std::string& reason) {
+    failure.clear();
+    definitions.clear();
+    materials.clear();
+    prototypes.clear();
+
+    std::string header;
+    append(header, "viewplane %d %d %.9g %d %.9g\n", w->vp.hres, w->vp.vres, w->vp.s, w->vp.num_samples, w->vp.gamma);
+    header += "background " + triple(w->background_color.r, w->background_color.g, w->background_color.b) + "\n";
+
+    if (dynamic_cast<RayCast*>(w->tracer_ptr))
+        header += "tracer raycast\n";
+    else if (w->tracer_ptr)
+        reject(std::string("tracer ") + typeid(*w->tracer_ptr).name());
+
+    if (w->camera_ptr)
+        write_camera(w->camera_ptr, header);
+
+    if (w->ambient_ptr) {
+        ShadeRec sr(*w);
+        RGBColor L = w->ambient_ptr->L(sr);
+        header += "ambient 1 " + triple(L.r, L.g, L.b) + "\n";
+    }
+
+    for (Light* light_ptr : w->lights)
+        write_light(light_ptr, header);
+
+    std::string body;
+    for (GeometricObject* object_ptr : w->objects)
+        write_object(object_ptr, 0, body);
+
+    if (!failure.empty()) {
+        reason = failure;
+        return (false);
+    }
+
+    text = header + "\n" + definitions + "\n" + body;
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- reject
+// keeps the first reason; the rest of the scene is still walked, but nothing is written
+
+void
+SceneWriter::reject(const std::string& what) {
+    if (failure.empty())
+        failure = "the scene format has no statement for " + what;
+}
+
+
+// ---------------------------------------------------------------- write_camera
+
+void
+SceneWriter::write_camera(const Camera* camera_ptr, std::string& out) {
+    CameraSettings camera;
+
+    if (!camera.read(camera_ptr)) {
+        reject(std::string("camera ") + typeid(*camera_ptr).name());
+        return;
+    }
+
+    static const char* models[] = { "", "pinhole", "thinlens", "fisheye" };
+
+    out += std::string("camera ") + models[camera.model] + " " + triple(camera.eye.x, camera.eye.y, camera.eye.z)
+         + " " + triple(camera.lookat.x, camera.lookat.y, camera.lookat.z) + " " + triple(camera.up.x, camera.up.y, camera.up.z);
+
+    if (camera.model == CameraSettings::PINHOLE)
+        append(out, " %.9g %.9g\n", camera.view_distance, camera.zoom);
+    else if (camera.model == CameraSettings::THIN_LENS)
+        append(out, " %.9g %.9g %.9g %.9g\n", camera.view_distance, camera.zoom, camera.focal_distance, camera.lens_radius);
+    else
+        append(out, " %.9g\n", camera.fov);
+}
+
+
+// ---------------------------------------------------------------- write_light
+
+void
+SceneWriter::write_light(Light* light_ptr, std::string& out) {
+    LightSettings light;
+
+    // the scene file has no disk lights
+    if (!light.read(w, light_ptr) || light.kind == LightSettings::DISK) {
+        reject(std::string("light ") + typeid(*light_ptr).name());
+        return;
+    }
+
+    out += std::string("light ") + (light.kind == LightSettings::POINT ? "point " : "directional ")
+         + triple(light.v.x, light.v.y, light.v.z) + " 1 " + triple(light.radiance.r, light.radiance.g, light.radiance.b)
+         + (light.shadows ? " 1\n" : " 0\n");
+}
+
+
+// ---------------------------------------------------------------- write_object
+
+void
+SceneWriter::write_object(GeometricObject* object_ptr, const int depth, std::string& out) {
+    std::string indent(depth, '\t');
+    std::string material = material_name(object_ptr->get_material().get());
+
+    if (PacketSphere* sphere_ptr = dynamic_cast<PacketSphere*>(object_ptr)) {
+        Point3D c = sphere_ptr->get_center();
+        out += indent + "sphere " + material + " " + triple(c.x, c.y, c.z);
+        append(out, " %.9g\n", sphere_ptr->get_radius());
+    }
+    else if (PacketPlane* plane_ptr = dynamic_cast<PacketPlane*>(object_ptr)) {
+        Point3D a = plane_ptr->get_point();
+        Normal n = plane_ptr->get_normal();
+        out += indent + "plane " + material + " " + triple(a.x, a.y, a.z) + " " + triple(n.x, n.y, n.z) + "\n";
+    }
+    else if (PacketDisk* disk_ptr = dynamic_cast<PacketDisk*>(object_ptr)) {
+        Point3D c = disk_ptr->get_center();
+        Normal n = disk_ptr->get_normal();
+        out += indent + "disk " + material + " " + triple(c.x, c.y, c.z) + " " + triple(n.x, n.y, n.z);
+        append(out, " %.9g\n", disk_ptr->get_radius());
+    }
+    else if (PacketTriangle* triangle_ptr = dynamic_cast<PacketTriangle*>(object_ptr)) {
+        Point3D v0 = triangle_ptr->get_v0(), v1 = triangle_ptr->get_v1(), v2 = triangle_ptr->get_v2();
+        out += indent + "triangle " + material + " " + triple(v0.x, v0.y, v0.z) + " "
+             + triple(v1.x, v1.y, v1.z) + " " + triple(v2.x, v2.y, v2.z) + "\n";
+    }
+    else if (PacketBox* box_ptr = dynamic_cast<PacketBox*>(object_ptr)) {
+        Point3D p0 = box_ptr->get_p0(), p1 = box_ptr->get_p1();
+        out += indent + "box " + material + " " + triple(p0.x, p0.y, p0.z) + " " + triple(p1.x, p1.y, p1.z) + "\n";
+    }
+    else if (PacketBeveledBox* beveled_ptr = dynamic_cast<PacketBeveledBox*>(object_ptr)) {
+        Point3D p0 = beveled_ptr->get_p0(), p1 = beveled_ptr->get_p1();
+        out += indent + "beveled_box " + material + " " + triple(p0.x, p0.y, p0.z) + " " + triple(p1.x, p1.y, p1.z);
+        append(out, " %.9g\n", beveled_ptr->get_bevel_radius());
+    }
+    else if (SphereSet* set_ptr = dynamic_cast<SphereSet*>(object_ptr)) {
+        // read back as separate spheres; the set's own material is only that of its last hit
+        out += indent + "compound - {\t# a sphere set\n";
+
+        for (int j = 0; j < set_ptr->get_num_spheres(); j++) {
+            Point3D c = set_ptr->get_center(j);
+            out += indent + "\tsphere " + material_name(set_ptr->get_sphere_material(j).get()) + " " + triple(c.x, c.y, c.z);
+            append(out, " %.9g\n", set_ptr->get_radius(j));
+        }
+
+        out += indent + "}\n";
+    }
+    else if (Placement* placement_ptr = dynamic_cast<Placement*>(object_ptr)) {
+        const Matrix& m = placement_ptr->get_matrix();
+        out += indent + "instance " + material + " " + prototype_name(placement_ptr->get_prototype().get()) + " matrix";
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 4; j++)
+                append(out, " %.9g", m.m[i][j]);
+        out += "\n";
+    }
+    else if (Group* group_ptr = dynamic_cast<Group*>(object_ptr)) {
+        // children carry their own materials, so the block itself has none
+        if (dynamic_cast<BVH*>(group_ptr))
+            out += indent + "bvh - {\n";
+        else if (dynamic_cast<MailboxGrid*>(group_ptr))
+            out += indent + "grid - {\n";
+        else if (typeid(*group_ptr) == typeid(Group))
+            out += indent + "compound - {\n";
+        else
+            out += indent + "compound - {\t# written as a compound: " + typeid(*group_ptr).name() + "\n";
+
+        for (GeometricObject* child_ptr : group_ptr->get_objects())
+            write_object(child_ptr, depth + 1, out);
+
+        out += indent + "}\n";
+    }
+    else if (dynamic_cast<Compound*>(object_ptr))
+        reject(std::string("a library ") + typeid(*object_ptr).name() + ", whose children are private to it; build with Group instead");
+    else if (dynamic_cast<Instance*>(object_ptr))
+        reject("an Instance, whose object and matrix are private to it; build with Placement instead");
+    else
+        reject(std::string("object ") + typeid(*object_ptr).name());
+}
+
+
+// ---------------------------------------------------------------- material_name
+// defines the material on first use; materials the registry did not make are written as
+// the world's default material, with a note
+
+std::string
+SceneWriter::material_name(const Material* material_ptr) {
+    if (!material_ptr)
+        return ("-");
+
+    std::map<const Material*, std::string>::const_iterator found = materials.find(material_ptr);
+    if (found != materials.end())
+        return (found->second);
+
+    std::string name = "m" + std::to_string(materials.size());
+    MaterialKey key;
+
+    if (!MaterialRegistry::shared().find_key(material_ptr, key))
+        definitions += "material " + name + " default 0.7 0.7 0.7\t# not from the registry: "
+                     + typeid(*material_ptr).name() + "\n";
+    else if (key.choice == MaterialKey::WORLD_DEFAULT)
+        definitions += "material " + name + " default " + triple(key.r, key.g, key.b) + "\n";
+    else if (key.choice == MaterialKey::PHONG_PARAMETERS) {
+        definitions += "material " + name + " phong " + triple(key.r, key.g, key.b);
+        append(definitions, " %.9g %.9g %.9g %.9g\n", key.ka, key.kd, key.ks, key.exp);
+    }
+    else if (key.choice == MaterialKey::MATTE_PARAMETERS) {
+        definitions += "material " + name + " matte " + triple(key.r, key.g, key.b);
+        append(definitions, " %.9g %.9g\n", key.ka, key.kd);
+    }
+    else if (key.choice == MaterialKey::CHECKER_PARAMETERS) {
+        definitions += "material " + name + " checker " + triple(key.r, key.g, key.b) + " " + triple(key.ka, key.kd, key.ks);
+        append(definitions, " %.9g\n", key.exp);
+    }
+    else
+        definitions += "material " + name + " " + kChoices[key.choice] + " " + triple(key.r, key.g, key.b) + "\n";
+
+    materials[material_ptr] = name;
+    return (name);
+}
+
+
+// ---------------------------------------------------------------- prototype_name
+// defines the prototype on first use; prototypes it instances are defined before it
+
+std::string
+SceneWriter::prototype_name(GeometricObject* prototype_ptr) {
+    std::map<const GeometricObject*, std::string>::const_iterator found = prototypes.find(prototype_ptr);
+    if (found != prototypes.end())
+        return (found->second);
+
+    std::string name = "p" + std::to_string(prototypes.size());
+    prototypes[prototype_ptr] = name;
+
+    std::string text;
+    write_object(prototype_ptr, 1, text);
+    definitions += "prototype " + name + " {\n" + text + "}\n";
+
+    return (name);
+}
@@ -0,0 +1,61 @@
+#ifndef __SCENE_WRITER__
+#define __SCENE_WRITER__
+
+// Writes a built World out in the format SceneReader reads, so the scenes of Worlds.cpp
+// can be exported once and edited as text from then on.
+// Objects are written by type: the packet primitives, Placement (as an instance of a
+// prototype, with its matrix), BVH, MailboxGrid and other groups. Materials are named
+// after the MaterialRegistry::shared() entry they came from.
+// Cameras and lights are recovered through CameraSettings and LightSettings.
+// A scene holding anything else (an Instance, whose object and matrix are private to it, a
+// library Compound, whose children are, a library primitive, another camera, light or tracer) is not written at all: write and
+// to_string return false with the reason, so an export never silently drops part of a scene.
+
+#include <map>
+#include <string>
+
+class Camera;
+class GeometricObject;
+class Light;
+class Material;
+class World;
+
+class SceneWriter {
+    public:
+
+        SceneWriter(World* w);
+
+        bool
+        write(const std::string& file_name, std::string& reason);
+
+        bool
+        to_string(std::string& text, std::string& reason);
+
+    private:
+
+        World* 										w;
+        std::string 								failure;		// the first thing that could not be written
+        std::string 								definitions;	// materials and prototypes, written before use
+        std::map<const Material*, std::string> 		materials;
+        std::map<const GeometricObject*, std::string> 	prototypes;
+
+        void
+        write_camera(const Camera* camera_ptr, std::string& out);
+
+        void
+        write_light(Light* light_ptr, std::string& out);
+
+        void
+        write_object(GeometricObject* object_ptr, const int depth, std::string& out);
+
+        void
+        reject(const std::string& what);
+
+        std::string
+        material_name(const Material* material_ptr);
+
+        std::string
+        prototype_name(GeometricObject* prototype_ptr);
+};
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef __SPHERE_FIELD__
+#define __SPHERE_FIELD__
+
+// A field of many small spheres (Worlds.cpp), held in one SphereSet, added behind the
+// spheres of a sphere world that is already built; for scaling sphere-heavy scenes.
+
+class World;
+
+void add_sphere_field(World* w, int num_spheres);
+
+#endif
@@ -0,0 +1,813 @@
+#include "TileRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "Cameras/PrimaryRays.h"
+#include "GeometricObjects/Occluder.h"
+#include "GeometricObjects/PacketPrimitive.h"
+#include "Materials/Material.h"
+#include "Samplers/SamplePatternStore.h"
+#include "Tracers/CountingTracer.h"
+#include "Tracers/RayCast.h"
+#include "Utilities/RandomStream.h"
+#include "Utilities/RayPacket.h"
+#include "Utilities/RenderStats.h"
+#include "Utilities/ShadeRec.h"
+#include "World/World.h"
+
+// one queue of tile indices per thread; owners pop from the front, thieves from the back
+
+class TileQueue {
+    public:
+
+        void
+        push(const int tile) {
+            std::lock_guard<std::mutex> lock(mutex);
+            tiles.push_back(tile);
+        }
+
+        bool
+        pop(int& tile) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tiles.empty())
+                return (false);
+            tile = tiles.front();
+            tiles.pop_front();
+            return (true);
+        }
+
+        bool
+        steal(int& tile) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tiles.empty())
+                return (false);
+            tile = tiles.back();
+            tiles.pop_back();
+            return (true);
+        }
+
+    private:
+
+        std::mutex 		mutex;
+        std::deque<int>	tiles;
+};
+
+
+// ---------------------------------------------------------------- pixel_sample
+// sample j of a pixel: from the cursor's pattern when it has one, otherwise jittered in
+// its stratum when the sample count is a square (n * n)
+
+static inline Point2D
+pixel_sample(const SampleCursor& cursor, const int j, const int n, const bool stratified, RandomStream& rng) {
+    if (cursor.has_pattern())
+        return (cursor.unit_square(j));
+
+    Point2D sp;
+
+    if (stratified) {
+        sp.x = (j % n + rng.next_float()) / n;
+        sp.y = (j / n + rng.next_float()) / n;
+    }
+    else {
+        sp.x = rng.next_float();
+        sp.y = rng.next_float();
+    }
+
+    return (sp);
+}
+
+
+// ---------------------------------------------------------------- luminance
+
+static inline float
+luminance(const RGBColor& c) {
+    return (0.2126f * c.r + 0.7152f * c.g + 0.0722f * c.b);
+}
+
+
+// ---------------------------------------------------------------- stratum_stride
+// a stride near num_samples / golden ratio that is coprime to num_samples, so that every
+// pass of a progressive render spreads its samples over the whole pixel
+
+static int
+stratum_stride(const int num_samples) {
+    for (int stride = std::max(1, (int) (0.618 * num_samples)); ; stride++) {
+        int a = stride, b = num_samples;
+
+        while (b != 0) {
+            int t = a % b;
+            a = b;
+            b = t;
+        }
+
+        if (a == 1)
+            return (stride);
+    }
+}
+
+
+// ---------------------------------------------------------------- Job constructor
+
+TileRenderer::Job::Job(const World& world, const PrimaryRays& primary_rays)
+    : 	w(world),
+        rays(primary_rays),
+        tiles(),
+        packet_objects(),
+        use_packets(false),
+        counting(false),
+        pattern()
+{}
+
+
+// ---------------------------------------------------------------- default constructor
+
+TileRenderer::TileRenderer(void)
+    : 	num_threads(0),
+        tile_size(16),
+        seed(0),
+        packets(true),
+        samples_per_pass(4),
+        variance_threshold(0.0f),
+        initial_samples(4),
+        sample_budget(0.0f)
+{}
+
+
+// ---------------------------------------------------------------- set_num_threads
+
+void
+TileRenderer::set_num_threads(const int n) {
+    num_threads = n < 0 ? 0 : n;
+}
+
+
+// ---------------------------------------------------------------- get_num_threads
+
+int
+TileRenderer::get_num_threads(void) const {
+    if (num_threads > 0)
+        return (num_threads);
+
+    int n = std::thread::hardware_concurrency();
+    return (n > 0 ? n : 1);
+}
+
+
+// ---------------------------------------------------------------- num_workers
+
+int
+TileRenderer::num_workers(const int num_tiles) const {
+    return (std::min(get_num_threads(), num_tiles));
+}
+
+
+// ---------------------------------------------------------------- make_tiles
+
+std::vector<Tile>
+TileRenderer::make_tiles(const int hres, const int vres) const {
+    std::vector<Tile> tiles;
+
+    for (int r = 0; r < vres; r += tile_size)
+        for (int c = 0; c < hres; c += tile_size) {
+            Tile tile;
+            tile.row0 		= r;
+            tile.column0 	= c;
+            tile.rows 		= std::min(tile_size, vres - r);
+            tile.columns 	= std::min(tile_size, hres - c);
+            tiles.push_back(tile);
+        }
+
+    return (tiles);
+}
+
+
+// ---------------------------------------------------------------- prepare
+// runs before the workers start, so the lights' occluder lists are not read while they change
+
+void
+TileRenderer::prepare(Job& job) const {
+    job.tiles 		= make_tiles(job.w.vp.hres, job.w.vp.vres);
+    job.use_packets = packets && takes_packets(job.w, job.rays, job.counting);
+    job.pattern 	= SamplePatternStore::get(job.w.vp.sampler_ptr, job.w.vp.num_samples);
+
+    for (GeometricObject* object_ptr : job.w.objects)
+        job.packet_objects.push_back(dynamic_cast<const PacketPrimitive*>(object_ptr));
+
+    for (Light* light_ptr : job.w.lights) {
+        OccluderList* occluders_ptr = dynamic_cast<OccluderList*>(light_ptr);
+
+        if (occluders_ptr)
+            occluders_ptr->resolve(job.w);
+    }
+}
+
+
+// ---------------------------------------------------------------- for_each_tile
+// runs work(tile, worker) for every tile index on the worker threads; worker is in
+// [0, num_workers(tile_indices.size())) and identifies the calling thread
+
+void
+TileRenderer::for_each_tile(const std::vector<int>& tile_indices,
+                            const std::function<void (const int tile, const int worker)>& work) const {
+    int n = num_workers(tile_indices.size());
+    if (n < 1)
+        return;
+
+    // deal contiguous runs of tiles to each queue, so that neighbouring tiles
+    // (and the geometry they see) tend to stay on one thread
+
+    std::vector<TileQueue> queues(n);
+    int per_queue = (tile_indices.size() + n - 1) / n;
+
+    for (int j = 0; j < (int) tile_indices.size(); j++)
+        queues[j / per_queue].push(tile_indices[j]);
+
+    auto worker = [&](const int id) {
+        int tile;
+
+        while (true) {
+            bool found = queues[id].pop(tile);
+
+            for (int k = 1; !found && k < n; k++)
+                found = queues[(id + k) % n].steal(tile);
+
+            if (!found)
+                break;
+
+            uint64_t allocated = RenderStats::allocation_counter();
+            work(tile, id);
+            RenderStats::local().allocations += RenderStats::allocation_counter() - allocated;
+        }
+
+        RenderStats::flush();
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(n - 1);
+
+    for (int id = 1; id < n; id++)
+        threads.push_back(std::thread(worker, id));
+
+    worker(0);
+
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+
+// ---------------------------------------------------------------- render
+
+bool
+TileRenderer::render(const World& w, Framebuffer& fb) const {
+    return (render(w, w.camera_ptr, fb));
+}
+
+
+// ---------------------------------------------------------------- render
+// returns false, leaving fb untouched, when the camera has no per-pixel ray path;
+// such cameras are rendered with their own render_scene
+
+bool
+TileRenderer::render(const World& w, const Camera* camera_ptr, Framebuffer& fb) const {
+    PrimaryRays rays(camera_ptr, w.vp);
+    if (!rays.is_supported())
+        return (false);
+
+    fb.resize(w.vp.hres, w.vp.vres);
+
+    Job job(w, rays);
+    prepare(job);
+
+    int num_samples = w.vp.num_samples;
+    Pass pass 		= {0, num_samples, 1, seed, NULL, NULL};
+
+    std::vector<int> tile_indices(job.tiles.size());
+    for (int j = 0; j < (int) tile_indices.size(); j++)
+        tile_indices[j] = j;
+
+    int n = num_workers(tile_indices.size());
+    std::vector<std::vector<RGBColor>> 	sums(n, std::vector<RGBColor>(tile_size * tile_size));
+    std::vector<std::vector<float>> 	squares(n, std::vector<float>(tile_size * tile_size));
+
+    for_each_tile(tile_indices, [&](const int tile, const int worker) {
+        trace_tile(job, job.tiles[tile], pass, sums[worker], squares[worker]);
+        copy_tile(job.tiles[tile], sums[worker], 1.0f / num_samples, fb);
+    });
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- render_views
+// fbs[j] receives the view from cameras[j]; the tiles of all the views are dealt out
+// together, each rendered exactly as render(w, cameras[j], fbs[j]) would render it
+// returns false, leaving its framebuffer empty, if any camera has no per-pixel ray path
+
+bool
+TileRenderer::render_views(const World& w, const std::vector<const Camera*>& cameras, std::vector<Framebuffer>& fbs) const {
+    int num_views = cameras.size();
+
+    std::vector<std::unique_ptr<PrimaryRays> > 	rays(num_views);
+    std::vector<std::unique_ptr<Job> > 			jobs(num_views);
+    std::vector<std::pair<int, int> > 			view_tiles;				// (view, tile in its job)
+    bool 										all_supported = true;
+
+    fbs.assign(num_views, Framebuffer());
+
+    for (int view = 0; view < num_views; view++) {
+        rays[view].reset(new PrimaryRays(cameras[view], w.vp));
+
+        if (!rays[view]->is_supported()) {
+            all_supported = false;
+            continue;
+        }
+
+        fbs[view].resize(w.vp.hres, w.vp.vres);
+        jobs[view].reset(new Job(w, *rays[view]));
+        prepare(*jobs[view]);
+
+        for (int tile = 0; tile < (int) jobs[view]->tiles.size(); tile++)
+            view_tiles.push_back(std::make_pair(view, tile));
+    }
+
+    int num_samples = w.vp.num_samples;
+    Pass pass 		= {0, num_samples, 1, seed, NULL, NULL};
+
+    std::vector<int> tile_indices(view_tiles.size());
+    for (int j = 0; j < (int) tile_indices.size(); j++)
+        tile_indices[j] = j;
+
+    int n = num_workers(tile_indices.size());
+    std::vector<std::vector<RGBColor>> 	sums(n, std::vector<RGBColor>(tile_size * tile_size));
+    std::vector<std::vector<float>> 	squares(n, std::vector<float>(tile_size * tile_size));
+
+    for_each_tile(tile_indices, [&](const int index, const int worker) {
+        const Job& job 		= *jobs[view_tiles[index].first];
+        const Tile& tile 	= job.tiles[view_tiles[index].second];
+
+        trace_tile(job, tile, pass, sums[worker], squares[worker]);
+        copy_tile(tile, sums[worker], 1.0f / num_samples, fbs[view_tiles[index].first]);
+    });
+
+    return (all_supported);
+}
+
+
+// ---------------------------------------------------------------- render_progressive
+// takes samples_per_pass samples of every pixel of the active tiles per pass, and calls
+// publish with the running averages after each pass
+// after the second pass, a tile whose largest per-pixel variance of the mean luminance is
+// below variance_threshold stops; the render ends when every tile has stopped, all the
+// view plane's samples are taken, or publish returns false
+
+bool
+TileRenderer::render_progressive(const World& w, Framebuffer& fb, const ProgressCallback& publish) const {
+    PrimaryRays rays(w.camera_ptr, w.vp);
+    if (!rays.is_supported())
+        return (false);
+
+    fb.resize(w.vp.hres, w.vp.vres);
+
+    Job job(w, rays);
+    prepare(job);
+
+    int num_samples = w.vp.num_samples;
+    int num_tiles 	= job.tiles.size();
+    int stride 		= stratum_stride(num_samples);
+
+    std::vector<RGBColor> 	image_sums(fb.pixels.size());
+    std::vector<float> 		image_squares(fb.pixels.size());
+    std::vector<char> 		converged(num_tiles);
+    std::vector<int> 		active(num_tiles);
+
+    for (int j = 0; j < num_tiles; j++)
+        active[j] = j;
+
+    int n = num_workers(num_tiles);
+    std::vector<std::vector<RGBColor>> 	sums(n, std::vector<RGBColor>(tile_size * tile_size));
+    std::vector<std::vector<float>> 	squares(n, std::vector<float>(tile_size * tile_size));
+
+    for (int pass_index = 0, first = 0; first < num_samples && !active.empty(); pass_index++) {
+        Pass pass;
+        pass.first 		= first;
+        pass.last 		= std::min(first + samples_per_pass, num_samples);
+        pass.stride 	= stride;
+        pass.sequence 	= (uint64_t) seed | ((uint64_t) pass_index << 32);
+        pass.taken 		= NULL;
+        pass.wanted 	= NULL;
+
+        int count = pass.last;
+
+        for_each_tile(active, [&](const int index, const int worker) {
+            const Tile& tile = job.tiles[index];
+            float largest = 0.0f;
+
+            trace_tile(job, tile, pass, sums[worker], squares[worker]);
+
+            for (int r = 0; r < tile.rows; r++)
+                for (int c = 0; c < tile.columns; c++) {
+                    int pixel = (tile.row0 + r) * fb.hres + tile.column0 + c;
+
+                    image_sums[pixel] 		+= sums[worker][r * tile_size + c];
+                    image_squares[pixel] 	+= squares[worker][r * tile_size + c];
+                    fb.pixels[pixel] 		= image_sums[pixel] / count;
+
+                    if (count > 1) {
+                        float mean 		= luminance(image_sums[pixel]) / count;
+                        float variance 	= (image_squares[pixel] / count - mean * mean) / (count - 1);
+                        largest 		= std::max(largest, variance);
+                    }
+                }
+
+            converged[index] = pass_index > 0 && largest < variance_threshold;
+        });
+
+        active.erase(std::remove_if(active.begin(), active.end(),
+                                    [&](const int index) { return (converged[index] != 0); }),
+                     active.end());
+
+        first = pass.last;
+
+        if (publish && !publish(fb, pass_index, active.size()))
+            break;
+    }
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- render_adaptive
+// every pixel first takes initial_samples samples; each round after that ranks the pixels
+// that can take more by their error, the variance of their mean luminance plus their squared
+// contrast with the four neighbours over the samples taken, and gives the worse half of them
+// samples_per_pass more. Rounds stop when sample_budget * hres * vres samples are spent, or
+// when no pixel's error is above variance_threshold; publish, if set, is called after each.
+
+bool
+TileRenderer::render_adaptive(const World& w, Framebuffer& fb, const ProgressCallback& publish) const {
+    PrimaryRays rays(w.camera_ptr, w.vp);
+    if (!rays.is_supported())
+        return (false);
+
+    fb.resize(w.vp.hres, w.vp.vres);
+
+    Job job(w, rays);
+    prepare(job);
+
+    int num_samples 	= w.vp.num_samples;
+    int num_pixels 		= fb.pixels.size();
+    int num_tiles 		= job.tiles.size();
+    int tiles_across 	= (fb.hres + tile_size - 1) / tile_size;
+    double budget 		= (sample_budget > 0.0f ? sample_budget : 0.25 * num_samples) * num_pixels;
+
+    std::vector<RGBColor> 	image_sums(num_pixels);
+    std::vector<float> 		image_squares(num_pixels);
+    std::vector<float> 		means(num_pixels);
+    std::vector<float> 		errors(num_pixels);
+    std::vector<int> 		taken(num_pixels, 0);
+    std::vector<int> 		wanted(num_pixels, std::min(initial_samples, num_samples));
+    std::vector<char> 		touched(num_tiles);
+    std::vector<int> 		candidates;
+    std::vector<int> 		active(num_tiles);
+
+    for (int j = 0; j < num_tiles; j++)
+        active[j] = j;
+
+    int n = num_workers(num_tiles);
+    std::vector<std::vector<RGBColor>> 	sums(n, std::vector<RGBColor>(tile_size * tile_size));
+    std::vector<std::vector<float>> 	squares(n, std::vector<float>(tile_size * tile_size));
+
+    for (int round = 0; !active.empty(); round++) {
+        Pass pass;
+        pass.first 		= 0;
+        pass.last 		= 0;
+        pass.stride 	= stratum_stride(num_samples);
+        pass.sequence 	= (uint64_t) seed | ((uint64_t) round << 32);
+        pass.taken 		= taken.data();
+        pass.wanted 	= wanted.data();
+
+        for_each_tile(active, [&](const int index, const int worker) {
+            const Tile& tile = job.tiles[index];
+
+            trace_tile(job, tile, pass, sums[worker], squares[worker]);
+
+            for (int r = 0; r < tile.rows; r++)
+                for (int c = 0; c < tile.columns; c++) {
+                    int pixel = (tile.row0 + r) * fb.hres + tile.column0 + c;
+
+                    if (wanted[pixel] == 0)
+                        continue;
+
+                    image_sums[pixel] 		+= sums[worker][r * tile_size + c];
+                    image_squares[pixel] 	+= squares[worker][r * tile_size + c];
+                    taken[pixel] 			+= wanted[pixel];
+                    fb.pixels[pixel] 		= image_sums[pixel] / taken[pixel];
+                }
+        });
+
+        for (int pixel = 0; pixel < num_pixels; pixel++) {
+            budget 			-= wanted[pixel];
+            wanted[pixel] 	= 0;
+            means[pixel] 	= luminance(fb.pixels[pixel]);
+        }
+
+        candidates.clear();
+
+        for (int row = 0; row < fb.vres; row++)
+            for (int column = 0; column < fb.hres; column++) {
+                int pixel 	= row * fb.hres + column;
+                int count 	= taken[pixel];
+
+                if (count >= num_samples || count < 2)
+                    continue;
+
+                float mean 		= means[pixel];
+                float variance 	= (image_squares[pixel] / count - mean * mean) / (count - 1);
+                float contrast 	= 0.0f;
+
+                if (row > 0)
+                    contrast = std::max(contrast, std::abs(mean - means[pixel - fb.hres]));
+                if (row < fb.vres - 1)
+                    contrast = std::max(contrast, std::abs(mean - means[pixel + fb.hres]));
+                if (column > 0)
+                    contrast = std::max(contrast, std::abs(mean - means[pixel - 1]));
+                if (column < fb.hres - 1)
+                    contrast = std::max(contrast, std::abs(mean - means[pixel + 1]));
+
+                errors[pixel] = variance + contrast * contrast / count;
+
+                if (errors[pixel] > variance_threshold)
+                    candidates.push_back(pixel);
+            }
+
+        int chosen = candidates.empty() ? 0 : std::max(1, (int) candidates.size() / 2);
+        chosen = std::min(chosen, (int) (budget / samples_per_pass));
+
+        std::fill(touched.begin(), touched.end(), 0);
+        active.clear();
+
+        if (chosen > 0) {
+            std::nth_element(	candidates.begin(), candidates.begin() + (chosen - 1), candidates.end(),
+                                [&](const int a, const int b) { return (errors[a] > errors[b]); });
+
+            for (int j = 0; j < chosen; j++) {
+                int pixel 	= candidates[j];
+                int index 	= (pixel / fb.hres / tile_size) * tiles_across + (pixel % fb.hres) / tile_size;
+
+                wanted[pixel] = std::min(samples_per_pass, num_samples - taken[pixel]);
+
+                if (!touched[index]) {
+                    touched[index] = 1;
+                    active.push_back(index);
+                }
+            }
+
+            std::sort(active.begin(), active.end());
+        }
+
+        if (publish && !publish(fb, round, active.size()))
+            break;
+    }
+
+    return (true);
+}
+
+
+// ---------------------------------------------------------------- Pass::range
+
+void
+TileRenderer::Pass::range(const int pixel, int& pixel_first, int& pixel_last) const {
+    if (taken) {
+        pixel_first = taken[pixel];
+        pixel_last 	= taken[pixel] + wanted[pixel];
+    }
+    else {
+        pixel_first = first;
+        pixel_last 	= last;
+    }
+}
+
+
+// ---------------------------------------------------------------- trace_tile
+// sums[r * tile_size + c] gets the sum of the pass's samples of the tile's pixel (r, c),
+// and squares the sum of their squared luminances
+
+void
+TileRenderer::trace_tile(	const Job& job, const Tile& tile, const Pass& pass,
+                            std::vector<RGBColor>& sums, std::vector<float>& squares) const {
+    if (job.use_packets)
+        render_tile_packets(job, tile, pass, sums, squares);
+    else
+        render_tile(job, tile, pass, sums, squares);
+}
+
+
+// ---------------------------------------------------------------- render_tile
+
+void
+TileRenderer::render_tile(	const Job& job, const Tile& tile, const Pass& pass,
+                            std::vector<RGBColor>& sums, std::vector<float>& squares) const {
+    const World& w 			= job.w;
+    const PrimaryRays& rays = job.rays;
+    const ViewPlane& vp 	= w.vp;
+    int num_samples 		= vp.num_samples;
+    int n 					= (int) sqrt((float) num_samples);
+    bool stratified 		= (n * n == num_samples);
+    RandomStream& rng 		= RandomStream::local();
+    SampleCursor pixel_cursor(job.pattern.get());
+    SampleCursor lens_cursor(job.pattern.get());
+    Ray ray;
+
+    for (int r = 0; r < tile.rows; r++)
+        for (int c = 0; c < tile.columns; c++) {
+            int row 	= tile.row0 + r;
+            int column 	= tile.column0 + c;
+            int first, last;
+
+            pass.range(row * vp.hres + column, first, last);
+            rng.seed(row * vp.hres + column, pass.sequence);
+            pixel_cursor.start(rng);
+            lens_cursor.start(rng);
+
+            RGBColor 	L = black;
+            float 		L2 = 0.0f;
+
+            for (int j = first; j < last; j++) {
+                int stratum = (j * pass.stride) % num_samples;
+                Point2D sp 	= pixel_sample(pixel_cursor, stratum, n, stratified, rng);
+                Point2D lp 	= pixel_sample(lens_cursor, stratum, 1, false, rng);
+
+                if (rays.generate(row, column, sp, lp, ray)) {
+                    RGBColor sample = w.tracer_ptr->trace_ray(ray, 0);
+                    float y 		= luminance(sample);
+
+                    L 	+= sample;
+                    L2 	+= y * y;
+                }
+            }
+
+            sums[r * tile_size + c] 	= L;
+            squares[r * tile_size + c] 	= L2;
+        }
+}
+
+
+// ---------------------------------------------------------------- takes_packets
+// packets need a camera whose rays share an origin and a tracer whose primary rays can be
+// shaded here: RayCast, possibly wrapped in a CountingTracer (counting is then set)
+
+bool
+TileRenderer::takes_packets(const World& w, const PrimaryRays& rays, bool& counting) {
+    const Tracer* tracer_ptr = w.tracer_ptr;
+    const CountingTracer* counting_ptr = dynamic_cast<const CountingTracer*>(tracer_ptr);
+
+    counting = counting_ptr != NULL;
+    if (counting)
+        tracer_ptr = counting_ptr->get_tracer();
+
+    return (rays.is_coherent() && dynamic_cast<const RayCast*>(tracer_ptr) != NULL);
+}
+
+
+// ---------------------------------------------------------------- render_tile_packets
+// runs of kPacketSize pixels along a row form a packet, one sample index at a time
+// every lane keeps its pixel's own stream and lends it to RandomStream::local() while it
+// is shaded, so each pixel consumes exactly the numbers it would have in render_tile
+// the top-level loop and the shading follow ThreadSafeRayCast::trace_ray
+
+void
+TileRenderer::render_tile_packets(	const Job& job, const Tile& tile, const Pass& pass,
+                                    std::vector<RGBColor>& sums, std::vector<float>& squares) const {
+    const World& w 			= job.w;
+    const PrimaryRays& rays = job.rays;
+    const ViewPlane& vp 	= w.vp;
+    World& world 			= const_cast<World&>(w);
+    int num_samples 		= vp.num_samples;
+    int n 					= (int) sqrt((float) num_samples);
+    bool stratified 		= (n * n == num_samples);
+    RandomStream& rng 		= RandomStream::local();
+    RenderCounts& counts 	= RenderStats::local();
+    ShadeRec scratch(world);
+
+    RandomStream 	streams[kPacketSize];
+    SampleCursor 	pixel_cursors[kPacketSize];
+    SampleCursor 	lens_cursors[kPacketSize];
+    RGBColor 		L[kPacketSize];
+    float 			L2[kPacketSize];
+    int 			first[kPacketSize], last[kPacketSize];
+    Ray 			ray;
+
+    for (int r = 0; r < tile.rows; r++)
+        for (int c0 = 0; c0 < tile.columns; c0 += kPacketSize) {
+            int row 	= tile.row0 + r;
+            int lanes 	= std::min(kPacketSize, tile.columns - c0);
+            int length 	= 0;
+
+            for (int k = 0; k < lanes; k++) {
+                pass.range(row * vp.hres + tile.column0 + c0 + k, first[k], last[k]);
+                streams[k].seed(row * vp.hres + tile.column0 + c0 + k, pass.sequence);
+                pixel_cursors[k] 	= SampleCursor(job.pattern.get());
+                lens_cursors[k] 	= SampleCursor(job.pattern.get());
+                pixel_cursors[k].start(streams[k]);
+                lens_cursors[k].start(streams[k]);
+                L[k] 	= black;
+                L2[k] 	= 0.0f;
+                length 	= std::max(length, last[k] - first[k]);
+            }
+
+            // with per-pixel ranges a lane drops out of the packet once its pixel is done
+
+            for (int i = 0; i < length; i++) {
+                RayPacket packet;
+
+                for (int k = 0; k < lanes; k++) {
+                    int j = first[k] + i;
+                    if (j >= last[k])
+                        continue;
+
+                    int stratum = (j * pass.stride) % num_samples;
+                    Point2D sp 	= pixel_sample(pixel_cursors[k], stratum, n, stratified, streams[k]);
+                    Point2D lp 	= pixel_sample(lens_cursors[k], stratum, 1, false, streams[k]);
+
+                    rays.generate(row, tile.column0 + c0 + k, sp, lp, ray);
+                    packet.set(k, ray);
+                }
+
+                packet.fill_inactive();
+
+                int active = lane_count(packet.active);
+
+                PacketHit hits(scratch);
+
+                for (int m = 0; m < (int) w.objects.size(); m++)
+                    PacketPrimitive::hit_object(w.objects[m], job.packet_objects[m], packet, hits);
+
+                if (job.counting) {
+                    counts.primary_rays += active;
+                    counts.object_tests += active * w.objects.size();
+                }
+
+                for (int k = 0; k < lanes; k++) {
+                    if (!(packet.active & (1 << k)))
+                        continue;
+
+                    if (!hits.material[k]) {
+                        float y = luminance(w.background_color);
+
+                        L[k] 	+= w.background_color;
+                        L2[k] 	+= y * y;
+                        continue;
+                    }
+
+                    ShadeRec sr(world);
+                    sr.hit_an_object 	= true;
+                    sr.material_ptr 	= hits.material[k];
+                    sr.t 				= hits.t_hit[k];
+                    sr.hit_point 		= packet.rays[k].o + hits.t_hit[k] * packet.rays[k].d;
+                    sr.normal 			= hits.normal[k];
+                    sr.local_hit_point 	= hits.local_hit_point[k];
+                    sr.ray 				= packet.rays[k];
+                    sr.depth 			= 0;
+
+                    rng = streams[k];
+                    RGBColor sample = sr.material_ptr->shade(sr);
+                    streams[k] = rng;
+
+                    float y = luminance(sample);
+
+                    L[k] 	+= sample;
+                    L2[k] 	+= y * y;
+                }
+            }
+
+            for (int k = 0; k < lanes; k++) {
+                sums[r * tile_size + c0 + k] 	= L[k];
+                squares[r * tile_size + c0 + k] = L2[k];
+            }
+        }
+}
+
+
+// ---------------------------------------------------------------- copy_tile
+// the tile is finished: copy it out in one go, scaling the sums to averages
+
+void
+TileRenderer::copy_tile(const Tile& tile, const std::vector<RGBColor>& buffer, const float scale, Framebuffer& fb) const {
+    for (int r = 0; r < tile.rows; r++)
+        for (int c = 0; c < tile.columns; c++)
+            fb.at(tile.row0 + r, tile.column0 + c) = buffer[r * tile_size + c] * scale;
+}
+
+
+// ---------------------------------------------------------------- display
+
+void
+TileRenderer::display(const World& w, const Framebuffer& fb) {
+    for (int r = 0; r < fb.vres; r++)
+        for (int c = 0; c < fb.hres; c++)
+            w.display_pixel(r, c, fb.at(r, c));
+}
@@ -0,0 +1,230 @@
+#ifndef __TILE_RENDERER__
+#define __TILE_RENDERER__
+
+// Multithreaded replacement for the cameras' per-pixel render loops.
+// The image is cut into square tiles that are dealt out to one queue per thread; a thread
+// that runs dry steals from the back of the other queues. Every pixel draws its samples
+// from a RandomStream seeded by the pixel index, so the image does not depend on the
+// thread count or on which thread renders which tile. Finished tiles are copied into a
+// shared Framebuffer, which display() then hands to World::display_pixel.
+// With a Pinhole camera and a RayCast tracer, neighbouring pixels of a row are traced
+// together as a RayPacket through the top-level objects that take packets; each lane is
+// then shaded as RayCast would have shaded it, drawing from its own pixel's stream, so
+// the image is the same with packets on or off.
+// render_progressive renders the samples of every pixel in passes, adds them up in a
+// floating-point buffer and publishes the running average after each pass. A tile stops
+// taking passes once the variance of its pixel means drops below a threshold, so flat
+// regions finish early and a bad framing can be cancelled from the first preview.
+// render_views renders one world from several cameras with a single pool of tiles, so the
+// scene is built once and the threads stay busy across the views.
+// render_adaptive gives every pixel a few samples and then spends a per-frame sample budget
+// only on the pixels whose luminance variance, or contrast with their neighbours, is high.
+// Before the threads start, every render looks up what it needs from the world's objects
+// once: their packet paths, and the occluders of the lights that keep an OccluderList.
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "World/Framebuffer.h"
+
+class Camera;
+class SamplePattern;
+class PacketPrimitive;
+class PrimaryRays;
+class World;
+
+struct Tile {
+    int row0, column0;
+    int rows, columns;
+};
+
+// called after every progressive pass with the running image; return false to stop
+
+typedef std::function<bool (const Framebuffer& fb, const int pass, const int active_tiles)> ProgressCallback;
+
+class TileRenderer {
+    public:
+
+        TileRenderer(void);
+
+        void
+        set_num_threads(const int n);				// 0 uses every hardware thread
+
+        int
+        get_num_threads(void) const;
+
+        void
+        set_tile_size(const int size);
+
+        void
+        set_seed(const unsigned int s);
+
+        void
+        set_packets(const bool on);					// on by default
+
+        void
+        set_samples_per_pass(const int n);			// progressive mode, 4 by default
+
+        void
+        set_variance_threshold(const float v);		// progressive mode, 0 never stops early
+
+        void
+        set_initial_samples(const int n);			// adaptive mode, 4 by default
+
+        void
+        set_sample_budget(const float n);			// adaptive mode, mean samples per pixel;
+                                                    // 0 uses a quarter of the view plane's
+
+        bool
+        render(const World& w, Framebuffer& fb) const;
+
+        bool
+        render(const World& w, const Camera* camera_ptr, Framebuffer& fb) const;
+
+        bool
+        render_views(const World& w, const std::vector<const Camera*>& cameras, std::vector<Framebuffer>& fbs) const;
+
+        bool
+        render_progressive(const World& w, Framebuffer& fb, const ProgressCallback& publish) const;
+
+        bool
+        render_adaptive(const World& w, Framebuffer& fb,
+                        const ProgressCallback& publish = ProgressCallback()) const;
+
+        static void
+        display(const World& w, const Framebuffer& fb);
+
+    private:
+
+        // the samples [first, last) of every pixel of a tile; sample j is taken in stratum
+        // (j * stride) % num_samples, and the pixel streams are seeded with sequence
+        // when taken and wanted are set, pixel p instead takes the samples
+        // [taken[p], taken[p] + wanted[p]), indexed as in Framebuffer::pixels
+
+        struct Pass {
+            int 		first, last;
+            int 		stride;
+            uint64_t 	sequence;
+            const int* 	taken;
+            const int* 	wanted;
+
+            void
+            range(const int pixel, int& pixel_first, int& pixel_last) const;
+        };
+
+        // the tiles of one render, with what the tile functions need to trace them
+        // pattern is the view plane sampler's shared pattern, or null when the sampler
+        // has none; the pixels are then jittered in their strata
+
+        struct Job {
+            const World& 							w;
+            const PrimaryRays& 						rays;
+            std::vector<Tile> 						tiles;
+            std::vector<const PacketPrimitive*> 	packet_objects;
+            bool 									use_packets;
+            bool 									counting;
+            std::shared_ptr<const SamplePattern> 	pattern;
+
+            Job(const World& world, const PrimaryRays& primary_rays);
+        };
+
+        int				num_threads;
+        int				tile_size;
+        unsigned int	seed;
+        bool			packets;
+        int				samples_per_pass;
+        float			variance_threshold;
+        int				initial_samples;
+        float			sample_budget;
+
+        std::vector<Tile>
+        make_tiles(const int hres, const int vres) const;
+
+        void
+        prepare(Job& job) const;
+
+        void
+        for_each_tile(	const std::vector<int>& tile_indices,
+                        const std::function<void (const int tile, const int worker)>& work) const;
+
+        int
+        num_workers(const int num_tiles) const;
+
+        void
+        trace_tile(const Job& job, const Tile& tile, const Pass& pass,
+                   std::vector<RGBColor>& sums, std::vector<float>& squares) const;
+
+        void
+        render_tile(const Job& job, const Tile& tile, const Pass& pass,
+                    std::vector<RGBColor>& sums, std::vector<float>& squares) const;
+
+        void
+        render_tile_packets(const Job& job, const Tile& tile, const Pass& pass,
+                            std::vector<RGBColor>& sums, std::vector<float>& squares) const;
+
+        void
+        copy_tile(const Tile& tile, const std::vector<RGBColor>& buffer, const float scale, Framebuffer& fb) const;
+
+        static bool
+        takes_packets(const World& w, const PrimaryRays& rays, bool& counting);
+};
+
+
+// ---------------------------------------------------------------- set_tile_size
+
+inline void
+TileRenderer::set_tile_size(const int size) {
+    tile_size = size < 1 ? 1 : size;
+}
+
+
+// ---------------------------------------------------------------- set_seed
+
+inline void
+TileRenderer::set_seed(const unsigned int s) {
+    seed = s;
+}
+
+
+// ---------------------------------------------------------------- set_packets
+
+inline void
+TileRenderer::set_packets(const bool on) {
+    packets = on;
+}
+
+
+// ---------------------------------------------------------------- set_samples_per_pass
+
+inline void
+TileRenderer::set_samples_per_pass(const int n) {
+    samples_per_pass = n < 1 ? 1 : n;
+}
+
+
+// ---------------------------------------------------------------- set_variance_threshold
+
+inline void
+TileRenderer::set_variance_threshold(const float v) {
+    variance_threshold = v < 0.0f ? 0.0f : v;
+}
+
+
+// ---------------------------------------------------------------- set_initial_samples
+
+inline void
+TileRenderer::set_initial_samples(const int n) {
+    initial_samples = n < 2 ? 2 : n;
+}
+
+
+// ---------------------------------------------------------------- set_sample_budget
+
+inline void
+TileRenderer::set_sample_budget(const float n) {
+    sample_budget = n < 0.0f ? 0.0f : n;
+}
+
+#endif
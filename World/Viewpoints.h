@@ -0,0 +1,32 @@
+#ifndef __VIEWPOINTS__
+#define __VIEWPOINTS__
+
+// Cameras for the VIEWPOINTs of the scenes that have them, made without touching the world,
+// so that one built scene can be rendered from several views (TileRenderer::render_views).
+// The orbit cameras circle the same targets about the z axis, for turntables (Animation).
+// The caller owns the cameras.
+
+#include <vector>
+
+#include "Utilities/Point3D.h"
+#include "World/Worlds.h"
+
+class Camera;
+
+Camera* make_viewpoint(const Point3D& target, VIEWPOINT view_choice, double distance, double view_distance);
+
+std::vector<Camera*> make_viewpoints(const Point3D& target, const std::vector<VIEWPOINT>& view_choices,
+                                     double distance, double view_distance);
+
+Camera* make_orbit_viewpoint(const Point3D& target, double azimuth, double elevation,
+                             double distance, double view_distance);				// angles in degrees
+
+std::vector<Camera*> transparent_viewpoints(const std::vector<VIEWPOINT>& view_choices);		// as build_transparent_world
+
+std::vector<Camera*> working_desk_viewpoints(const std::vector<VIEWPOINT>& view_choices);		// as build_working_desk_world
+
+Camera* transparent_orbit(double azimuth);
+
+Camera* working_desk_orbit(double azimuth);
+
+#endif
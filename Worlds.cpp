@@ -3,19 +3,26 @@
 #include "Materials/Reflective.h"
 #include "Materials/Transparent.h"
 #include "Materials/GlossyReflector.h"
+#include "Materials/MaterialRegistry.h"
 
 #include "Cameras/Fisheye.h"
 #include "Cameras/Pinhole.h"
 #include "Cameras/StereoCamera.h"
 #include "Cameras/ThinLens.h"
 
+#include "GeometricObjects/AnalyticBounds.h"
 #include "GeometricObjects/Instance.h"
+#include "GeometricObjects/Placement.h"
 
 #include "GeometricObjects/BeveledObjects/BeveledBox.h"
+#include "GeometricObjects/BeveledObjects/PacketBeveledBox.h"
 #include "GeometricObjects/Primitives/Rectangle.h"
 
 #include "GeometricObjects/CompoundObjects/Box.h"
-#include "GeometricObjects/CompoundObjects/Grid.h"
+#include "GeometricObjects/CompoundObjects/BVH.h"
+#include "GeometricObjects/CompoundObjects/Group.h"
+#include "GeometricObjects/CompoundObjects/PacketBox.h"
+#include "GeometricObjects/CompoundObjects/MailboxGrid.h"
 #include "GeometricObjects/CompoundObjects/RoundRimmedBowl.h"
 #include "GeometricObjects/CompoundObjects/SolidCylinder.h"
 #include "GeometricObjects/CompoundObjects/SolidCone.h"
@@ -24,15 +31,26 @@
 #include "GeometricObjects/PartObjects/ConvexPartSphere.h"
 #include "GeometricObjects/PartObjects/OpenPartCylinder.h"
 #include "GeometricObjects/Triangles/Triangle.h"
+#include "GeometricObjects/Triangles/PacketTriangle.h"
 
 #include "GeometricObjects/Primitives/Plane.h"
+#include "GeometricObjects/Primitives/Cone.h"
+#include "GeometricObjects/Primitives/PacketDisk.h"
+#include "GeometricObjects/Primitives/PacketPlane.h"
+#include "GeometricObjects/Primitives/PacketSphere.h"
+#include "GeometricObjects/Primitives/PacketTorus.h"
+#include "GeometricObjects/Primitives/SphereSet.h"
 #include "GeometricObjects/Primitives/Torus.h"
+#include "GeometricObjects/Primitives/Tube.h"
 
 
 
+#include "Lights/CachedDirectional.h"
 #include "Lights/Directional.h"
+#include "Lights/DiskLight.h"
 #include "Lights/PointLight.h"
 #include "Lights/AreaLight.h"
+#include "Lights/LightTree.h"
 
 #include "Materials/Matte.h"
 #include "Materials/SV_Matte.h"
@@ -44,11 +62,33 @@
 #include "Samplers/MultiJittered.h"
 #include "Samplers/Jittered.h"
 
-#include "Tracers/RayCast.h"
+#include "Tracers/ThreadSafeRayCast.h"
 
+#include "Utilities/Constants.h"
+
+#include "World/DeskLights.h"
+#include "World/SphereField.h"
+#include "World/Viewpoints.h"
 #include "World/Worlds.h"
 #include "World/World.h"
 
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+// every builder shares materials through this registry, so a colour used by many
+// objects is one Material rather than one per object; each top-level builder clears it
+// first, so that a new World never reuses the materials an earlier World's probe made
+static MaterialRegistry& materials = MaterialRegistry::shared();
+
+static void set_shared_material(World* w, GeometricObject* obj, const RGBColor& color) {
+    materials.set_material(w, obj, color);
+}
+static void set_shared_material(World* w, GeometricObject* obj, MATERIAL_CHOICE choice, const RGBColor& color) {
+    materials.set_material(w, obj, choice, color);
+}
+
 RGBColor lightRed(1, 0.4, 0.4);
 RGBColor darkRed(0.9, 0.1, 0.1);
 
@@ -93,9 +133,11 @@ struct ColorCenterRadius {
 };
 
 void build_spheres_helper(World* w, const std::vector<ColorCenterRadius>& spheres) {
-    for (const ColorCenterRadius& s : spheres) {
-        add_sphere_helper(w, s.color, s.center, s.radius);
-    }
+    SphereSet* set = new SphereSet;
+    for (const ColorCenterRadius& s : spheres)
+        set->add_sphere(s.center, s.radius, materials.get(w, s.color));
+    set->setup();
+    w->add_object(set);
 }
 
 void build_spheres(World* w) {
@@ -147,7 +189,23 @@ void build_spheres(World* w) {
     build_spheres_helper(w, spheres);
 }
 
+// a field of small spheres behind build_spheres', all in one SphereSet
+void add_sphere_field(World* w, int num_spheres) {
+    std::vector<RGBColor> colors = { yellow, brown, darkGreen, orange, green, lightGreen, darkYellow, lightPurple, darkPurple };
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+
+    SphereSet* field = new SphereSet;
+    for (int j = 0; j < num_spheres; j++) {
+        Point3D center(-300 + 600 * u(rng), -300 + 600 * u(rng), -650 + 400 * u(rng));
+        field->add_sphere(center, 1 + 2 * u(rng), materials.get(w, colors[j % colors.size()]));
+    }
+    field->setup();
+    w->add_object(field);
+}
+
 void build_sphere_world(World* w) {
+    materials.clear();
     Pinhole* camera = new Pinhole;
     camera->set_eye(0, 0, 500);
     camera->set_lookat(0.0);
@@ -158,13 +216,13 @@ void build_sphere_world(World* w) {
     w->init_viewplane();
 
     w->init_ambient_light();
-    Directional* lt = new Directional();
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
     lt->set_direction(300, 100, 200);
     lt->scale_radiance(7.0);
     w->add_light(lt);
 
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
 
     w->init_plane();
 
@@ -180,7 +238,9 @@ struct ColorBottomTop {
 
 void build_city_helper(World* w, const std::vector<ColorBottomTop>& buildings) {
     for (const ColorBottomTop& bldg : buildings) {
-        add_bb_helper(w, bldg.color, bldg.bottom, bldg.top);
+        PacketBox* box = new PacketBox(bldg.bottom, bldg.top);
+        set_shared_material(w, box, bldg.color);
+        w->add_object(box);
     }
 }
 void build_city(World* w) {
@@ -219,11 +279,12 @@ void build_city(World* w) {
         };
 
     build_city_helper(w, buildings);
-    Plane* plane = new Plane(Point3D(-30, -30, 0), Normal(0, 0, 1));
+    Plane* plane = new PacketPlane(Point3D(-30, -30, 0), Normal(0, 0, 1));
     build_checkerboard(plane, grey, white, 2);
     w->add_object(plane);
 }
 void build_city_world(World* w, double distance) {
+    materials.clear();
     Pinhole* camera = new Pinhole;
     camera->set_eye(-0.5, 0, 110);
     camera->set_lookat(-0.5, 0, -10);
@@ -234,13 +295,13 @@ void build_city_world(World* w, double distance) {
     w->init_viewplane();
 
     w->init_ambient_light();
-    Directional* lt = new Directional();
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
     lt->set_direction(-130, -15, 30);
     lt->scale_radiance(5);
     w->add_light(lt);
 
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
 
     w->init_plane();
 
@@ -252,7 +313,7 @@ void build_city_world(World* w, double distance) {
 #define SIDE 1
 
 void add_checkerboard(World* w, const RGBColor& c1, const RGBColor& c2, int size) {
-    Plane* plane = new Plane(Point3D(-30, -30, 0), Normal(0, 0, 1));
+    Plane* plane = new PacketPlane(Point3D(-30, -30, 0), Normal(0, 0, 1));
     build_checkerboard(plane, c1, c2, size);
     w->add_object(plane);
 }
@@ -270,6 +331,7 @@ void build_practical(World *w) {
     add_checkerboard(w, lightGrey, white, 1);
 }
 void build_practical_world(World* w, double distance) {
+    materials.clear();
     Pinhole* camera = new Pinhole;
     camera->set_eye(-6, -5, 9);
     camera->set_lookat(-1, 0, 7);
@@ -281,13 +343,13 @@ void build_practical_world(World* w, double distance) {
     w->init_viewplane();
 
     w->init_ambient_light();
-    Directional* lt = new Directional();
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
     lt->set_direction(10, -30, 10);
     lt->scale_radiance(8.5);
     w->add_light(lt);
 
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
 
     w->init_plane();
 
@@ -306,13 +368,14 @@ void build_sphere_triangle_box(World* w) {
     phong->set_ks(0.06);
     phong->set_exp(1);
 
-    Triangle* triangle = new Triangle(Point3D(0.7, -1, 0.2), Point3D(3, 0, 1.25), Point3D(1.5, 0.5, 1.75));
+    Triangle* triangle = new PacketTriangle(Point3D(0.7, -1, 0.2), Point3D(3, 0, 1.25), Point3D(1.5, 0.5, 1.75));
     triangle->set_material(phong);
     w->add_object(triangle);
 
     add_checkerboard(w, lightGrey, white, 1);
 }
 void build_sphere_triangle_box_world(World* w, CHOICE choice) {
+    materials.clear();
     Pinhole* camera = new Pinhole;
     switch(choice) {
     case A:    // front
@@ -341,13 +404,13 @@ void build_sphere_triangle_box_world(World* w, CHOICE choice) {
     w->init_viewplane();
 
     w->init_ambient_light();
-    Directional* lt = new Directional();
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
     lt->set_direction(50, -50, 300);
     lt->scale_radiance(4.0);
     w->add_light(lt);
 
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
 
     w->init_plane();
 
@@ -356,10 +419,11 @@ void build_sphere_triangle_box_world(World* w, CHOICE choice) {
 
 
 void build_olympic_ring(World* w, Point3D center, double rotation, RGBColor& color) {
-    Instance* isring = new Instance(new ThickRing(1.8, 2, 1, 1.1));
+    Placement* isring = new Placement(std::make_shared<ThickRing>(1.8, 2, 1, 1.1));
+    isring->set_bounds(AnalyticBounds::thick_ring(1.8, 2, 1, 1.1));
     isring->rotate_z(rotation);
     isring->translate(center);
-    w->set_material(isring, color);
+    set_shared_material(w, isring, color);
     w->add_object(isring);
 }
 
@@ -373,6 +437,7 @@ void build_olympic_rings(World* w) {
     add_checkerboard(w, lightGrey, white, 1);
 }
 void build_olympic_rings_world(World* w) {
+    materials.clear();
     Pinhole* camera = new Pinhole;
     camera->set_eye(0, 8, 10);
     camera->set_lookat(0, 0, -10);
@@ -389,12 +454,12 @@ void build_olympic_rings_world(World* w) {
 
     w->init_ambient_light(1.4);
     w->background_color = white;
-    Directional* lt = new Directional();
+    Directional* lt = new CachedDirectional;
     lt->set_direction(10, -100, 5);
     lt->scale_radiance(2);
     w->add_light(lt);
 
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
 
     w->init_plane();
 
@@ -420,6 +485,7 @@ void thin_lens_helper(World* w, const Point3D& p1, const Point3D& p2,
 }
 
 void build_thinlens(World* w, double focal_distance) {
+    materials.clear();
     int num_samples = 100;
 
     w->vp.set_hres(400);
@@ -428,7 +494,7 @@ void build_thinlens(World* w, double focal_distance) {
     w->vp.set_sampler(new MultiJittered(num_samples));
     w->vp.set_max_depth(0);
 
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
     w->background_color = white;
 
     Ambient* ambient_ptr = new Ambient;
@@ -448,7 +514,7 @@ void build_thinlens(World* w, double focal_distance) {
     w->set_camera(tl);
 
 
-    Directional* lp = new Directional;
+    Directional* lp = new CachedDirectional;
     lp->set_direction(1, 1, 1);
     lp->scale_radiance(7.5);
     lp->set_shadows(true);
@@ -458,7 +524,7 @@ void build_thinlens(World* w, double focal_distance) {
     thin_lens_helper(w, Point3D(-3.25, 0, -25), Point3D(4.75, 14, -24), blue_green, black);
     thin_lens_helper(w, Point3D(8, 0, -49),     Point3D(18, 15, -48),   orange,     black);
 
-    Instance* isplane = new Instance(new Plane(Point3D(0, 0, 0), Normal(0, 1, 0)));
+    Instance* isplane = new Instance(new PacketPlane(Point3D(0, 0, 0), Normal(0, 1, 0)));
     isplane->rotate_y(90);
     build_checkerboard(isplane, lightGrey, black, 8);
 
@@ -468,6 +534,7 @@ void build_thinlens(World* w, double focal_distance) {
 
 void
 build_fisheye(World* w, CHOICE choice) {
+    materials.clear();
     int num_samples = 25;
 
     w->vp.set_hres(600);
@@ -476,7 +543,7 @@ build_fisheye(World* w, CHOICE choice) {
 
     w->background_color = lightLightBlue;
 
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
 
     // pinhole camera for Figure 11.7(a)
 
@@ -545,7 +612,7 @@ build_fisheye(World* w, CHOICE choice) {
     matte3->set_ka(0.4);
     matte3->set_kd(0.5);
 
-    Grid* grid = new Grid;    // Construct rows of boxes stored in a grid
+    MailboxGrid* grid = new MailboxGrid;    // Construct rows of boxes stored in a grid
 
     int num_boxes = 40;    // first row
     float wx = 50;
@@ -599,7 +666,7 @@ build_fisheye(World* w, CHOICE choice) {
     sv_matte1->set_ka(1.0);
     sv_matte1->set_kd(0.50);
     sv_matte1->set_cd(check);
-    Plane* plane = new Plane(Point3D(0, 1, 0), Normal(0, 1, 0));
+    Plane* plane = new PacketPlane(Point3D(0, 1, 0), Normal(0, 1, 0));
     plane->set_material(sv_matte1);
     w->add_object(plane);
 }
@@ -628,6 +695,7 @@ build_fisheye(World* w, CHOICE choice) {
 
 
 void build_stereo(World* w, CHOICE choice) {
+    materials.clear();
   int num_samples = 1;
 
   w->vp.set_hres(200);
@@ -635,7 +703,7 @@ void build_stereo(World* w, CHOICE choice) {
   w->vp.set_pixel_size(0.05);
   w->vp.set_samples(num_samples);
 
-  w->tracer_ptr = new RayCast(w);
+  w->tracer_ptr = new ThreadSafeRayCast(w);
 
   float vpd = 100;  // view plane distance for 200 x 200 pixel images
 
@@ -667,7 +735,7 @@ void build_stereo(World* w, CHOICE choice) {
   w->set_camera(stereo);
 
 //  PointLight* lt = new PointLight;
-  Directional* lt = new Directional;
+  Directional* lt = new CachedDirectional;
   lt->set_direction(100, 100, 100);
   lt->scale_radiance(3);
 //  lt->scale_radiance(3);
@@ -700,15 +768,15 @@ void build_stereo(World* w, CHOICE choice) {
   phong3->set_ks(ks_);
   phong3->set_exp(exp_);
 
-  Sphere* sphere1 = new Sphere(Point3D(0, 0, 35), 0.75);
+  Sphere* sphere1 = new PacketSphere(Point3D(0, 0, 35), 0.75);
   sphere1->set_material(phong1);
   w->add_object(sphere1);
 
-  Sphere* sphere2 = new Sphere(Point3D(0), 2);
+  Sphere* sphere2 = new PacketSphere(Point3D(0), 2);
   sphere2->set_material(phong2);
   w->add_object(sphere2);
 
-  Sphere* sphere3 = new Sphere(Point3D(1.5, 0, -80), 2);
+  Sphere* sphere3 = new PacketSphere(Point3D(1.5, 0, -80), 2);
   sphere3->set_material(phong3);
   w->add_object(sphere3);
 }
@@ -722,8 +790,11 @@ void build_mcdonalds(World* w) {
     phong1->set_ks(0.06);
     phong1->set_exp(1);
 
-    Instance* ring1 = new Instance(new ThickRing(2, 4, 5, 6));
-    Instance* ring2 = new Instance(new ThickRing(2, 4, 5, 6));
+    std::shared_ptr<GeometricObject> ring = std::make_shared<ThickRing>(2, 4, 5, 6);
+    Placement* ring1 = new Placement(ring);
+    Placement* ring2 = new Placement(ring);
+    ring1->set_bounds(AnalyticBounds::thick_ring(2, 4, 5, 6));
+    ring2->set_bounds(AnalyticBounds::thick_ring(2, 4, 5, 6));
     ring1->translate(Point3D(0, 12, -1));
     ring2->translate(Point3D(0, 0, -1));
     ring1->set_material(phong1);
@@ -738,7 +809,8 @@ void build_mcdonalds(World* w) {
     phong2->set_ks(0.06);
     phong2->set_exp(2);
 
-    Instance* cone = new Instance(new SolidCone(5, 2));
+    Placement* cone = new Placement(std::make_shared<SolidCone>(5, 2));
+    cone->set_bounds(AnalyticBounds::solid_cone(5, 2));
     cone->rotate_x(90);
     cone->translate(Point3D(2, -3, 0));
     cone->set_material(phong2);
@@ -750,6 +822,7 @@ void build_mcdonalds(World* w) {
 }
 
 void build_mcdonalds_world(World* w) {
+    materials.clear();
     Pinhole* camera = new Pinhole;
     camera->set_eye(-3, -3, 6);
     camera->set_lookat(-1, 0, 2);
@@ -761,13 +834,13 @@ void build_mcdonalds_world(World* w) {
     w->init_viewplane();
 
     w->init_ambient_light();
-    Directional* lt = new Directional();
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
     lt->set_direction(-20, 10, 30);
     lt->scale_radiance(10.5);
     w->add_light(lt);
 
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
 
     w->init_plane();
 
@@ -775,6 +848,7 @@ void build_mcdonalds_world(World* w) {
 }
 
 void build_figure_10_10(World* w, CHOICE choice) {
+    materials.clear();
     switch(choice) {
         case A: build_thinlens(w, 50.0); break;
         case B: build_thinlens(w, 74.0); break;
@@ -784,7 +858,7 @@ void build_figure_10_10(World* w, CHOICE choice) {
 }
 
 void build_figure_11_7(World* w, CHOICE choice) {
-    qDebug("this is in 11_7\n");
+    materials.clear();
     switch(choice) {
         case A: case B: case C: case D: case E: build_fisheye(w, choice); break;
         default: throw new std::invalid_argument("Invalid choice.\n");
@@ -792,7 +866,7 @@ void build_figure_11_7(World* w, CHOICE choice) {
 }
 
 void build_figure_12_12(World* w, CHOICE choice) {
-    qDebug("this is in 12_12\n");
+    materials.clear();
     switch(choice) {
         case A: case B: build_stereo(w, choice); break;
         default: throw new std::invalid_argument("Invalid choice.\n");
@@ -808,54 +882,44 @@ struct RingDims {
 };
 
 void build_cone_helper(World* w, const Point3D& posn, const RGBColor& color, double h, double r) {
-    Instance* iscone = new Instance(new SolidCone(h,r));
+    Placement* iscone = new Placement(std::make_shared<SolidCone>(h,r));
+    iscone->set_bounds(AnalyticBounds::solid_cone(h, r));
     iscone->rotate_y(0);
     iscone->rotate_z(0);
     iscone->rotate_x(90);
     iscone->translate(posn);
 
-    std::shared_ptr<Phong> phong = std::make_shared<Phong>();
-    phong->set_ka(0.75);
-    phong->set_kd(1.25);
-    phong->set_cd(color);
-    phong->set_ks(0.25);
-    phong->set_exp(1.5);
-
-    iscone->set_material(phong);
+    iscone->set_material(materials.get_phong(color, 0.75, 1.25, 0.25, 1.5));
 //    w->set_material(iscone, color);
     w->add_object(iscone);
 }
 
 void build_cylinder_helper(World* w, const Point3D& posn, const RGBColor& color, double b, double t, double r) {
-    Instance* iscylinder = new Instance(new SolidCylinder(b,t,r));
+    Placement* iscylinder = new Placement(std::make_shared<SolidCylinder>(b,t,r));
+    iscylinder->set_bounds(AnalyticBounds::solid_cylinder(b, t, r));
     iscylinder->rotate_y(0);
     iscylinder->rotate_z(0);
     iscylinder->rotate_x(90);
     iscylinder->translate(posn);
 //    iscylinder->set_material(m_ptr);
 
-    std::shared_ptr<Phong> phong = std::make_shared<Phong>();
-    phong->set_ka(0.25);
-    phong->set_kd(0.75);
-    phong->set_cd(green);
-    phong->set_ks(0.25);
-    phong->set_exp(1.5);
-
-    w->set_material(iscylinder, color);
+    set_shared_material(w, iscylinder, color);
     w->add_object(iscylinder);
 }
 
 void build_ring_helper(World* w, const Point3D& posn, const RGBColor& color, const RingDims& rd, int r, std::shared_ptr<Material> m_ptr) {
-    Instance* isring = new Instance(new ThickRing(rd.bottom, rd.top, rd.inner, rd.outer));
+    Placement* isring = new Placement(std::make_shared<ThickRing>(rd.bottom, rd.top, rd.inner, rd.outer));
+    isring->set_bounds(AnalyticBounds::thick_ring(rd.bottom, rd.top, rd.inner, rd.outer));
     isring->rotate_y(0);
     isring->rotate_z(r);
     isring->translate(posn);
     isring->set_material(m_ptr);
-    w->set_material(isring, color);
+    set_shared_material(w, isring, color);
     w->add_object(isring);
 }
 
 void build_mcdonalds_alberto(World* w){
+    materials.clear();
     //camera
     Pinhole* ptr = new Pinhole;
     ptr->set_eye(-2, -12, 14);        // overhead
@@ -878,9 +942,9 @@ void build_mcdonalds_alberto(World* w){
     ambient_ptr->scale_radiance(0.2);
     w->set_ambient_light(ambient_ptr);
     w->background_color =  black;//RGBColor(0.9, 0.9, 0.9);
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
 
-    Directional* lt = new Directional();
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
     lt->set_direction(-30, 7, 10);
     lt->scale_radiance(8.5);
@@ -898,7 +962,7 @@ void build_mcdonalds_alberto(World* w){
     phong_ptr36->set_ks(0.25);
     phong_ptr36->set_exp(1.5);
 
-    Plane* plane_ptr = new Plane(Point3D(0, 0, -150), Normal(0, 0, 1));
+    Plane* plane_ptr = new PacketPlane(Point3D(0, 0, -150), Normal(0, 0, 1));
     plane_ptr->set_material(phong_ptr36);
     w->add_object(plane_ptr);
 
@@ -909,7 +973,7 @@ void build_mcdonalds_alberto(World* w){
     reflect1->set_kd(1.75);
     reflect1->set_cd(lightBlue);
 
-    Sphere* sphere2 = new Sphere(Point3D(2.5, 0.8, 4), 2.5);
+    Sphere* sphere2 = new PacketSphere(Point3D(2.5, 0.8, 4), 2.5);
     sphere2->set_material(reflect1);
     w->add_object(sphere2);
 
@@ -966,20 +1030,21 @@ void build_sundial(World* w, double height, double radius, double lat) {
     double pi = 3.141592;
     radius = 15;
 
-    Plane* plane = new Plane(Point3D(-30, -30, -height), Normal(0, 0, 1));
+    Plane* plane = new PacketPlane(Point3D(-30, -30, -height), Normal(0, 0, 1));
     build_checkerboard(plane, grey, white, 8);
     w->add_object(plane);
 
-    Compound* sundial = new Compound();
+    Compound* sundial = new Group();
 
     Instance* ispost = new Instance(new Box(Point3D(-post_side/2.0, -post_side/2.0, -height),
                                             Point3D(post_side, post_side, 1)));
     ispost->translate(-post_side/2, -post_side/2, 0);
-    w->set_material(ispost, darkBlue);
+    set_shared_material(w, ispost, darkBlue);
     sundial->add_object(ispost);
 
 
-    Instance* isface = new Instance(new ThickRing(0.0, 0.2, 1, radius));
+    Placement* isface = new Placement(std::make_shared<ThickRing>(0.0, 0.2, 1, radius));
+    isface->set_bounds(AnalyticBounds::thick_ring(0.0, 0.2, 1, radius));
     isface->rotate_x(90 - lat);
     isface->translate(0, 0, 0);
     build_checkerboard(isface, darkBlue, white, 1);
@@ -991,40 +1056,43 @@ void build_sundial(World* w, double height, double radius, double lat) {
                                               Point3D(side, side, gnomon_height)));
     isgnomon->translate(-side/2, -side/2, 0);
     isgnomon->rotate_x(-lat);
-    w->set_material(isgnomon, yellow);
+    set_shared_material(w, isgnomon, yellow);
     sundial->add_object(isgnomon);
 
-    Instance* iscone = new Instance(new SolidCone(4, 1));
+    Placement* iscone = new Placement(std::make_shared<SolidCone>(4, 1));
+    iscone->set_bounds(AnalyticBounds::solid_cone(4, 1));
     build_checkerboard(iscone, red, white, 0.5);
     iscone->rotate_x(90 - lat);
     iscone->translate(0, gnomon_height * sin(lat/180.0 * pi), gnomon_height * cos(lat/180.0 * pi));
     sundial->add_object(iscone);
 
-    Instance* isring = new Instance(new ThickRing(0.0, 0.5, radius - 0.1, radius));
+    Placement* isring = new Placement(std::make_shared<ThickRing>(0.0, 0.5, radius - 0.1, radius));
+    isring->set_bounds(AnalyticBounds::thick_ring(0.0, 0.5, radius - 0.1, radius));
         isring->rotate_x(90 - lat);
     isface->translate(0, 0, 0);
-    w->set_material(isring, yellow);
+    set_shared_material(w, isring, yellow);
     sundial->add_object(isring);
 
     double r = 1;
     double phi = 0.0;
     while (phi < 2 * pi) {
-        Instance* i = new Instance(new Sphere(Point3D(radius * cos(phi), radius * sin(phi),0), r));
+        Instance* i = new Instance(new PacketSphere(Point3D(radius * cos(phi), radius * sin(phi),0), r));
         i->rotate_x(-lat);
-        w->set_material(i, red);
+        set_shared_material(w, i, red);
         sundial->add_object(i);
         phi += pi / 12.0;
     }
 
     double thinside = 0.4;
     Box* box = new Box(Point3D(-thinside/2.0, -thinside/2.0, 0), Point3D(radius, thinside, thinside));
-    w->set_material(box, yellow);
+    set_shared_material(w, box, yellow);
     sundial->add_object(box);
 
     w->add_object(sundial);
 }
 
 void build_sundial_world(World* w, double height, double radius, double lat) {
+    materials.clear();
     Pinhole* ptr = new Pinhole;
     ptr->set_eye(-35, 30, 80);
 //    ptr->set_eye(-35, 30, 0);
@@ -1037,7 +1105,7 @@ void build_sundial_world(World* w, double height, double radius, double lat) {
 
     w->init_ambient_light(0.4);
 
-    Directional* lt = new Directional;
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
 //    lt->set_direction(500, 120, 30);
 //    lt->set_direction(20, 120, 30);
@@ -1047,7 +1115,7 @@ void build_sundial_world(World* w, double height, double radius, double lat) {
 
     w->add_light(lt);
 
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
 
     w->init_plane();
 
@@ -1057,7 +1125,7 @@ void build_sundial_world(World* w, double height, double radius, double lat) {
 Instance* add_torus_helper(World* w, const RGBColor& color, double a, double b,
                            Point3D& location, Point3D scale) {
     Instance* istorus = new Instance(new Torus(a, b));
-    w->set_material(istorus, color);
+    set_shared_material(w, istorus, color);
     istorus->rotate_x(90);
     istorus->rotate_y(65);//istorus->rotate_y(65);
     istorus->scale(scale);
@@ -1067,7 +1135,7 @@ Instance* add_torus_helper(World* w, const RGBColor& color, double a, double b,
 Instance* add_body_helper(World* w, const RGBColor& color, double a, double b,
                            Point3D location, Point3D scale) {
     Instance* issaucer5_3 = new Instance(new Torus(a,b));
-    w->set_material(issaucer5_3, color);
+    set_shared_material(w, issaucer5_3, color);
     issaucer5_3->rotate_z(90);
     issaucer5_3->rotate_y(-4);///
     issaucer5_3->scale(scale);
@@ -1075,32 +1143,67 @@ Instance* add_body_helper(World* w, const RGBColor& color, double a, double b,
     return issaucer5_3;
 }
 
+// the voyager is built from placements of shared prototypes, positioned in craft space;
+// every view places each part once more and collapses the pair into a single matrix
+static Placement* place_part(World* w, const std::shared_ptr<GeometricObject>& prototype, const RGBColor& color) {
+    Placement* part = new Placement(prototype);
+    set_shared_material(w, part, color);
+    return part;
+}
+static Placement* place_torus(World* w, const RGBColor& color, double a, double b,
+                              const Point3D& location, const Point3D& scale) {
+    Placement* torus = place_part(w, std::make_shared<PacketTorus>(a, b), color);
+    torus->set_bounds(AnalyticBounds::torus(a, b));
+    torus->rotate_x(90);
+    torus->rotate_y(65);
+    torus->scale(scale.x, scale.y, scale.z);
+    torus->translate(location.x, location.y, location.z);
+    return torus;
+}
+static Placement* place_body(World* w, const RGBColor& color, double a, double b,
+                             const Point3D& location, const Point3D& scale) {
+    Placement* body = place_part(w, std::make_shared<PacketTorus>(a, b), color);
+    body->set_bounds(AnalyticBounds::torus(a, b));
+    body->rotate_z(90);
+    body->rotate_y(-4);
+    body->scale(scale.x, scale.y, scale.z);
+    body->translate(location.x, location.y, location.z);
+    return body;
+}
+static void add_craft_view(World* w, const std::vector<std::shared_ptr<Placement> >& parts, const Placement& view) {
+    Compound* craft = new Group();
+    for (size_t j = 0; j < parts.size(); j++) {
+        Placement* leaf = new Placement(parts[j]);
+        leaf->append_transform(view);
+        leaf->collapse();
+        craft->add_object(leaf);
+    }
+    w->add_object(craft);
+}
+
 void build_voyager(World* w) {
     //1.Ground - big checkerboard
-    Plane* plane = new Plane(Point3D(-30, -30, 0), Normal(0, 0, 1));
+    Plane* plane = new PacketPlane(Point3D(-30, -30, 0), Normal(0, 0, 1));
     build_checkerboard(plane, grey, white, 8);
     Instance* planer = new Instance(plane);
     planer->translate(Point3D(0,0,-80));
     w->add_object(planer);
 
-    Compound* voyager = new Compound();
-    Compound* tail = new Compound();
-    Compound* head = new Compound();
+    std::vector<std::shared_ptr<Placement> > head;
+    std::vector<std::shared_ptr<Placement> > tail;
 
     //2.Top of head- smallest with the hat
     //Main head
-    Instance* issphere = new Instance(new ConvexPartSphere(Point3D(), 220, 0, 360, 0, 15));
-    w->set_material(issphere, darkDarkGrey);//red
+    Placement* issphere = place_part(w, std::make_shared<ConvexPartSphere>(Point3D(), 220, 0, 360, 0, 15), darkDarkGrey);//red
     issphere->rotate_x(90);
     issphere->scale(1,0.7,1);
     issphere->translate(Point3D(0, 0, -195));
-    head->add_object(issphere);
+    head.push_back(std::shared_ptr<Placement>(issphere));
 
     //Head-top hat (centralized controller)
-    Instance* hat = new Instance(new Box(Point3D(0,0,0),Point3D(4,4,5)));
+    Placement* hat = place_part(w, std::make_shared<Box>(Point3D(0,0,0),Point3D(4,4,5)), lightGrey);//yellow
     hat->translate(Point3D(0, -2, 22));
-    w->set_material(hat, lightGrey);//yellow
-    head->add_object(hat);
+    head.push_back(std::shared_ptr<Placement>(hat));
 
     //3.Initialize location for head addon and body-tail addon build up
     Point3D low_1_location(6, 0, 17);
@@ -1109,138 +1212,132 @@ void build_voyager(World* w) {
     Point3D low_4_location(15, 0, 17);
     Point3D low_5_location(18, 0, 17);
 
-    Point3D location(0, 0, 20);
-    Point3D high_location(4, 0, 20);
-
     //4.Head addon approximation
-    head->add_object(add_torus_helper(w, darkDarkGrey, 30, 5, low_1_location, Point3D(3, 1, 0.1)));//grey
-    head->add_object(add_torus_helper(w, darkDarkGrey, 30, 5, low_2_location, Point3D(3, 1, 0.1)));//darkBlue
-    head->add_object(add_torus_helper(w, darkDarkGrey, 30, 8, low_3_location, Point3D(2.3, 0.75, 0.1)));//lightPurple
-    head->add_object(add_torus_helper(w, darkDarkGrey, 30, 12, low_4_location, Point3D(1.7, 0.5, 0.1)));//red
-    head->add_object(add_torus_helper(w, darkDarkGrey, 30, 15, low_5_location, Point3D(1.4, 0.35, 0.1)));//red
+    head.push_back(std::shared_ptr<Placement>(place_torus(w, darkDarkGrey, 30, 5, low_1_location, Point3D(3, 1, 0.1))));//grey
+    head.push_back(std::shared_ptr<Placement>(place_torus(w, darkDarkGrey, 30, 5, low_2_location, Point3D(3, 1, 0.1))));//darkBlue
+    head.push_back(std::shared_ptr<Placement>(place_torus(w, darkDarkGrey, 30, 8, low_3_location, Point3D(2.3, 0.75, 0.1))));//lightPurple
+    head.push_back(std::shared_ptr<Placement>(place_torus(w, darkDarkGrey, 30, 12, low_4_location, Point3D(1.7, 0.5, 0.1))));//red
+    head.push_back(std::shared_ptr<Placement>(place_torus(w, darkDarkGrey, 30, 15, low_5_location, Point3D(1.4, 0.35, 0.1))));//red
 
     //5.Body-Tail Connector
     //main body-tail
-    Instance* issaucer4 = new Instance(new Torus(30, 18));
-    w->set_material(issaucer4, darkDarkGrey);//blue_green
+    Placement* issaucer4 = place_part(w, std::make_shared<PacketTorus>(30, 18), darkDarkGrey);//blue_green
+    issaucer4->set_bounds(AnalyticBounds::torus(30, 18));
     issaucer4->rotate_x(90);
     issaucer4->scale(1.25, 0.3, 0.2);
     issaucer4->translate(Point3D(45, 0, 17));
-    tail->add_object(issaucer4);
+    tail.push_back(std::shared_ptr<Placement>(issaucer4));
 
     //Body-tail addon approximation
-    Instance* issaucer5_1 = add_body_helper(w,darkDarkGrey, 30, 30, Point3D(36, 0, 21), Point3D(1, 0.2, 0.1));//lightGrey
-    tail->add_object(issaucer5_1);
-    Instance* issaucer5_2 = add_body_helper(w,darkDarkGrey, 30, 30, Point3D(40, 0, 20), Point3D(1, 0.2, 0.1));//grey
-    tail->add_object(issaucer5_2);
-    Instance* issaucer5_3 = add_body_helper(w,darkDarkGrey, 30, 30, Point3D(46, 0, 19.5), Point3D(1, 0.2, 0.1));
-    tail->add_object(issaucer5_3);
-    Instance* issaucer5_4 = add_body_helper(w,darkDarkGrey, 30, 30, Point3D(7, 0, 18), Point3D(1, 0.2, 0.1));//realGreen
-    tail->add_object(issaucer5_4);
-
-    //6.Hydrogen carriers x 2
+    tail.push_back(std::shared_ptr<Placement>(place_body(w, darkDarkGrey, 30, 30, Point3D(36, 0, 21), Point3D(1, 0.2, 0.1))));//lightGrey
+    tail.push_back(std::shared_ptr<Placement>(place_body(w, darkDarkGrey, 30, 30, Point3D(40, 0, 20), Point3D(1, 0.2, 0.1))));//grey
+    tail.push_back(std::shared_ptr<Placement>(place_body(w, darkDarkGrey, 30, 30, Point3D(46, 0, 19.5), Point3D(1, 0.2, 0.1))));
+    tail.push_back(std::shared_ptr<Placement>(place_body(w, darkDarkGrey, 30, 30, Point3D(7, 0, 18), Point3D(1, 0.2, 0.1))));//realGreen
+
+    //6.Hydrogen carriers x 2, sharing one cylinder
+    std::shared_ptr<GeometricObject> carrier = std::make_shared<SolidCylinder>(0,15,4);
     //outer-layer
-    Instance* iscarrier1 = new Instance(new SolidCylinder(0,15,4));
-    w->set_material(iscarrier1, darkDarkGrey);//orange
+    Placement* iscarrier1 = place_part(w, carrier, darkDarkGrey);//orange
+    iscarrier1->set_bounds(AnalyticBounds::solid_cylinder(0, 15, 4));
     iscarrier1->rotate_z(-90);
     //inner-layer
-    Instance* iscarrier1_1 = new Instance(iscarrier1->clone());
+    Placement* iscarrier1_1 = new Placement(*iscarrier1);
     iscarrier1_1->scale(Point3D(1.5, 0.7, 0.5));
     //...and real position
     iscarrier1->translate(Point3D(80, 25, 18));
     iscarrier1_1->translate(Point3D(76, 25, 18));
     //..before showing
-    tail->add_object(iscarrier1);
-    tail->add_object(iscarrier1_1);
+    tail.push_back(std::shared_ptr<Placement>(iscarrier1));
+    tail.push_back(std::shared_ptr<Placement>(iscarrier1_1));
 
     //we need 2 of those set, so..
-    Instance* iscarrier2 = new Instance(new SolidCylinder(0,15,4));//outer-layer
-    w->set_material(iscarrier2, darkDarkGrey);//orange
+    Placement* iscarrier2 = place_part(w, carrier, darkDarkGrey);//outer-layer
+    iscarrier2->set_bounds(AnalyticBounds::solid_cylinder(0, 15, 4));
     iscarrier2->rotate_z(-90);
 
-    Instance* iscarrier2_1 = new Instance(iscarrier2->clone()); //inner-layer
+    Placement* iscarrier2_1 = new Placement(*iscarrier2); //inner-layer
     iscarrier2_1->scale(Point3D(1.5, 0.7, 0.5));
     iscarrier2->translate(Point3D(80, -25, 18));
     iscarrier2_1->translate(Point3D(76, -25, 18));
 
-    tail->add_object(iscarrier2);
-    tail->add_object(iscarrier2_1);
+    tail.push_back(std::shared_ptr<Placement>(iscarrier2));
+    tail.push_back(std::shared_ptr<Placement>(iscarrier2_1));
 
     //7.Carrier-Tail Connector x2
-    Instance* connector1 = new Instance(new Box(Point3D(0,0,0),Point3D(5,15,5)));
+    std::shared_ptr<GeometricObject> connector = std::make_shared<Box>(Point3D(0,0,0),Point3D(5,15,5));
+    Placement* connector1 = place_part(w, connector, darkDarkGrey);//cyan
     connector1->rotate_z(+7);
     connector1->translate(Point3D(59, +02.5, 40));
     connector1->scale(1.5,1.5,0.4);
-    w->set_material(connector1, darkDarkGrey);//cyan
-    tail->add_object(connector1);
+    tail.push_back(std::shared_ptr<Placement>(connector1));
 
-    Instance* connector2 = new Instance(new Box(Point3D(0,0,0),Point3D(5,15,5)));
+    Placement* connector2 = place_part(w, connector, darkDarkGrey);//cyan
     connector2->rotate_z(-7);
     connector2->translate(Point3D(57, -17.5, 40));
     connector2->scale(1.5,1.5,0.4);
-    w->set_material(connector2, darkDarkGrey);//cyan
-    tail->add_object(connector2);
+    tail.push_back(std::shared_ptr<Placement>(connector2));
 
     //8. Have fun with compartments
-    Instance* tailer = new Instance(tail);
-    Instance* header = new Instance(head);
-
-    header->scale(Point3D(1,1,1.3));
-    header->translate(Point3D(-5,0,0));
-    header->rotate_y(-2);
-
-    voyager->add_object(header);
-    voyager->add_object(tailer);
+    Placement header;
+    header.scale(Point3D(1,1,1.3));
+    header.translate(Point3D(-5,0,0));
+    header.rotate_y(-2);
+
+    std::vector<std::shared_ptr<Placement> > voyager(tail);
+    for (size_t j = 0; j < head.size(); j++) {
+        head[j]->append_transform(header);
+        voyager.push_back(head[j]);
+    }
 
     //XII.Time for sampling angle viewing
-    Instance* craft_sample = new Instance(voyager);
+    Placement craft_sample;
     Point3D scaler = Point3D(0.6,0.6,0.6);
-    craft_sample->scale(scaler);//smaller for easier rendering
-//    w->add_object(craft_sample);
+    craft_sample.scale(scaler);//smaller for easier rendering
 
     //Overhead
-    Instance* overhead_craft = new Instance(craft_sample->clone());
-    overhead_craft->rotate_z(45);
-    overhead_craft->translate(Point3D(0,90,0));
-    w->add_object(overhead_craft);
+    Placement overhead_craft(craft_sample);
+    overhead_craft.rotate_z(45);
+    overhead_craft.translate(Point3D(0,90,0));
+    add_craft_view(w, voyager, overhead_craft);
 
     //Front
-    Instance* front_craft = new Instance(craft_sample->clone());
-    front_craft->rotate_z(45);
-    front_craft->rotate_y(90);
-    front_craft->rotate_x(-45);
+    Placement front_craft(craft_sample);
+    front_craft.rotate_z(45);
+    front_craft.rotate_y(90);
+    front_craft.rotate_x(-45);
 
     //customized angle view @ selected coord
-    front_craft->rotate_x(+18);
-    front_craft->rotate_z(+35);
-    front_craft->translate(Point3D(90,0,0));
-    front_craft->rotate_y(-45);
-    w->add_object(front_craft);
+    front_craft.rotate_x(+18);
+    front_craft.rotate_z(+35);
+    front_craft.translate(Point3D(90,0,0));
+    front_craft.rotate_y(-45);
+    add_craft_view(w, voyager, front_craft);
 
     //Side
-    Instance* side_craft = new Instance(craft_sample->clone());
-    side_craft->rotate_x(-90);
-    side_craft->rotate_z(-45);
-    side_craft->translate(Point3D(-90,0,0));
-    w->add_object(side_craft);
+    Placement side_craft(craft_sample);
+    side_craft.rotate_x(-90);
+    side_craft.rotate_z(-45);
+    side_craft.translate(Point3D(-90,0,0));
+    add_craft_view(w, voyager, side_craft);
 
     //Back
-    Instance* back_craft = new Instance(craft_sample->clone());
-    back_craft->rotate_x(-90);
-    back_craft->rotate_y(-90);
-    back_craft->rotate_z(-45);
+    Placement back_craft(craft_sample);
+    back_craft.rotate_x(-90);
+    back_craft.rotate_y(-90);
+    back_craft.rotate_z(-45);
     //customized angle view @ selected coord
-    back_craft->rotate_z(-45);
-    back_craft->rotate_y(-20);
-    back_craft->rotate_z(+45);
-    back_craft->translate(Point3D(0,-90,0));
-    back_craft->rotate_x(-20);
-    back_craft->rotate_z(-03);
-    w->add_object(back_craft);
+    back_craft.rotate_z(-45);
+    back_craft.rotate_y(-20);
+    back_craft.rotate_z(+45);
+    back_craft.translate(Point3D(0,-90,0));
+    back_craft.rotate_x(-20);
+    back_craft.rotate_z(-03);
+    add_craft_view(w, voyager, back_craft);
 
 }
 
 void build_voyager_world(World* w, int choice) {
+    materials.clear();
     //1.Camera
     Pinhole* ptr = new Pinhole;
     //1.1.Eye at
@@ -1264,7 +1361,7 @@ void build_voyager_world(World* w, int choice) {
     //2.Viewplane ft. Light
     w->init_viewplane();
     w->init_ambient_light(0.4);
-    Directional* lt = new Directional;
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
 
     switch(choice) {
@@ -1277,13 +1374,13 @@ void build_voyager_world(World* w, int choice) {
     w->add_light(lt);
 
     //3.Rays
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
     w->init_plane();
     build_voyager(w);
 }
 
 void build_transparent(World* w, const Point3D& ball) {
-    Plane* plane = new Plane(Point3D(-30,-30,0), Normal(0,0,1));
+    Plane* plane = new PacketPlane(Point3D(-30,-30,0), Normal(0,0,1));
     build_checkerboard(plane, grey, white, 20);
     w->add_object(plane);
 
@@ -1295,31 +1392,31 @@ void build_transparent(World* w, const Point3D& ball) {
     //                          X                                                   X
     //REACHING TRANSPARENTS--> Need surrouding balls to get transparent shown up on that object
     //1.center ball
-    Instance* iscenter_ball = new Instance(new Sphere(ball, 10));
+    Instance* iscenter_ball = new Instance(new PacketSphere(ball, 10));
     //2.surrounding balls
     //0.Define distance
     double distance_from_center_ball = 3.5;
     //2.1.bottom ball
     Instance* isbot_ball = new Instance(
-                new Sphere(Point3D(ball.x, ball.y, ball.z-distance_from_center_ball), 1));
+                new PacketSphere(Point3D(ball.x, ball.y, ball.z-distance_from_center_ball), 1));
     //2.2.top ball
     Instance* istop_ball = new Instance(
-                new Sphere(Point3D(ball.x, ball.y, ball.z+distance_from_center_ball), 1));
+                new PacketSphere(Point3D(ball.x, ball.y, ball.z+distance_from_center_ball), 1));
     //2.3.left ball
     Instance* isleft_ball = new Instance(
-                new Sphere(Point3D(ball.x, ball.y-distance_from_center_ball, ball.z), 1));
+                new PacketSphere(Point3D(ball.x, ball.y-distance_from_center_ball, ball.z), 1));
     //2.4.right ball
     Instance* isright_ball = new Instance(
-                new Sphere(Point3D(ball.x, ball.y+distance_from_center_ball, ball.z), 1));
+                new PacketSphere(Point3D(ball.x, ball.y+distance_from_center_ball, ball.z), 1));
     //2.5.front ball
     Instance* isfront_ball = new Instance(
-                new Sphere(Point3D(ball.x-distance_from_center_ball, ball.y, ball.z), 1));
+                new PacketSphere(Point3D(ball.x-distance_from_center_ball, ball.y, ball.z), 1));
     //2.6.back ball
     Instance* isback_ball = new Instance(
-                new Sphere(Point3D(ball.x+distance_from_center_ball, ball.y, ball.z), 1));
+                new PacketSphere(Point3D(ball.x+distance_from_center_ball, ball.y, ball.z), 1));
 
     //3.Okay, now let's show one by one on the checkerboard
-    w->set_material(iscenter_ball, TRANSPARENTS, white);    w->add_object(iscenter_ball);
+    set_shared_material(w, iscenter_ball, TRANSPARENTS, white);    w->add_object(iscenter_ball);
 //    w->set_material(isfront_ball, MATTE, red);              w->add_object(isfront_ball);
 //    w->set_material(isback_ball, MATTE, yellow);            w->add_object(isback_ball);
 //    w->set_material(isleft_ball, MATTE, green);             w->add_object(isleft_ball);
@@ -1328,16 +1425,18 @@ void build_transparent(World* w, const Point3D& ball) {
 //    w->set_material(isbot_ball, MATTE, brown);              w->add_object(isbot_ball);
 }
 
-Camera* set_viewpoint(World* w, Point3D& target, VIEWPOINT view_choice, double distance, double view_distance) {
-    Pinhole* ptr = new Pinhole;
-    ptr->set_view_distance(view_distance);
-    double x=target.x;
-    double y=target.y;
-    double z=target.z;
-
+// the two axis boxes the viewpoint scenes show at the origin; added once per world
+void add_viewpoint_axes(World* w) {
     Point3D origin = Point3D(0,0,0);
     add_bb_helper(w,red,origin,30,2,1);//x
     add_bb_helper(w,darkBlue,origin,2,30,1);//y
+}
+
+// a camera for view_choice, made without touching any world
+Camera* make_viewpoint(const Point3D& target, VIEWPOINT view_choice, double distance, double view_distance) {
+    double x=target.x;
+    double y=target.y;
+    double z=target.z;
 //enum VIEWPOINT {OVERHEAD, FRONT, BACK, LEFT, LEFT_TOP, RIGHT, RIGHT_TOP, UNDERNEATH };
     switch(view_choice) {
         case OVERHEAD:      z+=distance; break;
@@ -1352,10 +1451,38 @@ Camera* set_viewpoint(World* w, Point3D& target, VIEWPOINT view_choice, double d
     }
     x -= 0.001;
     y -= 0.001;
+    Pinhole* ptr = new Pinhole;
+    ptr->set_view_distance(view_distance);
     ptr->set_eye(Point3D(x,y,z));
     ptr->set_lookat(target);
     ptr->set_up_vector(0, 0, 1);
     ptr->compute_uvw();
+    return ptr;
+}
+
+std::vector<Camera*> make_viewpoints(const Point3D& target, const std::vector<VIEWPOINT>& view_choices,
+                                     double distance, double view_distance) {
+    std::vector<Camera*> cameras;
+    for (VIEWPOINT view_choice : view_choices)
+        cameras.push_back(make_viewpoint(target, view_choice, distance, view_distance));
+    return cameras;
+}
+
+// a camera circling target about the z axis, azimuth and elevation in degrees
+Camera* make_orbit_viewpoint(const Point3D& target, double azimuth, double elevation, double distance, double view_distance) {
+    double a = azimuth * PI_ON_180;
+    double e = elevation * PI_ON_180;
+    Pinhole* ptr = new Pinhole;
+    ptr->set_view_distance(view_distance);
+    ptr->set_eye(target + distance * Vector3D(cos(e) * cos(a), cos(e) * sin(a), sin(e)));
+    ptr->set_lookat(target);
+    ptr->set_up_vector(0, 0, 1);
+    ptr->compute_uvw();
+    return ptr;
+}
+
+Camera* set_viewpoint(World* w, Point3D& target, VIEWPOINT view_choice, double distance, double view_distance) {
+    Camera* ptr = make_viewpoint(target, view_choice, distance, view_distance);
     w->set_camera(ptr);
     return ptr;
 }
@@ -1367,10 +1494,6 @@ void set_viewpoint(World* w, Point3D& target, double angle_z, double distance, d
     double y=target.y + distance * cos(angle_z/180*3.14);
     double z=target.z + distance * sin(angle_z/180*3.14);
 
-    Point3D origin = Point3D(0,0,0);
-    add_bb_helper(w,red,origin,30,2,1);//x
-    add_bb_helper(w,darkBlue,origin,2,30,1);//y
-
     x += 0.001;
     y += 0.001;
     ptr->set_eye(Point3D(x,y,z));
@@ -1380,31 +1503,53 @@ void set_viewpoint(World* w, Point3D& target, double angle_z, double distance, d
     w->set_camera(ptr);
 }
 
+// where build_transparent_world and build_working_desk_world look from
+static const Point3D transparent_target(0,0,10);
+static const Point3D desk_target(-5,0,20);
+
+std::vector<Camera*> transparent_viewpoints(const std::vector<VIEWPOINT>& view_choices) {
+    return make_viewpoints(transparent_target, view_choices, 200, 300);
+}
+
+std::vector<Camera*> working_desk_viewpoints(const std::vector<VIEWPOINT>& view_choices) {
+    return make_viewpoints(desk_target, view_choices, 250, 250);
+}
+
+Camera* transparent_orbit(double azimuth) {
+    return make_orbit_viewpoint(transparent_target, azimuth, 35, 200, 300);
+}
+
+Camera* working_desk_orbit(double azimuth) {
+    return make_orbit_viewpoint(desk_target, azimuth, 35, 250, 250);
+}
+
 void build_transparent_world(World* w) {
-    Point3D ball(0,0,10);//0,0,10
+    materials.clear();
+    Point3D ball = transparent_target;
     set_viewpoint(w, ball, OVERHEAD, 200, 300);
     w->init_viewplane();
     w->init_ambient_light(0.4);
 
-    Directional* lt = new Directional;
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
     lt->set_direction(20,20,5);
     lt->scale_radiance(11);
     w->add_light(lt);
 
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
     w->init_plane();
 
-    //std::vector<VIEWPOINT> viewpoints = {FRONT};
-    //MultiCamera* multi_camera = build_multicamera(w, ball, viewpoints, 150, 300);
-    //w->set_cameras(multi_camera);
+    // other views of the same world: transparent_viewpoints and TileRenderer::render_views
 
     build_transparent(w, ball);
 }
 
 void build_working_desk_world(World* w, VIEWPOINT choice) {
+    materials.clear();
     //1.Camera
-    Point3D target = Point3D(-5,0,20);
+    Point3D target = desk_target;
+
+    add_viewpoint_axes(w);
 
     //1.1.Eye at
     set_viewpoint(w, target, choice, 250, 250);
@@ -1415,7 +1560,7 @@ void build_working_desk_world(World* w, VIEWPOINT choice) {
 
     //3.Light
     w->init_ambient_light(1.8);//0.4
-    Directional* lt = new Directional;
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
 
     lt->set_direction(50, 50, 100);
@@ -1423,14 +1568,17 @@ void build_working_desk_world(World* w, VIEWPOINT choice) {
     w->add_light(lt);
 
     //3.Rays
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
     w->init_plane();
     build_working_desk(w);
 }
 
 void build_working_desk_world(World* w, double angle) {
+    materials.clear();
     //1.Camera
-    Point3D target = Point3D(-5,0,20);
+    Point3D target = desk_target;
+
+    add_viewpoint_axes(w);
 
     //1.1.Eye at
     //set_viewpoint(w, target, choice, 250, 250);
@@ -1441,7 +1589,7 @@ void build_working_desk_world(World* w, double angle) {
 
     //3.Light
     w->init_ambient_light(1.8);//0.4
-    Directional* lt = new Directional;
+    Directional* lt = new CachedDirectional;
     lt->set_shadows(true);
 
     lt->set_direction(50, 50, 100);
@@ -1449,30 +1597,51 @@ void build_working_desk_world(World* w, double angle) {
     w->add_light(lt);
 
     //3.Rays
-    w->tracer_ptr = new RayCast(w);
+    w->tracer_ptr = new ThreadSafeRayCast(w);
     w->init_plane();
     build_working_desk(w);
 }
 
+// bevelled-box prototypes by (dx, dy, dz, bevel radius), owned by the desk being built:
+// build_working_desk makes one and points this thread's desk_prototypes at it until it
+// returns, so a prototype is shared within one World and never across Worlds or threads
+typedef std::map<std::tuple<double, double, double, double>, std::shared_ptr<GeometricObject> > BeveledBoxTable;
+
+static thread_local BeveledBoxTable* desk_prototypes = NULL;
+
+struct DeskPrototypes {
+    BeveledBoxTable table;
+    DeskPrototypes() { desk_prototypes = &table; }
+    ~DeskPrototypes() { desk_prototypes = NULL; }
+};
+
+// one bevelled box per size, with its corner at the origin, shared by every placement of
+// that size in the desk being built; outside a desk every call makes its own
+static std::shared_ptr<GeometricObject> shared_beveled_box(double dx, double dy, double dz, double rb) {
+    if (!desk_prototypes)
+        return std::make_shared<PacketBeveledBox>(Point3D(0, 0, 0), Point3D(dx, dy, dz), rb);
+    std::shared_ptr<GeometricObject>& prototype = (*desk_prototypes)[std::make_tuple(dx, dy, dz, rb)];
+    if (!prototype)
+        prototype = std::make_shared<PacketBeveledBox>(Point3D(0, 0, 0), Point3D(dx, dy, dz), rb);
+    return prototype;
+}
+
 void add_bb_to_compound(World* w, Compound* cp, RGBColor color,
                         Point3D p0, double dx, double dy, double dz) {
-    Point3D p1 = Point3D(p0.x + dx, p0.y + dy, p0.z + dz);
-    BeveledBox* bb = new BeveledBox(p0, p1, 0.2);
-    w->set_material(bb, color);//w->set_material(bb, color);
+    Placement* bb = new Placement(shared_beveled_box(dx, dy, dz, 0.2), Vector3D(p0.x, p0.y, p0.z));
+    set_shared_material(w, bb, color);
     cp->add_object(bb);
 }
 void add_bb_to_compound(World* w, Compound* cp, MATERIAL_CHOICE choice, RGBColor color,
                         Point3D p0, double dx, double dy, double dz) {
-    Point3D p1 = Point3D(p0.x + dx, p0.y + dy, p0.z + dz);
-    BeveledBox* bb = new BeveledBox(p0, p1, 0.2);
-    w->set_material(bb, choice, color);//w->set_material(bb, color);
+    Placement* bb = new Placement(shared_beveled_box(dx, dy, dz, 0.2), Vector3D(p0.x, p0.y, p0.z));
+    set_shared_material(w, bb, choice, color);
     cp->add_object(bb);
 }
 void add_curved_bb_to_compound(World* w, Compound* cp, MATERIAL_CHOICE choice, RGBColor color,
                         Point3D p0, double dx, double dy, double dz, double curve) {
-    Point3D p1 = Point3D(p0.x + dx, p0.y + dy, p0.z + dz);
-    BeveledBox* bb = new BeveledBox(p0, p1, curve);
-    w->set_material(bb, choice, color);//w->set_material(bb, color);
+    Placement* bb = new Placement(shared_beveled_box(dx, dy, dz, curve), Vector3D(p0.x, p0.y, p0.z));
+    set_shared_material(w, bb, choice, color);
     cp->add_object(bb);
 }
 #define KEY_WIDTH 4
@@ -1489,19 +1658,26 @@ void add_curved_bb_to_compound(World* w, Compound* cp, MATERIAL_CHOICE choice, R
 #define COUNTER_TOP_LATTITUDE 20
 #define TABLE_LENGTH_TIMES 30
 #define TABLE_WIDTH_TIMES 20
+#define IPAD_X 15                       //where the iPad sits on the table
+#define IPAD_Y 25
+#define LCD_X (-4.6 * KEY_SPACING)      //the lcd screen's corner in the iPad, and its size
+#define LCD_Y (-5.5 * KEY_SPACING)
+#define LCD_WIDTH (9.2 * KEY_SPACING)
+#define LCD_LENGTH (11 * KEY_SPACING)
 
 void build_working_desk(World* w) {
+    DeskPrototypes prototypes;  //the bevelled boxes' shared shapes, for this desk only
     //1.Ground - big checkerboard
     //============================================================
-    Plane* plane = new Plane(Point3D(-30, -30, 0), Normal(0, 0, 1));
-    build_checkerboard(plane, grey, white, 8);
-    Instance* planer = new Instance(plane);
+    Plane* plane = new PacketPlane(Point3D(-30, -30, 0), Normal(0, 0, 1));
+    plane->set_material(materials.get_checker(grey, white, 8));
+    Placement* planer = new Placement(std::shared_ptr<GeometricObject>(plane));
     planer->translate(Point3D(0,0,-40));
 
     //============================================================
     //2.Flat Matte Keyboard
-    Compound* cpkeyboard = new Compound();
-    Instance* iskeyboard = new Instance(cpkeyboard);
+    BVH* cpkeyboard = new BVH();
+    Placement* iskeyboard = new Placement(std::shared_ptr<GeometricObject>(cpkeyboard));
     int key_row = 0;
     int key_column = 0;
     int key_height = 0;
@@ -1592,6 +1768,7 @@ void build_working_desk(World* w) {
     //cover pad
     add_bb_to_compound(w, cpkeyboard, grey,Point3D(-2,-1,0),
     7 * KEY_SPACING - KEY_HALF_WIDTH, 14 * KEY_SPACING + KEY_HALF_LENGTH, KEY_1_HEIGHT);
+    cpkeyboard->setup_hierarchy();
     //okay, so what is origin-relative position of the keyboard? (x/2, y/2, z/2)
     iskeyboard->translate( - ( 7 * KEY_SPACING - KEY_HALF_WIDTH - (-2) ) / 2,
                            - (14 * KEY_SPACING + KEY_HALF_LENGTH - (-1) ) / 2,
@@ -1603,32 +1780,37 @@ void build_working_desk(World* w) {
 
     //============================================================
     //3.Glossy Apple Pen
-    Compound* cppen = new Compound();
-    Instance* ispen = new Instance(cppen);
+    BVH* cppen = new BVH();
+    Placement* ispen = new Placement(std::shared_ptr<GeometricObject>(cppen));
     //pen-body
-    Instance* ispen_body = new Instance(new SolidCylinder(0, 10.5 * KEY_SPACING, 1.3 * KEY_1_WIDTH));
-    w->set_material(ispen_body, PHONG, white);
+    Placement* ispen_body = new Placement(std::make_shared<Tube>(0, 10.5 * KEY_SPACING, 1.3 * KEY_1_WIDTH));
+    ispen_body->set_bounds(AnalyticBounds::solid_cylinder(0, 10.5 * KEY_SPACING, 1.3 * KEY_1_WIDTH));
+    set_shared_material(w, ispen_body, PHONG, white);
     cppen->add_object(ispen_body);
     //pen-head-curve
-    Instance* ispen_head_curve = new Instance(new SolidCone(KEY_SPACING, 1.3 * KEY_1_WIDTH));
-    w->set_material(ispen_head_curve, PHONG, white);
+    Placement* ispen_head_curve = new Placement(std::make_shared<Cone>(KEY_SPACING, 1.3 * KEY_1_WIDTH, true));
+    ispen_head_curve->set_bounds(AnalyticBounds::solid_cone(KEY_SPACING, 1.3 * KEY_1_WIDTH));
+    set_shared_material(w, ispen_head_curve, PHONG, white);
     ispen_head_curve->rotate_x(180);
     cppen->add_object(ispen_head_curve);
     //pen-head-pin
-    Instance* ispen_head_pin = new Instance(new SolidCone(KEY_SPACING, 1.00001 * KEY_1_WIDTH));
-    w->set_material(ispen_head_pin, PHONG, grey);
+    Placement* ispen_head_pin = new Placement(std::make_shared<Cone>(KEY_SPACING, 1.00001 * KEY_1_WIDTH, true));
+    ispen_head_pin->set_bounds(AnalyticBounds::solid_cone(KEY_SPACING, 1.00001 * KEY_1_WIDTH));
+    set_shared_material(w, ispen_head_pin, PHONG, grey);
     ispen_head_pin->rotate_x(180);
     ispen_head_pin->translate(0,-1.0,0);
     cppen->add_object(ispen_head_pin);
     //pen-body-liner
-    Instance* ispen_body_liner = new Instance(new SolidCylinder(0, 3, 1.30001*KEY_1_WIDTH));
-    w->set_material(ispen_body_liner, PHONG, grey);
+    Placement* ispen_body_liner = new Placement(std::make_shared<Tube>(0, 3, 1.30001*KEY_1_WIDTH));
+    ispen_body_liner->set_bounds(AnalyticBounds::solid_cylinder(0, 3, 1.30001*KEY_1_WIDTH));
+    set_shared_material(w, ispen_body_liner, PHONG, grey);
     ispen_body_liner->translate(0, 9.3*KEY_SPACING, 0);
     cppen->add_object(ispen_body_liner);
     //pen-tail
-    Instance* ispen_tail = new Instance(new Sphere(Point3D(0,10.5*KEY_SPACING,0), 1.3*KEY_1_WIDTH));
-    w->set_material(ispen_tail, PHONG, white);
+    Placement* ispen_tail = new Placement(std::make_shared<PacketSphere>(Point3D(0,10.5*KEY_SPACING,0), 1.3*KEY_1_WIDTH));
+    set_shared_material(w, ispen_tail, PHONG, white);
     cppen->add_object(ispen_tail);
+    cppen->setup_hierarchy();
     //okay, so what is origin-relative position of the pen? (x/2, y/2, z/2)
     ispen->translate(-( 0/*1.3*KEY_1_WIDTH*/ ) / 2,
                      -( 10.5 * KEY_SPACING + 1.3 * KEY_1_WIDTH) / 2,
@@ -1640,20 +1822,23 @@ void build_working_desk(World* w) {
 
     //============================================================
     //4.Transparent Glass cup
-    Compound* cpglass = new Compound();
-    Instance* isglass = new Instance(cpglass);
+    BVH* cpglass = new BVH();
+    Placement* isglass = new Placement(std::shared_ptr<GeometricObject>(cpglass));
 
     //body layer
-    Instance* iscup_body = new Instance(new ThickRing(0, 5*KEY_SPACING, 2 * KEY_SPACING, 2.2 * KEY_SPACING));
+    Placement* iscup_body = new Placement(std::make_shared<Tube>(0, 5*KEY_SPACING, 2 * KEY_SPACING, 2.2 * KEY_SPACING));
+    iscup_body->set_bounds(AnalyticBounds::thick_ring(0, 5*KEY_SPACING, 2 * KEY_SPACING, 2.2 * KEY_SPACING));
     cpglass->add_object(iscup_body);
 
     //bottom layer
-    Instance* iscup_bottom = new Instance(
-                new SolidCylinder(0, 0.5 * KEY_1_WIDTH, 2.2 * KEY_SPACING));
+    Placement* iscup_bottom = new Placement(
+                std::make_shared<Tube>(0, 0.5 * KEY_1_WIDTH, 2.2 * KEY_SPACING));
+    iscup_bottom->set_bounds(AnalyticBounds::solid_cylinder(0, 0.5 * KEY_1_WIDTH, 2.2 * KEY_SPACING));
     cpglass->add_object(iscup_bottom);
+    cpglass->setup_hierarchy();
 
     //okay, so what is origin-relative position of the pen? (x/2, y/2, z/2)
-    w->set_material(isglass, TRANSPARENTS, red);
+    set_shared_material(w, isglass, TRANSPARENTS, red);
     isglass->translate( -0,
                         -( 5 * KEY_SPACING + 0.5*KEY_1_WIDTH ) / 2,
                         -0);
@@ -1664,8 +1849,8 @@ void build_working_desk(World* w) {
 
     //============================================================
     //5.Reflective iPad
-    Compound* cpiPad = new Compound();
-    Instance* isiPad = new Instance(cpiPad);
+    BVH* cpiPad = new BVH();
+    Placement* isiPad = new Placement(std::shared_ptr<GeometricObject>(cpiPad));
     //cover
     add_curved_bb_to_compound(w, cpiPad, MATTE, white,
     Point3D(-5 * KEY_SPACING, -7 * KEY_SPACING, 0),
@@ -1677,22 +1862,23 @@ void build_working_desk(World* w) {
     +10.0 * KEY_SPACING, +14.0 * KEY_SPACING, 0.11 * KEY_1_WIDTH);
     //lcd screen
     add_bb_to_compound(w, cpiPad, REFLECTIVE, black,
-    Point3D(-4.6 * KEY_SPACING, -5.5 * KEY_SPACING, 1.9 * KEY_1_WIDTH),
-    +9.2 * KEY_SPACING, +11 * KEY_SPACING, 0.12 * KEY_1_WIDTH);
+    Point3D(LCD_X, LCD_Y, 1.9 * KEY_1_WIDTH),
+    +LCD_WIDTH, +LCD_LENGTH, 0.12 * KEY_1_WIDTH);
     //camera
-    Instance* isiPad_camera = new Instance(new Disk(Point3D(0, 6.25 * KEY_SPACING, 2.01 * KEY_1_WIDTH),
+    Placement* isiPad_camera = new Placement(std::make_shared<PacketDisk>(Point3D(0, 6.25 * KEY_SPACING, 2.01 * KEY_1_WIDTH),
                                                    Normal(0,0,1),0.15 * KEY_SPACING));
-    w->set_material(isiPad_camera, REFLECTIVE, black);
+    set_shared_material(w, isiPad_camera, REFLECTIVE, black);
     cpiPad->add_object(isiPad_camera);
     //home button
-    Instance* isiPad_home = new Instance(new Disk(Point3D(0, -6.25 * KEY_SPACING, 2.01 * KEY_1_WIDTH),
+    Placement* isiPad_home = new Placement(std::make_shared<PacketDisk>(Point3D(0, -6.25 * KEY_SPACING, 2.01 * KEY_1_WIDTH),
                                                    Normal(0,0,1),0.5 * KEY_SPACING));
-    Instance* isiPad_home_inner = new Instance(new Disk(Point3D(0, -6.25 * KEY_SPACING, 2.02 * KEY_1_WIDTH),
+    Placement* isiPad_home_inner = new Placement(std::make_shared<PacketDisk>(Point3D(0, -6.25 * KEY_SPACING, 2.02 * KEY_1_WIDTH),
                                                    Normal(0,0,1),0.48 * KEY_SPACING));
-    w->set_material(isiPad_home, MATTE, black);
-    w->set_material(isiPad_home_inner, MATTE, white);
+    set_shared_material(w, isiPad_home, MATTE, black);
+    set_shared_material(w, isiPad_home_inner, MATTE, white);
     cpiPad->add_object(isiPad_home);
     cpiPad->add_object(isiPad_home_inner);
+    cpiPad->setup_hierarchy();
     //okay, let put it all in surface of z=0 now
     isiPad->translate(  0,
                         0,
@@ -1700,43 +1886,49 @@ void build_working_desk(World* w) {
 
     //============================================================
     //6.Glossy (area light) lamp
-    Compound* cplamp = new Compound();
-    Instance* islamp = new Instance(cplamp);
+    BVH* cplamp = new BVH();
+    Placement* islamp = new Placement(std::shared_ptr<GeometricObject>(cplamp));
 
     //lamp base
-    Instance* islamp_base = new Instance(new SolidCylinder(0, 0.75 * KEY_SPACING, 1.25*KEY_SPACING));
-    w->set_material(islamp_base, PHONG, orange);
+    Placement* islamp_base = new Placement(std::make_shared<Tube>(0, 0.75 * KEY_SPACING, 1.25*KEY_SPACING));
+    islamp_base->set_bounds(AnalyticBounds::solid_cylinder(0, 0.75 * KEY_SPACING, 1.25*KEY_SPACING));
+    set_shared_material(w, islamp_base, PHONG, orange);
     cplamp->add_object(islamp_base);
     islamp_base->rotate_x(+90);
     islamp_base->translate(-35, 65, COUNTER_TOP_LATTITUDE);
     //lamp stand
-    Instance* islamp_stand = new Instance(new SolidCylinder(0, 7 * KEY_SPACING, 0.20*KEY_SPACING));
-    w->set_material(islamp_stand, PHONG, orange);
+    Placement* islamp_stand = new Placement(std::make_shared<Tube>(0, 7 * KEY_SPACING, 0.20*KEY_SPACING));
+    islamp_stand->set_bounds(AnalyticBounds::solid_cylinder(0, 7 * KEY_SPACING, 0.20*KEY_SPACING));
+    set_shared_material(w, islamp_stand, PHONG, orange);
     cplamp->add_object(islamp_stand);
     islamp_stand->rotate_x(+90);
     islamp_stand->translate(-35, 65, COUNTER_TOP_LATTITUDE);
-    //lamp ball
-    Instance* islamp_ball = new Instance(new Sphere(Point3D(0,0,0),0.5*KEY_SPACING));
-    w->set_material(islamp_ball, REFLECTIVE, white);
+    //lamp ball, the glowing bulb
+    Placement* islamp_ball = new Placement(std::make_shared<PacketSphere>(Point3D(0,0,0),0.5*KEY_SPACING));
+    set_shared_material(w, islamp_ball, EMISSIVE, lemon);
+    islamp_ball->set_shadows(false);
     cplamp->add_object(islamp_ball);
     islamp_ball->translate(-35, 65, COUNTER_TOP_LATTITUDE + 7 * KEY_SPACING);
-    //lamp ball with light
-    Directional* el = new Directional();
-    el->set_direction(-35, 60, COUNTER_TOP_LATTITUDE + 6.5 * KEY_SPACING);
+    //lamp light: a disk under the bulb, shining down
+    DiskLight* el = new DiskLight(Point3D(-35, 65, COUNTER_TOP_LATTITUDE + 6.5 * KEY_SPACING - 0.05),
+                                  Normal(0, 0, -1), 0.5*KEY_SPACING);
+    el->set_color(lemon);
+    el->scale_radiance(15.0);
+    el->set_num_samples(16);
     el->set_shadows(true);
-    el->scale_radiance(0.3);
 
     //lamp ball cover
-    Instance* islamp_ball_cover = new Instance(new OpenCone(3*KEY_SPACING, 3.5*KEY_SPACING));
-    w->set_material(islamp_ball_cover, PHONG, cyan);
+    Placement* islamp_ball_cover = new Placement(std::make_shared<Cone>(3*KEY_SPACING, 3.5*KEY_SPACING, false));
+    set_shared_material(w, islamp_ball_cover, PHONG, cyan);
     cplamp->add_object(islamp_ball_cover);
     islamp_ball_cover->rotate_x(+90);
     islamp_ball_cover->translate(-35, 65, COUNTER_TOP_LATTITUDE + 6.7 * KEY_SPACING);
+    cplamp->setup_hierarchy();
 
     //============================================================
     //7.Matte table
-    Compound* cptable = new Compound();
-    Instance* istable = new Instance(cptable);
+    BVH* cptable = new BVH();
+    Placement* istable = new Placement(std::shared_ptr<GeometricObject>(cptable));
 
     //counter top
     add_curved_bb_to_compound(w, cptable, PHONG, darkYellow,
@@ -1746,10 +1938,11 @@ void build_working_desk(World* w) {
                 +TABLE_LENGTH_TIMES * KEY_SPACING, 7 * KEY_1_WIDTH,
                     0.5);
     //table stand
-    Instance* istable_stand = new Instance (new
-                        SolidCylinder(0, COUNTER_TOP_LATTITUDE - 7 * KEY_1_WIDTH, 2 * KEY_SPACING));
+    Placement* istable_stand = new Placement(std::make_shared<
+                        Tube>(0, COUNTER_TOP_LATTITUDE - 7 * KEY_1_WIDTH, 2 * KEY_SPACING));
+    istable_stand->set_bounds(AnalyticBounds::solid_cylinder(0, COUNTER_TOP_LATTITUDE - 7 * KEY_1_WIDTH, 2 * KEY_SPACING));
     istable_stand->rotate_x(+90);
-    w->set_material(istable_stand, PHONG, green);
+    set_shared_material(w, istable_stand, PHONG, green);
     cptable->add_object(istable_stand);
 
     //okay, let put it all in surface of z=0 now
@@ -1770,17 +1963,18 @@ void build_working_desk(World* w) {
     isglass->translate(40, -60, COUNTER_TOP_LATTITUDE);
 
     //7.4.iPad visualization
-    isiPad->translate(15, 25, COUNTER_TOP_LATTITUDE);
+    isiPad->translate(IPAD_X, IPAD_Y, COUNTER_TOP_LATTITUDE);
 
     cptable->add_object(iskeyboard); //done
     cptable->add_object(ispen); //done
     cptable->add_object(isglass); //done
     cptable->add_object(isiPad); //done
     cptable->add_object(islamp); //done
+    cptable->setup_hierarchy();  //after every part has its final placement
     //============================================================
     //8.Matte chair
-    Compound* cpchair = new Compound();
-    Instance* ischair = new Instance(cpchair);
+    Compound* cpchair = new Group();
+    Placement* ischair = new Placement(std::shared_ptr<GeometricObject>(cpchair));
     //============================================================
     //9.Closing up
     w->add_light(el); //light
@@ -1789,15 +1983,37 @@ void build_working_desk(World* w) {
     w->add_object(planer);
 }
 
+// a ring of num_lamps lamps over the table and the iPad's lcd as a grid of glowing cells,
+// all in one LightTree, so the desk can carry many lights at the cost of one per hit
+LightTree* add_desk_lights(World* w, int num_lamps) {
+    LightTree* lights = new LightTree;
+    lights->set_shadows(true);
+
+    double lamp_height = COUNTER_TOP_LATTITUDE + 10 * KEY_SPACING;
+    double lamp_radius = 0.4 * TABLE_LENGTH_TIMES * KEY_SPACING;
+    for (int j = 0; j < num_lamps; j++) {
+        double phi = 2.0 * PI * j / num_lamps;
+        lights->add_emitter(Point3D(lamp_radius * cos(phi), lamp_radius * sin(phi), lamp_height),
+                            lemon, 2500.0 / num_lamps);
+    }
+
+    //lcd screen, as placed in build_working_desk
+    Point3D lcd_corner(IPAD_X + LCD_X, IPAD_Y + LCD_Y, COUNTER_TOP_LATTITUDE + 2.1 * KEY_1_WIDTH);
+    int columns = 8, rows = 10;
+    for (int r = 0; r < rows; r++)
+        for (int c = 0; c < columns; c++)
+            lights->add_emitter(lcd_corner + Vector3D((c + 0.5) * LCD_WIDTH / columns,
+                                                      (r + 0.5) * LCD_LENGTH / rows, 0),
+                                Vector3D(0, 0, 1), lightLightBlue, 3.0);
+
+    lights->build();
+    w->add_light(lights);
+    return lights;
+}
+
 MultiCamera* build_multicamera(World* w, Point3D& target, const std::vector<VIEWPOINT> viewpoints,
                                 double distance, double view_distance) {
-    Camera* camera = nullptr;
-    std::vector<Camera*> cameras;
-
-    for(auto viewpoint : viewpoints) {
-        camera = set_viewpoint(w, target, viewpoint, distance, view_distance);
-        cameras.push_back(camera);
-    }
+    std::vector<Camera*> cameras = make_viewpoints(target, viewpoints, distance, view_distance);
     MultiCamera* multi_camera = new MultiCamera();
     multi_camera->setup_cameras(w, cameras);
     return multi_camera;